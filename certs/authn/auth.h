@@ -419,7 +419,7 @@ CertData getCertificate(bool &retrieved_credentials,
             // Make a new key pair file
             try {
                 log_debug_printf(auth, "%s\n", e.what());
-                key_pair = IdFileFactory::createKeyPair();
+                key_pair = IdFileFactory::createKeyPair(config.key_type);
             } catch (std::exception &new_e) {
                 throw std::runtime_error(SB() << "Error creating client key: " << new_e.what());
             }
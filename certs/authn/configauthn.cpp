@@ -10,7 +10,12 @@
 #include <ifaddrs.h>
 #include <osiProcess.h>
 
+#include <pvxs/log.h>
+
 #include "certdate.h"
+#include "certfilefactory.h"
+
+DEFINE_LOGGER(auth_cfg, "pvxs.auth.config");
 
 struct ifaddrs;
 
@@ -88,6 +93,15 @@ void ConfigAuthN::fromAuthEnv(const std::map<std::string, std::string> &defs) {
     }
 
     if (pickone({"EPICS_PVA_AUTH_CERT_VALIDITY_MINS"})) cert_validity_mins = CertDate::parseDurationMins(pickone.val);
+
+    // EPICS_PVA_AUTH_KEY_TYPE, EPICS_PVAS_AUTH_KEY_TYPE
+    if (pickone({"EPICS_PVA_AUTH_KEY_TYPE", "EPICS_PVAS_AUTH_KEY_TYPE"})) {
+        try {
+            key_type = IdFileFactory::keyType(pickone.val);
+        } catch (std::exception &e) {
+            log_err_printf(auth_cfg, "%s: %s.  Using %s\n", pickone.name.c_str(), e.what(), key_type.c_str());
+        }
+    }
 }
 
 /**
@@ -109,6 +123,7 @@ void ConfigAuthN::updateDefs(defs_t &defs) const {
     defs["EPICS_PVAS_TLS_KEYCHAIN"] = tls_srv_keychain_file;
     defs["EPICS_PVA_AUTH_CERT_VALIDITY_MINS"] = CertDate::formatDurationMins(cert_validity_mins);
     defs["EPICS_PVA_AUTH_COUNTRY"] = country;
+    defs["EPICS_PVA_AUTH_KEY_TYPE"] = defs["EPICS_PVAS_AUTH_KEY_TYPE"] = key_type;
     defs["EPICS_PVA_AUTH_ISSUER"] = defs["EPICS_PVAS_AUTH_ISSUER"] = issuer_id;
     defs["EPICS_PVA_AUTH_NAME"] = name;
     defs["EPICS_PVA_AUTH_ORGANIZATION"] = organization;
@@ -32,6 +32,9 @@ class ConfigAuthN : public client::Config {
 
     int64_t cert_validity_mins = -1; // Minutes for Custom Duration of requested certificate
 
+    // Type of key to generate when the keychain file has none.  See IdFileFactory::keyType()
+    std::string key_type{"RSA"};
+
     void fromAuthEnv(const std::map<std::string, std::string>& defs);
     static std::string getIPAddress();
     void updateDefs(defs_t& defs) const override;
@@ -223,27 +223,25 @@ std::shared_ptr<CertCreationRequest> AuthNLdap::createCertCreationRequest(
     // --- Create the Digital Signature ---
     std::string payload = ccrToString(cert_creation_request, usage);
 
-    // Use the private key from key_pair->private_key to sign the payload with SHA-256.
+    // Use the private key from key_pair->private_key to sign the payload.
+    // SHA-256 digest, except for EdDSA keys which hash internally, so sign in one shot.
     ossl_ptr<EVP_MD_CTX> message_digest_context(EVP_MD_CTX_new(), false);
     if (!message_digest_context) {
         throw std::runtime_error("Failed to create EVP_MD_CTX");
     }
 
-    if (EVP_DigestSignInit(message_digest_context.get(), nullptr, EVP_sha256(), nullptr, key_pair->pkey.get()) <= 0) {
+    if (EVP_DigestSignInit(message_digest_context.get(), nullptr, signingDigest(key_pair->pkey.get()), nullptr, key_pair->pkey.get()) <= 0) {
         throw std::runtime_error("EVP_DigestSignInit failed");
     }
 
-    if (EVP_DigestSignUpdate(message_digest_context.get(), payload.data(), payload.size()) <= 0) {
-        throw std::runtime_error("EVP_DigestSignUpdate failed");
-    }
-
+    const auto tbs = reinterpret_cast<const unsigned char *>(payload.data());
     size_t sig_len = 0;
-    if (EVP_DigestSignFinal(message_digest_context.get(), nullptr, &sig_len) <= 0) {
-        throw std::runtime_error("EVP_DigestSignFinal (get length) failed");
+    if (EVP_DigestSign(message_digest_context.get(), nullptr, &sig_len, tbs, payload.size()) <= 0) {
+        throw std::runtime_error("EVP_DigestSign (get length) failed");
     }
     std::vector<unsigned char> signature(sig_len);
-    if (EVP_DigestSignFinal(message_digest_context.get(), signature.data(), &sig_len) <= 0) {
-        throw std::runtime_error("EVP_DigestSignFinal failed");
+    if (EVP_DigestSign(message_digest_context.get(), signature.data(), &sig_len, tbs, payload.size()) <= 0) {
+        throw std::runtime_error("EVP_DigestSign failed");
     }
 
     // base64-encode the signature so it can be represented as a string.
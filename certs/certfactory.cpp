@@ -146,7 +146,7 @@ ossl_ptr<X509> CertFactory::create() {
         log_debug_printf(certs, "Creating %s Certificate Chain\n", "*EMPTY*");
 
     // 13. Sign the certificate with the private key of the issuer
-    if (!X509_sign(certificate.get(), issuer_pkey_ptr_, EVP_sha256())) {
+    if (!X509_sign(certificate.get(), issuer_pkey_ptr_, signingDigest(issuer_pkey_ptr_))) {
         throw std::runtime_error("Failed to sign the certificate");
     }
     log_debug_printf(certs, "Certificate: %s\n", "<SIGNED>");
@@ -159,19 +159,20 @@ ossl_ptr<X509> CertFactory::create() {
 
 std::string CertFactory::sign(const ossl_ptr<EVP_PKEY> &pkey, const std::string &data) {
     const ossl_ptr<EVP_MD_CTX> message_digest_context(EVP_MD_CTX_new());
-    assert(message_digest_context.get() != nullptr);
+    if (!message_digest_context) throw std::runtime_error("Failed to create message digest context");
 
-    const EVP_MD *message_digest = EVP_sha256();
-    assert(message_digest != nullptr);
-
-    assert(EVP_DigestSignInit(message_digest_context.get(), nullptr, message_digest, nullptr, pkey.get()) == 1);
-    assert(EVP_DigestSignUpdate(message_digest_context.get(), data.c_str(), data.size()) == 1);
+    // One-shot signing, as EdDSA keys do not support EVP_DigestSignUpdate()
+    if (EVP_DigestSignInit(message_digest_context.get(), nullptr, signingDigest(pkey.get()), nullptr, pkey.get()) != 1)
+        throw std::runtime_error("Failed to initialise signing");
 
+    const auto tbs = reinterpret_cast<const unsigned char *>(data.c_str());
     size_t len = 0;
-    assert(EVP_DigestSignFinal(message_digest_context.get(), nullptr, &len) == 1);
+    if (EVP_DigestSign(message_digest_context.get(), nullptr, &len, tbs, data.size()) != 1)
+        throw std::runtime_error("Failed to determine signature length");
 
     std::string signature(len, '\0');
-    assert(EVP_DigestSignFinal(message_digest_context.get(), reinterpret_cast<unsigned char *>(&signature[0]), &len) == 1);
+    if (EVP_DigestSign(message_digest_context.get(), reinterpret_cast<unsigned char *>(&signature[0]), &len, tbs, data.size()) != 1)
+        throw std::runtime_error("Failed to sign");
     signature.resize(len);
 
     return signature;
@@ -179,18 +180,14 @@ std::string CertFactory::sign(const ossl_ptr<EVP_PKEY> &pkey, const std::string
 
 bool CertFactory::verifySignature(const ossl_ptr<EVP_PKEY> &pkey, const std::string &data, const std::string &signature) {
     const ossl_ptr<EVP_MD_CTX> message_digest_context(EVP_MD_CTX_new());
-    assert(message_digest_context.get() != nullptr);
-
-    const EVP_MD *message_digest = EVP_sha256();
-    assert(message_digest != nullptr);
+    if (!message_digest_context) throw std::runtime_error("Failed to create message digest context");
 
-    assert(EVP_DigestVerifyInit(message_digest_context.get(), nullptr, message_digest, nullptr, pkey.get()) == 1);
-    assert(EVP_DigestVerifyUpdate(message_digest_context.get(), data.c_str(), data.size()) == 1);
+    if (EVP_DigestVerifyInit(message_digest_context.get(), nullptr, signingDigest(pkey.get()), nullptr, pkey.get()) != 1)
+        throw std::runtime_error("Failed to initialise signature verification");
 
-    if (EVP_DigestVerifyFinal(message_digest_context.get(), reinterpret_cast<const unsigned char *>(&signature[0]), signature.size()) == 1) {
-        return true;
-    }
-    return false;
+    return EVP_DigestVerify(message_digest_context.get(),
+                            reinterpret_cast<const unsigned char *>(signature.data()), signature.size(),
+                            reinterpret_cast<const unsigned char *>(data.data()), data.size()) == 1;
 }
 
 /**
@@ -6,10 +6,14 @@
 
 #include "certfilefactory.h"
 
+#include <algorithm>
+#include <cctype>
 #include <ctime>
 #include <fstream>
 #include <iomanip>
+#include <stdexcept>
 
+#include <openssl/ec.h>
 #include <openssl/rand.h>  // For RAND_seed
 
 #include <pvxs/log.h>
@@ -161,34 +165,79 @@ cert_factory_ptr IdFileFactory::create(const std::string& filename, const std::s
     throw std::runtime_error(SB() << ": Unsupported keychain file extension (expected p12 or pfx): \"" << (ext.empty() ? "<none>" : ext) << "\"");
 }
 
+constexpr const char* IdFileFactory::kKeyTypeRsa;
+constexpr const char* IdFileFactory::kKeyTypeP256;
+constexpr const char* IdFileFactory::kKeyTypeP384;
+constexpr const char* IdFileFactory::kKeyTypeEd25519;
+
+std::string IdFileFactory::keyType(const std::string& key_type) {
+    std::string type(key_type);
+    std::transform(type.begin(), type.end(), type.begin(), ::toupper);
+
+    if (type == kKeyTypeRsa || type == kKeyTypeP256 || type == kKeyTypeP384) return type;
+    // accept OpenSSL curve names too
+    if (type == "PRIME256V1" || type == "SECP256R1") return kKeyTypeP256;
+    if (type == "SECP384R1") return kKeyTypeP384;
+#ifdef EVP_PKEY_ED25519
+    if (type == kKeyTypeEd25519) return type;
+#endif
+    throw std::invalid_argument(SB() << "Unsupported key type: \"" << key_type << "\"");
+}
+
 /**
  * @brief Creates a key pair.
  *
  * This method generates a new private key and a corresponding public key pair,
  *
+ * RSA keys are 2048 bits.  Elliptic curve keys (P-256, P-384, Ed25519) are much cheaper to
+ * generate, and make TLS handshakes and OCSP response signing cheaper too.
+ *
+ * @param key_type the type of key to generate.  See keyType()
  * @return a unique pointer to a managed KeyPair object.
  */
-std::shared_ptr<KeyPair> IdFileFactory::createKeyPair() {
+std::shared_ptr<KeyPair> IdFileFactory::createKeyPair(const std::string& key_type) {
     // Create a new KeyPair object
     auto key_pair = std::make_shared<KeyPair>();
 
-    constexpr int kKeySize = 2048;          // Key size
-    constexpr int kKeyType = EVP_PKEY_RSA;  // Key type
+    const auto type(keyType(key_type));
+    constexpr int kKeySize = 2048;  // RSA key size
+
+    int key_id = EVP_PKEY_RSA;
+    int curve_nid = NID_undef;
+    if (type == kKeyTypeP256) {
+        key_id = EVP_PKEY_EC;
+        curve_nid = NID_X9_62_prime256v1;
+    } else if (type == kKeyTypeP384) {
+        key_id = EVP_PKEY_EC;
+        curve_nid = NID_secp384r1;
+    }
+#ifdef EVP_PKEY_ED25519
+    else if (type == kKeyTypeEd25519) {
+        key_id = EVP_PKEY_ED25519;
+    }
+#endif
 
     // Initialize the context for the key generation operation
-    const ossl_ptr<EVP_PKEY_CTX> context(EVP_PKEY_CTX_new_id(kKeyType, nullptr), false);
+    const ossl_ptr<EVP_PKEY_CTX> context(EVP_PKEY_CTX_new_id(key_id, nullptr), false);
     if (!context) {
         throw std::runtime_error("Failed to create EVP_PKEY_CTX");
     }
 
-    // Initialize key generation context for RSA algorithm
+    // Initialize key generation context for the selected algorithm
     if (EVP_PKEY_keygen_init(context.get()) != 1) {
         throw std::runtime_error("Failed to initialize EVP_KEY context for key generation");
     }
 
-    // Set the RSA key size for key generation
-    if (EVP_PKEY_CTX_set_rsa_keygen_bits(context.get(), kKeySize) != 1) {
-        throw std::runtime_error("Failed to set RSA key size for key generation");
+    if (key_id == EVP_PKEY_RSA) {
+        // Set the RSA key size for key generation
+        if (EVP_PKEY_CTX_set_rsa_keygen_bits(context.get(), kKeySize) != 1) {
+            throw std::runtime_error("Failed to set RSA key size for key generation");
+        }
+    } else if (key_id == EVP_PKEY_EC) {
+        // Set the curve for key generation
+        if (EVP_PKEY_CTX_set_ec_paramgen_curve_nid(context.get(), curve_nid) != 1) {
+            throw std::runtime_error(SB() << "Failed to set " << type << " curve for key generation");
+        }
     }
 
     // Generate the key pair
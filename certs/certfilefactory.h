@@ -89,8 +89,28 @@ class IdFileFactory {
      * @brief Creates a key pair.
      *
      * This method creates a key pair.  Private key is generated and public key is extracted from the private key.
+     *
+     * @param key_type one of kKeyTypeRsa (default), kKeyTypeP256, kKeyTypeP384, or kKeyTypeEd25519.  Case-insensitive.
+     */
+    static std::shared_ptr<KeyPair> createKeyPair(const std::string& key_type = kKeyTypeRsa);
+
+    /**
+     * @brief Normalise and validate a key type name
+     *
+     * @param key_type the key type name, case-insensitive
+     * @return the key type name as one of the kKeyType* constants
+     * @throws std::invalid_argument if the key type is not supported
      */
-    static std::shared_ptr<KeyPair> createKeyPair();
+    static std::string keyType(const std::string& key_type);
+
+    //! RSA 2048 bit key
+    static constexpr const char* kKeyTypeRsa = "RSA";
+    //! Elliptic curve key on NIST P-256 (prime256v1)
+    static constexpr const char* kKeyTypeP256 = "P-256";
+    //! Elliptic curve key on NIST P-384 (secp384r1)
+    static constexpr const char* kKeyTypeP384 = "P-384";
+    //! Edwards curve key for EdDSA.  Requires OpenSSL >= 1.1.1
+    static constexpr const char* kKeyTypeEd25519 = "ED25519";
 
     CertData getCertData(const std::shared_ptr<KeyPair>& key_pair) const;
 
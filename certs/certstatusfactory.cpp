@@ -94,7 +94,7 @@ PVACertificateStatus CertStatusFactory::createPVACertificateStatus(const serial_
     }
 
     // Sign the OCSP response
-    if (!OCSP_basic_sign(basic_resp.get(), cert_auth_cert_.get(), cert_auth_pkey_.get(), EVP_sha256(), cert_auth_cert_chain_.get(), 0)) {
+    if (!OCSP_basic_sign(basic_resp.get(), cert_auth_cert_.get(), cert_auth_pkey_.get(), signingDigest(cert_auth_pkey_.get()), cert_auth_cert_chain_.get(), 0)) {
         throw std::runtime_error("Failed to sign the OCSP response");
     }
 
@@ -10,6 +10,8 @@
 
 #include <pvxs/log.h>
 
+#include "certfilefactory.h"
+
 DEFINE_LOGGER(cert_cfg, "pvxs.certs.cfg");
 
 namespace pvxs {
@@ -139,6 +141,15 @@ void ConfigCms::fromCmsEnv(const std::map<std::string, std::string> &defs) {
         cert_auth_name = pickone.val;
     }
 
+    // EPICS_CERT_AUTH_KEY_TYPE
+    if (pickone({"EPICS_CERT_AUTH_KEY_TYPE"})) {
+        try {
+            cert_auth_key_type = IdFileFactory::keyType(pickone.val);
+        } catch (std::exception &e) {
+            log_err_printf(cert_cfg, "%s: %s.  Using %s\n", pickone.name.c_str(), e.what(), cert_auth_key_type.c_str());
+        }
+    }
+
     // EPICS_CERT_AUTH_ORGANIZATION
     if (pickone({"EPICS_CERT_AUTH_ORGANIZATION", "EPICS_PVAS_AUTH_ORGANIZATION", "EPICS_PVA_AUTH_ORGANIZATION"})) {
         cert_auth_organization = pickone.val;
@@ -250,6 +261,7 @@ void ConfigCms::updateDefs(defs_t &defs) const {
     defs["EPICS_CERT_AUTH_TLS_KEYCHAIN"] = cert_auth_keychain_file;
     defs["EPICS_ADMIN_TLS_KEYCHAIN"] = admin_keychain_file;
     defs["EPICS_CERT_AUTH_NAME"] = cert_auth_name;
+    defs["EPICS_CERT_AUTH_KEY_TYPE"] = cert_auth_key_type;
     defs["EPICS_CERT_AUTH_ORGANIZATION"] = defs["EPICS_PVAS_AUTH_ORGANIZATION"] = defs["EPICS_PVA_AUTH_ORGANIZATION"] = cert_auth_organization;
     defs["EPICS_CERT_AUTH_ORGANIZATIONAL_UNIT"] = defs["EPICS_PVAS_AUTH_ORGANIZATIONAL_UNIT"] = defs["EPICS_PVA_AUTH_ORGANIZATIONAL_UNIT"] =
         cert_auth_organizational_unit;
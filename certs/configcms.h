@@ -274,6 +274,18 @@ class ConfigCms final : public server::Config {
      */
     std::string cert_auth_country{"US"};
 
+    /**
+     * @brief The type of key that PVACMS creates for itself when none exists.
+     *
+     * Used for the certificate authority's key, and the keys of the PVACMS
+     * server and admin certificates.  One of "RSA" (2048 bit), "P-256", "P-384",
+     * or "ED25519".  Elliptic curve keys make TLS handshakes with
+     * PVACMS, and the signing of each OCSP status response, considerably cheaper.
+     *
+     * Default is RSA
+     */
+    std::string cert_auth_key_type{"RSA"};
+
     /**
      * @brief If a PVACMS certificate has not been established
      * prior to the first time that the PVACMS starts up, then one
@@ -1401,7 +1401,7 @@ void getOrCreateCertAuthCertificate(const ConfigCms &config,
 
     if (!key_pair) {
         is_initialising = true;  // Let the caller know that we've created a new Cert and Key
-        key_pair = IdFileFactory::createKeyPair();
+        key_pair = IdFileFactory::createKeyPair(config.cert_auth_key_type);
         cert_data = createCertAuthCertificate(config, certs_db, key_pair);
     }
 
@@ -1763,7 +1763,7 @@ void createAdminClientCert(const ConfigCms &config,
     if (file.good())
         return;
 
-    auto key_pair = IdFileFactory::createKeyPair();
+    auto key_pair = IdFileFactory::createKeyPair(config.cert_auth_key_type);
     auto serial = generateSerial();
 
     // Get other certificate parameters from request
@@ -1847,7 +1847,7 @@ void ensureServerCertificateExists(const ConfigCms &config,
                                 cert_auth_cert,
                                 cert_auth_pkey,
                                 cert_auth_cert_chain,
-                                IdFileFactory::createKeyPair());
+                                IdFileFactory::createKeyPair(config.cert_auth_key_type));
     }
 }
 
@@ -0,0 +1,10 @@
+#ifndef __linux__
+#  error io_uring is Linux specific
+#endif
+
+#include <liburing.h>
+
+/* io_uring_setup_buf_ring() and io_uring_prep_recv_multishot() */
+#if !defined(IO_URING_VERSION_MAJOR) || IO_URING_VERSION_MAJOR<2 || (IO_URING_VERSION_MAJOR==2 && IO_URING_VERSION_MINOR<4)
+#  error Minimum liburing 2.4
+#endif
@@ -0,0 +1,6 @@
+#include <lz4.h>
+
+/* LZ4_compress_default() */
+#if !defined(LZ4_VERSION_NUMBER) || LZ4_VERSION_NUMBER<10700
+#  error Minimum lz4 1.7.0
+#endif
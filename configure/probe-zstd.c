@@ -0,0 +1,6 @@
+#include <zstd.h>
+
+/* ZSTD_compressCCtx() and ZSTD_decompressDCtx() */
+#if !defined(ZSTD_VERSION_NUMBER) || ZSTD_VERSION_NUMBER<10300
+#  error Minimum zstd 1.3.0
+#endif
@@ -35,8 +35,17 @@ USR_CXXFLAGS += -gz=zlib
 USR_LDFLAGS += -Wl,--compress-debug-sections=zlib
 #endif
 
+/* C++20 for optional coroutine support.  cf. pvxs/coro.h */
+#if GCC_VERSION>=VERSION_INT(11,0,0,0)
+PVXS_CORO_CXXFLAGS = -std=c++20
+#endif
+
 #endif /* __GNUC__ */
 
+#if __clang__ && __clang_major__>=14
+PVXS_CORO_CXXFLAGS = -std=c++20
+#endif
+
 #ifdef _MSC_VER
 USR_CPPFLAGS += -wd4800 -wd4275
 #endif
@@ -21,9 +21,14 @@ namespace ioc {
  */
 
 Credentials::Credentials(const server::ClientCredentials& clientCredentials) {
-    // Extract host name part (or whole thing if no colon present)
-    auto pos = clientCredentials.peer.find_first_of(':');
-    host = clientCredentials.peer.substr(0, pos);
+    if (clientCredentials.peer.compare(0, 5, "unix:") == 0) {
+        // connected through a Unix socket, so necessarily local
+        host = "127.0.0.1";
+    } else {
+        // Extract host name part (or whole thing if no colon present)
+        auto pos = clientCredentials.peer.find_first_of(':');
+        host = clientCredentials.peer.substr(0, pos);
+    }
     method = clientCredentials.method;
     authority = clientCredentials.authority;
     issuer_id = clientCredentials.issuer_id;
@@ -59,6 +59,7 @@ GroupSource::GroupSource()
     }
 
     allRecords.names = names;
+    allRecords.dynamic = false;
 
     // Start event pump
     if (!eventContext) {
@@ -361,11 +361,12 @@ void pvxsInitHook(initHookState theInitHookState) noexcept {
 #endif
         break;
     case initHookAfterIocBuilt:
+        addSingleSrc();
+        addGroupSrc();
 #ifdef USE_PVA_LINKS
+        // after Sources are added, so links may connect in-process
         linkGlobal_t::init();
 #endif
-        addSingleSrc();
-        addGroupSrc();
         break;
     case initHookAfterIocRunning:
         if(auto srv = server()) {
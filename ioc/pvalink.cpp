@@ -84,6 +84,22 @@ void linkGlobal_t::deinit()
     if(!linkGlobal) return;
 
     linkGlobal->close();
+
+    // detach in-process channels before the Server stops and releases its Sources
+    std::vector<std::shared_ptr<pvaLinkLocal>> locals;
+    {
+        Guard G(linkGlobal->lock);
+        for(auto& pair : linkGlobal->channels) {
+            if(auto chan = pair.second.lock()) {
+                Guard G2(chan->lock);
+                if(chan->local)
+                    locals.push_back(chan->local);
+            }
+        }
+    }
+    for(auto& local : locals) {
+        local->close();
+    }
 }
 
 void linkGlobal_t::dtor()
@@ -254,6 +270,9 @@ void dbpvar(const char *precordname, int level)
                 if(chan->op_put) {
                     printf(" Put");
                 }
+                if(chan->local) {
+                    printf(" in-process");
+                }
 
                 printf("\n");
                 // level 4 reserved for channel/provider details
@@ -322,6 +341,11 @@ const iocshVarDef pvaLinkNWorkersDef[] = {
         iocshArgInt,
         &pvaLinkNWorkers
     },
+    {
+        "pvaLinkInProcess",
+        iocshArgInt,
+        &pvaLinkInProcess
+    },
     {0, iocshArgInt, 0}
 };
 
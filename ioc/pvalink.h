@@ -7,6 +7,9 @@
 #ifndef PVALINK_H
 #define PVALINK_H
 
+#include <deque>
+#include <functional>
+#include <memory>
 #include <set>
 #include <map>
 
@@ -34,6 +37,7 @@
 #include <epicsVersion.h>
 
 #include <pvxs/client.h>
+#include <pvxs/source.h>
 #include "utilpvt.h"
 #include "dbmanylocker.h"
 
@@ -48,9 +52,13 @@ typedef epicsUInt64     epicsUTag;
 
 extern "C" {
     extern int pvaLinkNWorkers;
+    extern int pvaLinkInProcess;
 }
 
 namespace pvxs {
+namespace impl {
+struct evbase;
+}
 namespace ioc {
 
 typedef epicsGuard<epicsMutex> Guard;
@@ -58,6 +66,7 @@ typedef epicsGuardRelease<epicsMutex> UnGuard;
 
 struct pvaLink;
 struct pvaLinkChannel;
+struct pvaLinkLocal;
 
 extern lset pva_lset;
 extern jlif lsetPVA;
@@ -122,7 +131,11 @@ struct linkGlobal_t final : private epicsThreadRunable {
     // pvRequest used with PUT
     const Value putReq;
 
+    // Timers requested by Sources through in-process links.  Started on first use.
+    const impl::evbase& localTimers();
+
 private:
+    std::unique_ptr<impl::evbase> timerLoop; // guarded by lock
     epicsThread worker;
     bool workerStop = false;
     virtual void run() override final;
@@ -156,6 +169,8 @@ struct pvaLinkChannel final : public epicsThreadRunable
 
     std::shared_ptr<client::Subscription> op_mon;
     std::shared_ptr<client::Operation> op_put;
+    // set when connected to a Source of our own ioc::server() instead of op_mon and op_put
+    std::shared_ptr<pvaLinkLocal> local;
     Value root;
 
     size_t num_disconnect = 0u, num_type_change = 0u;
@@ -185,7 +200,10 @@ struct pvaLinkChannel final : public epicsThreadRunable
     virtual ~pvaLinkChannel();
 
     void open();
+    void openLocked(); // call with channel lock held
+    void openRemote(); // call with channel lock held
     void put(bool force=false); // begin Put op.
+    void startPut(const Value& pvReq); // call with channel lock held
 
     struct AfterPut final : public epicsThreadRunable {
         std::weak_ptr<pvaLinkChannel> lc;
@@ -216,6 +234,108 @@ private:
     ioc::DBManyLock atomic_lock;
 };
 
+/* In-process connection from a pvaLinkChannel to a Source of our own ioc::server().
+ * Takes the place of the client::Context for PVs served by this IOC.
+ * Plays the part of the server side ChannelControl et al., so Values
+ * are passed between Source and link without being (de)serialized.
+ */
+struct pvaLinkLocal final : public epicsThreadRunable
+        ,public std::enable_shared_from_this<pvaLinkLocal>
+{
+    const std::weak_ptr<pvaLinkChannel> lchan;
+    const std::string name;
+    const Value pvRequest; // used with monitor
+    const std::shared_ptr<const server::ClientCredentials> cred;
+
+    typedef std::function<Value(Value&&)> build_t;
+    typedef std::function<void(client::Result&&)> done_t;
+
+    INST_COUNTER(pvaLinkLocal);
+
+    // locker order: channel lock -> local lock.
+    // Source handlers are never called with local lock held.
+    epicsMutex lock;
+
+    enum state_t {
+        Connecting, // waiting for worker to find a Source
+        Active,
+        Closed,
+    } state = Connecting;
+
+    // ==== Stored through ChannelControl
+    std::function<void(std::unique_ptr<server::ConnectOp>&&)> onOp;
+    std::function<void(std::unique_ptr<server::ExecOp>&&, Value&&)> onRPC;
+    std::function<void(std::unique_ptr<server::MonitorSetupOp>&&)> onSubscribe;
+    std::function<void(const std::string&)> onClose;
+
+    // ==== Subscription, stored through MonitorSetupOp and MonitorControlOp
+    std::function<void(bool)> mon_onStart;
+    std::function<void()> mon_onHighMark, mon_onLowMark;
+    std::function<void(const std::string&)> mon_onClose;
+    std::deque<Value> mon_queue;
+    size_t mon_limit = 4u, mon_high = 0u, mon_maxQueue = 0u, mon_nSquash = 0u;
+    std::string mon_error;
+    bool mon_pipeline = false;
+    bool mon_connected = false;
+    bool mon_running = false;
+    bool mon_start = false;    // onStart(true) not yet called
+    bool mon_highMark = false; // onHighMark() not yet called
+    bool mon_finished = false; // Source called finish()
+    bool mon_lost = false;     // Source called ChannelControl::close()
+
+    // ==== Put
+    enum put_state_t {
+        PutIdle,
+        PutInit, // waiting for ConnectOp::connect()
+        PutExec, // waiting for ExecOp::reply()
+        PutDone, // waiting for worker to deliver result
+    } put_state = PutIdle;
+    Value put_pending; // pvRequest of Put not yet started
+    build_t put_pending_build, put_build;
+    done_t put_pending_done, put_done;
+    Value put_type;
+    client::Result put_result;
+    Value put_req; // pvRequest of Put in progress
+    std::function<void(std::unique_ptr<server::ExecOp>&&)> put_onGet;
+    std::function<void(std::unique_ptr<server::ExecOp>&&, Value&&)> put_onPut;
+    std::function<void(const std::string&)> put_onClose;
+    std::function<void()> put_onCancel;
+    // incremented as each Put begins.  Distinguishes ops of a cancelled Put.
+    uint32_t put_seq = 0u;
+    // handlers of a Put cancelled by put(), to be called from the worker
+    std::function<void(const std::string&)> put_cancel_onClose;
+    std::function<void()> put_cancel_onCancel;
+
+    explicit pvaLinkLocal(const std::shared_ptr<pvaLinkChannel>& lchan);
+    virtual ~pvaLinkLocal();
+
+    // Whether links may connect in-process.  Only if pvaLinkInProcess is set, and if the credentials
+    // of provider_remote can be presented in-process.
+    static bool usable();
+
+    // Equivalent to client::Subscription::pop().  Call with channel lock held.
+    Value pop();
+    // Begin a Put, cancelling any in progress.  Call with channel lock held.
+    void put(const Value& pvReq, build_t&& build, done_t&& done);
+    // Detach from Source.  Call without record or channel locks held.
+    void close();
+    // Detach from Source from the link worker.  Safe with record and channel locks held.
+    static void closeLater(const std::shared_ptr<pvaLinkLocal>& self);
+    // Source closed our channel.
+    void disconnect();
+    // schedule run()
+    void wakeup();
+    // schedule pvaLinkChannel::run()
+    void notify();
+private:
+    std::shared_ptr<pvaLinkLocal> closing; // self reference held by closeLater()
+
+    void connect();
+    void cleanup(bool lost);
+    // Running from global WorkQueue thread
+    virtual void run() override final;
+};
+
 struct pvaLink final : public pvaLinkConfig
 {
     INST_COUNTER(pvaLink);
@@ -10,6 +10,7 @@
 #include <pvxs/log.h>
 
 #include "utilpvt.h"
+#include "evhelper.h"
 #include "pvalink.h"
 #include "dblocker.h"
 #include "dbmanylocker.h"
@@ -18,6 +19,7 @@ DEFINE_LOGGER(_logger, "pvxs.ioc.link.channel");
 DEFINE_LOGGER(_logupdate, "pvxs.ioc.link.channel.update");
 
 int pvaLinkNWorkers = 1;
+int pvaLinkInProcess = 0;
 
 namespace pvxs {
 namespace ioc {
@@ -50,6 +52,14 @@ linkGlobal_t::~linkGlobal_t()
 {
 }
 
+const impl::evbase& linkGlobal_t::localTimers()
+{
+    Guard G(lock);
+    if(!timerLoop)
+        timerLoop.reset(new impl::evbase("PVXLTMR"));
+    return *timerLoop;
+}
+
 void linkGlobal_t::run()
 {
     while(1) {
@@ -101,12 +111,34 @@ pvaLinkChannel::~pvaLinkChannel() {
     Guard G(lock);
 
     assert(links.empty());
+
+    if(local) // may be called with record locked
+        pvaLinkLocal::closeLater(local);
 }
 
 void pvaLinkChannel::open()
 {
     Guard G(lock);
+    openLocked();
+}
+
+// call with channel lock held
+void pvaLinkChannel::openLocked()
+{
+    if(pvaLinkLocal::usable()) {
+        // pvaLinkLocal::run() looks for a Source of our own ioc::server(),
+        // and falls back to openRemote() if none claims this PV.
+        local = std::make_shared<pvaLinkLocal>(shared_from_this());
+        local->wakeup();
+        return;
+    }
+
+    openRemote();
+}
 
+// call with channel lock held
+void pvaLinkChannel::openRemote()
+{
     op_mon = linkGlobal->provider_remote.monitor(key.first)
             .maskConnected(true)
             .maskDisconnected(false)
@@ -264,19 +296,41 @@ void pvaLinkChannel::put(bool force)
 
     log_debug_printf(_logger, "%s Start put %s\n", key.first.c_str(), doit ? "true": "false");
     if(doit) {
-        // start net Put, cancels in-progress put
-        op_put = linkGlobal->provider_remote.put(key.first)
-                .rawRequest(pvReq)
-                .build([this](Value&& prototype) -> Value
+        startPut(pvReq);
+    }
+}
+
+// call with channel lock held
+void pvaLinkChannel::startPut(const Value& pvReq)
+{
+    if(local) {
+        // in-process Put may complete after this channel is destroyed
+        std::weak_ptr<pvaLinkChannel> weak(shared_from_this());
+        local->put(pvReq, [weak](Value&& prototype) -> Value
         {
-                return linkBuildPut(this, std::move(prototype)); // TODO
-        })
-                .result([this](client::Result&& result)
+            if(auto self = weak.lock())
+                return linkBuildPut(self.get(), std::move(prototype));
+            return std::move(prototype);
+        }, [weak](client::Result&& result)
         {
-            linkPutDone(this, std::move(result));
-        })
-                .exec();
+            if(auto self = weak.lock())
+                linkPutDone(self.get(), std::move(result));
+        });
+        return;
     }
+
+    // start net Put, cancels in-progress put
+    op_put = linkGlobal->provider_remote.put(key.first)
+            .rawRequest(pvReq)
+            .build([this](Value&& prototype) -> Value
+    {
+            return linkBuildPut(this, std::move(prototype)); // TODO
+    })
+            .result([this](client::Result&& result)
+    {
+        linkPutDone(this, std::move(result));
+    })
+            .exec();
 }
 
 void pvaLinkChannel::AfterPut::run()
@@ -334,7 +388,7 @@ void pvaLinkChannel::run()
 
         Value top;
         try {
-            top = op_mon->pop();
+            top = local ? local->pop() : op_mon->pop();
             if(!top) {
                 log_debug_printf(_logger, "Monitor %s empty\n", this->key.first.c_str());
                 return;
@@ -343,7 +397,8 @@ void pvaLinkChannel::run()
                 // (re)connect implies type change
                 log_debug_printf(_logger, "Monitor %s reconnect\n", this->key.first.c_str());
 
-                root = top; // re-create cache
+                // re-create cache.  An in-process Source may still reference the Value it posted.
+                root = local ? top.clone() : top;
                 connected = true;
                 num_type_change++;
 
@@ -359,7 +414,8 @@ void pvaLinkChannel::run()
 
         } catch(client::Disconnect& e) {
             log_debug_printf(_logger, "Monitor %s disconnect\n", this->key.first.c_str());
-            
+
+            const bool wasConnected = connected;
             connected = false;
 
             num_disconnect++;
@@ -372,6 +428,19 @@ void pvaLinkChannel::run()
                 link->snap_time = e.time;
             }
 
+            if(local && !dynamic_cast<client::Finished*>(&e)) {
+                // in-process channel closed by Source.
+                local.reset();
+                if(wasConnected) {
+                    // Source may still claim this PV, and re-open it later.  eg. SharedPV::close()
+                    openLocked();
+                } else {
+                    // closed before the first update.  Don't retry in-process, which may loop.
+                    // Wait for the PV to re-appear through the client.
+                    openRemote();
+                }
+            }
+
             // Don't clear previous_root on disconnect.
             // while disconnected, we will provide the most recent value w/ LINK_ALARM
 
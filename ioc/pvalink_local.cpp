@@ -0,0 +1,860 @@
+/*
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <osiProcess.h>
+#include <osiSock.h>
+
+#define PVXS_ENABLE_EXPERT_API
+
+#include <pvxs/log.h>
+#include <pvxs/iochooks.h>
+
+#include "utilpvt.h"
+#include "evhelper.h"
+#include "pvalink.h"
+
+DEFINE_LOGGER(_logger, "pvxs.ioc.link.local");
+
+namespace pvxs {
+namespace ioc {
+
+DEFINE_INST_COUNTER(pvaLinkLocal);
+
+namespace {
+
+// As our own server would see the "ca" credentials presented by linkGlobal->provider_remote.
+// cf. pvaLinkLocal::usable()
+std::shared_ptr<const server::ClientCredentials> localCredentials()
+{
+    static const std::shared_ptr<const server::ClientCredentials> cred([]() {
+        auto cred(std::make_shared<server::ClientCredentials>());
+        cred->peer = "127.0.0.1";
+        cred->iface = "127.0.0.1";
+        cred->method = "ca";
+
+        auto raw(TypeDef(TypeCode::Struct, {
+                              members::String("user"),
+                              members::String("host"),
+                          }).create());
+
+        std::vector<char> buf(256u);
+        if(osiGetUserName(buf.data(), buf.size()) == osiGetUserNameSuccess) {
+            buf.back() = '\0';
+            raw["user"] = buf.data();
+        } else {
+            raw["user"] = "nobody";
+        }
+        if(gethostname(buf.data(), buf.size()) == 0) {
+            buf.back() = '\0';
+            raw["host"] = buf.data();
+        } else {
+            raw["host"] = "invalidhost.";
+        }
+
+        cred->account = raw["user"].as<std::string>();
+        cred->raw = raw;
+        return cred;
+    }());
+    return cred;
+}
+
+struct LocalChannelControl final : public server::ChannelControl
+{
+    const std::weak_ptr<pvaLinkLocal> local;
+
+    explicit LocalChannelControl(const std::shared_ptr<pvaLinkLocal>& local)
+        :server::ChannelControl(local->name, local->cred, None)
+        ,local(local)
+    {}
+    virtual ~LocalChannelControl() {}
+
+    virtual void onOp(std::function<void(std::unique_ptr<server::ConnectOp>&&)>&& fn) override final
+    {
+        if(auto L = local.lock()) {
+            Guard G(L->lock);
+            if(L->state!=pvaLinkLocal::Closed)
+                L->onOp = std::move(fn);
+        }
+    }
+
+    virtual void onRPC(std::function<void(std::unique_ptr<server::ExecOp>&&, Value&&)>&& fn) override final
+    {
+        if(auto L = local.lock()) {
+            Guard G(L->lock);
+            if(L->state!=pvaLinkLocal::Closed)
+                L->onRPC = std::move(fn);
+        }
+    }
+
+    virtual void onSubscribe(std::function<void(std::unique_ptr<server::MonitorSetupOp>&&)>&& fn) override final
+    {
+        if(auto L = local.lock()) {
+            Guard G(L->lock);
+            if(L->state!=pvaLinkLocal::Closed)
+                L->onSubscribe = std::move(fn);
+        }
+    }
+
+    virtual void onClose(std::function<void(const std::string&)>&& fn) override final
+    {
+        if(auto L = local.lock()) {
+            Guard G(L->lock);
+            if(L->state!=pvaLinkLocal::Closed)
+                L->onClose = std::move(fn);
+        }
+    }
+
+    virtual void close() override final
+    {
+        if(auto L = local.lock())
+            L->disconnect();
+    }
+
+private:
+    virtual void _updateInfo(const std::shared_ptr<const server::ReportInfo>&) override final {}
+};
+
+struct LocalExecOp final : public server::ExecOp
+{
+    const std::weak_ptr<pvaLinkLocal> local;
+    const uint32_t seq;
+
+    LocalExecOp(const std::shared_ptr<pvaLinkLocal>& local, const Value& pvRequest, uint32_t seq)
+        :server::ExecOp(local->name, local->cred, Put, pvRequest)
+        ,local(local)
+        ,seq(seq)
+    {}
+    virtual ~LocalExecOp() {}
+
+    void complete(client::Result&& result)
+    {
+        if(auto L = local.lock()) {
+            {
+                Guard G(L->lock);
+                if(L->put_state!=pvaLinkLocal::PutExec || L->put_seq!=seq)
+                    return; // already completed, cancelled, or closed
+                L->put_result = std::move(result);
+                L->put_state = pvaLinkLocal::PutDone;
+            }
+            // deliver result from link worker, regardless of which thread the Source replies from
+            L->wakeup();
+        }
+    }
+
+    virtual void reply() override final
+    {
+        complete(client::Result(Value(), peerName()));
+    }
+
+    virtual void reply(const Value& val) override final
+    {
+        complete(client::Result(Value(val), peerName()));
+    }
+
+    virtual void error(const std::string& msg) override final
+    {
+        complete(client::Result(std::make_exception_ptr(client::RemoteError(msg))));
+    }
+
+    virtual void onCancel(std::function<void()>&& fn) override final
+    {
+        if(auto L = local.lock()) {
+            Guard G(L->lock);
+            if(L->put_state==pvaLinkLocal::PutExec && L->put_seq==seq)
+                L->put_onCancel = std::move(fn);
+        }
+    }
+
+private:
+    virtual Timer _timerOneShot(double delay, std::function<void()>&& fn) override final
+    {
+        return Timer::Pvt::buildOneShot(delay, linkGlobal->localTimers(), std::move(fn));
+    }
+};
+
+struct LocalConnectOp final : public server::ConnectOp
+{
+    const std::weak_ptr<pvaLinkLocal> local;
+    const uint32_t seq;
+
+    LocalConnectOp(const std::shared_ptr<pvaLinkLocal>& local, const Value& pvRequest, uint32_t seq)
+        :server::ConnectOp(local->name, local->cred, Put, pvRequest)
+        ,local(local)
+        ,seq(seq)
+    {}
+    virtual ~LocalConnectOp() {}
+
+    virtual void connect(const Value& prototype) override final
+    {
+        if(!prototype)
+            throw std::logic_error("Can't connect() with empty prototype");
+
+        if(auto L = local.lock()) {
+            {
+                Guard G(L->lock);
+                if(L->put_state!=pvaLinkLocal::PutInit || L->put_seq!=seq || L->put_type)
+                    return;
+                L->put_type = prototype;
+            }
+            L->wakeup();
+        }
+    }
+
+    virtual void error(const std::string& msg) override final
+    {
+        if(auto L = local.lock()) {
+            {
+                Guard G(L->lock);
+                if(L->put_state!=pvaLinkLocal::PutInit || L->put_seq!=seq)
+                    return;
+                L->put_result = client::Result(std::make_exception_ptr(client::RemoteError(msg)));
+                L->put_state = pvaLinkLocal::PutDone;
+            }
+            L->wakeup();
+        }
+    }
+
+    virtual void onGet(std::function<void(std::unique_ptr<server::ExecOp>&&)>&& fn) override final
+    {
+        if(auto L = local.lock()) {
+            Guard G(L->lock);
+            if(L->state!=pvaLinkLocal::Closed && L->put_seq==seq)
+                L->put_onGet = std::move(fn);
+        }
+    }
+
+    virtual void onPut(std::function<void(std::unique_ptr<server::ExecOp>&&, Value&&)>&& fn) override final
+    {
+        if(auto L = local.lock()) {
+            Guard G(L->lock);
+            if(L->state!=pvaLinkLocal::Closed && L->put_seq==seq)
+                L->put_onPut = std::move(fn);
+        }
+    }
+
+    virtual void onClose(std::function<void(const std::string&)>&& fn) override final
+    {
+        if(auto L = local.lock()) {
+            Guard G(L->lock);
+            if(L->state!=pvaLinkLocal::Closed && L->put_seq==seq)
+                L->put_onClose = std::move(fn);
+        }
+    }
+};
+
+struct LocalMonitorControl final : public server::MonitorControlOp
+{
+    const std::weak_ptr<pvaLinkLocal> local;
+
+    explicit LocalMonitorControl(const std::shared_ptr<pvaLinkLocal>& local)
+        :server::MonitorControlOp(local->name, local->cred, Info)
+        ,local(local)
+    {}
+    virtual ~LocalMonitorControl() {}
+
+protected:
+    virtual bool doPost(const Value& val, bool maybe, bool force) override final
+    {
+        auto L(local.lock());
+        if(!L)
+            return false;
+
+        bool wake = false, ret;
+        {
+            Guard G(L->lock);
+            if(L->state!=pvaLinkLocal::Active || L->mon_finished)
+                return false;
+
+            // as with a server, updates without any marked field are not delivered
+            if(!val || val.isMarked(true, true)) {
+
+                if((L->mon_queue.size() < L->mon_limit) || force || !val) {
+                    // the empty Value marks finish()
+                    L->mon_finished = !val;
+                    L->mon_queue.push_back(val);
+                    // pvaLinkChannel::run() re-queues itself until the queue is empty
+                    wake = L->mon_queue.size()==1u;
+
+                    if(L->mon_maxQueue < L->mon_queue.size())
+                        L->mon_maxQueue = L->mon_queue.size();
+
+                } else if(!maybe) {
+                    // squash
+                    L->mon_queue.back().assign(val);
+                    L->mon_nSquash++;
+                }
+            }
+
+            ret = L->mon_queue.size() < L->mon_limit;
+        }
+
+        if(wake)
+            L->notify();
+        return ret;
+    }
+
+public:
+    virtual void stats(server::MonitorStat& stat, bool reset) const override final
+    {
+        auto L(local.lock());
+        if(!L)
+            return;
+
+        Guard G(L->lock);
+
+        stat.running = L->mon_running;
+        stat.finished = L->mon_finished;
+        stat.pipeline = L->mon_pipeline;
+
+        stat.nQueue = L->mon_queue.size();
+        stat.maxQueue = L->mon_maxQueue;
+        stat.limitQueue = L->mon_limit;
+        stat.window = L->mon_limit - std::min(L->mon_limit, L->mon_queue.size());
+        stat.nSquash = L->mon_nSquash;
+
+        if(reset)
+            L->mon_maxQueue = L->mon_nSquash = 0u;
+    }
+
+    virtual void setWatermarks(size_t low, size_t high) override final
+    {
+        if(low > high)
+            throw std::logic_error("low must be <= high");
+
+        if(auto L = local.lock()) {
+            Guard G(L->lock);
+            L->mon_high = std::min(high, L->mon_limit-1u);
+        }
+    }
+
+    virtual void onStart(std::function<void(bool start)>&& fn) override final
+    {
+        if(auto L = local.lock()) {
+            Guard G(L->lock);
+            if(L->state!=pvaLinkLocal::Closed)
+                L->mon_onStart = std::move(fn);
+        }
+    }
+
+    virtual void onHighMark(std::function<void()>&& fn) override final
+    {
+        if(auto L = local.lock()) {
+            Guard G(L->lock);
+            if(L->state!=pvaLinkLocal::Closed)
+                L->mon_onHighMark = std::move(fn);
+        }
+    }
+
+    virtual void onLowMark(std::function<void()>&& fn) override final
+    {
+        if(auto L = local.lock()) {
+            Guard G(L->lock);
+            if(L->state!=pvaLinkLocal::Closed)
+                L->mon_onLowMark = std::move(fn);
+        }
+    }
+};
+
+struct LocalMonitorSetup final : public server::MonitorSetupOp
+{
+    const std::weak_ptr<pvaLinkLocal> local;
+
+    explicit LocalMonitorSetup(const std::shared_ptr<pvaLinkLocal>& local)
+        :server::MonitorSetupOp(local->name, local->cred, Info, local->pvRequest)
+        ,local(local)
+    {}
+    virtual ~LocalMonitorSetup() {}
+
+    virtual std::unique_ptr<server::MonitorControlOp> connect(const Value& prototype) override final
+    {
+        if(!prototype)
+            throw std::logic_error("Can't connect() with empty prototype");
+
+        auto L(local.lock());
+        if(!L)
+            throw std::logic_error("In-process PVA link already closed");
+
+        bool start = false;
+        {
+            Guard G(L->lock);
+            if(L->state==pvaLinkLocal::Active && !L->mon_connected) {
+                L->mon_connected = true;
+                // like a client, start as soon as connected
+                start = L->mon_start = true;
+            }
+        }
+        if(start)
+            L->wakeup();
+
+        return std::unique_ptr<server::MonitorControlOp>(new LocalMonitorControl(L));
+    }
+
+    virtual void error(const std::string& msg) override final
+    {
+        if(auto L = local.lock()) {
+            {
+                Guard G(L->lock);
+                if(L->state!=pvaLinkLocal::Active || L->mon_connected)
+                    return;
+                L->mon_error = msg;
+            }
+            L->notify();
+        }
+    }
+
+    virtual void onClose(std::function<void(const std::string&)>&& fn) override final
+    {
+        if(auto L = local.lock()) {
+            Guard G(L->lock);
+            if(L->state!=pvaLinkLocal::Closed)
+                L->mon_onClose = std::move(fn);
+        }
+    }
+};
+
+} // namespace
+
+pvaLinkLocal::pvaLinkLocal(const std::shared_ptr<pvaLinkChannel>& lchan)
+    :lchan(lchan)
+    ,name(lchan->key.first)
+    ,pvRequest(lchan->pvRequest)
+    ,cred(localCredentials())
+{
+    uint32_t qSize = 0u;
+    if(pvRequest["record._options.queueSize"].as(qSize) && qSize)
+        mon_limit = qSize;
+    (void)pvRequest["record._options.pipeline"].as(mon_pipeline);
+}
+
+pvaLinkLocal::~pvaLinkLocal() {}
+
+bool pvaLinkLocal::usable()
+{
+    if(!pvaLinkInProcess)
+        return false;
+#ifdef PVXS_ENABLE_OPENSSL
+    // over TLS, our server would see the x509 identity of provider_remote, which localCredentials() can't present.
+    if(linkGlobal->provider_remote.config().isTlsConfigured())
+        return false;
+#endif
+    return true;
+}
+
+void pvaLinkLocal::wakeup()
+{
+    linkGlobal->queue.push(shared_from_this());
+}
+
+void pvaLinkLocal::notify()
+{
+    if(auto chan = lchan.lock())
+        linkGlobal->queue.push(chan);
+}
+
+Value pvaLinkLocal::pop()
+{
+    Guard G(lock);
+
+    if(!mon_queue.empty()) {
+        auto ret(std::move(mon_queue.front()));
+        mon_queue.pop_front();
+
+        if(!ret)
+            throw client::Finished();
+
+        if(mon_pipeline && mon_onHighMark && !mon_highMark
+                && mon_limit - mon_queue.size() > mon_high)
+        {
+            mon_highMark = true;
+            wakeup();
+        }
+        return ret;
+
+    } else if(!mon_error.empty()) {
+        auto msg(std::move(mon_error));
+        mon_error.clear();
+        throw client::RemoteError(msg);
+
+    } else if(mon_lost) {
+        mon_lost = false;
+        throw client::Disconnect();
+    }
+
+    return Value();
+}
+
+void pvaLinkLocal::put(const Value& pvReq, build_t&& build, done_t&& done)
+{
+    // released after unlock
+    build_t prev_build;
+    done_t prev_done;
+    {
+        Guard G(lock);
+
+        if(put_state!=PutIdle) {
+            // as with the client, a new Put cancels one in progress.  Its result is never delivered.
+            // Source handlers are called from the worker, without record or channel locks.
+            if(put_state==PutExec)
+                put_cancel_onCancel = std::move(put_onCancel);
+            put_cancel_onClose = std::move(put_onClose);
+            prev_build = std::move(put_build);
+            prev_done = std::move(put_done);
+            put_onGet = nullptr;
+            put_onPut = nullptr;
+            put_onCancel = nullptr;
+            put_req = put_type = Value();
+            put_result = client::Result();
+            put_state = PutIdle;
+        }
+
+        put_pending = pvReq;
+        put_pending_build = std::move(build);
+        put_pending_done = std::move(done);
+    }
+    wakeup();
+}
+
+void pvaLinkLocal::close()
+{
+    cleanup(false);
+}
+
+void pvaLinkLocal::closeLater(const std::shared_ptr<pvaLinkLocal>& self)
+{
+    {
+        Guard G(self->lock);
+        if(self->state==Closed)
+            return;
+        self->closing = self;
+    }
+    self->wakeup();
+}
+
+void pvaLinkLocal::disconnect()
+{
+    log_debug_printf(_logger, "%s closed by Source\n", name.c_str());
+    cleanup(true);
+}
+
+void pvaLinkLocal::cleanup(bool lost)
+{
+    decltype(onClose) chanClose, monClose, putClose;
+    decltype(put_onCancel) putCancel, prevCancel;
+    decltype(put_onClose) prevClose;
+    // remaining handlers, and anything they reference, are released after onClose callbacks
+    decltype(onOp) op;
+    decltype(onRPC) rpc;
+    decltype(onSubscribe) sub;
+    decltype(mon_onStart) start;
+    decltype(mon_onHighMark) high, low;
+    decltype(put_onGet) get;
+    decltype(put_onPut) put;
+    done_t done, pending_done;
+    build_t build, pending_build;
+    {
+        Guard G(lock);
+
+        if(state==Closed)
+            return;
+
+        // if still Connecting, then connect() will fall back to client
+        mon_lost = lost && state==Active;
+        state = Closed;
+
+        chanClose = std::move(onClose);
+        monClose = std::move(mon_onClose);
+        putClose = std::move(put_onClose);
+        if(put_state==PutExec)
+            putCancel = std::move(put_onCancel);
+        prevCancel = std::move(put_cancel_onCancel);
+        prevClose = std::move(put_cancel_onClose);
+        op = std::move(onOp);
+        rpc = std::move(onRPC);
+        sub = std::move(onSubscribe);
+        start = std::move(mon_onStart);
+        high = std::move(mon_onHighMark);
+        low = std::move(mon_onLowMark);
+        get = std::move(put_onGet);
+        put = std::move(put_onPut);
+        done = std::move(put_done);
+        build = std::move(put_build);
+        pending_done = std::move(put_pending_done);
+        pending_build = std::move(put_pending_build);
+
+        mon_queue.clear();
+        put_pending = put_req = put_type = Value();
+        put_result = client::Result();
+        put_state = PutIdle;
+    }
+
+    if(prevCancel)
+        prevCancel();
+    if(prevClose)
+        prevClose("");
+    if(putCancel)
+        putCancel();
+    if(putClose)
+        putClose("");
+    if(monClose)
+        monClose("");
+    if(chanClose)
+        chanClose("");
+
+    if(lost)
+        notify();
+}
+
+// Running from link worker.
+void pvaLinkLocal::connect()
+{
+    auto self(shared_from_this());
+    bool claimed = false;
+
+    if(auto serv = ioc::server()) {
+        std::unique_ptr<server::ChannelControl> op(new LocalChannelControl(self));
+
+        // in order, as the Server would for CREATE_CHANNEL
+        for(auto& pair : serv.listSource()) {
+            auto src(serv.getSource(pair.first, pair.second));
+            if(!src)
+                continue;
+
+            try {
+                src->onCreate(std::move(op));
+            }catch(std::exception& e){
+                log_exc_printf(_logger, "%s Unhandled error in onCreate %s,%d : %s\n",
+                               name.c_str(), pair.first.c_str(), pair.second, e.what());
+            }
+
+            Guard G(lock);
+            if(state!=Connecting) {
+                break; // rejected
+            } else if(onOp || onRPC || onSubscribe || onClose) {
+                claimed = true;
+                break;
+            } else if(!op) {
+                break; // discarded
+            }
+        }
+    }
+
+    decltype(onSubscribe) sub;
+    Value req;
+    {
+        Guard G(lock);
+        if(claimed && state==Connecting) {
+            state = Active;
+            sub = onSubscribe;
+
+        } else {
+            claimed = false;
+            state = Closed;
+            req = std::move(put_pending);
+            put_pending_build = nullptr;
+            put_pending_done = nullptr;
+        }
+    }
+
+    if(!claimed) {
+        log_debug_printf(_logger, "%s not served in-process.  Using client\n", name.c_str());
+
+        if(auto chan = lchan.lock()) {
+            Guard G(chan->lock);
+            if(chan->local==self) {
+                chan->local.reset();
+                chan->openRemote();
+                if(req)
+                    chan->startPut(req);
+            }
+        }
+        return;
+    }
+
+    log_debug_printf(_logger, "%s connect in-process\n", name.c_str());
+
+    try {
+        if(!sub)
+            throw std::runtime_error("Monitor not implemented");
+
+        sub(std::unique_ptr<server::MonitorSetupOp>(new LocalMonitorSetup(self)));
+
+    }catch(std::exception& e){
+        log_debug_printf(_logger, "%s in-process monitor fails : %s\n", name.c_str(), e.what());
+        {
+            Guard G(lock);
+            if(mon_connected)
+                return;
+            mon_error = e.what();
+        }
+        notify();
+    }
+}
+
+void pvaLinkLocal::run()
+{
+    decltype(closing) keep;
+    bool doConnect;
+    {
+        Guard G(lock);
+        keep = std::move(closing);
+        doConnect = state==Connecting;
+    }
+
+    if(keep) {
+        log_debug_printf(_logger, "%s close in-process\n", name.c_str());
+        cleanup(false);
+        return;
+    }
+
+    try {
+        if(doConnect)
+            connect();
+
+        decltype(mon_onStart) start;
+        decltype(mon_onHighMark) high;
+        {
+            Guard G(lock);
+            if(state==Active && mon_start && mon_onStart) {
+                mon_start = false;
+                mon_running = true;
+                start = mon_onStart;
+            }
+            if(state==Active && mon_highMark) {
+                mon_highMark = false;
+                high = mon_onHighMark;
+            }
+        }
+        if(start)
+            start(true);
+        if(high)
+            high();
+
+    }catch(std::exception& e){
+        log_exc_printf(_logger, "%s Unhandled error in subscription setup : %s\n", name.c_str(), e.what());
+    }
+
+    auto self(shared_from_this());
+
+    {
+        decltype(put_cancel_onCancel) cancel;
+        decltype(put_cancel_onClose) close;
+        {
+            Guard G(lock);
+            cancel = std::move(put_cancel_onCancel);
+            close = std::move(put_cancel_onClose);
+        }
+        if(cancel)
+            cancel();
+        if(close)
+            close("");
+    }
+
+    // Source may complete synchronously.  Continue while progress is made.
+    while(true) {
+        put_state_t step;
+        uint32_t seq;
+        Value req, type;
+        decltype(onOp) op;
+        decltype(put_onPut) putfn;
+        build_t build;
+        done_t done;
+        decltype(put_onClose) putClose;
+        client::Result result;
+        {
+            Guard G(lock);
+            if(state!=Active)
+                break;
+
+            step = put_state;
+            switch(put_state) {
+            case PutIdle:
+                if(!put_pending)
+                    break;
+                put_seq++;
+                put_req = req = std::move(put_pending);
+                put_build = std::move(put_pending_build);
+                put_done = std::move(put_pending_done);
+                put_type = Value();
+                put_state = PutInit;
+                op = onOp;
+                break;
+            case PutInit:
+                if(!put_type) {
+                    step = PutExec; // waiting
+                    break;
+                }
+                req = put_req;
+                type = put_type;
+                build = put_build;
+                putfn = put_onPut;
+                put_state = PutExec;
+                break;
+            case PutExec:
+                break; // waiting
+            case PutDone:
+                result = std::move(put_result);
+                done = std::move(put_done);
+                putClose = std::move(put_onClose);
+                put_build = nullptr;
+                put_onGet = nullptr;
+                put_onPut = nullptr;
+                put_onCancel = nullptr;
+                put_req = put_type = Value();
+                put_state = PutIdle;
+                break;
+            }
+            seq = put_seq;
+        }
+
+        auto fail = [this, seq](const std::exception_ptr& err) {
+            Guard G(lock);
+            if((put_state==PutInit || put_state==PutExec) && put_seq==seq) {
+                put_result = client::Result(err);
+                put_state = PutDone;
+            }
+        };
+
+        if(step==PutIdle) {
+            if(!req)
+                break; // idle
+
+            log_debug_printf(_logger, "%s Start in-process put\n", name.c_str());
+            try {
+                if(!op)
+                    throw client::RemoteError("Put not implemented");
+                op(std::unique_ptr<server::ConnectOp>(new LocalConnectOp(self, req, seq)));
+            }catch(std::exception&){
+                fail(std::current_exception());
+            }
+
+        } else if(step==PutInit) {
+            try {
+                if(!putfn)
+                    throw client::RemoteError("Put not implemented");
+
+                auto val(build(type.cloneEmpty()));
+                putfn(std::unique_ptr<server::ExecOp>(new LocalExecOp(self, req, seq)), std::move(val));
+            }catch(std::exception&){
+                fail(std::current_exception());
+            }
+
+        } else if(step==PutDone) {
+            if(putClose)
+                putClose("");
+            if(done)
+                done(std::move(result));
+
+        } else {
+            break; // waiting for Source
+        }
+    }
+}
+
+}} // namespace pvxs::ioc
@@ -388,6 +388,7 @@ SingleSource::SingleSource()
     }
 
     allRecords.names = names;
+    allRecords.dynamic = false;
 
     // Start event pump
     if (!eventContext) {
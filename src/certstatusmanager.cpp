@@ -10,6 +10,7 @@
 
 #include "certstatusmanager.h"
 
+#include <map>
 #include <thread>
 
 #include <openssl/evp.h>
@@ -32,6 +33,99 @@ namespace certs {
 
 DEFINE_LOGGER(status, "pvxs.certs.status");
 
+namespace {
+// Upper bound on the number of verified responses remembered for any one trusted store
+constexpr size_t kMaxVerifiedOCSPResponses = 1024u;
+
+/**
+ * @brief Verified OCSP responses for one trusted store.
+ *
+ * Attached to the X509_STORE as ex_data so that its lifetime is bound to the store it
+ * was verified against.  Keys are the SHA-256 digest of the basic response followed by the
+ * SHA-256 digest of the responder certificate.  Values are the time until which the
+ * verification result may be reused: the earliest nextUpdate in the response, capped by the
+ * responder certificate's notAfter.
+ */
+struct OCSPVerifyCache {
+    epicsMutex lock;
+    std::map<std::string, time_t> verified;
+    size_t hits = 0u;
+};
+
+struct OCSPVerifyCacheGbl {
+    int X509_STORE_ex_idx;
+    epicsMutex lock;  // serialise creation of per-store caches
+} *ocsp_verify_cache_gbl;
+
+void free_OCSPVerifyCache(void *, void *ptr, CRYPTO_EX_DATA *, int, long, void *) noexcept {
+    auto cache = static_cast<OCSPVerifyCache *>(ptr);
+    delete cache;
+}
+
+void OCSPVerifyCacheGbl_init() {
+    std::unique_ptr<OCSPVerifyCacheGbl> gbl{new OCSPVerifyCacheGbl};
+    gbl->X509_STORE_ex_idx = X509_STORE_get_ex_new_index(0, nullptr, nullptr, nullptr, free_OCSPVerifyCache);
+    if (gbl->X509_STORE_ex_idx < 0) throw std::runtime_error("X509_STORE_get_ex_new_index");
+    ocsp_verify_cache_gbl = gbl.release();
+}
+
+/**
+ * @brief Get the verification cache attached to the given trusted store, creating it if needed
+ * @return the cache or nullptr if none could be attached
+ */
+OCSPVerifyCache *getOCSPVerifyCache(X509_STORE *trusted_store_ptr) {
+    impl::threadOnce<&OCSPVerifyCacheGbl_init>();
+    auto gbl = ocsp_verify_cache_gbl;
+    if (!gbl || !trusted_store_ptr) return nullptr;
+
+    Guard G(gbl->lock);
+    auto cache = static_cast<OCSPVerifyCache *>(X509_STORE_get_ex_data(trusted_store_ptr, gbl->X509_STORE_ex_idx));
+    if (!cache) {
+        std::unique_ptr<OCSPVerifyCache> car{new OCSPVerifyCache};
+        if (!X509_STORE_set_ex_data(trusted_store_ptr, gbl->X509_STORE_ex_idx, car.get())) return nullptr;
+        cache = car.release();  // X509_STORE_free() now responsible (using our registered callback `free_OCSPVerifyCache`)
+    }
+    return cache;
+}
+
+/**
+ * @brief Compute the verification cache key for an OCSP basic response.
+ *
+ * @param basic_response the response
+ * @param cert_auth_cert_chain the certificates included in the response
+ * @param signer_not_after set to the responder certificate's notAfter
+ * @return the key or an empty string if the response or its signer can't be digested
+ */
+std::string ocspVerifyCacheKey(OCSP_BASICRESP *basic_response, STACK_OF(X509) * cert_auth_cert_chain, time_t &signer_not_after) {
+    X509 *signer = nullptr;
+    if (OCSP_resp_get0_signer(basic_response, &signer, cert_auth_cert_chain) != 1 || !signer) return {};
+
+    unsigned char md[2 * EVP_MAX_MD_SIZE];
+    unsigned int response_len = 0u, signer_len = 0u;
+    if (!ASN1_item_digest(ASN1_ITEM_rptr(OCSP_BASICRESP), EVP_sha256(), basic_response, md, &response_len)) return {};
+    if (!X509_digest(signer, EVP_sha256(), md + response_len, &signer_len)) return {};
+
+    signer_not_after = CertDate::asn1TimeToTimeT(X509_get0_notAfter(signer));
+    return {reinterpret_cast<const char *>(md), response_len + signer_len};
+}
+
+/**
+ * @brief Get the time until which a verification of this response may be reused
+ * @return the earliest nextUpdate of all single responses or 0 if any single response has no nextUpdate
+ */
+time_t ocspNextUpdate(OCSP_BASICRESP *basic_response) {
+    time_t next_update_time = 0;
+    const int count = OCSP_resp_count(basic_response);
+    for (int i = 0; i < count; i++) {
+        ASN1_GENERALIZEDTIME *next_update = nullptr;
+        if (OCSP_single_get0_status(OCSP_resp_get0(basic_response, i), nullptr, nullptr, nullptr, &next_update) < 0 || !next_update) return 0;
+        const auto t = CertDate::asn1TimeToTimeT(next_update);
+        if (!next_update_time || t < next_update_time) next_update_time = t;
+    }
+    return next_update_time;
+}
+}  // namespace
+
 /**
  * @brief Retrieves the Online Certificate Status Protocol (OCSP) response from the given byte array.
  *
@@ -254,21 +348,74 @@ void CertStatusManager::unsubscribe() {
  *
  * Returns true if the OCSP response is valid, indicating that the certificate in question is from a trusted source.
  * Returns false if the OCSP response is invalid or if the certificate in question not to be trusted.
+ *
+ * Successful verifications are remembered with the trusted store, keyed by the response and responder
+ * certificate digests, so that the same response is not verified again until its nextUpdate.
  */
 bool CertStatusManager::verifyOCSPResponse(const ossl_ptr<OCSP_BASICRESP> &basic_response, X509_STORE *trusted_store_ptr) {
     // get cert_auth_cert_chain from the response (will be verified to see if it's ultimately signed by our trusted root certificate authority)
     const auto const_cert_auth_cert_chain_ptr = OCSP_resp_get0_certs(basic_response.get());
     ossl_ptr<STACK_OF(X509)> cert_auth_cert_chain(sk_X509_dup(const_cert_auth_cert_chain_ptr));  // remove const-ness
 
+    // Identical responses from the same responder, verified against the same store, need only be verified once until their nextUpdate
+    const auto now = time(nullptr);
+    time_t signer_not_after = 0;
+    const auto cache = getOCSPVerifyCache(trusted_store_ptr);
+    const auto key = cache ? ocspVerifyCacheKey(basic_response.get(), cert_auth_cert_chain.get(), signer_not_after) : std::string();
+    if (!key.empty()) {
+        Guard G(cache->lock);
+        auto it = cache->verified.find(key);
+        if (it != cache->verified.end()) {
+            if (now < it->second) {
+                log_debug_printf(status, "Reusing OCSP response verification: valid until %s\n", CertDate(it->second).s.c_str());
+                cache->hits++;
+                return true;
+            }
+            cache->verified.erase(it);
+        }
+    }
+
     // Verify the OCSP response.  Values greater than 0 mean verified
     const int verify_result = OCSP_basic_verify(basic_response.get(), cert_auth_cert_chain.get(), trusted_store_ptr, 0);
     if (verify_result <= 0) {
         throw OCSPParseException("OCSP_basic_verify failed");
     }
 
+    if (!key.empty()) {
+        auto valid_until = ocspNextUpdate(basic_response.get());
+        if (signer_not_after && signer_not_after < valid_until) valid_until = signer_not_after;
+        if (now < valid_until) {
+            Guard G(cache->lock);
+            if (cache->verified.size() >= kMaxVerifiedOCSPResponses) {
+                // drop expired entries, then the entry that would expire soonest
+                for (auto it = cache->verified.begin(); it != cache->verified.end();) {
+                    if (it->second <= now)
+                        it = cache->verified.erase(it);
+                    else
+                        ++it;
+                }
+                if (cache->verified.size() >= kMaxVerifiedOCSPResponses) {
+                    auto soonest = cache->verified.begin();
+                    for (auto it = cache->verified.begin(); it != cache->verified.end(); ++it) {
+                        if (it->second < soonest->second) soonest = it;
+                    }
+                    cache->verified.erase(soonest);
+                }
+            }
+            cache->verified[key] = valid_until;
+        }
+    }
+
     return true;
 }
 
+size_t CertStatusManager::verifyCacheHits(X509_STORE *trusted_store_ptr) {
+    const auto cache = getOCSPVerifyCache(trusted_store_ptr);
+    if (!cache) return 0u;
+    Guard G(cache->lock);
+    return cache->hits;
+}
+
 /**
  * @brief Get the string value of a custom extension by NID from a certificate.
  * This will return the PV name to monitor for status of the given certificate.
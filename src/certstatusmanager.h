@@ -191,6 +191,13 @@ class CertStatusManager {
      */
     void unsubscribe();
 
+    /**
+     * @brief Number of OCSP response verifications answered from the cache attached to this trusted store
+     * @param trusted_store_ptr the trusted store given to parse()
+     * @return the count, or 0 if no cache is attached
+     */
+    static size_t verifyCacheHits(X509_STORE *trusted_store_ptr);
+
     bool available(double timeout = 5.0) const noexcept { return isValid() || waitedTooLong(timeout); }
     bool waitedTooLong(double timeout = 5.0) const noexcept { return (manager_start_time_ + (time_t)timeout) < std::time(nullptr); }
     bool isValid() const noexcept { return status_ && status_->isValid(); }
@@ -43,6 +43,10 @@ constexpr timeval bucketIntervalFast{0, 200000};
 constexpr timeval initialSearchDelay{0, 10000};  // 10 ms
 // number of buckets in the search ring
 constexpr size_t nBuckets = 30u;
+// interval between packets of paced initial searches (bulk connect)
+constexpr timeval initialSearchPace{0, 10000};  // 10 ms
+// lowest fraction of Config::searchRate to which pacing will back off
+constexpr double searchRateMinFraction = 1.0 / 16.0;
 
 /* our limit for UDP packet payload.
  * try not to fragment with usual MTU==1500 allowing for some overhead
@@ -51,6 +55,11 @@ constexpr size_t nBuckets = 30u;
  */
 constexpr size_t maxSearchPayload = 1400;
 
+/* When a name does not fit in the remainder of a search packet, try
+ * this many of the following names before sending the packet.
+ */
+constexpr size_t maxSearchPackSkip = 8u;
+
 /* Interval between checks for Channels which are no longer used by any operation.
  * Channels will be discarded if found to be unused by two consecutive checks.
  */
@@ -348,6 +357,8 @@ std::shared_ptr<Channel> Channel::build(const std::shared_ptr<ContextImpl>& cont
 
 Operation::~Operation() = default;
 
+Batch::~Batch() = default;
+
 Subscription::~Subscription() {}
 
 #ifndef PVXS_ENABLE_OPENSSL
@@ -410,9 +421,16 @@ Report Context::report(bool zero) const {
             sconn.peer = conn->peerName;
             sconn.tx = conn->statTx;
             sconn.rx = conn->statRx;
+            sconn.ioUring = conn->ioUring();
+            sconn.tlsKernelOffload = conn->kernelTLSOffloaded();
+            if (conn->compressor) {
+                sconn.txSaved = conn->compressor->txSaved;
+                sconn.rxSaved = conn->compressor->rxSaved;
+            }
 
             if (zero) {
                 conn->statTx = conn->statRx = 0u;
+                if (conn->compressor) conn->compressor->txSaved = conn->compressor->rxSaved = 0u;
             }
 
             // omit stats for transitory conn->creatingByCID
@@ -432,6 +450,20 @@ Report Context::report(bool zero) const {
                 }
             }
         }
+
+#ifdef PVXS_ENABLE_OPENSSL
+        if (pvt->impl->tls_context && pvt->impl->tls_context->ctx) {
+            if (auto ex_data = pvt->impl->tls_context->getCertStatusExData()) {
+                {
+                    Guard G(ex_data->resumption.lock);
+                    ret.tlsFullHandshakes = ex_data->resumption.full_handshakes;
+                    ret.tlsResumedHandshakes = ex_data->resumption.resumed_handshakes;
+                    if (zero) ex_data->resumption.full_handshakes = ex_data->resumption.resumed_handshakes = 0u;
+                }
+                ex_data->countPeerStatuses(ret.tlsPeerStatuses, ret.tlsPeerSubscriptions);
+            }
+        }
+#endif
     });
 
     return ret;
@@ -485,7 +517,19 @@ ContextImpl::ContextImpl(const Config& conf, const evbase tcp_loop)
     }
 #endif
 
+    if (effective.ioUring) {
+        uring = URing::create(tcp_loop);
+        // fall back to libevent
+        effective.ioUring = !!uring;
+    }
+
+#ifndef PVXS_HAVE_UNIX_SOCKET
+    if (!effective.unixSocket.empty())
+        log_warn_printf(setup, "Unix sockets not supported.  Ignoring %s\n", effective.unixSocket.c_str());
+#endif
+
     searchBuckets.resize(nBuckets);
+    searchRate = effective.searchRate;
 
     std::set<SockAddr, SockAddrOnlyLess> bcasts;
     for (auto& addr : searchTx4.broadcasts()) {
@@ -632,6 +676,9 @@ void ContextImpl::close() {
         // breaks a ref. loop between Connection and ClientContextImpl
         nameServers.clear();
 
+        // any sockets still closing are closed now
+        uring.reset();
+
         // internal_self.use_count() may be >1 if
         // we are orphaning some Operations
     });
@@ -791,6 +838,19 @@ static void procSearchReply(ContextImpl& self, const SockAddr& src, uint8_t peer
 #endif
         return;
 
+    self.searchReplies++;
+
+    // a server on this host may also be reached through a Unix socket named for its GUID
+    std::string unixName;
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    if (isTCP && !self.effective.unixSocket.empty() && (serv.isLO() || self.ifmap.is_iface(serv))) {
+        unixName = unixSocketName(self.effective.unixSocket, guid);
+    }
+#endif
+
+    // all channels in one reply are to the same server, so CREATE_CHANNEL may be batched
+    std::shared_ptr<Connection> toCreate;
+
     for (auto n : range(nSearch)) {
         (void)n;
 
@@ -814,20 +874,23 @@ static void procSearchReply(ContextImpl& self, const SockAddr& src, uint8_t peer
             chan->replyAddr = serv;
 
 #ifdef PVXS_ENABLE_OPENSSL
-            chan->conn = Connection::build(self.shared_from_this(), serv, false, isTLS);
+            chan->conn = Connection::build(self.shared_from_this(), serv, false, isTLS, unixName);
 #else
-            chan->conn = Connection::build(self.shared_from_this(), serv, false);
+            chan->conn = Connection::build(self.shared_from_this(), serv, false, unixName);
 #endif
 
             chan->conn->pending[chan->cid] = chan;
             chan->state = Channel::Connecting;
 
-            chan->conn->createChannels();
+            if (toCreate && toCreate != chan->conn) toCreate->createChannels();
+            toCreate = chan->conn;
 
         } else if (chan->guid != guid) {
             log_err_printf(duppv, "Duplicate PV name %s from %s and %s\n", chan->name.c_str(), chan->replyAddr.tostring().c_str(), serv.tostring().c_str());
         }
     }
+
+    if (toCreate) toCreate->createChannels();
 }
 
 bool ContextImpl::onSearch(evutil_socket_t fd) {
@@ -912,7 +975,7 @@ void ContextImpl::onSearchS(evutil_socket_t fd, short evt, void* raw) {
     }
 }
 
-void ContextImpl::tickSearch(SearchKind kind, bool poked) {
+size_t ContextImpl::tickSearch(SearchKind kind, bool poked, size_t maxPackets) {
     // If kind == SearchKind::discover, then this is a discovery ping.
     // these are really empty searches with must-reply set.
     // So if !discover, then we should not be modifying any internal state
@@ -920,6 +983,11 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked) {
     // If kind == SearchKind::initial we are sending the first search request
     // for the channels in initalSearchBucket, and not resending requests for
     // channels in the searchBuckets.
+    //
+    // If maxPackets!=0, then at most this many packets are sent.  Any channels
+    // not searched for are left in the bucket they came from.
+    //
+    // Returns the number of packets sent.
 
     auto idx = currentBucket;
     if (kind == SearchKind::check) currentBucket = (currentBucket + 1u) % searchBuckets.size();
@@ -933,7 +1001,8 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked) {
         searchBuckets[idx].swap(bucket);
     }
 
-    while (!bucket.empty() || kind == SearchKind::discover) {
+    size_t npackets = 0u;
+    while ((!bucket.empty() && (!maxPackets || npackets < maxPackets)) || kind == SearchKind::discover) {
         // when 'discover' we only loop once
 
         searchMsg.resize(0x10000);
@@ -980,6 +1049,8 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked) {
         M.skip(2u, __FILE__, __LINE__);
 
         bool payload = false;
+        // names which did not fit in this packet, to be tried first in the next
+        decltype(bucket) deferred;
         while (!bucket.empty()) {
             assert(kind != SearchKind::discover);
 
@@ -1002,9 +1073,12 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked) {
 
             } else if (size_t(M.save() - searchMsg.data()) > maxSearchPayload) {
                 if (payload) {
-                    // other names did fit, defer this one to the next packet
+                    // other names did fit, defer this one to the next packet.
+                    // A following shorter name may still fit in this one.
                     M.restore(save);
-                    break;
+                    deferred.splice(deferred.end(), bucket, bucket.begin());
+                    if (deferred.size() >= maxSearchPackSkip) break;
+                    continue;
 
                 } else {
                     // some slightly less absurdly long PV name.
@@ -1034,6 +1108,7 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked) {
             nextBucket.splice(nextBucket.end(), bucket, bucket.begin());
             payload = true;
         }
+        bucket.splice(bucket.begin(), deferred);
         assert(M.good());
 
         if (!payload && kind != SearchKind::discover) break;
@@ -1095,8 +1170,18 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked) {
             // fail silently, will retry
         }
 
+        npackets++;
+
         if (kind == SearchKind::discover) break;
     }
+
+    if (!bucket.empty()) {
+        // packet limit reached.  Put back the remainder, to be searched for first next time
+        auto& src = kind == SearchKind::initial ? initialSearchBucket : searchBuckets[idx];
+        src.splice(src.begin(), bucket);
+    }
+
+    return npackets;
 }
 
 void ContextImpl::tickSearchS(evutil_socket_t fd, short evt, void* raw) {
@@ -1125,12 +1210,59 @@ void ContextImpl::initialSearchS(evutil_socket_t fd, short evt, void* raw) {
     auto self(static_cast<ContextImpl*>(raw));
     try {
         self->initialSearchScheduled = false;
-        self->tickSearch(SearchKind::initial, false);
+        if (self->effective.searchRate > 0.0) {
+            self->paceInitialSearch();
+        } else {
+            self->tickSearch(SearchKind::initial, false);
+        }
     } catch (std::exception& e) {
         log_exc_printf(io, "Unhandled error in initial search callback: %s\n", e.what());
     }
 }
 
+double ContextImpl::searchRateMin() const {
+    // at least one packet per pacing interval
+    return std::max(effective.searchRate * searchRateMinFraction, std::min(effective.searchRate, 1.0));
+}
+
+/* Send initial searches for bulk connect at no more than the current search rate,
+ * rescheduling until all have been sent.
+ *
+ * The rate adapts (AIMD) between searchRateMin() and the configured Config::searchRate.
+ * A UDP receive buffer overflow since the last interval means that search replies
+ * are arriving faster than they can be processed, so the rate is halved.
+ * Otherwise, replies being received increases the rate.
+ */
+void ContextImpl::paceInitialSearch() {
+    const double interval = initialSearchPace.tv_sec + initialSearchPace.tv_usec * 1e-6;
+
+    if (prevndrop != searchNDropPrev) {
+        searchNDropPrev = prevndrop;
+        searchRate = std::max(searchRateMin(), searchRate / 2.0);
+        log_debug_printf(setup, "Search replies lost.  Search rate %.1f pkt/s\n", searchRate);
+
+    } else if (searchReplies != searchRepliesPrev && searchRate < effective.searchRate) {
+        searchRate = std::min(effective.searchRate, searchRate + effective.searchRate * searchRateMinFraction);
+        log_debug_printf(setup, "Search rate %.1f pkt/s\n", searchRate);
+    }
+    searchRepliesPrev = searchReplies;
+
+    // no bursting beyond one interval worth of packets
+    const double burst = std::max(1.0, searchRate * interval);
+    searchCredit = std::min(burst, searchCredit + searchRate * interval);
+
+    if (searchCredit >= 1.0) {
+        auto nsent = tickSearch(SearchKind::initial, false, size_t(searchCredit));
+        searchCredit -= double(nsent);
+        if (searchCredit < 0.0) searchCredit = 0.0;
+    }
+
+    if (!initialSearchBucket.empty()) {
+        initialSearchScheduled = true;
+        if (event_add(initialSearcher.get(), &initialSearchPace)) throw std::runtime_error("Unable to schedule initialSearcher");
+    }
+}
+
 void ContextImpl::tickBeaconClean() {
     epicsTimeStamp now;
     epicsTimeGetCurrent(&now);
@@ -1314,7 +1446,8 @@ void ContextImpl::enableTlsForPeerConnection(const Connection* client_conn) {
     std::vector<std::weak_ptr<Connection>> to_cleanup;
     for (auto& pair : conns) {
         auto conn = pair.second.lock();
-        if (conn && (!client_conn || conn.get() == client_conn)) {
+        // a TLS connection whose peer status becomes good is kept
+        if (conn && (!client_conn || (conn.get() == client_conn && !conn->isTLS))) {
             to_cleanup.push_back(conn);
         }
     }
@@ -40,7 +40,7 @@ DEFINE_LOGGER(stapling, "pvxs.stapling");
 int clientOCSPCallback(SSL* ctx, ossl::SSLContext*) {
     log_debug_printf(stapling, "Client OCSP Stapling: %s\n", "clientOCSPCallback");
     // Find out what the peer cert we're verifying is
-    X509* peer_cert = SSL_get_peer_certificate(ctx);
+    X509* peer_cert = SSL_get0_peer_certificate(ctx);
 
     // Get the ex_data from the tls context, return if no peer-statuses to set
     auto ex_data = ossl::CertStatusExData::fromSSL(ctx);
@@ -60,12 +60,24 @@ int clientOCSPCallback(SSL* ctx, ossl::SSLContext*) {
             return PVXS_OCSP_STAPLING_OK;
         }
 
+        // If another connection to a server presenting the same certificate has already verified
+        // this same stapled response, and its status is still valid, then just share that status
+        if (auto peer_status = ex_data->getCachedPeerStatus(ossl::CertStatusExData::getSerialNumber(peer_cert))) {
+            certs::CertificateStatus cached_status;
+            if (peer_status->getStapledStatus(ocsp_response_ptr, (size_t)len, cached_status)) {
+                ossl::SSLContext::setStapledPeerStatus(ctx, cached_status, peer_status);
+                log_debug_printf(stapling, "Client OCSP stapled response already verified: %s\n", cached_status.status.s.c_str());
+                return PVXS_OCSP_STAPLING_OK;
+            }
+        }
+
         // Replace cached peer cert with received OCSP response.  Throws if parsing error and catch sets invalid status
         try {
             auto parsed_status = certs::CertStatusManager::parse(ocsp_response_ptr, (size_t)len, ex_data->trusted_store_ptr);
             auto status = parsed_status.status();
 
-            ex_data->setPeerStatus(peer_cert, status);
+            auto peer_status = ex_data->setPeerStatus(peer_cert, status, ocsp_response_ptr, (size_t)len);
+            ossl::SSLContext::setStapledPeerStatus(ctx, status, peer_status);
             log_debug_printf(stapling, "Client OCSP stapled response is: %s\n", parsed_status.ocsp_status.s.c_str());
             log_debug_printf(stapling, "Client OCSP stapled status date: %s\n", parsed_status.status_date.s.c_str());
             log_debug_printf(stapling, "Client OCSP stapled status valid until: %s\n", parsed_status.status_valid_until_date.s.c_str());
@@ -97,6 +109,7 @@ Connection::Connection(const std::shared_ptr<ContextImpl>& context,
 #ifdef PVXS_ENABLE_OPENSSL
                      , bool isTLS
 #endif
+                     , const std::string& unixName
                        )
     :
 #ifdef PVXS_ENABLE_OPENSSL
@@ -105,15 +118,13 @@ Connection::Connection(const std::shared_ptr<ContextImpl>& context,
     ConnBase (true, context->effective.sendBE(), nullptr, peerAddr)
 #endif
     ,context(context)
-    ,echoTimer(__FILE__, __LINE__,
-               event_new(context->tcp_loop.base, -1, EV_TIMEOUT|EV_PERSIST, &tickEchoS, this))
+    ,echoTimer(context->tcp_loop, [this]() { tickEcho(); })
+    ,unixName(unixName)
 {
     if(reconn) {
         log_debug_printf(io, "start holdoff timer for %s\n", peerName.c_str());
 
-        constexpr timeval holdoff{2, 0};
-        if(event_add(echoTimer.get(), &holdoff))
-            log_err_printf(io, "Server %s error starting echoTimer as holdoff\n", peerName.c_str());
+        echoTimer.start(2.0);
 
     } else {
         startConnecting();
@@ -133,10 +144,12 @@ ossl::CertStatusExData *Connection::getCertStatusExData() {
 }
 
 std::shared_ptr<Connection> Connection::build(const std::shared_ptr<ContextImpl>& context,
-                                              const SockAddr& serv, bool reconn, bool tls)
+                                              const SockAddr& serv, bool reconn, bool tls,
+                                              const std::string& unixName)
 #else
 std::shared_ptr<Connection> Connection::build(const std::shared_ptr<ContextImpl>& context,
-                                              const SockAddr& serv, bool reconn)
+                                              const SockAddr& serv, bool reconn,
+                                              const std::string& unixName)
 #endif
 {
     if(!context->isRunning())
@@ -147,13 +160,13 @@ std::shared_ptr<Connection> Connection::build(const std::shared_ptr<ContextImpl>
     std::shared_ptr<Connection> ret;
     auto it = context->connByAddr.find(pair);
     if (it == context->connByAddr.end() || !((ret = it->second.lock()))) {
-        context->connByAddr[pair] = ret = std::make_shared<Connection>(context, serv, reconn, tls);
+        context->connByAddr[pair] = ret = std::make_shared<Connection>(context, serv, reconn, tls, unixName);
     }
 #else
     std::shared_ptr<Connection> ret;
     auto it = context->connByAddr.find(serv);
     if(it==context->connByAddr.end() || !(ret = it->second.lock())) {
-        context->connByAddr[serv] = ret = std::make_shared<Connection>(context, serv, reconn);
+        context->connByAddr[serv] = ret = std::make_shared<Connection>(context, serv, reconn, unixName);
     }
 #endif
     return ret;
@@ -162,6 +175,22 @@ std::shared_ptr<Connection> Connection::build(const std::shared_ptr<ContextImpl>
 void Connection::startConnecting() {
     assert(!this->bev);
 
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    if (!unixName.empty() && !unixSock) {
+        if ((unixSock = unixConnect(unixName))) {
+            // the server first sends pva_ctrl_msg::ShmOffer, which must be received before libevent reads.
+            shmOfferWait.reset(event_new(context->tcp_loop.base, unixSock.sock, EV_READ, &onShmOfferS, this));
+            auto tmo(totv(context->effective.tcpTimeout));
+            if (!shmOfferWait || event_add(shmOfferWait.get(), &tmo))
+                throw std::runtime_error("Unable to begin connecting");
+            log_debug_printf(io, "Connecting to %s through %s\n", peerName.c_str(), unixName.c_str());
+            return;
+        }
+        log_debug_printf(io, "Server %s not reachable through %s, falling back to TCP\n", peerName.c_str(), unixName.c_str());
+        unixName.clear();
+    }
+#endif
+
     decltype(this->bev) bev(__FILE__, __LINE__, bufferevent_socket_new(context->tcp_loop.base, -1, BEV_OPT_CLOSE_ON_FREE | BEV_OPT_DEFER_CALLBACKS));
 
 #ifdef PVXS_ENABLE_OPENSSL
@@ -184,6 +213,26 @@ void Connection::startConnecting() {
 
         // Configure client OCSP callback if appropriate and required
         configureClientOCSPCallback(ctx);
+
+        // Offer a previous session with this server, and store new ones
+        context->tls_context->configureClientSessionResumption(ctx, peerName);
+    } else
+#endif
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    if (unixSock) {
+        // already connected.  bufferevent_socket_connect() w/o address will signal BEV_EVENT_CONNECTED
+        bev.reset(bufferevent_socket_new(context->tcp_loop.base, unixSock.sock, BEV_OPT_CLOSE_ON_FREE | BEV_OPT_DEFER_CALLBACKS));
+        unixSock.sock = -1; // ownership passes to bev
+    } else
+#endif
+#ifdef PVXS_ENABLE_IO_URING
+    if (context->uring) {
+        evsocket sock(peerAddr.family(), SOCK_STREAM, 0);
+        auto txLimit(evsocket::get_buffer_size(sock.sock, true));
+        auto rxLimit(evsocket::get_buffer_size(sock.sock, false));
+        auto fd(sock.sock);
+        sock.sock = -1; // ownership passes to uring
+        uring = context->uring->attach(fd, false, txLimit, rxLimit, bev);
     } else
 #endif
     {
@@ -192,18 +241,111 @@ void Connection::startConnecting() {
 
     bufferevent_setcb(bev.get(), &bevReadS, nullptr, &bevEventS, this);
 
-    timeval tmo(totv(context->effective.tcpTimeout));
-    bufferevent_set_timeouts(bev.get(), &tmo, &tmo);
+    bevTimeout = context->tcp_loop.commonTimeout(totv(context->effective.tcpTimeout));
+    bufferevent_set_timeouts(bev.get(), &bevTimeout, &bevTimeout);
 
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    if (!unixName.empty()) {
+        if (bufferevent_socket_connect(bev.get(), nullptr, 0)) throw std::runtime_error("Unable to begin connecting");
+    } else
+#endif
+#ifdef PVXS_ENABLE_IO_URING
+    if (uring)
+        uring->connect(peerAddr);
+    else
+#endif
     if (bufferevent_socket_connect(bev.get(), const_cast<sockaddr*>(&peerAddr->sa), peerAddr.size())) throw std::runtime_error("Unable to begin connecting");
 
     connect(std::move(bev));
 
 #ifdef PVXS_ENABLE_OPENSSL
-    log_debug_printf(io, "Connecting to %s, RX readahead %zu%s\n", peerName.c_str(), readahead, isTLS ? " TLS" : "");
+    log_debug_printf(io, "Connecting to %s, RX readahead %zu%s\n", peerName.c_str(), readahead, isTLS ? " TLS" : unixName.empty() ? "" : " Unix");
 #else
-    log_debug_printf(io, "Connecting to %s, RX readahead %zu\n", peerName.c_str(), readahead);
+    log_debug_printf(io, "Connecting to %s, RX readahead %zu%s\n", peerName.c_str(), readahead, unixName.empty() ? "" : " Unix");
+#endif
+}
+
+#ifdef PVXS_HAVE_UNIX_SOCKET
+void Connection::onShmOffer(short evt)
+{
+    size_t threshold = 0u;
+    int fd = -1;
+    int ok = (evt&EV_READ) ? recvShmOffer(unixSock.sock, threshold, fd) : 0;
+
+    if(ok<0) { // spurious wakeup
+        auto tmo(totv(context->effective.tcpTimeout));
+        if(!event_add(shmOfferWait.get(), &tmo))
+            return;
+        ok = 0;
+    }
+    shmOfferWait.reset();
+
+    if(ok && fd>=0) {
+        std::weak_ptr<Connection> weak(shared_from_this());
+        auto loop(context->tcp_loop);
+        // arrays may be released from any thread
+        shm = ShmMap::open(fd, [weak, loop](uint64_t offset) {
+            loop.tryDispatch([weak, offset]() {
+                if(auto self = weak.lock())
+                    self->sendShmRelease(offset);
+            });
+        });
+        ok = !!shm;
+    }
+
+    if(!ok) {
+        log_debug_printf(io, "Server %s no usable offer through %s, falling back to TCP\n", peerName.c_str(), unixName.c_str());
+        unixSock = evsocket();
+        unixName.clear();
+    } else {
+        shmThreshold = shm ? threshold : 0u;
+        log_debug_printf(io, "Server %s through %s, shared memory threshold %zu\n", peerName.c_str(), unixName.c_str(), shmThreshold);
+    }
+
+    startConnecting();
+}
+
+void Connection::onShmOfferS(evutil_socket_t fd, short evt, void *raw)
+{
+    try {
+        static_cast<Connection*>(raw)->onShmOffer(evt);
+    }catch(std::exception& e){
+        log_exc_printf(io, "Unhandled error in ShmOffer callback: %s\n", e.what());
+    }
+}
 #endif
+
+void Connection::sendShmRelease(uint64_t offset)
+{
+    if(!bev)
+        return;
+    auto tx = bufferevent_get_output(bev.get());
+    to_evbuf(tx, Header{pva_ctrl_msg::ShmRelease, pva_flags::Control, uint32_t(offset/ShmRing::align)}, sendBE);
+}
+
+void Connection::handle_Control(uint8_t cmd, uint32_t value)
+{
+    if(cmd!=pva_ctrl_msg::CompressOffer || compressor || !context->effective.compress)
+        return;
+#ifdef PVXS_ENABLE_OPENSSL
+    if(isTLS) {
+        log_debug_printf(connsetup, "Server %s offers compression through TLS.  Ignoring\n", peerName.c_str());
+        return;
+    }
+#endif
+
+    auto algo = Compressor::choose(value);
+    log_debug_printf(connsetup, "Server %s offers compression 0x%x, choose %s\n",
+                     peerName.c_str(), unsigned(value), Compressor::name(algo));
+    if(algo==Compressor::None)
+        return;
+
+    // ready to receive compressed messages before the server may send them
+    compressor.reset(new Compressor(algo, context->effective.compressThreshold, context->effective.compressMaxSize));
+
+    auto tx = bufferevent_get_output(bev.get());
+    to_evbuf(tx, Header{pva_ctrl_msg::CompressAccept, pva_flags::Control, uint32_t(algo)}, sendBE);
+    statTx += 8u;
 }
 
 #ifdef PVXS_ENABLE_OPENSSL
@@ -235,31 +377,50 @@ void Connection::createChannels()
     if(!ready)
         return; // defer until CONNECTION_VALIDATED
 
-    (void)evbuffer_drain(txBody.get(), evbuffer_get_length(txBody.get()));
-
     auto todo = std::move(pending);
 
+    std::vector<std::shared_ptr<Channel>> batch;
+    batch.reserve(todo.size());
+
     for(auto& pair : todo) {
         auto chan = pair.second.lock();
         if(!chan || chan->state!=Channel::Connecting)
             continue;
 
-        {
-            (void)evbuffer_drain(txBody.get(), evbuffer_get_length(txBody.get()));
+        batch.push_back(std::move(chan));
+    }
 
+    // count is a uint16_t
+    const size_t maxBatch = std::max(1u, std::min(0xffffu, context->effective.createChannelBatch));
+
+    for(size_t first=0u; first<batch.size(); first+=maxBatch) {
+        const auto last = std::min(batch.size(), first+maxBatch);
+
+        (void)evbuffer_drain(txBody.get(), evbuffer_get_length(txBody.get()));
+
+        {
             EvOutBuf R(sendBE, txBody.get());
 
-            to_wire(R, uint16_t(1u));
-            to_wire(R, chan->cid);
-            to_wire(R, chan->name);
+            to_wire(R, uint16_t(last-first));
+            for(auto i : range(first, last)) {
+                to_wire(R, batch[i]->cid);
+                to_wire(R, batch[i]->name);
+            }
         }
-        chan->statTx += enqueueTxBody(CMD_CREATE_CHANNEL);
+        auto tx = enqueueTxBody(CMD_CREATE_CHANNEL);
 
-        creatingByCID[chan->cid] = chan;
-        chan->state = Channel::Creating;
+        for(auto i : range(first, last)) {
+            auto& chan = batch[i];
 
-        log_debug_printf(io, "Server %s creating channel '%s' (%u)\n", peerName.c_str(),
-                         chan->name.c_str(), unsigned(chan->cid));
+            // apportion message size
+            chan->statTx += tx/(last-first);
+
+            creatingByCID[chan->cid] = chan;
+            chan->state = Channel::Creating;
+
+            log_debug_printf(io, "Server %s creating channel '%s' (%u)\n", peerName.c_str(),
+                             chan->name.c_str(), unsigned(chan->cid));
+        }
     }
 }
 
@@ -302,7 +463,7 @@ void Connection::bevEvent(short events) {
     // called Connection::cleanup()
 
     if(bev && (events&BEV_EVENT_CONNECTED)) {
-        log_debug_printf(io, "Connected to %s\n", peerName.c_str());
+        log_debug_printf(io, "Connected to %s%s\n", peerName.c_str(), unixName.empty() ? "" : " through Unix socket");
         connTime = epicsTime::getCurrent();
 
         auto peerCred(std::make_shared<ServerCredentials>());
@@ -312,16 +473,16 @@ void Connection::bevEvent(short events) {
         peerCred->isTLS = isTLS;
 
         if (isTLS) {
-            const auto ctx = bufferevent_openssl_get_ssl(bev.get());
+            const auto ctx = ssl();
             assert(ctx);
             ossl::SSLContext::getPeerCredentials(*peerCred, ctx);
         }
 #endif
         cred = std::move(peerCred);
 
-        {
+        if(unixName.empty()) {
             // after async connect() to avoid winsock specific race.
-            auto fd(bufferevent_getfd(bev.get()));
+            auto fd(sockfd());
             int opt = 1;
             if(setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (char*)&opt, sizeof(opt))<0) {
                 auto err(SOCKERRNO);
@@ -335,14 +496,19 @@ void Connection::bevEvent(short events) {
         // start echo timer
         // tcpTimeout(40) -> 15 second echo period
         // bound echo to range [1, 15]
-        timeval tmo(totv(std::max(1.0, std::min(15.0, context->effective.tcpTimeout*3.0/8.0))));
-        if(event_add(echoTimer.get(), &tmo))
-            log_err_printf(io, "Server %s error starting echoTimer\n", peerName.c_str());
+        echoTimer.start(std::max(1.0, std::min(15.0, context->effective.tcpTimeout*3.0/8.0)), true);
 
         state = Connected;
     }
 }
 
+void Connection::bevRead()
+{
+    // once per batch of messages.  Bounds the age of GET results served from monitor cache.
+    lastRx = epicsTime::getCurrent();
+    ConnBase::bevRead();
+}
+
 std::shared_ptr<ConnBase> Connection::self_from_this()
 {
     return shared_from_this();
@@ -360,9 +526,20 @@ void Connection::cleanup()
 
     if(bev)
         bev.reset();
+#ifdef PVXS_ENABLE_IO_URING
+    uring.reset();
+#endif
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    shmOfferWait.reset();
+    unixSock = evsocket();
+#endif
+    // arrays still referencing the mapping keep it alive
+    shm.reset();
+    shmThreshold = 0u;
+    // negotiated again on reconnect
+    compressor.reset();
 
-    if(event_del(echoTimer.get()))
-        log_err_printf(io, "Server %s error stopping echoTimer\n", peerName.c_str());
+    echoTimer.cancel();
 
     // return Channels to Searching state
     std::set<std::shared_ptr<Channel>> todo;
@@ -669,14 +846,48 @@ void Connection::handle_MESSAGE()
                op && op->chan ? op->chan->name.c_str() : "<dead>", msg.c_str());
 }
 
+// A complete value requested by CMD_MCAST_NACK.  cf. McastGroup::onRx()
+void Connection::handle_MCAST_DATA()
+{
+    std::vector<uint8_t> buf(evbuffer_get_length(segBuf.get()));
+    if(evbuffer_remove(segBuf.get(), buf.data(), buf.size())!=int(buf.size()))
+        throw std::runtime_error("Unable to copy multicast message");
+
+    FixedBuf M(peerBE, buf);
+    std::string name;
+    uint64_t seq = 0u;
+    uint8_t kind = 0u;
+    from_wire(M, name);
+    from_wire(M, seq);
+    from_wire(M, kind);
+
+    if(!M.good())
+        throw std::runtime_error(SB()<<M.file()<<':'<<M.line()<<" Decode error for multicast message");
+
+    // copy in case a sink removes itself
+    std::vector<std::shared_ptr<OperationBase>> targets;
+    for(auto& pair : opByIOID) {
+        if(pair.second.op!=Operation::Monitor)
+            continue;
+        auto op(pair.second.handle.lock());
+        if(op && op->chan && op->chan->name==name && dynamic_cast<McastSink*>(op.get()))
+            targets.push_back(op);
+    }
+
+    auto body = M.save();
+    auto blen = M.size();
+
+    for(auto& op : targets) {
+        FixedBuf B(peerBE, body, blen);
+        dynamic_cast<McastSink*>(op.get())->mcastData(seq, kind, B);
+    }
+}
+
 void Connection::tickEcho()
 {
     if(state==Holdoff) {
         log_debug_printf(io, "Server %s holdoff expires\n", peerName.c_str());
 
-        if(event_del(echoTimer.get()))
-            log_err_printf(io, "Server %s error Disabling echoTimer\n", peerName.c_str());
-
         startConnecting();
 
     } else {
@@ -696,13 +907,5 @@ void Connection::tickEcho()
     }
 }
 
-void Connection::tickEchoS(evutil_socket_t fd, short evt, void *raw)
-{
-    try {
-        static_cast<Connection*>(raw)->tickEcho();
-    }catch(std::exception& e){
-        log_exc_printf(io, "Unhandled error in echo timer callback: %s\n", e.what());
-    }
-}
 } // namespace client
 } // namespace pvxs
@@ -4,6 +4,7 @@
  * in file LICENSE that is included with this distribution.
  */
 #include <epicsAssert.h>
+#include <epicsGuard.h>
 
 #include <pvxs/log.h>
 #include <pvxs/nt.h>
@@ -13,6 +14,9 @@
 namespace pvxs {
 namespace client {
 
+typedef epicsGuard<epicsMutex> Guard;
+typedef epicsGuardRelease<epicsMutex> UnGuard;
+
 DEFINE_LOGGER(setup, "pvxs.cli.init");
 DEFINE_LOGGER(io, "pvxs.cli.io");
 
@@ -121,6 +125,8 @@ struct GPROp : public OperationBase
     Result result;
     bool getOput = false;
     bool autoExec = true;
+    // GET only.  <0 to disable
+    double maxAge = -1.0;
 
     enum state_t : uint8_t {
         Connecting, // waiting for an active Channel
@@ -332,6 +338,31 @@ struct GPROp : public OperationBase
         }
     }
 
+    // Complete a GET from the cache of a running MONITOR on the same Channel
+    bool fromCache()
+    {
+        if(op!=Get || !autoExec || maxAge<0.0)
+            return false;
+
+        auto cached(chan->cachedValue(pvRequest, maxAge));
+        if(!cached)
+            return false;
+
+        log_debug_printf(io, "Server %s channel '%s' GET from cache\n",
+                         chan->conn->peerName.c_str(), chan->name.c_str());
+
+        state = Done;
+        try {
+            if(onInit)
+                onInit(cached);
+            result = Result(std::move(cached), chan->conn->peerName);
+        } catch(std::exception& e) {
+            result = Result(std::current_exception());
+        }
+        notify();
+        return true;
+    }
+
     virtual void createOp() override final
     {
         if(state!=Connecting) {
@@ -393,6 +424,11 @@ void Connection::handle_GPR(pva_app_msg_t cmd)
 {
     auto rxlen = 8u + evbuffer_get_length(segBuf.get());
     EvInBuf M(peerBE, segBuf.get(), 16);
+    if(cmd!=CMD_RPC) {
+        // arrays may be placed in shared memory.  cf. ServerConn::shm
+        M.shmMap = shm.get();
+        M.shmThreshold = shmThreshold;
+    }
 
     uint32_t ioid;
     uint8_t subcmd=0;
@@ -449,6 +485,8 @@ void Connection::handle_GPR(pva_app_msg_t cmd)
             if(data) {
                 from_wire_valid(M, rxRegistry, data);
                 cache_sync(info->prototype, data);
+                if(M.shmMap)
+                    ShmMap::unpin(info->prototype);
             }
         }
     }
@@ -597,6 +635,9 @@ std::shared_ptr<Operation> gpr_setup(const std::shared_ptr<ContextImpl>& context
         try {
             internal->chan = Channel::build(context, name, server);
 
+            if(internal->fromCache())
+                return;
+
             internal->chan->pending.push_back(internal);
             internal->chan->createOperations();
         }catch(...){
@@ -609,6 +650,201 @@ std::shared_ptr<Operation> gpr_setup(const std::shared_ptr<ContextImpl>& context
     return external;
 }
 
+namespace {
+
+struct BatchOp final : public Batch
+{
+    const evbase loop;
+    const size_t nops;
+    // const after exec()
+    std::function<void(std::vector<Result>&&)> done;
+
+    // only access from loop (after exec())
+    std::vector<std::shared_ptr<GPROp>> ops;
+
+    mutable epicsMutex lock;
+    epicsEvent notify;
+
+    // guarded by lock
+    std::vector<Result> results;
+    size_t remaining;
+    enum {
+        Busy,
+        Done,
+        Abort,
+    } outcome = Busy;
+
+    BatchOp(const evbase& loop, size_t nops)
+        :loop(loop)
+        ,nops(nops)
+        ,results(nops)
+        ,remaining(nops)
+    {}
+    virtual ~BatchOp() {}
+
+    virtual size_t size() const override final { return nops; }
+
+    virtual bool cancel() override final
+    {
+        std::vector<std::function<void(Result&&)>> junk;
+        bool ret = false;
+        (void)loop.tryCall([this, &junk, &ret](){
+            for(auto& op : ops) {
+                if(!op->chan)
+                    continue;
+                ret |= op->_cancel(false);
+                junk.push_back(std::move(op->done));
+            }
+        });
+        return ret;
+    }
+
+    virtual std::vector<Result> wait(double timeout) override final
+    {
+        if(done)
+            throw std::logic_error("Batch has custom .result() callback");
+
+        Guard G(lock);
+        while(outcome==Busy) {
+            UnGuard U(G);
+            if(!notify.wait(timeout))
+                throw Timeout();
+        }
+        if(outcome==Abort)
+            throw Interrupted();
+        return results;
+    }
+
+    virtual void interrupt() override final
+    {
+        {
+            Guard G(lock);
+            if(outcome!=Busy)
+                return;
+            outcome = Abort;
+        }
+        notify.signal();
+    }
+
+    // on loop
+    void complete(size_t i, Result&& result)
+    {
+        {
+            Guard G(lock);
+            results[i] = std::move(result);
+            if(--remaining)
+                return;
+        }
+        finish();
+    }
+
+    // on loop
+    void finish()
+    {
+        std::vector<Result> all;
+        {
+            Guard G(lock);
+            if(outcome!=Busy)
+                return;
+            outcome = Done;
+            if(done)
+                all = std::move(results);
+        }
+
+        if(!done) {
+            notify.signal();
+            return;
+        }
+
+        try {
+            done(std::move(all));
+        } catch(std::exception& e) {
+            log_err_printf(io, "Batch Result Callback Error: %s\n", e.what());
+        }
+    }
+};
+
+} // namespace
+
+std::shared_ptr<Batch> BatchBuilder::exec()
+{
+    if(!ctx)
+        throw std::logic_error("NULL Builder");
+
+    auto context(ctx->impl->shared_from_this());
+    auto pvReq(_buildReq());
+
+    auto internal(std::make_shared<BatchOp>(context->tcp_loop, _names.size()));
+    internal->done = std::move(_result);
+    internal->ops.reserve(_names.size());
+
+    std::weak_ptr<BatchOp> wbatch(internal);
+    for(size_t i=0u; i<_names.size(); i++) {
+        auto op(std::make_shared<GPROp>(_put ? Operation::Put : Operation::Get, context->tcp_loop));
+        op->internal_self = op;
+        op->setDone([wbatch, i](Result&& result) {
+            if(auto batch = wbatch.lock())
+                batch->complete(i, std::move(result));
+        }, nullptr);
+        op->pvRequest = pvReq;
+        if(_put) {
+            auto val(_values[i]);
+            op->builder = [val](Value&& prototype) -> Value {
+                auto ret(prototype.cloneEmpty());
+                ret.assign(val);
+                return ret;
+            };
+        }
+        internal->ops.push_back(std::move(op));
+    }
+
+    auto syncCancel = _syncCancel;
+    std::shared_ptr<BatchOp> external(internal.get(), [internal, syncCancel](BatchOp*) mutable {
+        // (maybe) user thread
+        auto temp(std::move(internal));
+        auto loop(temp->loop);
+        loop.tryInvoke(syncCancel, std::bind([](std::shared_ptr<BatchOp>& batch) {
+                           // on worker
+                           for(auto& op : batch->ops) {
+                               if(op->chan)
+                                   op->_cancel(true);
+                           }
+                       }, std::move(temp)));
+    });
+
+    auto names(_names);
+    auto server(_server);
+    context->tcp_loop.dispatch([context, internal, names, server]() {
+        // on worker
+        // Setup all operations in one callback.  Requests to each Connection
+        // are queued together, and sent together when this callback returns.
+        std::vector<std::shared_ptr<Channel>> chans;
+        chans.reserve(names.size());
+
+        for(size_t i=0u; i<names.size(); i++) {
+            auto& op = internal->ops[i];
+            try {
+                op->chan = Channel::build(context, names[i], server);
+
+                op->chan->pending.push_back(op);
+                chans.push_back(op->chan);
+            }catch(...){
+                op->result = Result(std::current_exception());
+                op->state = GPROp::Done;
+                op->notify();
+            }
+        }
+
+        for(auto& chan : chans)
+            chan->createOperations();
+
+        if(names.empty())
+            internal->finish();
+    });
+
+    return external;
+}
+
 std::shared_ptr<Operation> GetBuilder::_exec_get()
 {
     assert(_get);
@@ -620,6 +856,7 @@ std::shared_ptr<Operation> GetBuilder::_exec_get()
     auto op(std::make_shared<GPROp>(Operation::Get, context->tcp_loop));
     op->setDone(std::move(_result), std::move(_onInit));
     op->autoExec = _autoexec;
+    op->maxAge = _maxAge;
     op->pvRequest = _buildReq();
 
     return gpr_setup(context, _name, _server, std::move(op), _syncCancel);
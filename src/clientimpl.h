@@ -21,7 +21,9 @@
 #include "evhelper.h"
 #include "openssl.h"
 #include "ownedptr.h"
+#include "shm.h"
 #include "udp_collector.h"
+#include "uring.h"
 #include "utilpvt.h"
 
 #ifdef PVXS_ENABLE_OPENSSL
@@ -87,6 +89,8 @@ struct RequestInfo {
 
     Value prototype;
     std::shared_ptr<RequestFL> fl;
+    // MONITOR only.  prototype holds a complete value (at least one update received)
+    bool complete = false;
 
     RequestInfo(uint32_t sid, uint32_t ioid, std::shared_ptr<OperationBase>& handle);
 };
@@ -96,7 +100,7 @@ struct Connection final : public ConnBase, public std::enable_shared_from_this<C
 
     // While HoldOff, the time until re-connection
     // While Connected, periodic Echo
-    const evevent echoTimer;
+    WheelTimer echoTimer;
 
     bool ready = false;
     bool nameserver = false;
@@ -113,16 +117,30 @@ struct Connection final : public ConnBase, public std::enable_shared_from_this<C
     uint32_t nextIOID = 0x10002000u;
 
     epicsTime connTime;
+    // time of most recent RX from this server
+    epicsTime lastRx;
     std::shared_ptr<const ServerCredentials> cred;
 
     INST_COUNTER(Connection);
 
+    // when non-empty, first try to connect through this Unix socket.  cf. ConfigCommon::unixSocket
+    std::string unixName;
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    // connected Unix socket, while waiting for pva_ctrl_msg::ShmOffer
+    evsocket unixSock;
+    evevent shmOfferWait;
+#endif
+    // mapping of server's ShmRing.  Also referenced by any arrays placed there.
+    std::shared_ptr<ShmMap> shm;
+    size_t shmThreshold = 0u;
+
     Connection(const std::shared_ptr<ContextImpl>& context,
                const SockAddr &peerAddr,
                bool reconn
 #ifdef PVXS_ENABLE_OPENSSL
       , bool isTLS
 #endif
+      , const std::string& unixName = std::string()
                );
     virtual ~Connection();
 
@@ -133,6 +151,7 @@ struct Connection final : public ConnBase, public std::enable_shared_from_this<C
 #ifdef PVXS_ENABLE_OPENSSL
                                     , bool isTLS
 #endif
+                                    , const std::string& unixName = std::string()
                                       );
 
 #ifdef PVXS_ENABLE_OPENSSL
@@ -140,12 +159,20 @@ struct Connection final : public ConnBase, public std::enable_shared_from_this<C
 #endif
 private:
     void startConnecting();
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    void onShmOffer(short evt);
+    static void onShmOfferS(evutil_socket_t fd, short evt, void *raw);
+#endif
     virtual void bevEvent(short events) override final;
+    virtual void bevRead() override final;
 public:
 
     void createChannels();
 
     void sendDestroyRequest(uint32_t sid, uint32_t ioid);
+    void sendShmRelease(uint64_t offset);
+
+    virtual void handle_Control(uint8_t cmd, uint32_t value) override final;
 
     virtual std::shared_ptr<ConnBase> self_from_this() override;
     virtual void cleanup() override final;
@@ -170,12 +197,13 @@ public:
     CASE(GET_FIELD);
 
     CASE(MESSAGE);
+
+    CASE(MCAST_DATA);
 #undef CASE
 
     void handle_GPR(pva_app_msg_t cmd);
 protected:
     void tickEcho();
-    static void tickEchoS(evutil_socket_t fd, short evt, void *raw);
 };
 
 struct ConnectImpl final : public Connect
@@ -244,6 +272,11 @@ struct Channel {
     void createOperations();
     void disconnect(const std::shared_ptr<Channel>& self);
 
+    // Search for a running MONITOR with the same field selection as pvRequest
+    // which has been heard from within maxAge seconds.
+    // Returns a copy of its cached value, or !valid() if none.
+    Value cachedValue(const Value& pvRequest, double maxAge) const;
+
     static
     std::shared_ptr<Channel> build(const std::shared_ptr<ContextImpl>& context,
                                    const std::string& name,
@@ -270,6 +303,67 @@ private:
     virtual void disconnected(const std::shared_ptr<OperationBase> &self) override final;
 };
 
+//! Receives multicast monitor updates.  cf. McastGroup
+struct McastSink {
+    virtual ~McastSink() {}
+    /** A CMD_MCAST_DATA datagram for a PV of interest.
+     *
+     * @param kind pva_mcast_kind::type_t
+     * @param M Positioned after the kind, at any update.
+     */
+    virtual void mcastData(uint64_t seq, uint8_t kind, Buffer& M) =0;
+};
+
+/** Membership of a multicast group, through which servers publish monitor updates.
+ *  cf. server::Server::addMulticast()
+ *
+ * Shared by those subscriptions of a Context which opt in with "record._options.multicast".
+ * Only used on the TCP worker.
+ */
+struct McastGroup {
+    const evbase loop;
+    const SockEndpoint group;
+
+    McastGroup(const evbase& loop, const std::string& group);
+    ~McastGroup();
+    McastGroup(const McastGroup&) = delete;
+    McastGroup& operator=(const McastGroup&) = delete;
+
+    //! Find, or join, a group on behalf of a Context
+    static std::shared_ptr<McastGroup> join(ContextImpl& context, const std::string& group);
+
+    void add(const std::string& name, McastSink* sink);
+    void remove(const std::string& name, McastSink* sink);
+
+    /** A server has accepted a subscription to a PV through this group.
+     *  Datagrams for this PV are then accepted only from the host of publisher.
+     *
+     * @param publisher The host of the server's TCP connection, with the port from pva_mcast_kind::Grant
+     */
+    void grant(const std::string& name, const SockAddr& publisher);
+
+    /** Ask the publisher of a PV to re-send updates [first, last].
+     *  first==0 asks for a complete value.
+     *
+     * @returns false if no subscription to this PV has yet been granted.
+     */
+    bool nack(const std::string& name, uint64_t first, uint64_t last);
+
+private:
+    void onRx(evutil_socket_t sock);
+    static void onRxS(evutil_socket_t sock, short evt, void *raw);
+
+    // bound to the group port, to receive multicasts
+    evsocket rxSock;
+    // sends NACKs, and receives replies
+    evsocket txSock;
+    const evevent rxEvent, txEvent;
+    std::multimap<std::string, McastSink*> sinks;
+    // PV name -> publisher, from grant()
+    std::map<std::string, SockAddr> publishers;
+    std::vector<uint8_t> buf;
+};
+
 struct ContextImpl : public std::enable_shared_from_this<ContextImpl>
 {
     SockAttach attach;
@@ -351,6 +445,16 @@ struct ContextImpl : public std::enable_shared_from_this<ContextImpl>
     // tcp_loop so this does not need to be guarded by a mutex
     bool initialSearchScheduled = false;
 
+    // bulk connect pacing of initial searches, when effective.searchRate>0.  Only used from tcp_loop
+    // current rate in packets per second.  Adapted between searchRateMin() and effective.searchRate
+    double searchRate = 0.0;
+    // packets which may be sent now
+    double searchCredit = 0.0;
+    // count of search replies received, and prevndrop, at the last adaptation
+    size_t searchReplies = 0u;
+    size_t searchRepliesPrev = 0u;
+    uint32_t searchNDropPrev = 0u;
+
     // map: endpoint+proto -> Beaconer
     typedef std::pair<SockAddr, std::string> BeaconServer;
     struct BeaconInfo {
@@ -400,6 +504,8 @@ struct ContextImpl : public std::enable_shared_from_this<ContextImpl>
     std::vector<std::pair<SockEndpoint, std::shared_ptr<Connection>>> nameServers;
 
     const evbase tcp_loop;
+    // when effective.ioUring
+    std::shared_ptr<URing> uring;
     const evevent searchRx4, searchRx6;
     const evevent searchTimer;
     const evevent initialSearcher;
@@ -410,6 +516,9 @@ struct ContextImpl : public std::enable_shared_from_this<ContextImpl>
 
     std::map<Discovery*, std::weak_ptr<Discovery>> discoverers;
 
+    // group -> membership shared by subscriptions.  cf. McastGroup::join()
+    std::map<std::string, std::weak_ptr<McastGroup>> mcastGroups;
+
     const evevent beaconCleaner;
     const evevent cacheCleaner;
     const evevent nsChecker;
@@ -436,7 +545,9 @@ struct ContextImpl : public std::enable_shared_from_this<ContextImpl>
     bool onSearch(evutil_socket_t fd);
     static void onSearchS(evutil_socket_t fd, short evt, void *raw);
     enum class SearchKind { discover, initial, check };
-    void tickSearch(SearchKind kind, bool poked);
+    size_t tickSearch(SearchKind kind, bool poked, size_t maxPackets = 0u);
+    void paceInitialSearch();
+    double searchRateMin() const;
     static void tickSearchS(evutil_socket_t fd, short evt, void *raw);
     static void initialSearchS(evutil_socket_t fd, short evt, void *raw);
     void tickBeaconClean();
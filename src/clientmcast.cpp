@@ -0,0 +1,200 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <osiSock.h>
+
+#include <pvxs/log.h>
+#include "utilpvt.h"
+#include "clientimpl.h"
+
+DEFINE_LOGGER(logmcast, "pvxs.cli.mcast");
+
+namespace pvxs {
+namespace client {
+
+McastGroup::McastGroup(const evbase& loop, const std::string& group)
+    :loop(loop)
+    ,group(group)
+    ,rxSock(this->group.addr.family(), SOCK_DGRAM, 0)
+    ,txSock(this->group.addr.family(), SOCK_DGRAM, 0)
+    ,rxEvent(__FILE__, __LINE__,
+             event_new(loop.base, rxSock.sock, EV_READ|EV_PERSIST, &onRxS, this))
+    ,txEvent(__FILE__, __LINE__,
+             event_new(loop.base, txSock.sock, EV_READ|EV_PERSIST, &onRxS, this))
+{
+    loop.assertInLoop();
+
+    if(!this->group.addr.isMCast() || !this->group.addr.port())
+        throw std::invalid_argument(SB()<<"Expected multicast group address with port, not '"<<group<<"'");
+
+    // other processes on this host may also be members
+    epicsSocketEnableAddressUseForDatagramFanout(rxSock.sock);
+    rxSock.bind(SockAddr::any(this->group.addr.family(), this->group.addr.port()));
+    if(!rxSock.mcast_join(this->group.resolve()))
+        throw std::runtime_error(SB()<<"Unable to join multicast group "<<group);
+
+    txSock.bind(SockAddr::any(this->group.addr.family()));
+
+    if(event_add(rxEvent.get(), nullptr) || event_add(txEvent.get(), nullptr))
+        throw std::runtime_error("Unable to enable multicast RX");
+
+    log_debug_printf(logmcast, "Joined multicast group %s\n", group.c_str());
+}
+
+McastGroup::~McastGroup()
+{
+    try {
+        rxSock.mcast_leave(group.resolve());
+    }catch(std::exception& e){
+        log_debug_printf(logmcast, "Error leaving multicast group : %s\n", e.what());
+    }
+}
+
+std::shared_ptr<McastGroup> McastGroup::join(ContextImpl& context, const std::string& group)
+{
+    context.tcp_loop.assertInLoop();
+
+    auto& ent = context.mcastGroups[group];
+    auto ret(ent.lock());
+    if(!ret) {
+        ret = std::make_shared<McastGroup>(context.tcp_loop, group);
+        ent = ret;
+    }
+    return ret;
+}
+
+void McastGroup::add(const std::string& name, McastSink* sink)
+{
+    sinks.emplace(name, sink);
+}
+
+void McastGroup::remove(const std::string& name, McastSink* sink)
+{
+    for(auto it(sinks.lower_bound(name)), end(sinks.upper_bound(name)); it!=end; ++it) {
+        if(it->second==sink) {
+            sinks.erase(it);
+            break;
+        }
+    }
+    if(!sinks.count(name))
+        publishers.erase(name);
+}
+
+void McastGroup::grant(const std::string& name, const SockAddr& publisher)
+{
+    if(!sinks.count(name))
+        return;
+
+    log_debug_printf(logmcast, "Granted '%s' from %s\n", name.c_str(), publisher.tostring().c_str());
+    publishers[name] = publisher;
+}
+
+bool McastGroup::nack(const std::string& name, uint64_t first, uint64_t last)
+{
+    auto it(publishers.find(name));
+    if(it==publishers.end())
+        return false;
+
+    std::vector<uint8_t> msg;
+    VectorOutBuf M(hostBE, msg);
+    M.skip(8, __FILE__, __LINE__); // fill in header after body length known
+    to_wire(M, name);
+    to_wire(M, first);
+    to_wire(M, last);
+
+    auto pktlen = M.save()-msg.data();
+
+    FixedBuf H(hostBE, msg.data(), 8);
+    to_wire(H, Header{CMD_MCAST_NACK, 0u, uint32_t(pktlen-8)});
+    assert(M.good() && H.good());
+
+    log_debug_printf(logmcast, "NACK '%s' %llu-%llu to %s\n", name.c_str(),
+                     (unsigned long long)first, (unsigned long long)last, it->second.tostring().c_str());
+
+    auto ntx = sendto(txSock.sock, (char*)msg.data(), pktlen, 0, &it->second->sa, it->second.size());
+    if(ntx < 0) {
+        int err = evutil_socket_geterror(txSock.sock);
+        log_debug_printf(logmcast, "Error sending NACK to %s : %s\n",
+                         it->second.tostring().c_str(), evutil_socket_error_to_string(err));
+    }
+    return true;
+}
+
+void McastGroup::onRx(evutil_socket_t sock)
+{
+    buf.resize(0x10000u);
+
+    for(unsigned i=0u; i<16u; i++) {
+        SockAddr src;
+        recvfromx R{sock, (char*)buf.data(), buf.size(), &src, nullptr};
+        const int nrx = R.call();
+
+        if(nrx<0)
+            break; // wait for more I/O
+
+        if(nrx<8 || buf[0]!=0xca || buf[3]!=CMD_MCAST_DATA || !(buf[2]&pva_flags::Server))
+            continue;
+
+        const bool be = buf[2]&pva_flags::MSB;
+        FixedBuf M(be, buf.data()+4, nrx-4);
+        uint32_t len = 0u;
+        std::string name;
+        uint64_t seq = 0u;
+        uint8_t kind = 0u;
+        from_wire(M, len);
+        from_wire(M, name);
+        from_wire(M, seq);
+        from_wire(M, kind);
+
+        if(!M.good() || len > uint32_t(nrx-8)) {
+            log_debug_printf(logmcast, "Ignore invalid datagram from %s\n", src.tostring().c_str());
+            continue;
+        }
+
+        auto first(sinks.lower_bound(name)), end(sinks.upper_bound(name));
+        if(first==end)
+            continue; // not interested
+
+        // Anyone on the segment can send to the group.  Only the host of the server
+        // which granted the subscription, through TCP, is believed.
+        auto pub(publishers.find(name));
+        if(pub==publishers.end() || pub->second.compare(src, false)!=0 || kind==pva_mcast_kind::Grant) {
+            log_debug_printf(logmcast, "Ignore '%s' from %s, not the granting server\n",
+                             name.c_str(), src.tostring().c_str());
+            continue;
+        }
+
+        // copy in case a sink removes itself
+        std::vector<McastSink*> targets;
+        for(auto it(first); it!=end; ++it)
+            targets.push_back(it->second);
+
+        auto body = M.save();
+        auto blen = size_t(buf.data() + 8u + len - body);
+
+        for(auto sink : targets) {
+            FixedBuf B(be, body, blen);
+            try {
+                sink->mcastData(seq, kind, B);
+            }catch(std::exception& e){
+                log_exc_printf(logmcast, "Unhandled error handling multicast of '%s' : %s\n",
+                               name.c_str(), e.what());
+            }
+        }
+    }
+}
+
+void McastGroup::onRxS(evutil_socket_t sock, short evt, void *raw)
+{
+    try {
+        static_cast<McastGroup*>(raw)->onRx(sock);
+    }catch(std::exception& e){
+        log_exc_printf(logmcast, "Unhandled error in multicast RX callback: %s\n", e.what());
+    }
+}
+
+} // namespace client
+} // namespace pvxs
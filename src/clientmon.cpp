@@ -7,20 +7,32 @@
 #include <epicsAssert.h>
 #include <epicsMutex.h>
 #include <epicsGuard.h>
+#include <epicsTime.h>
+#include <epicsVersion.h>
 
 #include <deque>
 
 #include <pvxs/log.h>
 #include "clientimpl.h"
+#include "ndcodec.h"
+
+#if EPICS_VERSION_INT<VERSION_INT(7,0,3,1)
+#  define getMonotonic getCurrent
+#endif
 
 namespace pvxs {
 namespace client {
 
 typedef epicsGuard<epicsMutex> Guard;
+typedef epicsGuardRelease<epicsMutex> UnGuard;
 
 DEFINE_LOGGER(monevt, "pvxs.cli.mon");
 DEFINE_LOGGER(io, "pvxs.cli.io");
 
+// Limit on out of order multicast updates held while waiting for a retransmit.
+// Matches the history kept by the server.
+constexpr size_t maxMcastHeld = 64u;
+
 namespace {
 struct Entry {
     Value val;
@@ -31,7 +43,38 @@ struct Entry {
 };
 }
 
-struct SubscriptionImpl final : public OperationBase, public Subscription
+struct SubscriptionImpl;
+
+struct CompletionQueue::Pvt {
+    struct Ready {
+        std::weak_ptr<Subscription> sub;
+        // valid while sub.lock() succeeds
+        SubscriptionImpl* impl;
+    };
+
+    mutable epicsMutex lock;
+    epicsEvent wakeup;
+
+    // guarded by lock
+    std::deque<Ready> ready;
+    unsigned nwaiters = 0u;
+    bool closed = false;
+
+    // on worker
+    void push(const std::weak_ptr<Subscription>& sub, SubscriptionImpl* impl)
+    {
+        bool wake;
+        {
+            Guard G(lock);
+            wake = ready.empty() && nwaiters;
+            ready.push_back(Ready{sub, impl});
+        }
+        if(wake)
+            wakeup.signal();
+    }
+};
+
+struct SubscriptionImpl final : public OperationBase, public Subscription, public McastSink
 {
     // for use in log messages, even after cancel()
     std::string channelName;
@@ -43,11 +86,17 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
     std::function<void (Subscription&, const Value&)> onInit;
     std::function<void(Subscription&)> event;
     Value pvRequest;
+    std::shared_ptr<CompletionQueue::Pvt> cq;
+    std::weak_ptr<Subscription> cqSelf; // external
     bool pipeline = false;
     bool autostart = true;
     bool maskConn = false, maskDiscon = true;
+    bool ndCodec = false; // requested "record._options.codec"
     uint32_t queueSize = 4u, ackAt=0u;
 
+    // set while queued in cq
+    std::atomic<bool> cqQueued{false};
+
     // only access from loop
     mutable std::weak_ptr<Subscription>     external_internal; // 'self' wrapped to be returned by shared_from_this()
 
@@ -68,11 +117,21 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
     uint32_t unack =0u;  // updates pop()'d, but not ack'd
     size_t nSrvSquash =0u;
     size_t nCliSquash =0u;
+    size_t nMcast =0u;
     size_t queueMax =0u;
     // user code has seen pop()==nullptr
     bool needNotify = true;
     bool ackPending = false; // ackTick scheduled
 
+    // only access from loop.  when opted in with "record._options.multicast"
+    std::shared_ptr<McastGroup> mcast;
+    uint64_t mcastNext = 0u; // next expected seq.  zero until a complete value is received
+    // out of order updates, held until gap is filled
+    std::map<uint64_t, std::vector<uint8_t>> mcastHeld;
+    bool mcastHeldBE = false;
+    TypeStore mcastTypes;
+    epicsTime mcastLastNack;
+
     INST_COUNTER(SubscriptionImpl);
 
     explicit SubscriptionImpl(const evbase& loop)
@@ -83,6 +142,8 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
     virtual ~SubscriptionImpl() {
         if(loop.assertInRunningLoop())
             _cancel(true);
+        if(mcast)
+            mcast->remove(channelName, this);
     }
 
     virtual const std::string& _name() override final {
@@ -113,6 +174,8 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
                                 __func__, typeid (e).name(), e.what());
             }
         }
+        if(cq && !cqQueued.exchange(true))
+            cq->push(cqSelf, this);
     }
 
     virtual void pause(bool p) override final
@@ -140,6 +203,9 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
                 chan->statTx += conn->enqueueTxBody(CMD_MONITOR);
 
                 state = p ? Idle : Running;
+
+                if(mcast && !p)
+                    mcastResync();
             }
         });
     }
@@ -151,8 +217,9 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
         ret.nSrvSquash = nSrvSquash;
         ret.nCliSquash = nCliSquash;
         ret.nQueue = queue.size();
+        ret.nMcast = nMcast;
         if(reset) {
-            nSrvSquash = nCliSquash = queueMax = 0u;
+            nSrvSquash = nCliSquash = queueMax = nMcast = 0u;
         }
     }
 
@@ -168,18 +235,15 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
                 queue.pop_front();
 
                 if(pipeline) {
-                    timeval tick{}; // immediate ACK
-
                     unack++;
 
                     if(!ackPending && unack>=ackAt) {
-                        if(event_add(ackTick.get(), &tick)) {
-                            log_err_printf(io, "Monitor '%s' unable to schedule ack\n", channelName.c_str());
-                        } else {
-                            log_debug_printf(io, "Monitor '%s' sched ack %u/%u\n",
-                                             channelName.c_str(), unsigned(unack), unsigned(ackAt));
-                            ackPending = true;
-                        }
+                        // immediate ACK.  Activate directly, as a zero timeout would
+                        // still pass through the libevent timer min-heap.
+                        event_active(ackTick.get(), EV_TIMEOUT, 0);
+                        log_debug_printf(io, "Monitor '%s' sched ack %u/%u\n",
+                                         channelName.c_str(), unsigned(unack), unsigned(ackAt));
+                        ackPending = true;
                     }
                 }
                 log_printf(monevt, ent.exc || ent.val ? Level::Info : Level::Err,
@@ -209,6 +273,9 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
             Guard G(lock);
             _pop(ret, true);
         }
+        // decompress in user thread, without the lock
+        if(ndCodec && ret)
+            (void)impl::ndCodecDecode(ret);
         return ret;
     }
 
@@ -222,18 +289,28 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
 
         out.reserve(limit);
 
-        Guard G(lock);
+        bool more;
+        {
+            Guard G(lock);
 
-        while(out.size() < limit) {
-            Value temp;
-            _pop(temp, out.empty()); // only throw if out is empty
-            if(!temp)
-                break;
+            while(out.size() < limit) {
+                Value temp;
+                _pop(temp, out.empty()); // only throw if out is empty
+                if(!temp)
+                    break;
+
+                out.emplace_back(std::move(temp));
+            }
+
+            more = !needNotify;
+        }
 
-            out.emplace_back(std::move(temp));
+        if(ndCodec) {
+            for(auto& val : out)
+                (void)impl::ndCodecDecode(val);
         }
 
-        return !needNotify;
+        return more;
     }
 
     virtual std::shared_ptr<Subscription> shared_from_this() const override final {
@@ -311,9 +388,176 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
         }
         bool ret = state!=Done;
         state = Done;
+        if(mcast) {
+            mcast->remove(channelName, this);
+            mcast.reset();
+        }
         return ret;
     }
 
+    // discard partial state, and ask for a complete value
+    void mcastResync()
+    {
+        mcastNext = 0u;
+        mcastHeld.clear();
+        mcastNack(0u, 0u);
+    }
+
+    void mcastNack(uint64_t first, uint64_t last)
+    {
+        // limit rate when many datagrams are lost together
+        epicsTime now(epicsTime::getCurrent());
+        if(now - mcastLastNack < 0.1)
+            return;
+        if(mcast->nack(channelName, first, last))
+            mcastLastNack = now;
+    }
+
+    // decode and queue one update
+    bool mcastPush(Buffer& M)
+    {
+        auto it(chan->conn->opByIOID.find(ioid));
+        if(it==chan->conn->opByIOID.end() || !it->second.prototype)
+            return false;
+
+        Value val(it->second.prototype.cloneEmpty());
+        BitMask overrun;
+        from_wire_valid(M, mcastTypes, val);
+        from_wire(M, overrun);
+
+        if(!M.good()) {
+            log_err_printf(io, "Channel '%s' invalid multicast update\n", channelName.c_str());
+            return false;
+        }
+
+        cache_sync(it->second.prototype, val);
+        it->second.complete = true;
+
+        bool notify;
+        {
+            Guard G(lock);
+
+            notify = queue.empty();
+
+            if(queue.size() >= queueSize && queue.back().val) {
+                log_debug_printf(io, "Channel %s multicast monitor Squash\n", channelName.c_str());
+                queue.back().val.assign(val);
+                nCliSquash++;
+
+            } else {
+                log_debug_printf(io, "Channel %s multicast monitor PUSH\n", channelName.c_str());
+                queue.emplace_back();
+                queue.back().val = std::move(val);
+            }
+
+            if(queueMax < queue.size())
+                queueMax = queue.size();
+            nMcast++;
+
+            if(notify)
+                notify = wantToNotify();
+        }
+
+        if(notify)
+            doNotify();
+        return true;
+    }
+
+    // deliver any held updates which are now in sequence
+    void mcastDrain()
+    {
+        while(!mcastHeld.empty() && mcastHeld.begin()->first <= mcastNext) {
+            auto ent(mcastHeld.begin());
+            if(ent->first == mcastNext) {
+                FixedBuf B(mcastHeldBE, ent->second);
+                if(!mcastPush(B)) {
+                    mcastResync();
+                    return;
+                }
+                mcastNext++;
+            }
+            mcastHeld.erase(ent);
+        }
+    }
+
+    void mcastHold(uint64_t seq, Buffer& M)
+    {
+        if(mcastHeld.size() >= maxMcastHeld) {
+            // too far behind to catch up
+            mcastResync();
+            return;
+        }
+        mcastHeldBE = M.be;
+        mcastHeld[seq].assign(M.save(), M.save()+M.size());
+    }
+
+    virtual void mcastData(uint64_t seq, uint8_t kind, Buffer& M) override final
+    {
+        if(!mcast) {
+            return; // not, or no longer, subscribed through a group
+
+        } else if(kind==pva_mcast_kind::Grant) {
+            // only through TCP.  cf. McastGroup::onRx()
+            uint16_t port = 0u;
+            from_wire(M, port);
+            if(M.good() && port && chan && chan->conn)
+                mcast->grant(channelName, chan->conn->peerAddr.withPort(port));
+            return;
+
+        } else if(state!=Running) {
+            // resume() will resync
+            mcastNext = 0u;
+            mcastHeld.clear();
+            return;
+        }
+
+        switch(kind) {
+        case pva_mcast_kind::Sync:
+            if(mcastNext && seq < mcastNext)
+                return; // already have this, or later
+            // sent with all fields marked
+            if(!mcastPush(M))
+                return;
+            mcastNext = seq + 1u;
+            mcastDrain();
+            break;
+
+        case pva_mcast_kind::Update:
+            if(!mcastNext) {
+                // may follow the requested Sync
+                mcastHold(seq, M);
+                mcastNack(0u, 0u);
+
+            } else if(seq == mcastNext) {
+                if(!mcastPush(M)) {
+                    mcastResync();
+                    return;
+                }
+                mcastNext++;
+                mcastDrain();
+
+            } else if(seq > mcastNext) {
+                log_debug_printf(io, "Channel '%s' multicast gap %llu-%llu\n", channelName.c_str(),
+                                 (unsigned long long)mcastNext, (unsigned long long)(seq-1u));
+                mcastHold(seq, M);
+                if(mcastNext)
+                    mcastNack(mcastNext, seq-1u);
+            }
+            // else duplicate
+            break;
+
+        case pva_mcast_kind::Heartbeat:
+            if(!mcastNext)
+                mcastNack(0u, 0u);
+            else if(seq >= mcastNext) // missed the latest Update(s)
+                mcastNack(mcastNext, seq);
+            break;
+
+        default:
+            log_debug_printf(io, "Channel '%s' ignores multicast kind %u\n", channelName.c_str(), kind);
+        }
+    }
+
     // not actually visible through Subscription.
     // an artifact of using OperationBase for convenience
     void _reExecGet(std::function<void(client::Result&&)>&& resultcb) override final {}
@@ -327,6 +571,15 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
 
         auto& conn = chan->conn;
 
+        if(mcast && conn->isTLS) {
+            // updates to a subscription authenticated by TLS are not sent as cleartext, unauthenticated, UDP
+            log_debug_printf(io, "Server %s channel '%s' monitor through TLS, not multicast\n",
+                             conn->peerName.c_str(), chan->name.c_str());
+            mcast->remove(channelName, this);
+            mcast.reset();
+            pvRequest["record._options.multicast"] = "";
+        }
+
         {
             uint8_t subcmd = 0x08; // INIT
             if(pipeline)
@@ -467,6 +720,9 @@ void Connection::handle_MONITOR()
 {
     auto rxlen = 8u + evbuffer_get_length(segBuf.get());
     EvInBuf M(peerBE, segBuf.get(), 16);
+    // arrays may be placed in shared memory.  cf. ServerConn::shm
+    M.shmMap = shm.get();
+    M.shmThreshold = shmThreshold;
 
     uint32_t ioid=0;
     uint8_t subcmd=0;
@@ -550,6 +806,9 @@ void Connection::handle_MONITOR()
             from_wire_valid(M, rxRegistry, data);
 
             cache_sync(info->prototype, data);
+            if(M.shmMap)
+                ShmMap::unpin(info->prototype);
+            info->complete = true;
 
             BitMask overrun;
             from_wire(M, overrun);
@@ -740,6 +999,125 @@ void Connection::handle_MONITOR()
 }
 
 
+Value Channel::cachedValue(const Value& pvRequest, double maxAge) const
+{
+    // record._options may change server behavior (eg. process=true), so always go to the network
+    if(state!=Active || !conn || pvRequest["record._options"])
+        return Value();
+
+    if(epicsTime::getCurrent() - conn->lastRx > maxAge)
+        return Value();
+
+    auto field(pvRequest["field"]);
+
+    for(auto& pair : opByIOID) {
+        auto info = pair.second;
+        if(info->op!=Operation::Monitor || !info->complete)
+            continue;
+
+        auto op(info->handle.lock());
+        if(!op)
+            continue;
+        auto mon = static_cast<const SubscriptionImpl*>(op.get());
+
+        // while paused, or when pipelined (with a full window), the server may hold back updates
+        if(mon->state!=SubscriptionImpl::Running || mon->pipeline)
+            continue;
+
+        auto monField(mon->pvRequest["field"]);
+        if(field.valid()!=monField.valid() || (field && !field.equalType(monField)))
+            continue;
+
+        auto ret(info->prototype.clone());
+        ret.mark();
+        return ret;
+    }
+
+    return Value();
+}
+
+CompletionQueue::CompletionQueue()
+    :pvt(std::make_shared<Pvt>())
+{}
+
+CompletionQueue::~CompletionQueue() {}
+
+size_t CompletionQueue::wait(std::vector<std::shared_ptr<Subscription>>& ready, size_t maxEvents, double timeout)
+{
+    if(!pvt)
+        throw std::logic_error("NULL CompletionQueue");
+
+    ready.clear();
+    maxEvents = std::max(size_t(1u), maxEvents);
+
+    // a wakeup may find that another waiter has taken the ready Subscriptions.
+    // So wait again until the deadline.
+    epicsTime deadline;
+    if(timeout>0.0)
+        deadline = epicsTime::getMonotonic() + timeout;
+
+    Guard G(pvt->lock);
+    while(true) {
+        while(!pvt->ready.empty() && ready.size() < maxEvents) {
+            auto ent(std::move(pvt->ready.front()));
+            pvt->ready.pop_front();
+
+            if(auto sub = ent.sub.lock()) {
+                // from now, another event will queue again
+                ent.impl->cqQueued = false;
+                ready.push_back(std::move(sub));
+            }
+        }
+
+        if(!ready.empty() || pvt->closed || timeout==0.0)
+            break;
+
+        bool ok;
+        pvt->nwaiters++;
+        {
+            UnGuard U(G);
+            if(timeout<0.0) {
+                pvt->wakeup.wait();
+                ok = true;
+            } else {
+                double remaining = deadline - epicsTime::getMonotonic();
+                ok = remaining>0.0 && pvt->wakeup.wait(remaining);
+            }
+        }
+        pvt->nwaiters--;
+        if(!ok)
+            break;
+    }
+
+    // pass along to another waiter
+    bool wake = pvt->nwaiters && (!pvt->ready.empty() || pvt->closed);
+    if(wake) {
+        UnGuard U(G);
+        pvt->wakeup.signal();
+    }
+
+    return ready.size();
+}
+
+void CompletionQueue::close()
+{
+    if(!pvt)
+        throw std::logic_error("NULL CompletionQueue");
+    {
+        Guard G(pvt->lock);
+        pvt->closed = true;
+    }
+    pvt->wakeup.signal();
+}
+
+size_t CompletionQueue::size() const
+{
+    if(!pvt)
+        throw std::logic_error("NULL CompletionQueue");
+    Guard G(pvt->lock);
+    return pvt->ready.size();
+}
+
 std::shared_ptr<Subscription> MonitorBuilder::exec()
 {
     if(!ctx)
@@ -751,6 +1129,7 @@ std::shared_ptr<Subscription> MonitorBuilder::exec()
     op->self = op;
     op->channelName = std::move(_name);
     op->event = std::move(_event);
+    op->cq = std::move(_cq);
     op->onInit = std::move(_onInit);
     op->pvRequest = _buildReq();
     op->maskConn = _maskConn;
@@ -766,6 +1145,21 @@ std::shared_ptr<Subscription> MonitorBuilder::exec()
 
     (void)options["pipeline"].as(op->pipeline);
 
+    {
+        auto codec(options["codec"]);
+        if(codec.type()==TypeCode::String) {
+            auto name(codec.as<std::string>());
+            if(impl::ndCodecSupported(name)) {
+                op->ndCodec = true;
+            } else if(!name.empty()) {
+                log_warn_printf(monevt, "Channel '%s' codec \"%s\" not supported, continuing without\n",
+                                op->channelName.c_str(), name.c_str());
+                // would not be able to decode
+                codec = "";
+            }
+        }
+    }
+
     auto ackAny = options["ackAny"];
 
     if(ackAny.type()==TypeCode::String) {
@@ -814,10 +1208,29 @@ std::shared_ptr<Subscription> MonitorBuilder::exec()
                                op->_cancel(true);
                        }, std::move(temp)));
     });
+    op->cqSelf = external;
+
+    auto mcastGroup(options["multicast"]);
+    if(mcastGroup.type()!=TypeCode::String)
+        mcastGroup = Value();
 
     auto server(std::move(_server));
     context->tcp_loop.dispatch([=]() {
         // on worker
+        if(mcastGroup) {
+            auto group(mcastGroup.as<std::string>());
+            try {
+                op->mcast = McastGroup::join(*context, group);
+                op->mcast->add(op->channelName, op.get());
+            }catch(std::exception& e){
+                log_warn_printf(monevt, "Channel '%s' unable to use multicast group '%s', continuing without : %s\n",
+                                op->channelName.c_str(), group.c_str(), e.what());
+                op->mcast.reset();
+                // ask for updates through TCP instead
+                op->pvRequest["record._options.multicast"] = "";
+            }
+        }
+
         try {
             op->chan = Channel::build(context, op->channelName, server);
 
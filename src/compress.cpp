@@ -0,0 +1,280 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <stdexcept>
+
+#include <pvxs/log.h>
+
+#include "compress.h"
+#include "pvaproto.h"
+#include "utilpvt.h"
+
+#ifdef PVXS_ENABLE_LZ4
+#  include <lz4.h>
+#endif
+#ifdef PVXS_ENABLE_ZSTD
+#  include <zstd.h>
+#endif
+
+DEFINE_LOGGER(logcomp, "pvxs.compress");
+
+namespace pvxs {
+namespace impl {
+
+namespace {
+// Number of compressed messages over which the ratio is judged
+constexpr unsigned sampleMsgs = 16u;
+// Backoff when a sample saves less than 1/minSavedDiv
+constexpr size_t minSavedDiv = 10u;
+// Number of eligible messages then sent uncompressed, before trying again
+constexpr unsigned backoffMsgs = 256u;
+// LZ4 can not expand one byte to more than 255.  A literal length byte, or a repeated match.
+constexpr size_t lz4MaxRatio = 255u;
+// Favor speed over ratio
+constexpr int zstdLevel = 1;
+}
+
+struct Compressor::Pvt {
+#ifdef PVXS_ENABLE_ZSTD
+    ZSTD_CCtx* cctx = nullptr;
+    ZSTD_DCtx* dctx = nullptr;
+#endif
+    evbuf scratch;
+
+    // current sample
+    unsigned nSample = 0u;
+    size_t sampleIn = 0u, sampleOut = 0u;
+    // eligible messages remaining to send uncompressed
+    unsigned backoff = 0u;
+
+    Pvt() :scratch(__FILE__, __LINE__, evbuffer_new()) {}
+    ~Pvt() {
+#ifdef PVXS_ENABLE_ZSTD
+        ZSTD_freeCCtx(cctx);
+        ZSTD_freeDCtx(dctx);
+#endif
+    }
+};
+
+uint32_t Compressor::supported()
+{
+    uint32_t ret = 0u;
+#ifdef PVXS_ENABLE_LZ4
+    ret |= 1u<<LZ4;
+#endif
+#ifdef PVXS_ENABLE_ZSTD
+    ret |= 1u<<Zstd;
+#endif
+    return ret;
+}
+
+Compressor::algo_t Compressor::choose(uint32_t offered)
+{
+    offered &= supported();
+    // zstd at a low level is comparable in speed, with better ratio
+    for(auto algo : {Zstd, LZ4}) {
+        if(offered & (1u<<algo))
+            return algo;
+    }
+    return None;
+}
+
+const char* Compressor::name(algo_t algo)
+{
+    switch(algo) {
+    case None: return "none";
+    case LZ4: return "lz4";
+    case Zstd: return "zstd";
+    }
+    return "<invalid>";
+}
+
+Compressor::Compressor(algo_t algo, size_t threshold, size_t maxSize)
+    :algo(algo)
+    ,threshold(std::max(threshold, size_t(8u)))
+    ,maxSize(maxSize)
+    ,pvt(new Pvt)
+{
+    if(algo==None || !(supported() & (1u<<algo)))
+        throw std::logic_error(SB()<<"Unsupported compression "<<unsigned(algo));
+
+#ifdef PVXS_ENABLE_ZSTD
+    if(algo==Zstd) {
+        pvt->cctx = ZSTD_createCCtx();
+        pvt->dctx = ZSTD_createDCtx();
+        if(!pvt->cctx || !pvt->dctx)
+            throw std::bad_alloc();
+    }
+#endif
+}
+
+Compressor::~Compressor() {}
+
+bool Compressor::compress(evbuffer* body, bool be)
+{
+    const size_t blen = evbuffer_get_length(body);
+    if(blen < threshold || blen > 0x7e000000u) // LZ4_MAX_INPUT_SIZE
+        return false;
+
+    if(pvt->backoff) {
+        pvt->backoff--;
+        return false;
+    }
+
+    auto src = evbuffer_pullup(body, -1);
+    if(!src)
+        throw std::bad_alloc();
+
+    size_t bound = 0u;
+    switch(algo) {
+#ifdef PVXS_ENABLE_LZ4
+    case LZ4: bound = LZ4_compressBound(int(blen)); break;
+#endif
+#ifdef PVXS_ENABLE_ZSTD
+    case Zstd: bound = ZSTD_compressBound(blen); break;
+#endif
+    default: return false;
+    }
+
+    evbuffer_iovec vec{};
+    if(evbuffer_reserve_space(pvt->scratch.get(), 4u + bound, &vec, 1)!=1)
+        throw std::bad_alloc();
+    auto dst = static_cast<uint8_t*>(vec.iov_base);
+
+    {
+        FixedBuf L(be, dst, 4u);
+        to_wire(L, uint32_t(blen));
+    }
+
+    size_t clen = 0u;
+    switch(algo) {
+#ifdef PVXS_ENABLE_LZ4
+    case LZ4: {
+        auto ret = LZ4_compress_default((const char*)src, (char*)dst+4u, int(blen), int(bound));
+        clen = ret>0 ? size_t(ret) : 0u;
+        break;
+    }
+#endif
+#ifdef PVXS_ENABLE_ZSTD
+    case Zstd: {
+        auto ret = ZSTD_compressCCtx(pvt->cctx, dst+4u, bound, src, blen, zstdLevel);
+        clen = ZSTD_isError(ret) ? 0u : ret;
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+
+    pvt->nSample++;
+    pvt->sampleIn += blen;
+    pvt->sampleOut += clen ? 4u + clen : blen;
+
+    if(pvt->nSample >= sampleMsgs) {
+        auto saved = pvt->sampleIn > pvt->sampleOut ? pvt->sampleIn - pvt->sampleOut : 0u;
+        if(saved < pvt->sampleIn/minSavedDiv) {
+            log_debug_printf(logcomp, "%s saves %zu of %zu bytes.  Backing off\n",
+                             name(algo), saved, pvt->sampleIn);
+            pvt->backoff = backoffMsgs;
+        }
+        pvt->nSample = 0u;
+        pvt->sampleIn = pvt->sampleOut = 0u;
+    }
+
+    if(!clen || 4u + clen >= blen) {
+        // not worthwhile.  send as is
+        vec.iov_len = 0u;
+        (void)evbuffer_commit_space(pvt->scratch.get(), &vec, 1);
+        return false;
+    }
+
+    vec.iov_len = 4u + clen;
+    if(evbuffer_commit_space(pvt->scratch.get(), &vec, 1))
+        throw std::bad_alloc();
+
+    (void)evbuffer_drain(body, blen);
+    auto err = evbuffer_add_buffer(body, pvt->scratch.get());
+    assert(!err);
+
+    txSaved += blen - (4u + clen);
+    return true;
+}
+
+void Compressor::decompress(evbuffer* body, bool be)
+{
+    const size_t clen = evbuffer_get_length(body);
+    auto src = evbuffer_pullup(body, -1);
+    if(clen < 4u || !src)
+        throw std::runtime_error("Truncated compressed message");
+
+    uint32_t blen = 0u;
+    {
+        FixedBuf L(be, src, 4u);
+        from_wire(L, blen);
+    }
+    if(blen > maxSize)
+        throw std::runtime_error(SB()<<"Compressed message would expand to "<<blen<<" bytes");
+
+    // before allocating, check that blen is plausible
+    bool plausible = false;
+    switch(algo) {
+#ifdef PVXS_ENABLE_LZ4
+    case LZ4:
+        plausible = blen <= (clen-4u)*lz4MaxRatio;
+        break;
+#endif
+#ifdef PVXS_ENABLE_ZSTD
+    case Zstd:
+        // always written by compress()
+        plausible = ZSTD_getFrameContentSize(src+4u, clen-4u)==blen;
+        break;
+#endif
+    default:
+        break;
+    }
+    if(!plausible)
+        throw std::runtime_error(SB()<<"Compressed message of "<<clen<<" bytes can not expand to "<<blen);
+
+    evbuffer_iovec vec{};
+    if(blen && evbuffer_reserve_space(pvt->scratch.get(), blen, &vec, 1)!=1)
+        throw std::bad_alloc();
+
+    bool ok = false;
+    switch(algo) {
+#ifdef PVXS_ENABLE_LZ4
+    case LZ4: {
+        auto ret = LZ4_decompress_safe((const char*)src+4u, (char*)vec.iov_base, int(clen-4u), int(blen));
+        ok = ret>=0 && uint32_t(ret)==blen;
+        break;
+    }
+#endif
+#ifdef PVXS_ENABLE_ZSTD
+    case Zstd: {
+        auto ret = ZSTD_decompressDCtx(pvt->dctx, vec.iov_base, blen, src+4u, clen-4u);
+        ok = !ZSTD_isError(ret) && ret==blen;
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+
+    if(!ok)
+        throw std::runtime_error(SB()<<"Invalid "<<name(algo)<<" compressed message");
+
+    vec.iov_len = blen;
+    if(blen && evbuffer_commit_space(pvt->scratch.get(), &vec, 1))
+        throw std::bad_alloc();
+
+    (void)evbuffer_drain(body, clen);
+    auto err = evbuffer_add_buffer(body, pvt->scratch.get());
+    assert(!err);
+
+    if(blen > clen)
+        rxSaved += blen - clen;
+}
+
+}} // namespace pvxs::impl
@@ -0,0 +1,76 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <memory>
+
+#include "evhelper.h"
+
+namespace pvxs {
+namespace impl {
+
+/** Compression of the payloads of one connection.
+ *
+ * A server offers the algorithms it supports with pva_ctrl_msg::CompressOffer.
+ * A client which also enables compression replies with pva_ctrl_msg::CompressAccept
+ * naming one of these.  Thereafter each peer may compress any unsegmented message,
+ * marking it with pva_flags::Compressed.
+ * The body of such a message is the uncompressed length (uint32_t) followed by the compressed payload.
+ * Not used through TLS.  cf. ConfigCommon::compress
+ *
+ * Only used from the connection worker.
+ */
+struct PVXS_API Compressor {
+    enum algo_t : uint8_t {
+        None = 0,
+        LZ4 = 1,
+        Zstd = 2,
+    };
+
+    //! Mask of (1u<<algo_t) supported by this build.  Zero if none
+    static uint32_t supported();
+    //! Preferred algorithm of those in mask, and supported.  None if no overlap
+    static algo_t choose(uint32_t offered);
+    static const char* name(algo_t algo);
+
+    const algo_t algo;
+    const size_t threshold;
+    //! Largest uncompressed length accepted by decompress()
+    const size_t maxSize;
+
+    // counters of bytes not sent, and not received, through compression
+    size_t txSaved = 0u, rxSaved = 0u;
+
+    //! @pre algo is supported()
+    Compressor(algo_t algo, size_t threshold, size_t maxSize);
+    ~Compressor();
+    Compressor(const Compressor&) = delete;
+    Compressor& operator=(const Compressor&) = delete;
+
+    /** Replace body with its compressed form.
+     *
+     * @returns false, leaving body unchanged, if smaller than threshold,
+     *          when backing off after poor ratios, or if not made smaller.
+     */
+    bool compress(evbuffer* body, bool be);
+
+    /** Replace body with its decompressed form.
+     *
+     * The uncompressed length is checked against maxSize, and against the compressed length,
+     * before allocating.
+     * @throws std::runtime_error if not valid
+     */
+    void decompress(evbuffer* body, bool be);
+
+private:
+    struct Pvt;
+    const std::unique_ptr<Pvt> pvt;
+};
+
+}} // namespace pvxs::impl
+
+#endif // COMPRESS_H
@@ -475,6 +475,16 @@ void parseTLSOptions(ConfigCommon& conf, const std::string& options) {
                 conf.tls_disable_stapling = true;
             else
                 log_warn_printf(config, "Ignore unknown TLS option `no_stapling` value %s.  no value expected\n", opt.c_str());
+        } else if (key == "no_resumption") {
+            if ( val.empty())
+                conf.tls_disable_session_resumption = true;
+            else
+                log_warn_printf(config, "Ignore unknown TLS option `no_resumption` value %s.  no value expected\n", opt.c_str());
+        } else if (key == "ktls") {
+            if ( val.empty())
+                conf.tls_kernel_offload = true;
+            else
+                log_warn_printf(config, "Ignore unknown TLS option `ktls` value %s.  no value expected\n", opt.c_str());
         } else {
             log_warn_printf(config, "Ignore unknown TLS option key %s\n", opt.c_str());
         }
@@ -508,6 +518,10 @@ std::string printTLSOptions(const ConfigCommon& conf) {
         opts.push_back("no_revocation_check");
     if ( conf.tls_disable_stapling)
         opts.push_back("no_stapling");
+    if ( conf.tls_disable_session_resumption)
+        opts.push_back("no_resumption");
+    if ( conf.tls_kernel_offload)
+        opts.push_back("ktls");
     if ( conf.tls_throw_if_cant_verify)
         opts.push_back("on_no_cms=throw");
     else
@@ -560,6 +574,66 @@ void Config::fromDefs(Config& self, const std::map<std::string, std::string>& de
         parse_timeout(self.tcpTimeout, pickone.name, pickone.val);
     }
 
+    if (pickone({"EPICS_PVAS_IO_URING", "EPICS_PVA_IO_URING"})) {
+        parse_bool(self.ioUring, pickone.name, pickone.val);
+    }
+
+    if (pickone({"EPICS_PVAS_UNIX_SOCKET", "EPICS_PVA_UNIX_SOCKET"})) {
+        self.unixSocket = pickone.val;
+    }
+
+    if (pickone({"EPICS_PVAS_COMPRESS", "EPICS_PVA_COMPRESS"})) {
+        parse_bool(self.compress, pickone.name, pickone.val);
+    }
+
+    if (pickone({"EPICS_PVAS_COMPRESS_THRESHOLD", "EPICS_PVA_COMPRESS_THRESHOLD"})) {
+        try {
+            self.compressThreshold = parseTo<uint64_t>(pickone.val);
+        } catch (std::exception& e) {
+            log_err_printf(serversetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
+    if (pickone({"EPICS_PVAS_COMPRESS_MAX", "EPICS_PVA_COMPRESS_MAX"})) {
+        try {
+            self.compressMaxSize = parseTo<uint64_t>(pickone.val);
+        } catch (std::exception& e) {
+            log_err_printf(serversetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
+    if (pickone({"EPICS_PVAS_SEARCH_CACHE_SIZE"})) {
+        try {
+            self.searchCacheSize = parseTo<uint64_t>(pickone.val);
+        } catch (std::exception& e) {
+            log_err_printf(serversetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
+    if (pickone({"EPICS_PVAS_ZEROCOPY_THRESHOLD"})) {
+        try {
+            self.zeroCopyThreshold = parseTo<uint64_t>(pickone.val);
+        } catch (std::exception& e) {
+            log_err_printf(serversetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
+    if (pickone({"EPICS_PVAS_SHM_SIZE"})) {
+        try {
+            self.shmSize = parseTo<uint64_t>(pickone.val);
+        } catch (std::exception& e) {
+            log_err_printf(serversetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
+    if (pickone({"EPICS_PVAS_SHM_THRESHOLD"})) {
+        try {
+            self.shmThreshold = parseTo<uint64_t>(pickone.val);
+        } catch (std::exception& e) {
+            log_err_printf(serversetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
 #ifdef PVXS_ENABLE_OPENSSL
     // EPICS_PVAS_TLS_KEYCHAIN
     if (pickone({"EPICS_PVAS_TLS_KEYCHAIN", "EPICS_PVA_TLS_KEYCHAIN"})) {
@@ -681,6 +755,15 @@ void Config::updateDefs(defs_t& defs) const {
     if (!interfaces.empty()) defs["EPICS_PVA_INTF_ADDR_LIST"] = defs["EPICS_PVAS_INTF_ADDR_LIST"] = join_addr(interfaces);
     if (!ignoreAddrs.empty()) defs["EPICS_PVAS_IGNORE_ADDR_LIST"] = join_addr(ignoreAddrs);
     defs["EPICS_PVA_CONN_TMO"] = std::to_string(tcpTimeout / tmoScale);
+    defs["EPICS_PVAS_SEARCH_CACHE_SIZE"] = std::to_string(searchCacheSize);
+    defs["EPICS_PVAS_ZEROCOPY_THRESHOLD"] = std::to_string(zeroCopyThreshold);
+    defs["EPICS_PVAS_SHM_SIZE"] = std::to_string(shmSize);
+    defs["EPICS_PVAS_SHM_THRESHOLD"] = std::to_string(shmThreshold);
+    if (ioUring) defs["EPICS_PVA_IO_URING"] = defs["EPICS_PVAS_IO_URING"] = "YES";
+    if (!unixSocket.empty()) defs["EPICS_PVA_UNIX_SOCKET"] = defs["EPICS_PVAS_UNIX_SOCKET"] = unixSocket;
+    if (compress) defs["EPICS_PVA_COMPRESS"] = defs["EPICS_PVAS_COMPRESS"] = "YES";
+    defs["EPICS_PVA_COMPRESS_THRESHOLD"] = defs["EPICS_PVAS_COMPRESS_THRESHOLD"] = std::to_string(compressThreshold);
+    defs["EPICS_PVA_COMPRESS_MAX"] = defs["EPICS_PVAS_COMPRESS_MAX"] = std::to_string(compressMaxSize);
 
     defs["EPICS_XDG_DATA_HOME"] = data_home;
     defs["EPICS_XDG_CONFIG_HOME"] = config_home;
@@ -821,6 +904,56 @@ void Config::fromDefs(Config& self, const std::map<std::string, std::string>& de
         parse_timeout(self.tcpTimeout, pickone.name, pickone.val);
     }
 
+    if (pickone({"EPICS_PVA_IO_URING"})) {
+        parse_bool(self.ioUring, pickone.name, pickone.val);
+    }
+
+    if (pickone({"EPICS_PVA_UNIX_SOCKET"})) {
+        self.unixSocket = pickone.val;
+    }
+
+    if (pickone({"EPICS_PVA_COMPRESS"})) {
+        parse_bool(self.compress, pickone.name, pickone.val);
+    }
+
+    if (pickone({"EPICS_PVA_COMPRESS_THRESHOLD"})) {
+        try {
+            self.compressThreshold = parseTo<uint64_t>(pickone.val);
+        } catch (std::exception& e) {
+            log_err_printf(clientsetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
+    if (pickone({"EPICS_PVA_COMPRESS_MAX"})) {
+        try {
+            self.compressMaxSize = parseTo<uint64_t>(pickone.val);
+        } catch (std::exception& e) {
+            log_err_printf(clientsetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
+    if (pickone({"EPICS_PVA_SEARCH_RATE"})) {
+        try {
+            self.searchRate = parseTo<double>(pickone.val);
+            if (self.searchRate < 0.0) throw std::logic_error("must not be negative");
+        } catch (std::exception& e) {
+            log_warn_printf(clientsetup, "%s invalid rate : %s", pickone.name.c_str(), e.what());
+            self.searchRate = 0.0;
+        }
+    }
+
+    if (pickone({"EPICS_PVA_CREATE_BATCH"})) {
+        try {
+            auto batch(parseTo<int64_t>(pickone.val));
+            // CREATE_CHANNEL count is a uint16_t
+            if (batch < 0 || batch > 0xffff) throw std::logic_error("must be in range [0, 65535]");
+            self.createChannelBatch = unsigned(batch);
+        } catch (std::exception& e) {
+            log_warn_printf(clientsetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+            self.createChannelBatch = 1u;
+        }
+    }
+
 #ifdef PVXS_ENABLE_OPENSSL
     // EPICS_PVA_TLS_KEYCHAIN
     if (pickone({"EPICS_PVA_TLS_KEYCHAIN"})) {
@@ -885,6 +1018,13 @@ void Config::updateDefs(defs_t& defs) const {
     if (!interfaces.empty()) defs["EPICS_PVA_INTF_ADDR_LIST"] = join_addr(interfaces);
     defs["EPICS_PVA_CONN_TMO"] = std::to_string(tcpTimeout / tmoScale);
     if (!nameServers.empty()) defs["EPICS_PVA_NAME_SERVERS"] = join_addr(nameServers);
+    if (searchRate > 0.0) defs["EPICS_PVA_SEARCH_RATE"] = SB() << searchRate;
+    if (createChannelBatch > 1u) defs["EPICS_PVA_CREATE_BATCH"] = SB() << createChannelBatch;
+    if (ioUring) defs["EPICS_PVA_IO_URING"] = "YES";
+    if (!unixSocket.empty()) defs["EPICS_PVA_UNIX_SOCKET"] = unixSocket;
+    if (compress) defs["EPICS_PVA_COMPRESS"] = "YES";
+    defs["EPICS_PVA_COMPRESS_THRESHOLD"] = std::to_string(compressThreshold);
+    defs["EPICS_PVA_COMPRESS_MAX"] = std::to_string(compressMaxSize);
 
     defs["XDG_DATA_HOME"] = data_home;
     defs["XDG_CONFIG_HOME"] = config_home;
@@ -10,11 +10,24 @@
 
 #include <pvxs/log.h>
 #include "conn.h"
+#include "uring.h"
 
 #ifdef PVXS_ENABLE_OPENSSL
 #include "openssl.h"
 #endif
 
+#ifdef PVXS_HAVE_KTLS
+#include <vector>
+#include <unistd.h>
+#  ifdef __linux__
+#    include <sys/socket.h>
+#    include <linux/tls.h>
+#    ifndef SOL_TLS
+#      define SOL_TLS 282
+#    endif
+#  endif
+#endif
+
 DEFINE_LOGGER(connsetup, "pvxs.tcp.setup");
 DEFINE_LOGGER(connio, "pvxs.tcp.io");
 
@@ -31,12 +44,14 @@ static
 constexpr size_t tcp_readahead_mult = 2u;
 
 #ifdef PVXS_ENABLE_OPENSSL
-ConnBase::ConnBase(bool isClient, bool isTLS, bool sendBE, evbufferevent&& bev, const SockAddr& peerAddr)
+ConnBase::ConnBase(bool isClient, bool isTLS, bool sendBE, evbufferevent&& bev, const SockAddr& peerAddr,
+                   const std::string& peerName)
 #else
-ConnBase::ConnBase(bool isClient, bool sendBE, evbufferevent&& bev, const SockAddr& peerAddr)
+ConnBase::ConnBase(bool isClient, bool sendBE, evbufferevent&& bev, const SockAddr& peerAddr,
+                   const std::string& peerName)
 #endif
     :peerAddr(peerAddr)
-    ,peerName(peerAddr.tostring())
+    ,peerName(peerName.empty() ? peerAddr.tostring() : peerName)
 #ifdef PVXS_ENABLE_OPENSSL
     ,isTLS(isTLS)
 #endif
@@ -68,7 +83,12 @@ void ConnBase::connect(ev_owned_ptr<bufferevent> &&bev)
         throw BAD_ALLOC();
     assert(!this->bev && state==Holdoff);
 
-    readahead = evsocket::get_buffer_size(bufferevent_getfd(bev.get()), false);
+    auto fd(bufferevent_getfd(bev.get()));
+#ifdef PVXS_ENABLE_IO_URING
+    if(uring)
+        fd = uring->sock;
+#endif
+    readahead = evsocket::get_buffer_size(fd, false);
 
 #if LIBEVENT_VERSION_NUMBER >= 0x02010000
     // allow to drain OS socket buffer in a single read
@@ -93,15 +113,178 @@ void ConnBase::connect(ev_owned_ptr<bufferevent> &&bev)
 void ConnBase::disconnect()
 {
     bev.reset();
+#ifdef PVXS_ENABLE_OPENSSL
+    ktlsSSL.reset();
+#endif
+#ifdef PVXS_ENABLE_IO_URING
+    uring.reset();
+#endif
     state = Disconnected;
 }
 
+evutil_socket_t ConnBase::sockfd() const
+{
+#ifdef PVXS_ENABLE_IO_URING
+    if(uring)
+        return uring->sock;
+#endif
+    return bev ? bufferevent_getfd(bev.get()) : -1;
+}
+
+#ifdef PVXS_ENABLE_OPENSSL
+SSL* ConnBase::ssl() const
+{
+    if(ktlsSSL)
+        return ktlsSSL.get();
+    return bev && isTLS ? bufferevent_openssl_get_ssl(bev.get()) : nullptr;
+}
+
+/* After a handshake offloaded to the kernel, replace the SSL bufferevent with a plain
+ * socket bufferevent, so that TLS connections take the same I/O path as TCP.
+ * Only possible once OpenSSL holds no buffered records, and has nothing partially written.
+ * Clients also wait for the first application data, which follows any post-handshake
+ * messages (session tickets) sent by the server.
+ */
+void ConnBase::kernelTLS()
+{
+#ifdef PVXS_HAVE_KTLS
+    if(!ktlsPending || !bev)
+        return;
+
+    auto ssl = bufferevent_openssl_get_ssl(bev.get());
+    if(!ssl) {
+        ktlsPending = false;
+        return;
+    }
+    if(SSL_has_pending(ssl) || evbuffer_get_length(bufferevent_get_output(bev.get())) || (isClient && !statRx))
+        return;
+    ktlsPending = false;
+
+    // freeing the SSL bufferevent closes its socket
+    auto fd = dup(bufferevent_getfd(bev.get()));
+    if(fd<0) {
+        log_warn_printf(connsetup, "%s %s unable to dup() for TLS kernel offload: %d\n", peerLabel(), peerName.c_str(), errno);
+        return;
+    }
+    evbufferevent plain(__FILE__, __LINE__, bufferevent_socket_new(bufferevent_get_base(bev.get()), fd,
+                                                                   BEV_OPT_CLOSE_ON_FREE|BEV_OPT_DEFER_CALLBACKS));
+
+    bufferevent_data_cb readcb, writecb;
+    bufferevent_event_cb eventcb;
+    void *arg;
+    bufferevent_getcb(bev.get(), &readcb, &writecb, &eventcb, &arg);
+    bufferevent_setcb(plain.get(), readcb, writecb, eventcb, arg);
+    bufferevent_set_timeouts(plain.get(), &bevTimeout, &bevTimeout);
+
+    for(auto which : {EV_READ, EV_WRITE}) {
+        size_t low, high;
+        if(!bufferevent_getwatermark(bev.get(), which, &low, &high))
+            bufferevent_setwatermark(plain.get(), which, low, high);
+    }
+    (void)bufferevent_set_max_single_read(plain.get(), readahead/tcp_readahead_mult);
+    (void)bufferevent_set_max_single_write(plain.get(), EV_SSIZE_MAX);
+
+    // already decrypted, but not yet processed
+    if(evbuffer_add_buffer(bufferevent_get_input(plain.get()), bufferevent_get_input(bev.get())))
+        throw BAD_ALLOC();
+
+    auto enabled = bufferevent_get_enabled(bev.get());
+
+    SSL_up_ref(ssl);
+    ktlsSSL.reset(ssl);
+    bev = std::move(plain);
+
+    if(bufferevent_enable(bev.get(), enabled))
+        throw std::logic_error("Unable to enable BEV");
+
+    log_debug_printf(connsetup, "%s %s TLS offloaded to kernel\n", peerLabel(), peerName.c_str());
+#endif // PVXS_HAVE_KTLS
+}
+
+/* After offload, read() fails with EIO when the next TLS record is not application data.
+ * Such a record can only be taken with recvmsg(), which gives its type.
+ * Session tickets are discarded, so an offloaded session is not resumed from them.
+ * Anything else (eg. KeyUpdate, or an alert) ends the connection.
+ * Returns true if reading may continue.
+ */
+bool ConnBase::kernelTLSControl()
+{
+#if defined(PVXS_HAVE_KTLS) && defined(__linux__)
+    // max. TLS record payload, with padding
+    std::vector<uint8_t> buf(16u*1024u + 256u);
+    union {
+        cmsghdr align;
+        char space[CMSG_SPACE(sizeof(unsigned char))];
+    } ctrl;
+    iovec iov{buf.data(), buf.size()};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1u;
+    msg.msg_control = ctrl.space;
+    msg.msg_controllen = sizeof(ctrl.space);
+
+    auto n = recvmsg(bufferevent_getfd(bev.get()), &msg, 0);
+    if(n<0) {
+        auto err = errno;
+        if(err==EAGAIN || err==EWOULDBLOCK || err==EINTR)
+            return true;
+        log_debug_printf(connio, "%s %s TLS control record error %d\n", peerLabel(), peerName.c_str(), err);
+        return false;
+    } else if(n==0) {
+        return false;
+    }
+
+    uint8_t type = 23u; // application_data
+    for(auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if(cmsg->cmsg_level==SOL_TLS && cmsg->cmsg_type==TLS_GET_RECORD_TYPE)
+            type = *CMSG_DATA(cmsg);
+    }
+
+    if(type==23u) {
+        return !evbuffer_add(bufferevent_get_input(bev.get()), buf.data(), size_t(n));
+
+    } else if(type==22u) { // handshake
+        for(size_t pos=0u; pos < size_t(n);) {
+            if(pos+4u > size_t(n))
+                break;
+            size_t mlen = (size_t(buf[pos+1u])<<16u) | (size_t(buf[pos+2u])<<8u) | buf[pos+3u];
+            if(buf[pos]!=4u || pos+4u+mlen > size_t(n)) // NewSessionTicket
+                break;
+            pos += 4u + mlen;
+            if(pos==size_t(n)) {
+                log_debug_printf(connio, "%s %s ignore TLS session ticket after kernel offload\n", peerLabel(), peerName.c_str());
+                return true;
+            }
+        }
+        log_warn_printf(connio, "%s %s unsupported TLS handshake message 0x%02x after kernel offload\n",
+                        peerLabel(), peerName.c_str(), buf[0]);
+        return false;
+
+    } else if(type==21u && n>=2 && buf[1]==0u) { // close_notify alert
+        log_debug_printf(connio, "%s %s TLS close_notify\n", peerLabel(), peerName.c_str());
+        return false;
+
+    } else {
+        log_warn_printf(connio, "%s %s unexpected TLS record type %u after kernel offload\n",
+                        peerLabel(), peerName.c_str(), type);
+        return false;
+    }
+#else
+    return false;
+#endif
+}
+#endif // PVXS_ENABLE_OPENSSL
+
 size_t ConnBase::enqueueTxBody(pva_app_msg_t cmd)
 {
+    uint8_t flags = isClient ? 0u : pva_flags::Server;
+    if(compressor && compressor->compress(txBody.get(), sendBE))
+        flags |= pva_flags::Compressed;
+
     auto blen = evbuffer_get_length(txBody.get());
     auto tx = bufferevent_get_output(bev.get());
     to_evbuf(tx, Header{cmd,
-                        uint8_t(isClient ? 0u : pva_flags::Server),
+                        flags,
                         uint32_t(blen)},
              sendBE);
     auto err = evbuffer_add_buffer(tx, txBody.get());
@@ -133,12 +316,29 @@ void ConnBase::handle_DESTROY_REQUEST() {};
 
 void ConnBase::handle_MESSAGE() {};
 
+void ConnBase::handle_MCAST_DATA() {};
+
+void ConnBase::handle_Control(uint8_t, uint32_t) {}
+
 #ifndef PVXS_ENABLE_OPENSSL
 void ConnBase::bevEvent(short events)
 #else
 void ConnBase::bevEvent(short events, std::function<void(bool)> fn)
 #endif
 {
+#ifdef PVXS_ENABLE_OPENSSL
+    if (bev && ktlsSSL && (events & BEV_EVENT_READING) && (events & BEV_EVENT_ERROR) && EVUTIL_SOCKET_ERROR() == EIO) {
+        // a TLS record other than application data
+        if (kernelTLSControl()) {
+            // re-enable, as libevent disables reading on error
+            if (bufferevent_enable(bev.get(), EV_READ)) throw std::logic_error("Unable to enable BEV");
+            if (evbuffer_get_length(bufferevent_get_input(bev.get()))) bevRead();
+            return;
+        }
+        // peer closed, or we can not continue
+        events = (events & ~BEV_EVENT_ERROR) | BEV_EVENT_EOF;
+    }
+#endif
 
     if (bev && isTLS) {
         if (events & (BEV_EVENT_ERROR | BEV_EVENT_EOF)) {
@@ -148,13 +348,21 @@ void ConnBase::bevEvent(short events, std::function<void(bool)> fn)
             }
         }
 
-#ifndef PVXS_ENABLE_OPENSSL
+        if (events & BEV_EVENT_CONNECTED) {
+            auto ssl = bufferevent_openssl_get_ssl(bev.get());
+            ossl::SSLContext::countHandshake(ssl);
+            ktlsPending = ossl::SSLContext::kernelOffloaded(ssl);
+        }
+
+#ifdef PVXS_ENABLE_OPENSSL
         // If this is a connect then subscribe to peer status is required
         if (events & BEV_EVENT_CONNECTED) {
             auto ctx = bufferevent_openssl_get_ssl(bev.get());
             assert(ctx);
             try {
-                if (!ossl::SSLContext::subscribeToPeerCertStatus(ctx, fn)) {
+                // Connections to peers presenting the same certificate share one status and monitor
+                peer_status_and_monitor = ossl::SSLContext::subscribeToPeerCertStatus(ctx, fn);
+                if (!peer_status_and_monitor) {
                     log_warn_printf(connio, "unable to subscribe to %s %s certificate status\n", peerLabel(), peerName.c_str());
                 }
             } catch (certs::CertStatusNoExtensionException &e) {
@@ -185,6 +393,9 @@ void ConnBase::bevEvent(short events, std::function<void(bool)> fn)
         }
         state = Disconnected;
         bev.reset();
+#ifdef PVXS_ENABLE_OPENSSL
+        ktlsSSL.reset();
+#endif
     }
 
     if (!bev)
@@ -230,8 +441,14 @@ void ConnBase::bevRead()
                  * flag subsequent messages...
                  */
                 sendBE = header[2]&pva_flags::MSB;
+
+            } else {
+                FixedBuf L(header[2]&pva_flags::MSB, header+4, 4);
+                uint32_t value = 0;
+                from_wire(L, value);
+                handle_Control(header[3], value);
             }
-            // Control messages are not actually useful
+            // Control messages are not otherwise useful
             evbuffer_drain(rx, 8);
             statRx += 8u;
             remaining -= 8u;
@@ -286,11 +503,21 @@ void ConnBase::bevRead()
             segCmd = header[3];
         }
 
+        const bool compressed = header[2]&pva_flags::Compressed;
+        if(compressed && (!compressor || seg)) {
+            log_crit_printf(connio, "%s %s Unexpected compressed message\n", peerLabel(), peerName.c_str());
+            bev.reset();
+            break;
+        }
+
         if(!seg || seg==pva_flags::SegLast) {
             expectSeg = false;
 
             // ready to process segBuf
             try {
+                if(compressed)
+                    compressor->decompress(segBuf.get(), peerBE);
+
                 switch(segCmd) {
                     case CMD_ECHO: handle_ECHO(); break;
 
@@ -316,6 +543,8 @@ void ConnBase::bevRead()
 
                     case CMD_MESSAGE: handle_MESSAGE(); break;
 
+                    case CMD_MCAST_DATA: handle_MCAST_DATA(); break;
+
                     default:
                         log_debug_printf(connio, "%s %s Ignore unexpected command 0x%02x\n", peerLabel(), peerName.c_str(), segCmd);
                         evbuffer_drain(segBuf.get(), evbuffer_get_length(segBuf.get()));
@@ -344,6 +573,9 @@ void ConnBase::bevRead()
         // wait for next header
         bufferevent_setwatermark(bev.get(), EV_READ, 8, readahead);
 
+#ifdef PVXS_ENABLE_OPENSSL
+        kernelTLS();
+#endif
     } else {
         cleanup();
     }
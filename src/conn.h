@@ -7,29 +7,43 @@
 #define CONN_H
 
 #include "evhelper.h"
+#include "compress.h"
 #include "dataimpl.h"
 #include "certstatus.h"
 #include "utilpvt.h"
 
+#ifdef PVXS_ENABLE_OPENSSL
+#include "ownedptr.h"
+#endif
+
 namespace pvxs {
 namespace ossl{
     struct CertStatusExData;
     struct SSLPeerStatusAndMonitor;
+    struct SSLPeerStatusSubscription;
 }
 namespace impl {
+struct URingSocket;
+
 struct ConnBase
 {
     const SockAddr peerAddr;
     const std::string peerName;
 protected:
     evbufferevent bev;
+#ifdef PVXS_ENABLE_IO_URING
+    // When set, bev is one end of a bufferevent pair, and the socket is serviced by io_uring.  cf. uring.h
+    std::shared_ptr<URingSocket> uring;
+#endif
 #ifdef PVXS_ENABLE_OPENSSL
-    // This is the strong reference to the peer status and its monitor.
+    // This is the connection's subscription, holding the strong reference to the peer status and its monitor.
     //
     // CLEANUP:
-    //  - If multiple connections subscribe to the same peer then they will all keep a
+    //  - If multiple connections subscribe to the same peer certificate then they will all keep a
     //      shared strong reference, but when the last is cleaned-up, it will finally
     //      call the destructor of the `pvxs::ossl::SSLPeerStatusAndMonitor` instance itself.
+    //  - Destroying a subscription removes only that connection's function from the
+    //      subscribers of the shared `pvxs::ossl::SSLPeerStatusAndMonitor`.
     //  - Each `pvxs::ossl::SSLPeerStatusAndMonitor` instance holds the tls context's key into the
     //      master map of `pvxs::ossl::SSLPeerStatusAndMonitor`s stored inside the ex_data
     //      (`pvxs::ossl::CertStatusExData`) attached to the `SSL_CTX` (tls context) of the
@@ -47,10 +61,12 @@ protected:
     // RECAP:
     //  - `pvxs::ossl::SSLPeerStatusAndMonitor`
     //      Structure holds peer status and a status monitor and also the status pv of cert to monitor
+    //  - `pvxs::ossl::SSLPeerStatusSubscription`
+    //      Lightweight per-connection subscriber holding the connection's status change function
     //  - `pvxs::ossl::ConnBase::peer_status_and_monitor`
-    //      Shared ptr strong reference to the peer status and its monitor in each connection
+    //      Shared ptr to the connection's subscription to the peer status and its monitor
     //  - `pvxs::ossl::CertStatusExData::peer_statuses`
-    //      Map of status PV string to peer status and its monitor.
+    //      Map of peer certificate serial number to peer status and its monitor.
     //  - `pvxs::ossl::CertStatusExData`
     //      Attached to a client or server's tls context with `SSL_CTX_set_ex_data()`,
     //      and `SSL_CTX_get_ex_data()`.  Peer certs can be shared between connections',
@@ -99,9 +115,14 @@ protected:
     // @endcode
     //
     // `SSLPeerStatusAndMonitor()` will remove itself from this table using the internally stored key.
-    std::shared_ptr<ossl::SSLPeerStatusAndMonitor> peer_status_and_monitor;
+    std::shared_ptr<ossl::SSLPeerStatusSubscription> peer_status_and_monitor;
     inline virtual ossl::CertStatusExData* getCertStatusExData() = 0;
 
+    // Set after a handshake which was offloaded to the kernel, until bev is replaced.  cf. kernelTLS()
+    bool ktlsPending = false;
+    // After kernel offload, bev is a plain socket bufferevent.  Keeps the (now idle) session for its peer credentials.
+    ossl_ptr<SSL> ktlsSSL;
+
   public:
     const bool isTLS;
 
@@ -129,6 +150,10 @@ public:
 
     size_t statTx{}, statRx{};
     size_t readahead{};
+    // set once payload compression is negotiated
+    std::unique_ptr<Compressor> compressor;
+    // inactivity timeout.  Applied again if bev is replaced
+    timeval bevTimeout{};
 
     enum {
         Holdoff,
@@ -138,9 +163,11 @@ public:
     } state;
 
 #ifdef PVXS_ENABLE_OPENSSL
-    ConnBase(bool isClient, bool isTLS, bool sendBE, evbufferevent &&bev, const SockAddr& peerAddr);
+    ConnBase(bool isClient, bool isTLS, bool sendBE, evbufferevent &&bev, const SockAddr& peerAddr,
+             const std::string& peerName = std::string());
 #else
-    ConnBase(bool isClient, bool sendBE, evbufferevent &&bev, const SockAddr& peerAddr);
+    ConnBase(bool isClient, bool sendBE, evbufferevent &&bev, const SockAddr& peerAddr,
+             const std::string& peerName = std::string());
 #endif
     ConnBase(const ConnBase&) = delete;
     ConnBase& operator=(const ConnBase&) = delete;
@@ -148,9 +175,33 @@ public:
 
     const char* peerLabel() const;
 
-    size_t enqueueTxBody(pva_app_msg_t cmd);
+    //! Socket serviced by io_uring
+    bool ioUring() const {
+#ifdef PVXS_ENABLE_IO_URING
+        return !!uring;
+#else
+        return false;
+#endif
+    }
+
+    //! TLS session offloaded to the kernel.  cf. kernelTLS()
+    bool kernelTLSOffloaded() const {
+#ifdef PVXS_ENABLE_OPENSSL
+        return !!ktlsSSL;
+#else
+        return false;
+#endif
+    }
+
+    virtual size_t enqueueTxBody(pva_app_msg_t cmd);
 
     bufferevent* connection() { return bev.get(); }
+    //! Underlying socket, or -1
+    evutil_socket_t sockfd() const;
+#ifdef PVXS_ENABLE_OPENSSL
+    //! TLS session, or nullptr
+    SSL* ssl() const;
+#endif
 
     void connect(ev_owned_ptr<bufferevent> &&bev);
     void disconnect();
@@ -179,12 +230,19 @@ public:
 
     virtual void handle_MESSAGE();
 
+    virtual void handle_MCAST_DATA();
+
+    // control messages other than SetEndian.  value is the header size field
+    virtual void handle_Control(uint8_t cmd, uint32_t value);
+
     virtual std::shared_ptr<ConnBase> self_from_this() = 0;
     virtual void cleanup() =0;
 
 #ifdef PVXS_ENABLE_OPENSSL
     virtual void bevEvent(short events) = 0;
     void bevEvent(short events, std::function<void(bool)>fn);
+    void kernelTLS();
+    bool kernelTLSControl();
 #else
     virtual void bevEvent(short events);
 #endif
@@ -28,6 +28,13 @@ LookupError::LookupError(const std::string& msg)
 
 LookupError::~LookupError() {}
 
+namespace {
+void notFrozen(const impl::FieldStorage* store)
+{
+    if(store->top->frozen)
+        throw std::logic_error("Can't change frozen Value.  Recommend pvxs::Value::thaw()");
+}
+} // namespace
 
 std::shared_ptr<const impl::FieldDesc>
 Value::Helper::type(const Value& v)
@@ -180,6 +187,8 @@ void Value::clear()
     if(!desc)
         return;
 
+    notFrozen(store.get());
+
     for(auto i : range(size_t(0u), desc->size())) {
         auto& s = store.get()[i];
         s.valid = false;
@@ -210,6 +219,52 @@ void Value::clear()
     }
 }
 
+Value& Value::freeze()
+{
+    if(!desc || store->top->frozen)
+        return *this;
+
+    auto top = store->top;
+    top->frozen = true;
+
+    for(auto& mem : top->members) {
+        if(mem.code==StoreType::Compound)
+            mem.as<Value>().freeze();
+    }
+    return *this;
+}
+
+Value& Value::thaw()
+{
+    if(!desc || !store->top->frozen)
+        return *this;
+
+    if(store.use_count()==1 && desc==store->top->desc.get()) {
+        // only reference, avoid copy
+        store->top->frozen = false;
+    } else {
+        *this = clone();
+    }
+
+    auto top = store->top;
+    for(auto& mem : top->members) {
+        if(mem.code!=StoreType::Compound)
+            continue;
+
+        auto& val = mem.as<Value>();
+        auto mtop = val ? val.store->top : nullptr;
+        val.thaw();
+        if(val && val.store->top!=mtop) // copied, so re-attach
+            val.store->top->enclosing = decltype(store)(store, &mem);
+    }
+    return *this;
+}
+
+bool Value::isFrozen() const
+{
+    return desc && store->top->frozen;
+}
+
 bool Value::isMarked(bool parents, bool children) const
 {
     if(!desc)
@@ -258,6 +313,8 @@ void Value::mark(bool v)
     if(!desc)
         return;
 
+    notFrozen(store.get());
+
     store->valid = v;
     if(!v)
         return;
@@ -275,6 +332,8 @@ void Value::unmark(bool parents, bool children)
     if(!desc)
         return;
 
+    notFrozen(store.get());
+
     store->valid = false;
 
     auto top = store->top;
@@ -540,6 +599,8 @@ void Value::copyIn(const void *ptr, StoreType type)
     if(!desc)
         throw NoField();
 
+    notFrozen(store.get());
+
     switch(store->code) {
     case StoreType::Real: {
         if(!copyInScalar(store->as<double>(), ptr, type)) throw NoConvert(SB()<<"Unable to assign "<<desc->code<<" with "<<type);
@@ -731,7 +792,48 @@ void Value::copyIn(const void *ptr, StoreType type)
     case StoreType::Null:
         if(type==StoreType::Compound) {
             auto& src = *reinterpret_cast<const Value*>(ptr);
-            if(src.type()==TypeCode::Struct) {
+            if(src.desc==desc) {
+                // copy struct to identical struct.  (eg. during Value::clone() or SharedPV::post())
+                // co-iterate storage instead of looking up each marked field by name.
+                // Still visits every field to test its mark, so O(fields), but only marked
+                // fields are copied.
+                auto sstore = src.store.get();
+                bool any = false;
+
+                for(size_t i=1u, N=desc->size(), endmark=0u; i<N; i++) {
+                    auto S = sstore + i;
+                    if(S->valid && i>=endmark && S->code==StoreType::Null) {
+                        // entire sub-struct marked.
+                        endmark = i + desc[i].size();
+                    }
+                    if(!S->valid && i>=endmark)
+                        continue;
+
+                    Value dfld;
+                    dfld.store = decltype(store)(store, store.get() + i);
+                    dfld.desc = desc + i;
+                    if(S->code==StoreType::Null)
+                        dfld.store->valid = true;
+                    else
+                        dfld.copyIn(&S->store, S->code);
+                    any = true;
+                }
+                if(src.isMarked()) {
+                    mark();
+
+                } else if(any) {
+                    // as if we mark()'d each field
+                    auto top = store->top;
+                    std::shared_ptr<FieldStorage> enc;
+                    while(top && (enc=top->enclosing.lock())) {
+                        enc->valid = true;
+                        top = enc->top;
+                    }
+                }
+
+                return;
+
+            } else if(src.type()==TypeCode::Struct) {
                 // copy struct to struct
                 // all marked source field may be mapped to destination fields
 
@@ -878,6 +980,7 @@ void Value::traverse(const std::string &expr, bool modify, bool dothrow)
                             // will select, or already selected
                             if(fld.desc!=&desc->members[it->second]) {
                                 // select
+                                notFrozen(store.get());
                                 std::shared_ptr<const FieldDesc> mtype(store->top->desc, &desc->members[it->second]);
                                 fld = Value(mtype, *this);
                             }
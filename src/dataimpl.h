@@ -153,6 +153,9 @@ struct StructTop {
     // empty, or the field of a structure which encloses this.
     std::weak_ptr<FieldStorage> enclosing;
 
+    // set by Value::freeze()
+    bool frozen = false;
+
     StructTop(const std::shared_ptr<const FieldDesc>& desc)
         :desc(desc)
         ,members(desc->size())
@@ -9,6 +9,11 @@
 #ifdef _WIN32
 #  include <windows.h>
 #  include <mswsock.h>
+#else
+#  include <pwd.h>
+#  include <unistd.h>
+#  include <dirent.h>
+#  include <sys/stat.h>
 #endif
 
 #include <cstring>
@@ -16,6 +21,7 @@
 #include <deque>
 #include <limits>
 #include <algorithm>
+#include <cmath>
 
 #include <event2/event.h>
 #include <event2/thread.h>
@@ -32,6 +38,7 @@
 
 #include "evhelper.h"
 #include "pvaproto.h"
+#include "shm.h"
 #include "utilpvt.h"
 #include <pvxs/log.h>
 
@@ -132,6 +139,7 @@ struct evbase::Pvt final : public epicsThreadRunable
     evbaseptr base;
     evevent keepalive;
     evevent dowork;
+    std::unique_ptr<TimerWheel> wheel;
     epicsEvent start_sync;
     epicsMutex lock;
 
@@ -192,9 +200,12 @@ struct evbase::Pvt final : public epicsThreadRunable
             evevent ka(__FILE__, __LINE__,
                        event_new(tbase.get(), -1, EV_TIMEOUT|EV_PERSIST, &evkeepalive, this));
 
+            std::unique_ptr<TimerWheel> twheel(new TimerWheel(tbase.get()));
+
             base = std::move(tbase);
             dowork = std::move(handle);
             keepalive = std::move(ka);
+            wheel = std::move(twheel);
 
             timeval tick{1000,0};
             if(event_add(keepalive.get(), &tick))
@@ -374,6 +385,129 @@ bool evbase::assertInRunningLoop() const
     throw std::logic_error("Not in running evbase worker");
 }
 
+TimerWheel& evbase::wheel() const
+{
+    return *pvt->wheel;
+}
+
+timeval evbase::commonTimeout(const timeval& tmo) const
+{
+    if(auto ret = event_base_init_common_timeout(base, &tmo))
+        return *ret;
+    return tmo; // limit on number of common timeouts reached
+}
+
+constexpr unsigned TimerWheel::tickMS;
+constexpr size_t TimerWheel::nslots;
+
+TimerWheel::TimerWheel(event_base* base)
+    :tick(__FILE__, __LINE__, event_new(base, -1, EV_TIMEOUT|EV_PERSIST, &onTickS, this))
+    ,slots(new Link[nslots])
+{}
+
+TimerWheel::~TimerWheel()
+{
+    // orphan any WheelTimer still pending
+    for(size_t i=0u; i<nslots; i++) {
+        while(slots[i].linked())
+            slots[i].next->unlink();
+    }
+}
+
+void TimerWheel::place(WheelTimer& timer)
+{
+    // expire on the timer.ticks'th tick from now
+    timer.rounds = (timer.ticks-1u)/nslots;
+    timer.link(slots[(cursor + timer.ticks)%nslots]);
+}
+
+void TimerWheel::onTick()
+{
+    cursor = (cursor+1u)%nslots;
+    auto& slot = slots[cursor];
+
+    // move slot contents to a temporary list, so that callbacks may start or cancel any timer
+    Link expired;
+    if(slot.linked()) {
+        expired.next = slot.next;
+        expired.prev = slot.prev;
+        expired.next->prev = expired.prev->next = &expired;
+        slot.next = slot.prev = &slot;
+    }
+
+    while(expired.linked()) {
+        auto timer = static_cast<WheelTimer*>(expired.next);
+        timer->unlink();
+
+        if(timer->rounds) {
+            timer->rounds--;
+            timer->link(slot);
+            continue;
+        }
+
+        if(timer->periodic)
+            place(*timer);
+        else
+            count--;
+
+        try {
+            // may destroy timer
+            timer->cb();
+        }catch(std::exception& e){
+            log_exc_printf(logerr, "Unhandled error in timer callback: %s\n", e.what());
+        }
+    }
+
+    if(!count && event_del(tick.get()))
+        log_err_printf(logerr, "Unable to stop TimerWheel%s\n", "");
+}
+
+void TimerWheel::onTickS(evutil_socket_t, short, void *raw)
+{
+    try {
+        static_cast<TimerWheel*>(raw)->onTick();
+    }catch(std::exception& e){
+        log_exc_printf(logerr, "Unhandled error in TimerWheel callback: %s\n", e.what());
+    }
+}
+
+WheelTimer::WheelTimer(const evbase& loop, std::function<void()>&& cb)
+    :wheel(loop.wheel())
+    ,cb(std::move(cb))
+{}
+
+WheelTimer::~WheelTimer()
+{
+    cancel();
+}
+
+void WheelTimer::start(double delay, bool periodic)
+{
+    if(linked()) {
+        unlink();
+
+    } else if(!wheel.count++) {
+        timeval period{0, TimerWheel::tickMS*1000};
+        if(event_add(wheel.tick.get(), &period))
+            log_err_printf(logerr, "Unable to start TimerWheel%s\n", "");
+    }
+
+    ticks = size_t(std::max(1.0, std::ceil(delay*1000.0/TimerWheel::tickMS)));
+    this->periodic = periodic;
+    wheel.place(*this);
+}
+
+bool WheelTimer::cancel()
+{
+    if(!linked())
+        return false;
+
+    unlink();
+    if(!--wheel.count && event_del(wheel.tick.get()))
+        log_err_printf(logerr, "Unable to stop TimerWheel%s\n", "");
+    return true;
+}
+
 bool evsocket::canIPv6;
 evsocket::ipstack_t evsocket::ipstack;
 
@@ -390,7 +524,11 @@ evsocket::evsocket(int af, evutil_socket_t sock, bool blocking)
 #endif
         throw std::system_error(err, std::system_category());
     }
-    if(af!=AF_INET && af!=AF_INET6) {
+    if(af!=AF_INET && af!=AF_INET6
+#ifdef PVXS_HAVE_UNIX_SOCKET
+            && af!=AF_UNIX
+#endif
+            ) {
         evutil_closesocket(sock);
         throw std::logic_error("Unsupported address family");
     }
@@ -693,6 +831,140 @@ bool evsocket::init_canIPv6() noexcept
     }
 }
 
+#ifdef PVXS_HAVE_UNIX_SOCKET
+
+UnixAddr::UnixAddr(const std::string& name)
+{
+    addr.sun_family = AF_UNIX;
+    bool abstract = !name.empty() && name[0]=='@';
+#ifndef __linux__
+    if(abstract)
+        throw std::invalid_argument(SB()<<"Abstract Unix sockets only supported on Linux: "<<name);
+#endif
+    if(name.empty() || name.size() > sizeof(addr.sun_path)-1u)
+        throw std::invalid_argument(SB()<<"Invalid Unix socket name: '"<<name<<"'");
+
+    memcpy(addr.sun_path, name.data(), name.size());
+    if(abstract) {
+        // not nil terminated.  Length of address is significant
+        addr.sun_path[0] = '\0';
+        len = socklen_t(offsetof(sockaddr_un, sun_path) + name.size());
+    } else {
+        len = socklen_t(sizeof(addr));
+    }
+}
+
+std::string unixSocketName(const std::string& prefix, const ServerGUID& guid)
+{
+    SB name;
+    name<<prefix<<'/';
+    for(auto b : guid) {
+        static const char hex[] = "0123456789abcdef";
+        name<<hex[b>>4u]<<hex[b&0xfu];
+    }
+    return name.str();
+}
+
+evsocket unixConnect(const std::string& name)
+{
+    UnixAddr addr(name);
+    evsocket sock(AF_UNIX, SOCK_STREAM, 0);
+    // completes, or fails, immediately.  Never EINPROGRESS.
+    if(connect(sock.sock, addr.sa(), addr.len)) {
+        auto err(evutil_socket_geterror(sock.sock));
+        log_debug_printf(logsock, "Unable to connect Unix socket %s : %s\n",
+                         name.c_str(), evutil_socket_error_to_string(err));
+        sock = evsocket();
+    }
+    return sock;
+}
+
+bool unixPeerUser(evutil_socket_t sock, std::string& user)
+{
+    uid_t uid;
+#if defined(SO_PEERCRED)
+    ucred cred{};
+    socklen_t len = sizeof(cred);
+    if(getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &cred, &len) || len!=sizeof(cred))
+        return false;
+    uid = cred.uid;
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+    gid_t gid;
+    if(getpeereid(sock, &uid, &gid))
+        return false;
+#else
+    (void)sock;
+    (void)user;
+    return false;
+#endif
+
+    std::vector<char> buf(1024u);
+    passwd pw{}, *result = nullptr;
+    while(getpwuid_r(uid, &pw, buf.data(), buf.size(), &result)==ERANGE && buf.size() < 0x10000u)
+        buf.resize(buf.size()*2u);
+
+    if(result)
+        user = result->pw_name;
+    else
+        user = SB()<<"uid:"<<uid; // no passwd entry
+    return true;
+}
+
+std::string unixPeerName(evutil_socket_t sock)
+{
+    SB name;
+    name<<"unix:";
+#if defined(SO_PEERCRED)
+    ucred cred{};
+    socklen_t len = sizeof(cred);
+    if(!getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &cred, &len) && len==sizeof(cred))
+        name<<cred.pid;
+#else
+    (void)sock;
+#endif
+    return name.str();
+}
+
+void unixRemoveStale(const std::string& prefix)
+{
+    if(prefix.empty() || prefix[0]=='@')
+        return; // abstract names vanish with their socket
+
+    std::unique_ptr<DIR, int(*)(DIR*)> dir(opendir(prefix.c_str()), &closedir);
+    if(!dir) {
+        log_debug_printf(logsock, "Unable to list %s : %d\n", prefix.c_str(), errno);
+        return;
+    }
+
+    const size_t nameLen = 2u*ServerGUID().size(); // cf. unixSocketName()
+    while(auto ent = readdir(dir.get())) {
+        std::string name(ent->d_name);
+        if(name.size()!=nameLen || name.find_first_not_of("0123456789abcdef")!=std::string::npos)
+            continue;
+
+        std::string path(SB()<<prefix<<'/'<<name);
+        struct stat info{};
+        if(lstat(path.c_str(), &info) || !S_ISSOCK(info.st_mode))
+            continue;
+
+        UnixAddr addr(path);
+        evsocket sock(AF_UNIX, SOCK_STREAM, 0);
+        if(!connect(sock.sock, addr.sa(), addr.len))
+            continue; // in use
+        auto err(evutil_socket_geterror(sock.sock));
+        if(err!=ECONNREFUSED)
+            continue; // eg. EAGAIN when listener is busy
+
+        if(unlink(path.c_str())) {
+            log_debug_printf(logsock, "Unable to remove stale %s : %d\n", path.c_str(), errno);
+        } else {
+            log_debug_printf(logsock, "Removed stale %s\n", path.c_str());
+        }
+    }
+}
+
+#endif // PVXS_HAVE_UNIX_SOCKET
+
 #if EPICS_VERSION_INT<VERSION_INT(7,0,3,1)
 #  define getMonotonic getCurrent
 #endif
@@ -985,8 +1257,40 @@ bool EvOutBuf::refill(size_t more)
     return true;
 }
 
+static
+void releaseArray(const void *, size_t, void *raw)
+{
+    delete static_cast<shared_array<const void>*>(raw);
+}
+
+bool EvOutBuf::reference(const shared_array<const void>& arr, const void* ptr, size_t nbytes)
+{
+    if(err || !refThreshold || nbytes < refThreshold)
+        return false;
+
+    refill(0); // commit preceding
+
+    std::unique_ptr<shared_array<const void>> hold(new shared_array<const void>(arr));
+    if(evbuffer_add_reference(backing, ptr, nbytes, &releaseArray, hold.get()))
+        throw BAD_ALLOC();
+    hold.release(); // releaseArray() now responsible
+    if(refCount)
+        *refCount += nbytes;
+    return true;
+}
+
+bool EvOutBuf::shmPlace(const void* ptr, size_t nbytes, uint64_t& offset)
+{
+    return !err && shmRing && shmRing->place(ptr, nbytes, offset);
+}
+
 EvInBuf::~EvInBuf() { refill(0); }
 
+std::shared_ptr<const void> EvInBuf::shmArray(uint64_t offset, size_t nbytes)
+{
+    return shmMap ? shmMap->array(offset, nbytes) : nullptr;
+}
+
 bool EvInBuf::refill(size_t needed)
 {
     if(err) return false;
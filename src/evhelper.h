@@ -25,6 +25,11 @@
 #include <event2/bufferevent_ssl.h>
 #endif
 
+#if !defined(_WIN32) && defined(AF_UNIX)
+#  include <sys/un.h>
+#  define PVXS_HAVE_UNIX_SOCKET
+#endif
+
 #include <epicsTime.h>
 #include <utilpvt.h>
 
@@ -117,6 +122,9 @@ struct DelayedDispatcher {
       , dispatch_when_condition(dispatch_when_condition){}
 };
 
+struct TimerWheel;
+struct WheelTimer;
+
 struct PVXS_API evbase {
     evbase() = default;
     explicit evbase(const std::string& name, unsigned prio=0);
@@ -166,6 +174,13 @@ public:
     //! @returns true if working is running.
     bool assertInRunningLoop() const;
 
+    //! Timer wheel of this loop.  cf. WheelTimer
+    TimerWheel& wheel() const;
+
+    //! Equivalent timeout for which libevent keeps a FIFO queue instead of its min-heap.
+    //! For a timeout shared by many events.  eg. with bufferevent_set_timeouts()
+    timeval commonTimeout(const timeval& tmo) const;
+
     inline void reset() { pvt.reset(); }
 
   private:
@@ -185,6 +200,85 @@ typedef ev_owned_ptr<evconnlistener> evlisten;
 typedef ev_owned_ptr<bufferevent> evbufferevent;
 typedef ev_owned_ptr<evbuffer> evbuf;
 
+/* Hashed timer wheel.  One per evbase, driven by a single libevent timer
+ * which only runs while some WheelTimer is pending.
+ *
+ * For coarse timeouts, of which there may be very many, which are frequently
+ * started or cancelled.  eg. per connection.  Where the libevent min-heap
+ * costs O(log n) for each, WheelTimer::start() and cancel() are O(1).
+ *
+ * Only access from the loop worker.
+ */
+struct PVXS_API TimerWheel {
+    //! Resolution of WheelTimer
+    static constexpr unsigned tickMS = 100u;
+    //! A timeout longer than nslots*tickMS waits for more than one revolution
+    static constexpr size_t nslots = 512u;
+
+    // intrusive doubly linked list
+    struct Link {
+        Link* prev;
+        Link* next;
+        Link() :prev(this), next(this) {}
+        Link(const Link&) = delete;
+        Link& operator=(const Link&) = delete;
+        bool linked() const { return next!=this; }
+        void unlink() {
+            prev->next = next;
+            next->prev = prev;
+            prev = next = this;
+        }
+        // insert at the tail of the list headed by 'head'
+        void link(Link& head) {
+            prev = head.prev;
+            next = &head;
+            head.prev->next = this;
+            head.prev = this;
+        }
+    };
+
+    explicit TimerWheel(event_base* base);
+    ~TimerWheel();
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    //! Number of pending WheelTimer
+    size_t size() const { return count; }
+
+private:
+    friend struct WheelTimer;
+    void place(WheelTimer& timer);
+    void onTick();
+    static void onTickS(evutil_socket_t, short, void *raw);
+
+    evevent tick;
+    std::unique_ptr<Link[]> slots;
+    size_t cursor = 0u;
+    size_t count = 0u;
+};
+
+//! Coarse timer driven by the TimerWheel of an evbase.  Only access from the loop worker.
+//! Must not outlive the evbase.
+struct PVXS_API WheelTimer : private TimerWheel::Link {
+    WheelTimer(const evbase& loop, std::function<void()>&& cb);
+    ~WheelTimer();
+
+    //! (Re)start to expire after delay (seconds), to within the resolution of TimerWheel.
+    //! If periodic, then again every delay until cancel()'d
+    void start(double delay, bool periodic=false);
+    //! @returns true if was pending
+    bool cancel();
+    inline bool pending() const { return linked(); }
+
+private:
+    friend struct TimerWheel;
+    TimerWheel& wheel;
+    const std::function<void()> cb;
+    size_t ticks = 0u;
+    size_t rounds = 0u; // remaining revolutions
+    bool periodic = false;
+};
+
 PVXS_API
 void to_wire(Buffer& buf, const SockAddr& val);
 
@@ -264,6 +358,41 @@ struct PVXS_API evsocket
     static ipstack_t ipstack;
 };
 
+#ifdef PVXS_HAVE_UNIX_SOCKET
+//! Unix domain socket address.  A leading '@' selects the Linux abstract namespace.
+struct PVXS_API UnixAddr {
+    sockaddr_un addr{};
+    socklen_t len = 0u;
+
+    explicit UnixAddr(const std::string& name);
+
+    const sockaddr* sa() const { return reinterpret_cast<const sockaddr*>(&addr); }
+};
+
+//! Name of the Unix socket through which the server with this GUID is reached.  cf. ConfigCommon::unixSocket
+PVXS_API
+std::string unixSocketName(const std::string& prefix, const ServerGUID& guid);
+
+//! Connect a Unix socket, which does not block.
+//! @returns The connected socket, or invalid if no server is listening.
+PVXS_API
+evsocket unixConnect(const std::string& name);
+
+//! Look up the name of the user owning the peer process of a connected Unix socket.
+//! @returns false if the platform, or the socket, does not provide peer credentials
+PVXS_API
+bool unixPeerUser(evutil_socket_t sock, std::string& user);
+
+//! Identity of the peer of a connected Unix socket.  "unix:" and the process ID, where known.
+PVXS_API
+std::string unixPeerName(evutil_socket_t sock);
+
+//! Remove sockets left under this prefix by servers which have exited without unlinking.
+//! Only names of the form given by unixSocketName(), with no listener.  No-op for the abstract namespace.
+PVXS_API
+void unixRemoveStale(const std::string& prefix);
+#endif // PVXS_HAVE_UNIX_SOCKET
+
 struct PVXS_API IfaceMap {
     static
     IfaceMap& instance();
@@ -330,7 +459,8 @@ struct Timer::Pvt {
 
     bool cancel();
 
-    static
+    // also used by pvxsIoc
+    PVXS_API static
     Timer buildOneShot(double delay, const evbase &base, std::function<void()>&& cb);
 
     INST_COUNTER(Timer);
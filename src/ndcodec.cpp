@@ -0,0 +1,440 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <pvxs/log.h>
+
+#include "ndcodec.h"
+#include "pvaproto.h"
+#include "utilpvt.h"
+
+#ifdef PVXS_ENABLE_LZ4
+#  include <lz4.h>
+#endif
+#ifdef PVXS_ENABLE_ZSTD
+#  include <zstd.h>
+#endif
+
+DEFINE_LOGGER(logcodec, "pvxs.ndcodec");
+
+namespace pvxs {
+namespace impl {
+
+namespace {
+
+// Members of the NTNDArray value union, indexed by pvData ScalarType (codec.parameters)
+const struct {
+    const char* member;
+    TypeCode code;
+} ndTypes[] = {
+    {"booleanValue", TypeCode::BoolA},
+    {"byteValue", TypeCode::Int8A},
+    {"shortValue", TypeCode::Int16A},
+    {"intValue", TypeCode::Int32A},
+    {"longValue", TypeCode::Int64A},
+    {"ubyteValue", TypeCode::UInt8A},
+    {"ushortValue", TypeCode::UInt16A},
+    {"uintValue", TypeCode::UInt32A},
+    {"ulongValue", TypeCode::UInt64A},
+    {"floatValue", TypeCode::Float32A},
+    {"doubleValue", TypeCode::Float64A},
+};
+constexpr size_t nNDTypes = sizeof(ndTypes)/sizeof(ndTypes[0]);
+
+// Refuse to allocate more for one decompressed array
+constexpr size_t maxDecompressed = 1u<<30u;
+// LZ4_MAX_INPUT_SIZE
+constexpr size_t maxLZ4Input = 0x7e000000u;
+// Favor speed over ratio
+constexpr int zstdLevel = 1;
+
+enum algo_t {
+    None,
+    LZ4,
+    BSLZ4,
+    Zstd,
+};
+
+algo_t algoOf(const std::string& name)
+{
+#ifdef PVXS_ENABLE_LZ4
+    if(name=="lz4")
+        return LZ4;
+    if(name=="bslz4")
+        return BSLZ4;
+#endif
+#ifdef PVXS_ENABLE_ZSTD
+    if(name=="zstd")
+        return Zstd;
+#endif
+    (void)name;
+    return None;
+}
+
+// reverse the byte order of each element
+void swapElements(uint8_t* buf, size_t nelem, size_t esize)
+{
+    for(size_t i=0u; i<nelem; i++, buf+=esize)
+        std::reverse(buf, buf+esize);
+}
+
+#ifdef PVXS_ENABLE_LZ4
+
+/* Bitshuffle, as in the bitshuffle library (bshuf_compress_lz4()) used by areaDetector.
+ *
+ * Elements are processed in blocks of ~8KB.  Each block is shuffled so that bit N of byte M
+ * of every element are grouped together, then compressed with LZ4 and stored as
+ * its compressed length (uint32_t big endian) followed by the compressed bytes.
+ * Any trailing (count%8) elements are appended unchanged.
+ */
+
+size_t bshufBlockSize(size_t esize)
+{
+    size_t bs = 8192u/esize/8u*8u;
+    return std::max(bs, size_t(128u));
+}
+
+// transpose 8x8 bit matrix.  bit N of byte M <-> bit M of byte N
+inline
+uint64_t transBit8x8(uint64_t x)
+{
+    uint64_t t;
+    t = (x ^ (x >> 7u)) & 0x00AA00AA00AA00AAull;
+    x = x ^ t ^ (t << 7u);
+    t = (x ^ (x >> 14u)) & 0x0000CCCC0000CCCCull;
+    x = x ^ t ^ (t << 14u);
+    t = (x ^ (x >> 28u)) & 0x00000000F0F0F0F0ull;
+    x = x ^ t ^ (t << 28u);
+    return x;
+}
+
+// @pre nelem%8==0
+void bitshuffle(const uint8_t* in, uint8_t* out, size_t nelem, size_t esize)
+{
+    const size_t ngroup = nelem/8u;
+    for(size_t j=0u; j<esize; j++) {
+        for(size_t g=0u; g<ngroup; g++) {
+            uint64_t x = 0u;
+            for(unsigned m=0u; m<8u; m++)
+                x |= uint64_t(in[(g*8u + m)*esize + j]) << (8u*m);
+            x = transBit8x8(x);
+            for(unsigned k=0u; k<8u; k++)
+                out[(j*8u + k)*ngroup + g] = uint8_t(x >> (8u*k));
+        }
+    }
+}
+
+// @pre nelem%8==0
+void bitunshuffle(const uint8_t* in, uint8_t* out, size_t nelem, size_t esize)
+{
+    const size_t ngroup = nelem/8u;
+    for(size_t j=0u; j<esize; j++) {
+        for(size_t g=0u; g<ngroup; g++) {
+            uint64_t x = 0u;
+            for(unsigned k=0u; k<8u; k++)
+                x |= uint64_t(in[(j*8u + k)*ngroup + g]) << (8u*k);
+            x = transBit8x8(x);
+            for(unsigned m=0u; m<8u; m++)
+                out[(g*8u + m)*esize + j] = uint8_t(x >> (8u*m));
+        }
+    }
+}
+
+size_t bslz4Bound(size_t nelem, size_t esize)
+{
+    const size_t bs = bshufBlockSize(esize);
+    size_t ret = (nelem/bs) * (4u + LZ4_compressBound(int(bs*esize)));
+    size_t last = nelem%bs;
+    last -= last%8u;
+    if(last)
+        ret += 4u + LZ4_compressBound(int(last*esize));
+    return ret + (nelem%8u)*esize;
+}
+
+// @returns compressed length, or zero on failure
+size_t bslz4Compress(const uint8_t* src, size_t nelem, size_t esize, uint8_t* dst, size_t dlen)
+{
+    const size_t bs = bshufBlockSize(esize);
+    std::vector<uint8_t> shuf(bs*esize);
+    size_t pos = 0u;
+    size_t i = 0u;
+
+    for(; nelem-i >= 8u; ) {
+        size_t cnt = std::min(bs, nelem-i);
+        cnt -= cnt%8u;
+
+        bitshuffle(src + i*esize, shuf.data(), cnt, esize);
+
+        if(dlen-pos < 4u)
+            return 0u;
+        auto ret = LZ4_compress_default((const char*)shuf.data(), (char*)dst+pos+4u, int(cnt*esize), int(dlen-pos-4u));
+        if(ret<=0)
+            return 0u;
+
+        FixedBuf L(true, dst+pos, 4u);
+        to_wire(L, uint32_t(ret));
+        pos += 4u + size_t(ret);
+        i += cnt;
+    }
+
+    const size_t rem = (nelem-i)*esize;
+    if(dlen-pos < rem)
+        return 0u;
+    memcpy(dst+pos, src + i*esize, rem);
+    return pos + rem;
+}
+
+bool bslz4Decompress(const uint8_t* src, size_t slen, uint8_t* dst, size_t nelem, size_t esize)
+{
+    const size_t bs = bshufBlockSize(esize);
+    std::vector<uint8_t> shuf(bs*esize);
+    size_t pos = 0u;
+    size_t i = 0u;
+
+    for(; nelem-i >= 8u; ) {
+        size_t cnt = std::min(bs, nelem-i);
+        cnt -= cnt%8u;
+
+        uint32_t clen = 0u;
+        if(slen-pos < 4u)
+            return false;
+        {
+            FixedBuf L(true, const_cast<uint8_t*>(src+pos), 4u);
+            from_wire(L, clen);
+        }
+        pos += 4u;
+        if(slen-pos < clen)
+            return false;
+
+        auto ret = LZ4_decompress_safe((const char*)src+pos, (char*)shuf.data(), int(clen), int(cnt*esize));
+        if(ret<0 || size_t(ret)!=cnt*esize)
+            return false;
+
+        bitunshuffle(shuf.data(), dst + i*esize, cnt, esize);
+        pos += clen;
+        i += cnt;
+    }
+
+    const size_t rem = (nelem-i)*esize;
+    if(slen-pos != rem)
+        return false;
+    memcpy(dst + i*esize, src+pos, rem);
+    return true;
+}
+
+#endif // PVXS_ENABLE_LZ4
+
+/* Sent uncompressed, although a codec was requested.  Clear, and mark, codec.name
+ * so that a client does not apply it from a previous compressed update.
+ */
+Value sendPlain(const Value& update, size_t nbytes)
+{
+    auto ret(update.clone());
+    ret["codec.name"] = "";
+    if(nbytes) {
+        ret["uncompressedSize"] = int64_t(nbytes);
+        if(auto csize = ret["compressedSize"])
+            csize = int64_t(nbytes);
+    }
+    return ret;
+}
+
+} // namespace
+
+bool ndCodecSupported(const std::string& codec)
+{
+    return algoOf(codec)!=None;
+}
+
+Value ndCodecEncode(const Value& update, const std::string& codec)
+{
+    auto algo = algoOf(codec);
+    auto value(update["value"]);
+    auto cname(update["codec.name"]);
+    if(algo==None || value.type()!=TypeCode::Union || !value.isMarked()
+            || cname.type()!=TypeCode::String || !cname.as<std::string>().empty()
+            || !update["uncompressedSize"])
+        return update;
+
+    auto arr(value.as<Value>());
+    size_t stype = 0u;
+    for(; stype<nNDTypes; stype++) {
+        if(arr.type()==ndTypes[stype].code)
+            break;
+    }
+    if(stype==nNDTypes)
+        return sendPlain(update, 0u);
+
+    auto src(arr.as<shared_array<const void>>());
+    const size_t esize = elementSize(src.original_type());
+    const size_t nbytes = src.size()*esize;
+    if(!nbytes || nbytes > maxDecompressed)
+        return sendPlain(update, nbytes);
+
+    auto in = static_cast<const uint8_t*>(src.data());
+    std::vector<uint8_t> swapped;
+    if(hostBE && esize>1u) {
+        swapped.assign(in, in+nbytes);
+        swapElements(swapped.data(), src.size(), esize);
+        in = swapped.data();
+    }
+
+    size_t bound = 0u;
+    switch(algo) {
+#ifdef PVXS_ENABLE_LZ4
+    case LZ4: bound = LZ4_compressBound(int(std::min(nbytes, maxLZ4Input))); break;
+    case BSLZ4: bound = bslz4Bound(src.size(), esize); break;
+#endif
+#ifdef PVXS_ENABLE_ZSTD
+    case Zstd: bound = ZSTD_compressBound(nbytes); break;
+#endif
+    default: return sendPlain(update, nbytes);
+    }
+
+    shared_array<uint8_t> out(bound);
+    size_t clen = 0u;
+
+    switch(algo) {
+#ifdef PVXS_ENABLE_LZ4
+    case LZ4:
+        if(nbytes <= maxLZ4Input) {
+            auto ret = LZ4_compress_default((const char*)in, (char*)out.data(), int(nbytes), int(bound));
+            clen = ret>0 ? size_t(ret) : 0u;
+        }
+        break;
+    case BSLZ4:
+        clen = bslz4Compress(in, src.size(), esize, out.data(), bound);
+        break;
+#endif
+#ifdef PVXS_ENABLE_ZSTD
+    case Zstd: {
+        auto ret = ZSTD_compress(out.data(), bound, in, nbytes, zstdLevel);
+        clen = ZSTD_isError(ret) ? 0u : ret;
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+
+    if(!clen || clen >= nbytes) {
+        log_debug_printf(logcodec, "%s does not reduce %zu bytes\n", codec.c_str(), nbytes);
+        return sendPlain(update, nbytes);
+    }
+    out.resize(clen);
+
+    auto ret(update.clone());
+    ret["value->ubyteValue"] = out.freeze();
+    ret["codec.name"] = codec;
+    ret["codec.parameters"] = int32_t(stype);
+    ret["uncompressedSize"] = int64_t(nbytes);
+    if(auto csize = ret["compressedSize"])
+        csize = int64_t(clen);
+    return ret;
+}
+
+bool ndCodecDecode(Value& update)
+{
+    auto cname(update["codec.name"]);
+    auto value(update["value"]);
+    if(cname.type()!=TypeCode::String || value.type()!=TypeCode::Union)
+        return false;
+
+    auto codec(cname.as<std::string>());
+    if(codec.empty())
+        return false;
+
+    auto algo = algoOf(codec);
+    if(algo==None) {
+        log_debug_printf(logcodec, "Unsupported codec '%s'\n", codec.c_str());
+        return false;
+    }
+
+    auto arr(value.as<Value>());
+    int32_t stype = -1;
+    int64_t nbytes = -1;
+    auto params(update["codec.parameters"]);
+    auto usize(update["uncompressedSize"]);
+    if(arr.type()!=TypeCode::UInt8A || !params.as(stype) || !usize.as(nbytes)
+            || stype<0 || size_t(stype)>=nNDTypes || nbytes<0 || size_t(nbytes)>maxDecompressed)
+    {
+        log_err_printf(logcodec, "Invalid %s compressed array\n", codec.c_str());
+        return false;
+    }
+
+    auto src(arr.as<shared_array<const uint8_t>>());
+    auto atype(ndTypes[stype].code.arrayType());
+    const size_t esize = elementSize(atype);
+    if(size_t(nbytes)%esize) {
+        log_err_printf(logcodec, "Invalid %s compressed array size %lld\n", codec.c_str(), (long long)nbytes);
+        return false;
+    }
+
+    const size_t nelem = size_t(nbytes)/esize;
+    auto out(allocArray(atype, nelem));
+    auto dst = static_cast<uint8_t*>(out.data());
+    bool ok = false;
+
+    switch(algo) {
+#ifdef PVXS_ENABLE_LZ4
+    case LZ4:
+        if(src.size() <= maxLZ4Input) {
+            auto ret = LZ4_decompress_safe((const char*)src.data(), (char*)dst, int(src.size()), int(nbytes));
+            ok = ret>=0 && ret==nbytes;
+        }
+        break;
+    case BSLZ4:
+        ok = bslz4Decompress(src.data(), src.size(), dst, nelem, esize);
+        break;
+#endif
+#ifdef PVXS_ENABLE_ZSTD
+    case Zstd: {
+        auto ret = ZSTD_decompress(dst, size_t(nbytes), src.data(), src.size());
+        ok = !ZSTD_isError(ret) && ret==size_t(nbytes);
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+
+    if(!ok) {
+        log_err_printf(logcodec, "Invalid %s compressed array\n", codec.c_str());
+        return false;
+    }
+
+    if(hostBE && esize>1u)
+        swapElements(dst, nelem, esize);
+
+    // replace without changing which fields are marked
+    auto csize(update["compressedSize"]);
+    const bool valueMarked = value.isMarked(false);
+    const bool nameMarked = cname.isMarked(false);
+    const bool paramsMarked = params.isMarked(false);
+    const bool csizeMarked = csize.isMarked(false);
+
+    update[std::string("value->") + ndTypes[stype].member] = out.freeze();
+    cname = "";
+    params = 0;
+    if(csize)
+        csize = nbytes;
+
+    if(!valueMarked)
+        update["value"].unmark();
+    if(!nameMarked)
+        cname.unmark();
+    if(!paramsMarked)
+        params.unmark();
+    if(!csizeMarked)
+        csize.unmark();
+
+    return true;
+}
+
+}} // namespace pvxs::impl
@@ -0,0 +1,50 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef NDCODEC_H
+#define NDCODEC_H
+
+#include <string>
+
+#include <pvxs/data.h>
+
+namespace pvxs {
+namespace impl {
+
+/* Compression of the value array of NTNDArray updates, using the codec sub-structure
+ * in the manner of the areaDetector NDPluginCodec.
+ *
+ * A compressed array is sent as "value->ubyteValue" with "codec.name" naming the algorithm
+ * ("lz4", "bslz4", or "zstd"), "codec.parameters" holding the pvData ScalarType
+ * of the original array (eg. 6 for uint16_t), and "uncompressedSize" its length in bytes.
+ * Elements are compressed in little endian byte order.
+ * An update sent uncompressed, although a codec was requested, has "codec.name" marked and empty.
+ */
+
+//! Is this codec name implemented by this build?
+PVXS_API
+bool ndCodecSupported(const std::string& codec);
+
+/** Compress the value array of one NTNDArray update.
+ *
+ * @returns A copy of update with "value" replaced by its compressed form,
+ *          or update itself if it is not an NTNDArray with a marked and uncompressed value.
+ *          If compression would not save space, a copy with "codec.name" marked and empty.
+ */
+PVXS_API
+Value ndCodecEncode(const Value& update, const std::string& codec);
+
+/** Decompress, in place, an update compressed by a supported codec.
+ *
+ * Marks are preserved.  Invalid compressed data is logged, and left as is.
+ *
+ * @returns true if update was decompressed.
+ */
+PVXS_API
+bool ndCodecDecode(Value& update);
+
+}} // namespace pvxs::impl
+
+#endif // NDCODEC_H
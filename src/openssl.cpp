@@ -10,14 +10,17 @@
 #include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <limits>
 #include <stdexcept>
 #include <tuple>
 
 #include <epicsExit.h>
 
 #include <openssl/conf.h>
+#include <openssl/core_names.h>
 #include <openssl/err.h>
 #include <openssl/pkcs12.h>
+#include <openssl/rand.h>
 
 #include <pvxs/log.h>
 #include <pvxs/sslinit.h>
@@ -121,10 +124,22 @@ void SSLContext::setTlsOrTcpMode() {
 SSLContext::SSLContext(const impl::evbase loop) : loop(loop) {}
 
 SSLContext::SSLContext(const SSLContext &o)
-    : loop(o.loop), ctx(o.ctx), state(o.state), status_check_disabled(o.status_check_disabled), stapling_disabled(o.stapling_disabled) {}
+    : loop(o.loop),
+      ctx(o.ctx),
+      state(o.state),
+      status_check_disabled(o.status_check_disabled),
+      stapling_disabled(o.stapling_disabled),
+      session_resumption_disabled(o.session_resumption_disabled),
+      kernel_offload(o.kernel_offload) {}
 
 SSLContext::SSLContext(SSLContext &o) noexcept
-    : loop(o.loop), ctx(o.ctx), state(o.state), status_check_disabled(o.status_check_disabled), stapling_disabled(o.stapling_disabled) {}
+    : loop(o.loop),
+      ctx(o.ctx),
+      state(o.state),
+      status_check_disabled(o.status_check_disabled),
+      stapling_disabled(o.stapling_disabled),
+      session_resumption_disabled(o.session_resumption_disabled),
+      kernel_offload(o.kernel_offload) {}
 
 void SSLContext::setStatusValidityCountdown() {
     auto now = time(nullptr);
@@ -165,6 +180,7 @@ const unsigned char pva_alpn[] = "\x05pva/1";
 struct OSSLGbl {
     ossl_ptr<OSSL_LIB_CTX> libctx;
     int SSL_CTX_ex_idx;
+    int SSL_ex_idx;
 #ifdef PVXS_ENABLE_SSLKEYLOGFILE
     std::ofstream keylog;
     epicsMutex keylock;
@@ -212,12 +228,18 @@ void free_SSL_CTX_sidecar(void *, void *ptr, CRYPTO_EX_DATA *, int, long, void *
     delete car;
 }
 
+void free_SSL_sidecar(void *, void *ptr, CRYPTO_EX_DATA *, int, long, void *) noexcept {
+    auto car = static_cast<SSLSessionPeer *>(ptr);
+    delete car;
+}
+
 void OSSLGbl_init() {
     ossl_ptr<OSSL_LIB_CTX> ctx(__FILE__, __LINE__, OSSL_LIB_CTX_new());
     // read $OPENSSL_CONF or eg. /usr/lib/ssl/openssl.cnf
     (void)CONF_modules_load_file_ex(ctx.get(), NULL, "pvxs", CONF_MFLAGS_IGNORE_MISSING_FILE | CONF_MFLAGS_IGNORE_RETURN_CODES);
     std::unique_ptr<OSSLGbl> gbl{new OSSLGbl};
     gbl->SSL_CTX_ex_idx = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, free_SSL_CTX_sidecar);
+    gbl->SSL_ex_idx = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, free_SSL_sidecar);
 #ifdef PVXS_ENABLE_SSLKEYLOGFILE
     if (auto env = getenv("SSLKEYLOGFILE")) {
         epicsGuard<epicsMutex> G(gbl->keylock);
@@ -246,6 +268,88 @@ int ossl_alpn_select(SSL *, const unsigned char **out, unsigned char *outlen, co
     }
 }
 
+/**
+ * @brief Server side session ticket key callback.  Delegates to the SSLSessionResumption of the SSL_CTX
+ */
+int ossl_ticket_key(SSL *ssl, unsigned char key_name[16], unsigned char *iv, EVP_CIPHER_CTX *cipher_ctx, EVP_MAC_CTX *mac_ctx, int enc) {
+    auto ex_data = CertStatusExData::fromSSL(ssl);
+    if (!ex_data) return -1;
+    return ex_data->resumption.ticketKey(key_name, iv, cipher_ctx, mac_ctx, enc);
+}
+
+/**
+ * @brief Client side new session callback.  Stores resumable sessions for the server they came from
+ *
+ * A session is stored until the earliest of its own expiry, the expiry of the server's certificate,
+ * and, if the server's status is being checked, the end of validity of its stapled status.
+ *
+ * A copy is stored because OpenSSL marks the session of a connection that is not shut down cleanly,
+ * eg. when the server goes away, as not resumable.
+ *
+ * @return always 0.  We never keep a reference to the given session
+ */
+int ossl_new_session(SSL *ssl, SSL_SESSION *session) {
+    auto ex_data = CertStatusExData::fromSSL(ssl);
+    auto peer = static_cast<const SSLSessionPeer *>(SSL_get_ex_data(ssl, ossl_gbl->SSL_ex_idx));
+    if (!ex_data || !peer || !SSL_SESSION_is_resumable(session)) return 0;
+
+    auto resumable_until = static_cast<time_t>(SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session));
+    if (const auto peer_cert = SSL_SESSION_get0_peer(session)) {
+        const auto not_after = certs::CertDate::asn1TimeToTimeT(X509_get0_notAfter(peer_cert));
+        if (not_after < resumable_until) resumable_until = not_after;
+    }
+
+    if (peer->require_good_status) {
+        // Only resume while the status stapled in the full handshake remains good
+        if (!peer->status_good_until) {
+            log_debug_printf(io, "Not storing TLS session for %s: no good stapled status\n", peer->peer_name.c_str());
+            return 0;
+        }
+        if (peer->status_good_until < resumable_until) resumable_until = peer->status_good_until;
+    }
+
+    const auto copy = SSL_SESSION_dup(session);
+    if (!copy) return 0;
+    if (ex_data->resumption.storeSession(peer->peer_name, ossl_shared_ptr<SSL_SESSION>(copy), resumable_until))
+        log_debug_printf(io, "Stored TLS session for %s until %s\n", peer->peer_name.c_str(), certs::CertDate(resumable_until).s.c_str());
+    return 0;
+}
+
+/**
+ * @brief Rebuild the verified chain of the peer certificate of a resumed session
+ *
+ * The verified chain is not retained across session resumption, so rebuild it from the trusted store,
+ * the peer's chain (if retained) and our own chain certificates.
+ *
+ * @param ssl the resumed connection
+ * @param cert the peer certificate
+ * @return a verification context holding the rebuilt chain, or nullptr if the chain can't be built
+ */
+ossl_ptr<X509_STORE_CTX> rebuildVerifiedChain(const SSL *ssl, X509 *cert) {
+    const auto ssl_ctx = SSL_get_SSL_CTX(ssl);
+    ossl_ptr<STACK_OF(X509)> untrusted(sk_X509_new_null(), false);
+    if (!untrusted) return {};
+    if (const auto peer_chain = SSL_get_peer_cert_chain(ssl)) {
+        for (int i = 0, N = sk_X509_num(peer_chain); i < N; i++) sk_X509_push(untrusted.get(), sk_X509_value(peer_chain, i));
+    }
+    STACK_OF(X509) *own_chain = nullptr;
+    if (SSL_CTX_get0_chain_certs(ssl_ctx, &own_chain) && own_chain) {
+        for (int i = 0, N = sk_X509_num(own_chain); i < N; i++) sk_X509_push(untrusted.get(), sk_X509_value(own_chain, i));
+    }
+
+    ossl_ptr<X509_STORE_CTX> store_ctx(X509_STORE_CTX_new(), false);
+    if (!store_ctx || !X509_STORE_CTX_init(store_ctx.get(), SSL_CTX_get_cert_store(ssl_ctx), cert, untrusted.get())) return {};
+    X509_STORE_CTX_set_depth(store_ctx.get(), ossl_verify_depth);
+    const auto ok = X509_verify_cert(store_ctx.get()) > 0;
+    // untrusted certs are only referenced during verification, the resulting chain holds its own references
+    X509_STORE_CTX_set0_untrusted(store_ctx.get(), nullptr);
+    if (!ok) {
+        log_debug_printf(io, "Unable to rebuild peer chain of resumed session: %s\n", X509_verify_cert_error_string(X509_STORE_CTX_get_error(store_ctx.get())));
+        return {};
+    }
+    return store_ctx;
+}
+
 /**
  * @brief Verifies the key usage of a given certificate.
  *
@@ -375,6 +479,38 @@ std::shared_ptr<SSLContext> commonSetup(const SSL_METHOD *method, const bool is_
     (void)SSL_CTX_set_min_proto_version(tls_context->ctx.get(), TLS1_3_VERSION);
     (void)SSL_CTX_set_max_proto_version(tls_context->ctx.get(), 0);
 
+    // Configure TLS session resumption:
+    //  - servers issue stateless tickets, encrypted with rotating keys, and keep no session cache
+    //  - clients store sessions themselves, per server, in the new session callback
+    tls_context->session_resumption_disabled = conf.tls_disable_session_resumption;
+    if (tls_context->session_resumption_disabled) {
+        (void)SSL_CTX_set_session_cache_mode(tls_context->ctx.get(), SSL_SESS_CACHE_OFF);
+        (void)SSL_CTX_set_options(tls_context->ctx.get(), SSL_OP_NO_TICKET);
+        (void)SSL_CTX_set_num_tickets(tls_context->ctx.get(), 0);
+    } else if (is_for_client) {
+        (void)SSL_CTX_set_session_cache_mode(tls_context->ctx.get(), SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(tls_context->ctx.get(), &ossl_new_session);
+    } else {
+        // Resumed sessions must have been established by this same application protocol
+        if (!SSL_CTX_set_session_id_context(tls_context->ctx.get(), pva_alpn + 1, sizeof(pva_alpn) - 2u)) throw SSLError("SSL_CTX_set_session_id_context");
+        (void)SSL_CTX_set_session_cache_mode(tls_context->ctx.get(), SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+        (void)SSL_CTX_set_num_tickets(tls_context->ctx.get(), 1);
+        // Tickets must not outlive the key they are encrypted with
+        (void)SSL_CTX_set_timeout(tls_context->ctx.get(), SSLSessionResumption::kTicketKeyLifetimeSecs);
+        if (!SSL_CTX_set_tlsext_ticket_key_evp_cb(tls_context->ctx.get(), &ossl_ticket_key)) throw SSLError("SSL_CTX_set_tlsext_ticket_key_evp_cb");
+    }
+
+    // Hand negotiated sessions to the kernel.  eg. on Linux, OpenSSL sets TCP_ULP "tls" and
+    // installs the traffic keys on the socket after the handshake, if the cipher is supported.
+    if (conf.tls_kernel_offload) {
+#ifdef PVXS_HAVE_KTLS
+        (void)SSL_CTX_set_options(tls_context->ctx.get(), SSL_OP_ENABLE_KTLS);
+        tls_context->kernel_offload = true;
+#else
+        log_warn_printf(setup, "TLS kernel offload not supported by this build%s\n", "");
+#endif
+    }
+
     // If TLS is disabled or not configured then set the context to degraded mode so that
     // only TCP connections are allowed.
     if (conf.tls_disabled || !conf.isTlsConfigured()) {
@@ -540,46 +676,37 @@ SSLPeerStatusAndMonitor::~SSLPeerStatusAndMonitor() {
  * @brief Sets the peer status for the given peer certificate
  * @param peer_cert_ptr - Peer certificate pointer
  * @param new_status - Certificate status
- * @fn function to be configured to be called for updates
+ * @param stapled_response_ptr - optional raw stapled OCSP response that the status was verified from
+ * @param stapled_response_len - its length
  * @return The peer status that was set
  */
 std::shared_ptr<SSLPeerStatusAndMonitor> CertStatusExData::setPeerStatus(X509 *peer_cert_ptr, const certs::CertificateStatus &new_status,
-                                                                         std::function<void(bool)> fn) {
+                                                                         const uint8_t *stapled_response_ptr, size_t stapled_response_len) {
     const auto serial_number = getSerialNumber(peer_cert_ptr);
-    std::shared_ptr<SSLPeerStatusAndMonitor> peer_status_and_monitor;
-    try {
-        if (status_check_enabled && fn) {
-            const auto status_pv = certs::CertStatusManager::getStatusPvFromCert(peer_cert_ptr);
-            peer_status_and_monitor = getOrCreatePeerStatus(serial_number, status_pv, fn);
-        } else {
-            peer_status_and_monitor = getOrCreatePeerStatus(serial_number);
-        }
-    } catch (certs::CertStatusNoExtensionException &e) {
-        peer_status_and_monitor = getOrCreatePeerStatus(serial_number);
-    }
-
-    peer_status_and_monitor->updateStatus(new_status);
+    auto peer_status_and_monitor = getOrCreatePeerStatus(serial_number);
+    peer_status_and_monitor->updateStatus(new_status, stapled_response_ptr, stapled_response_len);
     return peer_status_and_monitor;
 }
 
-std::shared_ptr<SSLPeerStatusAndMonitor> CertStatusExData::getOrCreatePeerStatus(const serial_number_t serial_number, const std::string &status_pv,
-                                                                                 std::function<void(bool)> fn) {
+std::shared_ptr<SSLPeerStatusAndMonitor> CertStatusExData::getOrCreatePeerStatus(const serial_number_t serial_number, const std::string &status_pv) {
     // Create holder for peer status or return current holder if already exists
-    auto peer_status = createPeerStatus(serial_number, fn);
+    auto peer_status = createPeerStatus(serial_number);
 
-    // Subscribe if we have a function and we're not already subscribed
-    if (fn && status_check_enabled && !peer_status->isSubscribed()) {
-        // Subscribe to certificate status updates
-        std::weak_ptr<SSLPeerStatusAndMonitor> weak_peer_status = peer_status;
+    // Subscribe if we have a status PV and no other connection has already subscribed for this certificate
+    if (!status_pv.empty() && status_check_enabled) {
         Guard G(peer_status->lock);
-        peer_status->cert_status_manager =
-            certs::CertStatusManager::subscribe(trusted_store_ptr, status_pv, [weak_peer_status](const certs::PVACertificateStatus &status) {
-                const auto peer_status_update = weak_peer_status.lock();
-                if (!status.isGood())
-                    log_warn_printf(watcher, "Peer certificate not valid: %s\n", CERT_STATE(status.status.i));
-                // Update the cached state
-                if (peer_status_update) peer_status_update->updateStatus((const certs::CertificateStatus)status);
-            });
+        if (!peer_status->isSubscribed()) {
+            // Subscribe to certificate status updates
+            std::weak_ptr<SSLPeerStatusAndMonitor> weak_peer_status = peer_status;
+            peer_status->cert_status_manager =
+                certs::CertStatusManager::subscribe(trusted_store_ptr, status_pv, [weak_peer_status](const certs::PVACertificateStatus &status) {
+                    const auto peer_status_update = weak_peer_status.lock();
+                    if (!status.isGood())
+                        log_warn_printf(watcher, "Peer certificate not valid: %s\n", CERT_STATE(status.status.i));
+                    // Update the cached state
+                    if (peer_status_update) peer_status_update->updateStatus((const certs::CertificateStatus)status);
+                });
+        }
     }
     return peer_status;
 }
@@ -587,52 +714,126 @@ std::shared_ptr<SSLPeerStatusAndMonitor> CertStatusExData::getOrCreatePeerStatus
 /**
  * @brief Create a peer status in the list of statuses or return existing one
  * @param serial_number the serial number to index into the list
- * @param fn optional function that will be called as status changes if provided
  * @return the existing or new peer status
  */
-std::shared_ptr<SSLPeerStatusAndMonitor> CertStatusExData::createPeerStatus(serial_number_t serial_number, const std::function<void(bool)> fn) {
+std::shared_ptr<SSLPeerStatusAndMonitor> CertStatusExData::createPeerStatus(serial_number_t serial_number) {
+    Guard G(lock);
     auto existing_peer_status_entry = peer_statuses.find(serial_number);
-    if (existing_peer_status_entry != peer_statuses.end()) return existing_peer_status_entry->second.lock();
+    if (existing_peer_status_entry != peer_statuses.end()) {
+        if (auto existing_peer_status = existing_peer_status_entry->second.lock()) return existing_peer_status;
+        // Last connection has gone but its peer status is not yet removed
+        peer_statuses.erase(existing_peer_status_entry);
+    }
 
-    std::shared_ptr<SSLPeerStatusAndMonitor> new_peer_status;
-    if (fn) {
-        auto validity_timer = impl::evevent(__FILE__, __LINE__, event_new(loop.base, -1, EV_TIMEOUT, peersStatusValidityExpirationHandler, this));
-        new_peer_status = std::make_shared<SSLPeerStatusAndMonitor>(serial_number, this, std::move(validity_timer), fn);
-    } else {
-        new_peer_status = std::make_shared<SSLPeerStatusAndMonitor>(serial_number, this, nullptr, nullptr);
+    auto new_peer_status = std::make_shared<SSLPeerStatusAndMonitor>(serial_number, this);
+    if (status_check_enabled && loop.base) {
+        new_peer_status->validity_timer =
+            impl::evevent(__FILE__, __LINE__, event_new(loop.base, -1, EV_TIMEOUT, peersStatusValidityExpirationHandler, new_peer_status.get()));
     }
     peer_statuses.emplace(serial_number, new_peer_status);
     return new_peer_status;
 };
 
 /**
- * @brief Update the status with the given value and call the callback if supplied and restart the status validity timer
+ * @brief Update the status with the given value, call the subscribers if changed and restart the status validity timer
  * @param new_status the new status to set
+ * @param stapled_response_ptr optional raw stapled OCSP response that the new status was verified from
+ * @param stapled_response_len its length
  */
-void SSLPeerStatusAndMonitor::updateStatus(const certs::CertificateStatus &new_status) {
-    // Update the status
+void SSLPeerStatusAndMonitor::updateStatus(const certs::CertificateStatus &new_status, const uint8_t *stapled_response_ptr, size_t stapled_response_len) {
+    bool was_good, is_good;
+    {
+        // Update the status
+        Guard G(lock);
+        was_good = status.isOstensiblyGood();
+        status = new_status;
+        if (stapled_response_ptr)
+            stapled_response.assign(reinterpret_cast<const char *>(stapled_response_ptr), stapled_response_len);
+        else
+            stapled_response.clear();
+        is_good = status.isGood();
+
+        if (!subscribers.empty() && status.isValid() && !status.isPermanent()) {
+            // Start validity timer
+            restartPeerStatusValidityCountdown();
+        }
+    }
+
+    // Call the subscribers if there has been any state change
+    if (is_good != was_good) notify(is_good);
+}
+
+bool SSLPeerStatusAndMonitor::getStapledStatus(const uint8_t *stapled_response_ptr, size_t stapled_response_len, certs::CertificateStatus &cached_status) {
     Guard G(lock);
-    const auto was_good = status.isOstensiblyGood();
-    status = new_status;
+    if (!stapled_response_ptr || stapled_response.size() != stapled_response_len ||
+        stapled_response.compare(0, std::string::npos, reinterpret_cast<const char *>(stapled_response_ptr), stapled_response_len) != 0)
+        return false;
+    if (!status.isValid()) return false;
+    cached_status = status;
+    return true;
+}
 
-    // Call the callback if there has been any state change
-    bool is_good = status.isGood();
-    if (fn && is_good != was_good) {
-        fn(is_good);
+size_t SSLPeerStatusAndMonitor::addSubscriber(const std::function<void(bool)> &fn) {
+    Guard G(lock);
+    auto id = next_subscriber_id++;
+    if (fn) {
+        subscribers.emplace(id, fn);
+        if (subscribers.size() == 1u && status.isValid() && !status.isPermanent()) restartPeerStatusValidityCountdown();
     }
+    return id;
+}
+
+void SSLPeerStatusAndMonitor::removeSubscriber(size_t id) {
+    Guard G(lock);
+    subscribers.erase(id);
+}
 
-    if (fn && status.isValid() && !status.isPermanent()) {
-        // Start validity timer
-        restartPeerStatusValidityCountdown();
+void SSLPeerStatusAndMonitor::notify(bool is_good) {
+    // Copy so that subscribers may unsubscribe while being called
+    std::vector<std::function<void(bool)>> to_notify;
+    {
+        Guard G(lock);
+        to_notify.reserve(subscribers.size());
+        for (auto &subscriber : subscribers) to_notify.push_back(subscriber.second);
     }
+    log_debug_printf(watcher, "Peer certificate %llu status now %s: notifying %zu connection(s)\n", (unsigned long long)serial_number,
+                     is_good ? "good" : "not good", to_notify.size());
+    for (auto &fn : to_notify) fn(is_good);
 }
 
-std::shared_ptr<SSLPeerStatusAndMonitor> CertStatusExData::subscribeToPeerCertStatus(X509 *cert_ptr, std::function<void(bool)> fn) noexcept {
+std::shared_ptr<SSLPeerStatusSubscription> CertStatusExData::subscribeToPeerCertStatus(X509 *cert_ptr, const std::function<void(bool)> &fn) {
     assert(cert_ptr && "Peer Cert NULL");
     auto serial_number = getSerialNumber(cert_ptr);
     assert(serial_number && "Peer Cert has no serial number");
 
-    return setPeerStatus(cert_ptr, fn);
+    // Only monitor certificates with a status PV, and only once however many connections present them
+    std::string status_pv;
+    if (status_check_enabled) {
+        try {
+            status_pv = certs::CertStatusManager::getStatusPvFromCert(cert_ptr);
+        } catch (certs::CertStatusNoExtensionException &e) {
+        }
+    }
+
+    return std::make_shared<SSLPeerStatusSubscription>(getOrCreatePeerStatus(serial_number, status_pv), fn);
+}
+
+void CertStatusExData::countPeerStatuses(size_t &statuses, size_t &subscriptions) {
+    std::vector<std::shared_ptr<SSLPeerStatusAndMonitor>> live;
+    {
+        Guard G(lock);
+        for (auto &pair : peer_statuses) {
+            if (auto peer_status = pair.second.lock()) live.push_back(std::move(peer_status));
+        }
+    }
+    // released outside of our lock, as the last reference removes itself from peer_statuses
+
+    statuses = live.size();
+    subscriptions = 0u;
+    for (auto &peer_status : live) {
+        Guard G(peer_status->lock);
+        subscriptions += peer_status->subscribers.size();
+    }
 }
 
 /**
@@ -659,16 +860,17 @@ void CertStatusExData::peersStatusValidityExpirationHandler(evutil_socket_t, sho
  * @param serial_number - The serial number of the peer status that expired
  */
 void SSLPeerStatusAndMonitor::peersStatusValidityExpirationHandler() {
-    if (status.isValid()) {
-        log_debug_printf(watcher, "Validity Timer expired but status is still valid%s", "\n");
-        restartPeerStatusValidityCountdown();
-    } else {
-        {
-            Guard G(lock);
-            status = certs::CertificateStatus();
+    {
+        Guard G(lock);
+        if (status.isValid()) {
+            log_debug_printf(watcher, "Validity Timer expired but status is still valid%s", "\n");
+            restartPeerStatusValidityCountdown();
+            return;
         }
-        if (fn) fn(false);
+        status = certs::CertificateStatus();
+        stapled_response.clear();
     }
+    notify(false);
 }
 
 void SSLPeerStatusAndMonitor::restartPeerStatusValidityCountdown() {
@@ -778,7 +980,13 @@ bool SSLContext::getPeerCredentials(PeerCredentials &C, const SSL *ctx) {
             temp.serial = std::to_string(serial);
 
             // try to use certificate chain authority names to qualify
-            if (const auto chain = SSL_get0_verified_chain(ctx)) {
+            auto chain = SSL_get0_verified_chain(ctx);
+            ossl_ptr<X509_STORE_CTX> rebuilt;
+            if (!chain && SSL_session_reused(const_cast<SSL *>(ctx))) {
+                rebuilt = rebuildVerifiedChain(ctx, cert);
+                if (rebuilt) chain = X509_STORE_CTX_get0_chain(rebuilt.get());
+            }
+            if (chain) {
                 const auto N = sk_X509_num(chain);
 
                 if (N > 0) {
@@ -835,21 +1043,162 @@ bool SSLContext::getPeerCredentials(PeerCredentials &C, const SSL *ctx) {
  *
  * @param ctx the SSL context to get the peer certificate from
  * @param fn the function to call when the certificate status changes
- * @return true if the peer certificate status was successfully subscribed, false otherwise
+ * @return the connection's subscription to the shared peer status, or null if there is no peer certificate
  */
-bool SSLContext::subscribeToPeerCertStatus(const SSL *ctx, std::function<void(bool)> fn) {
+std::shared_ptr<SSLPeerStatusSubscription> SSLContext::subscribeToPeerCertStatus(const SSL *ctx, const std::function<void(bool)> &fn) {
     if (!ctx) throw std::invalid_argument("NULL");
 
     if (auto cert = SSL_get0_peer_certificate(ctx)) {
         // Subscribe to peer certificate status if necessary
         auto ex_data = CertStatusExData::fromSSL(const_cast<SSL *>(ctx));
         if (ex_data) {
-            ex_data->subscribeToPeerCertStatus(cert, [=](bool is_good) { fn(is_good); });
+            return ex_data->subscribeToPeerCertStatus(cert, fn);
         }
-        return true;
+    }
+    return {};
+}
+
+void SSLContext::configureClientSessionResumption(SSL *ssl, const std::string &peer_name) const {
+    if (!ssl) throw std::invalid_argument("NULL");
+
+    // If the server's status is stapled then sessions may only be resumed while that status is good
+    std::unique_ptr<SSLSessionPeer> car{new SSLSessionPeer(peer_name, !status_check_disabled && !stapling_disabled)};
+    if (!SSL_set_ex_data(ssl, ossl_gbl->SSL_ex_idx, car.get())) throw SSLError("SSL_set_ex_data");
+    car.release();  // SSL_free() now responsible (using our registered callback `free_SSL_sidecar`)
+
+    if (session_resumption_disabled) return;
+
+    auto ex_data = getCertStatusExData();
+    if (!ex_data) return;
+    if (auto session = ex_data->resumption.findSession(peer_name)) {
+        if (SSL_set_session(ssl, session.get())) {
+            log_debug_printf(io, "Offering TLS session resumption to %s\n", peer_name.c_str());
+        } else {
+            log_debug_printf(io, "Unable to offer TLS session resumption to %s\n", peer_name.c_str());
+        }
+    }
+}
+
+void SSLContext::setStapledPeerStatus(SSL *ssl, const certs::CertificateStatus &status, const std::shared_ptr<SSLPeerStatusAndMonitor> &peer_status) {
+    auto peer = static_cast<SSLSessionPeer *>(SSL_get_ex_data(ssl, ossl_gbl->SSL_ex_idx));
+    if (!peer) return;
+    peer->peer_status = peer_status;
+    if (!status.isGood()) {
+        peer->status_good_until = 0;
+    } else if (status.isPermanent()) {
+        peer->status_good_until = std::numeric_limits<time_t>::max();
     } else {
-        return false;
+        peer->status_good_until = status.status_valid_until_date.t;
+    }
+}
+
+void SSLContext::countHandshake(const SSL *ssl) {
+    if (!ssl) return;
+    if (auto ex_data = CertStatusExData::fromSSL(const_cast<SSL *>(ssl))) {
+        const bool resumed = SSL_session_reused(const_cast<SSL *>(ssl));
+        ex_data->resumption.countHandshake(resumed);
+        log_debug_printf(io, "TLS handshake complete: %s\n", resumed ? "resumed" : "full");
+    }
+}
+
+bool SSLContext::kernelOffloaded(SSL *ssl) {
+#ifdef PVXS_HAVE_KTLS
+    if (!ssl || !(SSL_get_options(ssl) & SSL_OP_ENABLE_KTLS)) return false;
+    const bool tx = BIO_get_ktls_send(SSL_get_wbio(ssl));
+    const bool rx = BIO_get_ktls_recv(SSL_get_rbio(ssl));
+    log_debug_printf(io, "TLS kernel offload TX %s RX %s\n", tx ? "yes" : "no", rx ? "yes" : "no");
+    return tx && rx;
+#else
+    (void)ssl;
+    return false;
+#endif
+}
+
+int SSLSessionResumption::ticketKey(unsigned char key_name[16], unsigned char *iv, EVP_CIPHER_CTX *cipher_ctx, EVP_MAC_CTX *mac_ctx, int enc) {
+    const auto now = time(nullptr);
+    const auto cipher = EVP_aes_256_cbc();
+    const TLSTicketKey *key = nullptr;
+    int ret = 1;
+
+    Guard G(lock);
+    if (enc) {
+        // Rotate keys as needed.  The previous key remains usable for decryption for one more rotation period
+        if (!current_key.created || now - current_key.created >= kTicketKeyLifetimeSecs) {
+            TLSTicketKey new_key;
+            if (RAND_bytes(new_key.name, sizeof(new_key.name)) <= 0 || RAND_bytes(new_key.aes_key, sizeof(new_key.aes_key)) <= 0 ||
+                RAND_bytes(new_key.hmac_key, sizeof(new_key.hmac_key)) <= 0)
+                return -1;
+            new_key.created = now;
+            previous_key = current_key;
+            current_key = new_key;
+            log_debug_printf(setup, "Rotated TLS session ticket key%s\n", "");
+        }
+        key = &current_key;
+        memcpy(key_name, key->name, sizeof(key->name));
+        if (RAND_bytes(iv, EVP_CIPHER_get_iv_length(cipher)) <= 0) return -1;
+    } else {
+        if (current_key.created && !memcmp(key_name, current_key.name, sizeof(current_key.name))) {
+            key = &current_key;
+        } else if (previous_key.created && now - previous_key.created < 2 * kTicketKeyLifetimeSecs &&
+                   !memcmp(key_name, previous_key.name, sizeof(previous_key.name))) {
+            key = &previous_key;
+        } else {
+            return 0;  // unknown or expired key: full handshake
+        }
+        // Always renew.  Without a renewal the TLS 1.3 server does not issue a new ticket on resumption
+        // so clients would be left with an ageing ticket, encrypted with a key that will be retired.
+        ret = 2;
+    }
+
+    OSSL_PARAM params[3];
+    params[0] = OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, const_cast<unsigned char *>(key->hmac_key), sizeof(key->hmac_key));
+    params[1] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char *>("SHA256"), 0);
+    params[2] = OSSL_PARAM_construct_end();
+    if (!EVP_MAC_CTX_set_params(mac_ctx, params)) return -1;
+
+    if (enc) {
+        if (!EVP_EncryptInit_ex(cipher_ctx, cipher, nullptr, key->aes_key, iv)) return -1;
+    } else {
+        if (!EVP_DecryptInit_ex(cipher_ctx, cipher, nullptr, key->aes_key, iv)) return -1;
+    }
+    return ret;
+}
+
+bool SSLSessionResumption::storeSession(const std::string &peer_name, const ossl_shared_ptr<SSL_SESSION> &session, time_t resumable_until) {
+    const auto now = time(nullptr);
+    if (resumable_until <= now) return false;
+
+    Guard G(lock);
+    if (sessions.size() >= kMaxStoredSessions && sessions.find(peer_name) == sessions.end()) {
+        // drop sessions that can no longer be offered, then the one that would expire soonest
+        for (auto it = sessions.begin(); it != sessions.end();) {
+            if (it->second.resumable_until <= now)
+                it = sessions.erase(it);
+            else
+                ++it;
+        }
+        if (sessions.size() >= kMaxStoredSessions) {
+            auto soonest = sessions.begin();
+            for (auto it = sessions.begin(); it != sessions.end(); ++it) {
+                if (it->second.resumable_until < soonest->second.resumable_until) soonest = it;
+            }
+            sessions.erase(soonest);
+        }
+    }
+    sessions[peer_name] = StoredSession{session, resumable_until};
+    return true;
+}
+
+ossl_shared_ptr<SSL_SESSION> SSLSessionResumption::findSession(const std::string &peer_name) {
+    Guard G(lock);
+    auto it = sessions.find(peer_name);
+    if (it == sessions.end()) return {};
+    if (it->second.resumable_until <= time(nullptr)) {
+        sessions.erase(it);
+        return {};
     }
+    // Replaced when the server issues a new ticket on resumption
+    return it->second.session;
 }
 
 std::shared_ptr<SSLContext> SSLContext::for_client(const ConfigCommon &conf, const impl::evbase loop) {
@@ -8,6 +8,7 @@
 #define PVXS_OPENSSL_H
 
 #include <list>
+#include <map>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -40,6 +41,11 @@ typedef epicsGuard<epicsMutex> Guard;
 typedef epicsGuardRelease<epicsMutex> UnGuard;
 typedef uint64_t serial_number_t;
 
+// Kernel TLS offload (kTLS) is possible.  cf. ConfigCommon::tls_kernel_offload
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(_WIN32) && LIBEVENT_VERSION_NUMBER >= 0x02010100
+#  define PVXS_HAVE_KTLS
+#endif
+
 namespace pvxs {
 
 namespace client {
@@ -85,14 +91,16 @@ struct PVXS_API SSLError : public std::runtime_error {
 };
 
 /**
- * @brief A peer status monitor: containing a monitor and function to call when the peer status changes, the current status, and a status validity timer
+ * @brief A peer status monitor: containing a monitor and functions to call when the peer status changes, the current status, and a status validity timer
  *
- * This is used to store the peer status, the cert status manager, the validity timer and the function to call when the peer status changes.
+ * This is used to store the peer status, the cert status manager, the validity timer and the functions to call when the peer status changes.
+ * There is one for each distinct peer certificate (serial number), shared by all connections presenting that certificate, so that
+ * the status is monitored and verified once however many connections there are.  Each connection subscribes with its own function.
  *
  * The validity timer is used to create a timer for the status validity countdown.
  *
- * The function to call when the peer status changes is used to notify the caller when the peer status changes from good to bad or vice versa.
- * This function should disconnect the TLS connection if status goes from good to bad and should disconnect
+ * The functions to call when the peer status changes are used to notify the subscribers when the peer status changes from good to bad or vice versa.
+ * Each function should disconnect the TLS connection if status goes from good to bad and should disconnect
  * a TCP connection so that it can be reconnected as a TLS connection when status goes from bad to good.
  *
  * Peer statuses are established when a connection is made and peer status monitoring is enabled.
@@ -111,8 +119,9 @@ struct SSLPeerStatusAndMonitor {
     certs::cert_status_ptr<certs::CertStatusManager> cert_status_manager{};
     // The validity timer
     evevent validity_timer{};
-    // The function to call when the peer status changes
-    const std::function<void(bool)> fn;
+    // The functions to call when the peer status changes, one for each subscribed connection, keyed by subscription id
+    std::map<size_t, std::function<void(bool)>> subscribers{};
+    size_t next_subscriber_id{0};
 
     // The serial number of the certificate being monitored.  We get the status PV from the cert, so we know that it is from the right certificate authority 
     const serial_number_t serial_number;
@@ -122,16 +131,17 @@ struct SSLPeerStatusAndMonitor {
 
     certs::CertificateStatus status;
 
+    // The raw stapled OCSP response that `status` was verified from, if any.
+    // An identical response stapled by the same peer on another connection need not be verified again.
+    std::string stapled_response{};
+
     /**
-     * @brief Constructor when monitoring is needed
+     * @brief Constructor
      * @param serial_number the serial number of the certificate that we're monitoring
      * @param ex_data_ptr the ex_data structure that the list of peer status and monitors is stored, for cleanup
-     * @param validity_timer the status validity time to use (created externally and passed in)
-     * @param fn function to call when the status changes
-     * @param status optional initial status to set
      */
-    SSLPeerStatusAndMonitor(const serial_number_t serial_number, CertStatusExData* ex_data_ptr, evevent&& validity_timer, const std::function<void(bool)>& fn)
-        : validity_timer(std::move(validity_timer)), fn(fn), serial_number{serial_number}, ex_data_ptr{ex_data_ptr} {}
+    SSLPeerStatusAndMonitor(const serial_number_t serial_number, CertStatusExData* ex_data_ptr)
+        : serial_number{serial_number}, ex_data_ptr{ex_data_ptr} {}
 
     /**
      * @brief Constructor when no monitoring is needed
@@ -142,20 +152,158 @@ struct SSLPeerStatusAndMonitor {
     SSLPeerStatusAndMonitor(const serial_number_t serial_number, CertStatusExData* ex_data_ptr, certs::CertificateStatus& status)
         : serial_number{serial_number}, ex_data_ptr{ex_data_ptr}, status{status} {}
 
-    void updateStatus(const certs::CertificateStatus& status);
+    void updateStatus(const certs::CertificateStatus& status, const uint8_t* stapled_response_ptr = nullptr, size_t stapled_response_len = 0u);
+
+    /**
+     * @brief Get the status previously verified from an identical stapled OCSP response
+     * @param stapled_response_ptr the raw stapled OCSP response
+     * @param stapled_response_len its length
+     * @param cached_status set to the cached status if found
+     * @return true if the response matches the one the cached status was verified from and that status is still valid
+     */
+    bool getStapledStatus(const uint8_t* stapled_response_ptr, size_t stapled_response_len, certs::CertificateStatus& cached_status);
+
+    size_t addSubscriber(const std::function<void(bool)>& fn);
+    void removeSubscriber(size_t id);
 
     // Clean up peer status and monitor
     // Also remove from peer cert status map
     ~SSLPeerStatusAndMonitor();
 
+    // Call with lock held
     void restartPeerStatusValidityCountdown();
     void peersStatusValidityExpirationHandler();
 
-    bool isSubscribed() { return !cert_status_manager; }
+    bool isSubscribed() const { return !!cert_status_manager; }
+
+   private:
+    // Call each subscriber, outside the lock, if the status has changed from good to bad or vice versa
+    void notify(bool is_good);
+};
+
+/**
+ * @brief A connection's subscription to its peer's status
+ *
+ * This is the lightweight reference that each connection holds.  All connections to peers presenting the same
+ * certificate share one `SSLPeerStatusAndMonitor`, and so one status monitor and one verified status.
+ * Destroying the subscription removes the connection's function from the list of subscribers.
+ */
+struct SSLPeerStatusSubscription {
+    const std::shared_ptr<SSLPeerStatusAndMonitor> peer_status;
+    const size_t id;
+
+    SSLPeerStatusSubscription(const std::shared_ptr<SSLPeerStatusAndMonitor>& peer_status, const std::function<void(bool)>& fn)
+        : peer_status(peer_status), id(peer_status->addSubscriber(fn)) {}
+    ~SSLPeerStatusSubscription() { peer_status->removeSubscriber(id); }
+
+    SSLPeerStatusSubscription(const SSLPeerStatusSubscription&) = delete;
+    SSLPeerStatusSubscription& operator=(const SSLPeerStatusSubscription&) = delete;
 };
 
 struct StatusValidityExpirationHandlerParam;
 
+/**
+ * @brief A TLS session ticket encryption key
+ *
+ * Tickets are encrypted with AES-256-CBC and authenticated with HMAC-SHA256.  The name
+ * is sent in the clear with the ticket, so that we can find the key to decrypt it with.
+ */
+struct TLSTicketKey {
+    unsigned char name[16];
+    unsigned char aes_key[32];
+    unsigned char hmac_key[32];
+    // When this key was created.  0 if this key has never been set
+    time_t created{0};
+};
+
+/**
+ * @brief TLS session resumption state stored in the SSL_CTX alongside the cert status data
+ *
+ * Servers issue stateless TLS 1.3 session tickets encrypted with a key that is rotated every
+ * `kTicketKeyLifetimeSecs`.  Tickets encrypted with the previous key are still accepted for one more
+ * rotation period.  Tickets are renewed on every resumption.  Keys are never written anywhere, so a restarted server
+ * simply performs full handshakes until new tickets have been issued.
+ *
+ * Clients keep the latest resumable session for each server, keyed by the server's address.
+ * A session is only offered while the server's stapled certificate status, if any, is still
+ * valid, so a resumed handshake never trusts a peer status for longer than a full handshake would.
+ *
+ * Full and resumed handshakes are counted for reporting.
+ */
+struct SSLSessionResumption {
+    // How long a ticket key is used to encrypt new tickets
+    static constexpr time_t kTicketKeyLifetimeSecs = 3600;
+    // Upper bound on the number of servers that a client remembers sessions for
+    static constexpr size_t kMaxStoredSessions = 1024u;
+
+    // To lock changes to keys, sessions and counters
+    epicsMutex lock;
+
+    // Server: current and previous ticket keys
+    TLSTicketKey current_key{}, previous_key{};
+
+    // Client: the session to offer to each server, and when it must no longer be offered
+    struct StoredSession {
+        ossl_shared_ptr<SSL_SESSION> session;
+        time_t resumable_until;
+    };
+    std::map<std::string, StoredSession> sessions{};
+
+    // Count of completed handshakes
+    size_t full_handshakes{0u}, resumed_handshakes{0u};
+
+    /**
+     * @brief Server side ticket key callback.  See SSL_CTX_set_tlsext_ticket_key_evp_cb()
+     * @return -1 on error, 0 if the ticket can't be decrypted (full handshake), 1 on encryption, 2 on decryption (with ticket renewal)
+     */
+    int ticketKey(unsigned char key_name[16], unsigned char* iv, EVP_CIPHER_CTX* cipher_ctx, EVP_MAC_CTX* mac_ctx, int enc);
+
+    /**
+     * @brief Client side: remember a new session for the given server
+     * @param peer_name the server address
+     * @param session the new session
+     * @param resumable_until time after which the session must no longer be offered
+     * @return true if the session was stored
+     */
+    bool storeSession(const std::string& peer_name, const ossl_shared_ptr<SSL_SESSION>& session, time_t resumable_until);
+
+    /**
+     * @brief Client side: get the session to offer to the given server, if any
+     * @param peer_name the server address
+     * @return the session or nullptr
+     */
+    ossl_shared_ptr<SSL_SESSION> findSession(const std::string& peer_name);
+
+    /**
+     * @brief Count a completed handshake
+     * @param resumed true if a previous session was resumed
+     */
+    void countHandshake(bool resumed) {
+        Guard G(lock);
+        (resumed ? resumed_handshakes : full_handshakes)++;
+    }
+};
+
+/**
+ * @brief The per-connection (SSL) resumption data for a client connection
+ *
+ * Set on each client SSL so that the new session callback knows which server a session belongs to
+ * and until when the server's stapled certificate status remains good.  Also holds the connection's
+ * reference to the shared status of the server's certificate.
+ */
+struct SSLSessionPeer {
+    // The server address
+    const std::string peer_name;
+    // Whether sessions may only be stored while the server's stapled status is good
+    const bool require_good_status;
+    // The stapled certificate status of the server is good until this time.  0 if no good status was stapled
+    time_t status_good_until{0};
+    // Keeps the verified status of the server's certificate shared with other connections while this one lasts
+    std::shared_ptr<SSLPeerStatusAndMonitor> peer_status{};
+
+    SSLSessionPeer(const std::string& peer_name, bool require_good_status) : peer_name(peer_name), require_good_status(require_good_status) {}
+};
+
 /**
  * @brief The custom cert status related data stored in the SSL_CTX
  *
@@ -194,6 +342,8 @@ struct CertStatusExData {
     std::map<serial_number_t, std::weak_ptr<SSLPeerStatusAndMonitor>> peer_statuses{};
     // map to keep status validity expiration handler parameters from going stale
     std::map<serial_number_t, StatusValidityExpirationHandlerParam> sveh_params{};
+    // TLS session resumption state: ticket keys, stored sessions and handshake counters
+    SSLSessionResumption resumption{};
 
     /**
      * @brief Constructor
@@ -219,7 +369,9 @@ struct CertStatusExData {
 
     void removePeerStatusAndMonitor(serial_number_t serial_number) {
         Guard G(lock);
-        peer_statuses.erase(serial_number);
+        // Only if not already replaced by a new peer status for the same serial number
+        auto it = peer_statuses.find(serial_number);
+        if (it != peer_statuses.end() && it->second.expired()) peer_statuses.erase(it);
     }
 
     /**
@@ -241,37 +393,36 @@ struct CertStatusExData {
         return (serial_number_t)BN_get_word(bn.get());
     }
 
-    std::shared_ptr<SSLPeerStatusAndMonitor> createPeerStatus(serial_number_t serial_number, std::function<void(bool)> fn);
+    std::shared_ptr<SSLPeerStatusAndMonitor> createPeerStatus(serial_number_t serial_number);
 
     /**
      * @brief Sets the peer status for the given certificate
      * @param peer_cert - Peer Certificate
      * @param new_status - New Certificate status
-     * @param fn - the function to call
      * @return The peer status that was set
      */
-    std::shared_ptr<SSLPeerStatusAndMonitor> setPeerStatus(ossl_ptr<X509>& peer_cert, const certs::CertificateStatus& new_status,
-                                                           const std::function<void(bool)>& fn = nullptr) {
-        return setPeerStatus(peer_cert.get(), new_status, fn);
-    }
-
-    std::shared_ptr<SSLPeerStatusAndMonitor> setPeerStatus(ossl_ptr<X509>& peer_cert, const std::function<void(bool)>& fn = nullptr) {
-        return setPeerStatus(peer_cert.get(), {}, fn);
-    }
-
-    std::shared_ptr<SSLPeerStatusAndMonitor> setPeerStatus(X509* peer_cert_ptr, const std::function<void(bool)>& fn = nullptr) {
-        return setPeerStatus(peer_cert_ptr, {}, fn);
+    std::shared_ptr<SSLPeerStatusAndMonitor> setPeerStatus(ossl_ptr<X509>& peer_cert, const certs::CertificateStatus& new_status) {
+        return setPeerStatus(peer_cert.get(), new_status);
     }
 
+    /**
+     * @brief Sets the peer status for the given certificate
+     * @param peer_cert_ptr - Peer Certificate
+     * @param new_status - New Certificate status
+     * @param stapled_response_ptr - optional raw stapled OCSP response that the status was verified from
+     * @param stapled_response_len - its length
+     * @return The peer status that was set
+     */
     std::shared_ptr<SSLPeerStatusAndMonitor> setPeerStatus(X509* peer_cert_ptr, const certs::CertificateStatus& new_status,
-                                                           std::function<void(bool)> fn = nullptr);
+                                                           const uint8_t* stapled_response_ptr = nullptr, size_t stapled_response_len = 0u);
 
     /**
      * @brief Returns the currently cached peer status and monitor if any.  Null if none cached
      * @param serial_number - Serial number
      * @return The cached peer status
      */
-    std::shared_ptr<SSLPeerStatusAndMonitor> getCachedPeerStatus(serial_number_t serial_number) const {
+    std::shared_ptr<SSLPeerStatusAndMonitor> getCachedPeerStatus(serial_number_t serial_number) {
+        Guard G(lock);
         auto it = peer_statuses.find(serial_number);
         if (it != peer_statuses.end()) {
             auto peer_status = it->second.lock();
@@ -281,12 +432,19 @@ struct CertStatusExData {
     }
 
     /**
-     * @brief Subscribes to peer status if required and not already monitoring
+     * @brief Count the peer statuses in use, and the connections subscribed to them
+     * @param statuses - set to the number of distinct peer certificates with a shared status
+     * @param subscriptions - set to the number of connections subscribed to those statuses
+     */
+    void countPeerStatuses(size_t& statuses, size_t& subscriptions);
+
+    /**
+     * @brief Subscribes to peer status, monitoring it if required and not already monitored for another connection
      * @param cert_ptr - peer certificate status to subscribe to
      * @param fn - Function to call when the peer status changes from good to bad or vice versa
-     * @return a shared pointer to the peer status and optional monitor
+     * @return the subscription to the shared peer status and optional monitor, held by the connection
      */
-    std::shared_ptr<SSLPeerStatusAndMonitor> subscribeToPeerCertStatus(X509* cert_ptr, std::function<void(bool)> fn) noexcept;
+    std::shared_ptr<SSLPeerStatusSubscription> subscribeToPeerCertStatus(X509* cert_ptr, const std::function<void(bool)>& fn);
 
    private:
     /**
@@ -305,15 +463,15 @@ struct CertStatusExData {
     /**
      * @brief Creates a peer status if it does not already exist or returns the existing peer status
      *
-     * This will initialise the peer status as Unknown and set up a time capable of being used as a status validity timer.  It also
-     * sets up the function to call when the peer status changes. If the peer status already exists then it is returned.
+     * This will initialise the peer status as Unknown and set up a timer capable of being used as a status validity timer.
+     * If a status PV is given and the peer status is not yet monitored then a status monitor is started.  If the peer status
+     * already exists then it is returned, so that there is only ever one status monitor for each peer certificate.
      *
-     * @param status_pv - status pv
-     * @param fn - Function to call when the peer status changes
+     * @param serial_number - serial number of the peer certificate
+     * @param status_pv - status pv, empty if the status is not to be monitored
      * @return The peer status that was created or found
      */
-    std::shared_ptr<SSLPeerStatusAndMonitor> getOrCreatePeerStatus(serial_number_t serial_number, const std::string& status_pv = {},
-                                                                   std::function<void(bool)> fn = nullptr);
+    std::shared_ptr<SSLPeerStatusAndMonitor> getOrCreatePeerStatus(serial_number_t serial_number, const std::string& status_pv = {});
 };
 
 /**
@@ -380,6 +538,10 @@ struct SSLContext {
     bool status_check_disabled{false};
     // Whether stapling is disabled.  Copied from the config
     bool stapling_disabled{false};
+    // Whether TLS session resumption is disabled.  Copied from the config
+    bool session_resumption_disabled{false};
+    // Whether negotiated sessions are handed to the kernel.  Copied from the config, if supported
+    bool kernel_offload{false};
 
     // The entity certificate status validity timer (peer statuses are stored in the CertStatusExData tied to the SSL_CTX (ctx) created for this context)
     impl::evevent status_validity_timer{__FILE__, __LINE__, event_new(loop.base, -1, EV_TIMEOUT, statusValidityExpirationHandler, this)};
@@ -432,7 +594,44 @@ struct SSLContext {
     bool hasExpired() const;
 
     static bool getPeerCredentials(PeerCredentials& cred, const SSL* ctx);
-    static bool subscribeToPeerCertStatus(const SSL* ctx, std::function<void(bool)> fn);
+    static std::shared_ptr<SSLPeerStatusSubscription> subscribeToPeerCertStatus(const SSL* ctx, const std::function<void(bool)>& fn);
+
+    /**
+     * @brief Prepare a new client connection for TLS session resumption
+     *
+     * Offers the stored session for the given server, if there is one, and arranges for new sessions
+     * received on this connection to be stored for it.
+     *
+     * @param ssl the new client SSL connection
+     * @param peer_name the server address
+     */
+    void configureClientSessionResumption(SSL* ssl, const std::string& peer_name) const;
+
+    /**
+     * @brief Note the certificate status stapled by the server of a client connection
+     *
+     * Sessions are only stored for resumption while this status remains good.
+     * The connection also keeps a reference to the shared peer status so that other connections to
+     * servers presenting the same certificate can reuse it without verifying the stapled response again.
+     *
+     * @param ssl the client SSL connection
+     * @param status the verified stapled status
+     * @param peer_status the shared peer status that the stapled status was set in
+     */
+    static void setStapledPeerStatus(SSL* ssl, const certs::CertificateStatus& status, const std::shared_ptr<SSLPeerStatusAndMonitor>& peer_status = {});
+
+    /**
+     * @brief Count a completed handshake as full or resumed
+     * @param ssl the connection that completed its handshake
+     */
+    static void countHandshake(const SSL* ssl);
+
+    /**
+     * @brief Test whether both directions of a completed handshake are now processed by the kernel (kTLS)
+     * @param ssl the connection that completed its handshake
+     * @return true if the socket may now be read and written directly
+     */
+    static bool kernelOffloaded(SSL* ssl);
     const certs::PVACertificateStatus& get_status() { return cert_status; }
 
    private:
@@ -7,6 +7,9 @@
  */
 
 #include <vector>
+#include <map>
+#include <set>
+#include <deque>
 
 #if defined(_WIN32)
 #  define USE_LANMAN
@@ -43,20 +46,31 @@ typedef gid_t osi_gid_t;
 #endif
 
 #include <epicsAssert.h>
+#include <epicsMutex.h>
+#include <epicsEvent.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#include <pvxs/log.h>
 
 #include "utilpvt.h"
 
 namespace pvxs {
 namespace impl {
 
+DEFINE_LOGGER(setup, "pvxs.roles");
+
+typedef epicsGuard<epicsMutex> Guard;
+typedef epicsGuardRelease<epicsMutex> UnGuard;
+
 #if defined(USE_UNIX_GROUPS)
 
-void osdGetRoles(const std::string& account, std::set<std::string>& roles)
+bool osdGetRoles(const std::string& account, std::set<std::string>& roles)
 {
     passwd *user = getpwnam(account.c_str());
     if(!user) {
         roles.insert(account);
-        return; // don't know who this is
+        return false; // don't know who this is
     }
 
     typedef std::set<gid_t> gids_t;
@@ -122,11 +136,12 @@ void osdGetRoles(const std::string& account, std::set<std::string>& roles)
         if(group* gr = getgrgid(gid))
             roles.insert(gr->gr_name);
     }
+    return true;
 }
 
 #elif defined(USE_LANMAN)
 
-void osdGetRoles(const std::string& account, std::set<std::string>& roles)
+bool osdGetRoles(const std::string& account, std::set<std::string>& roles)
 {
     NET_API_STATUS sts;
     LPLOCALGROUP_USERS_INFO_0 pinfo = NULL;
@@ -136,7 +151,7 @@ void osdGetRoles(const std::string& account, std::set<std::string>& roles)
     {
         size_t N = mbstowcs(NULL, account.c_str(), 0);
         if(N==size_t(-1))
-            return; // username has invalid MB char
+            return false; // username has invalid MB char
         wbuf.resize(N+1);
         N = mbstowcs(&wbuf[0], account.c_str(), account.size());
         assert(N+1==wbuf.size());
@@ -176,19 +191,174 @@ void osdGetRoles(const std::string& account, std::set<std::string>& roles)
         throw;
     }
 
-    if(roles.empty())
+    if(roles.empty()) {
         roles.insert(account);
+        return false;
+    }
+    return true;
 }
 
 #else
 
-void osdGetRoles(const std::string& account, std::set<std::string>& roles)
+bool osdGetRoles(const std::string& account, std::set<std::string>& roles)
 {
     /* Group list not available (RTEMS, vxWorks)
      * Report the remote account as the only role.
      */
     roles.insert(account);
+    return true;
 }
 #endif
 
+namespace {
+
+/* Process wide cache of osdGetRoles() results.
+ *
+ * Lookups may go through NSS to LDAP/SSSD and take a long time.
+ * So remember results for a while, and resolve in advance from a worker
+ * thread when a client connects.
+ */
+struct RoleCache final : private epicsThreadRunable {
+    struct Entry {
+        std::set<std::string> roles;
+        epicsTime expires;
+    };
+
+    epicsMutex lock;
+    std::map<std::string, Entry> entries;
+    // accounts waiting for, or being resolved by, the worker
+    std::set<std::string> inprog;
+    std::deque<std::string> todo;
+    epicsEvent wakeup;
+    // signaled as the worker finishes each account
+    epicsEvent resolved;
+    epicsThread worker;
+    bool started = false;
+
+    RoleCache()
+        :worker(*this, "PVXROLES",
+                epicsThreadGetStackSize(epicsThreadStackSmall),
+                epicsThreadPriorityLow)
+    {}
+    virtual ~RoleCache() {} // never destroyed
+
+    // call with lock held
+    bool find(const std::string& account, std::set<std::string>& roles, const epicsTime& now) {
+        auto it(entries.find(account));
+        if(it==entries.end())
+            return false;
+
+        if(it->second.expires < now) {
+            entries.erase(it);
+            return false;
+        }
+
+        roles = it->second.roles;
+        return true;
+    }
+
+    // call without lock held
+    void resolve(const std::string& account, std::set<std::string>& roles) {
+        bool known = osdGetRoles(account, roles);
+
+        auto expires(epicsTime::getCurrent() + (known ? roleCacheTTL : roleCacheNegativeTTL));
+
+        Guard G(lock);
+        // bound size.  crude, but entries are small and accounts few
+        if(entries.size() >= roleCacheMaxEntries)
+            entries.clear();
+        auto& ent = entries[account];
+        ent.roles = roles;
+        ent.expires = expires;
+    }
+
+    virtual void run() override final {
+        Guard G(lock);
+        while(true) {
+            if(todo.empty()) {
+                UnGuard U(G);
+                wakeup.wait();
+                continue;
+            }
+            auto account(std::move(todo.front()));
+            todo.pop_front();
+
+            {
+                UnGuard U(G);
+                std::set<std::string> roles;
+                try {
+                    resolve(account, roles);
+                }catch(std::exception& e){
+                    log_exc_printf(setup, "Unable to resolve roles of '%s' : %s\n", account.c_str(), e.what());
+                }
+            }
+            inprog.erase(account);
+            resolved.signal();
+        }
+    }
+};
+
+RoleCache* roleCache;
+
+void roleCacheInit()
+{
+    roleCache = new RoleCache;
+}
+
+} // namespace
+
+void getRoles(const std::string& account, std::set<std::string>& roles)
+{
+    threadOnce<&roleCacheInit>();
+    auto& cache = *roleCache;
+
+    {
+        Guard G(cache.lock);
+        while(true) {
+            if(cache.find(account, roles, epicsTime::getCurrent()))
+                return;
+            else if(!cache.inprog.count(account))
+                break;
+
+            // being prefetched.  wait for the worker rather than repeating the lookup.
+            // Timeout as another caller may consume the signal.
+            UnGuard U(G);
+            cache.resolved.wait(0.1);
+        }
+    }
+
+    // not cached, or prefetch failed.  Resolve now.
+    roles.clear();
+    cache.resolve(account, roles);
+}
+
+void prefetchRoles(const std::string& account)
+{
+    threadOnce<&roleCacheInit>();
+    auto& cache = *roleCache;
+
+    {
+        Guard G(cache.lock);
+
+        std::set<std::string> ignore;
+        if(cache.find(account, ignore, epicsTime::getCurrent()) || !cache.inprog.insert(account).second)
+            return;
+
+        cache.todo.push_back(account);
+
+        if(!cache.started) {
+            cache.started = true;
+            cache.worker.start();
+        }
+    }
+    cache.wakeup.signal();
+}
+
+void clearRoleCache()
+{
+    threadOnce<&roleCacheInit>();
+    Guard G(roleCache->lock);
+    roleCache->entries.clear();
+}
+
 }} // namespace pvxs::impl
@@ -147,6 +147,7 @@ DEFINE_SSL_DELETER_FOR_(OSSL_LIB_CTX);
 DEFINE_SSL_DELETER_FOR_(PKCS12);
 DEFINE_SSL_DELETER_FOR_(SSL);
 DEFINE_SSL_DELETER_FOR_(SSL_CTX);
+DEFINE_SSL_DELETER_FOR_(SSL_SESSION);
 DEFINE_SSL_DELETER_FOR_(X509);
 DEFINE_SSL_DELETER_FOR_(X509_ATTRIBUTE);
 DEFINE_SSL_DELETER_FOR_(X509_EXTENSION);
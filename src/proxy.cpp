@@ -0,0 +1,514 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <map>
+#include <vector>
+
+#include <epicsTime.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsVersion.h>
+
+#include <pvxs/log.h>
+#include <pvxs/client.h>
+#include <pvxs/proxy.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/source.h>
+
+#include "evhelper.h"
+#include "utilpvt.h"
+
+#if EPICS_VERSION_INT<VERSION_INT(7,0,3,1)
+#  define getMonotonic getCurrent
+#endif
+
+typedef epicsGuard<epicsMutex> Guard;
+typedef epicsGuardRelease<epicsMutex> UnGuard;
+
+DEFINE_LOGGER(logproxy, "pvxs.svr.proxy");
+
+namespace pvxs {
+namespace server {
+
+namespace {
+// Period of the idle sweep
+constexpr double sweepInterval = 1.0;
+}
+
+struct ProxySource::Impl final : public Source, public std::enable_shared_from_this<Impl>
+{
+    // One upstream subscription, and the SharedPV through which it is re-served.
+    struct Entry {
+        const std::string name;
+        SharedPV pv;
+
+        // remaining members protected by lock.
+        // Lock order: Impl::lock, then Entry::lock
+        mutable epicsMutex lock;
+        std::shared_ptr<client::Subscription> sub;
+        enum state_t {
+            Searching, // waiting for the upstream subscription to connect
+            Connected, // pv is open()
+            Negative,  // not found, or failed, upstream.  sub released
+        } state = Searching;
+        // time of entering state
+        epicsTime since;
+        // time of last downstream search, create, or disconnect
+        epicsTime used;
+        // has downstream clients
+        bool inuse = false;
+
+        Entry(const std::string& name, const epicsTime& now)
+            :name(name)
+            ,pv(SharedPV::buildReadonly())
+            ,since(now)
+            ,used(now)
+        {}
+    };
+
+    client::Context upstream;
+
+    mutable epicsMutex lock;
+    double negTimeout = 30.0;
+    double idleTimeout = 60.0;
+    size_t maxSearching = 1024u;
+    bool forwardPut = false;
+    std::map<std::string, std::shared_ptr<Entry>> entries;
+    // Entries in Searching state.  Recounted by sweep(), so may over-count until then.
+    size_t nSearching = 0u;
+
+    impl::evbase loop;
+    // runs sweep().  only access from loop worker
+    std::unique_ptr<impl::WheelTimer> sweeper;
+
+    explicit Impl(const client::Context& upstream)
+        :upstream(upstream)
+        ,loop("PVXPROXY")
+    {
+        loop.call([this]() {
+            sweeper.reset(new impl::WheelTimer(loop, [this]() { onSweep(); }));
+            sweeper->start(sweepInterval, true);
+        });
+    }
+    virtual ~Impl() {
+        loop.call([this]() {
+            sweeper.reset();
+        });
+    }
+
+    virtual void onSearch(Search& op) override final
+    {
+        const auto now(epicsTime::getMonotonic());
+        std::vector<std::shared_ptr<Entry>> starting;
+        // released after unlock
+        std::vector<std::shared_ptr<Entry>> dropped;
+        std::vector<std::shared_ptr<client::Subscription>> cancelled;
+
+        {
+            Guard G(lock);
+
+            for(auto& name : op) {
+                auto it(entries.find(name.name()));
+                if(it!=entries.end()) {
+                    auto& ent = it->second;
+                    Guard E(ent->lock);
+                    ent->used = now;
+
+                    if(ent->state==Entry::Connected) {
+                        name.claim();
+                        log_debug_printf(logproxy, "%p claim '%s'\n", this, name.name());
+                        continue;
+
+                    } else if(ent->state==Entry::Searching) {
+                        continue;
+
+                    } else if(now - ent->since < negTimeout) { // Negative
+                        continue;
+                    }
+                    // negative entry expired.  search upstream again
+                }
+
+                if(nSearching >= maxSearching) {
+                    log_debug_printf(logproxy, "%p too many searching upstream, ignore '%s'\n", this, name.name());
+                    continue;
+                }
+                if(it!=entries.end())
+                    dropped.push_back(it->second);
+
+                log_debug_printf(logproxy, "%p search upstream '%s'\n", this, name.name());
+                auto ent(std::make_shared<Entry>(name.name(), now));
+                entries[name.name()] = ent;
+                nSearching++;
+                starting.push_back(std::move(ent));
+            }
+        }
+
+        for(auto& ent : starting) {
+            try {
+                start(ent);
+            }catch(std::exception& e){
+                log_err_printf(logproxy, "Unable to subscribe to '%s' : %s\n", ent->name.c_str(), e.what());
+            }
+        }
+    }
+
+    virtual void onCreate(std::unique_ptr<ChannelControl>&& op) override final
+    {
+        std::shared_ptr<Entry> ent;
+        {
+            Guard G(lock);
+            auto it(entries.find(op->name()));
+            if(it==entries.end())
+                return; // not mine
+
+            Guard E(it->second->lock);
+            if(it->second->state!=Entry::Connected)
+                return; // wait for the client to search again
+
+            it->second->used = epicsTime::getMonotonic();
+            ent = it->second;
+        }
+
+        log_debug_printf(logproxy, "%p create '%s'\n", this, ent->name.c_str());
+        // if upstream disconnects meanwhile, the SharedPV will hold this channel until re-open()
+        ent->pv.attach(std::move(op));
+    }
+
+    virtual List onList() override final
+    {
+        auto names(std::make_shared<std::set<std::string>>());
+        {
+            Guard G(lock);
+            for(auto& pair : entries) {
+                Guard E(pair.second->lock);
+                if(pair.second->state==Entry::Connected)
+                    names->emplace(pair.first);
+            }
+        }
+
+        List ret;
+        ret.names = std::move(names);
+        ret.dynamic = true; // changes with upstream connectivity
+        return ret;
+    }
+
+    virtual void show(std::ostream& strm) override final
+    {
+        strm<<"ProxySource";
+
+        Guard G(lock);
+        for(auto& pair : entries) {
+            Guard E(pair.second->lock);
+            strm<<"\n"<<indent{}<<pair.first;
+            switch(pair.second->state) {
+            case Entry::Searching: strm<<" SEARCHING"; break;
+            case Entry::Connected: strm<<" CONNECTED"; break;
+            case Entry::Negative:  strm<<" NEGATIVE"; break;
+            }
+            if(pair.second->inuse)
+                strm<<" INUSE";
+        }
+    }
+
+    // on loop worker
+    void onSweep()
+    {
+        const auto now(epicsTime::getMonotonic());
+        // released after unlock
+        std::vector<std::shared_ptr<Entry>> dropped;
+        std::vector<std::shared_ptr<client::Subscription>> cancelled;
+
+        Guard G(lock);
+        sweep(now, dropped, cancelled);
+
+        UnGuard U(G);
+        cancelled.clear();
+        dropped.clear();
+    }
+
+    // Give up on names not found upstream, and forget idle, and expired negative, entries.
+    // Call with lock held.
+    void sweep(const epicsTime& now,
+               std::vector<std::shared_ptr<Entry>>& dropped,
+               std::vector<std::shared_ptr<client::Subscription>>& cancelled)
+    {
+        nSearching = 0u;
+        for(auto it(entries.begin()), end(entries.end()); it!=end;) {
+            auto& ent = it->second;
+            bool drop;
+            {
+                Guard E(ent->lock);
+                if(ent->state==Entry::Searching && now - ent->since >= negTimeout) {
+                    log_debug_printf(logproxy, "%p not found upstream '%s'\n", this, it->first.c_str());
+                    ent->state = Entry::Negative;
+                    ent->since = now;
+                    cancelled.push_back(std::move(ent->sub));
+                }
+
+                if(ent->state==Entry::Negative) {
+                    drop = now - ent->since >= negTimeout;
+                } else {
+                    drop = !ent->inuse && now - ent->used >= idleTimeout;
+                }
+                if(drop && ent->sub)
+                    cancelled.push_back(std::move(ent->sub));
+                if(!drop && ent->state==Entry::Searching)
+                    nSearching++;
+            }
+
+            if(drop) {
+                log_debug_printf(logproxy, "%p forget '%s'\n", this, it->first.c_str());
+                dropped.push_back(std::move(ent));
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Begin upstream subscription.  Call without lock held.
+    void start(const std::shared_ptr<Entry>& ent)
+    {
+        std::weak_ptr<Impl> wself(shared_from_this());
+        std::weak_ptr<Entry> went(ent);
+        const auto name(ent->name);
+        bool putUpstream;
+        {
+            Guard G(lock);
+            putUpstream = forwardPut;
+        }
+
+        auto& pv = ent->pv;
+
+        pv.onFirstConnect([went](SharedPV&) {
+            if(auto ent = went.lock()) {
+                Guard E(ent->lock);
+                ent->inuse = true;
+            }
+        });
+        pv.onLastDisconnect([went](SharedPV&) {
+            if(auto ent = went.lock()) {
+                Guard E(ent->lock);
+                ent->inuse = false;
+                ent->used = epicsTime::getMonotonic();
+            }
+        });
+        // unless forwarded, PUT is rejected by the read-only SharedPV
+        if(putUpstream) {
+            pv.onPut([wself, name](SharedPV&, std::unique_ptr<ExecOp>&& eop, Value&& val) {
+                // on server worker
+                auto self(wself.lock());
+                if(!self) {
+                    eop->error("Proxy closed");
+                    return;
+                }
+
+                std::shared_ptr<ExecOp> op(std::move(eop));
+                auto put(self->upstream.put(name)
+                         .syncCancel(false)
+                         .build([val](Value&& prototype) -> Value {
+                             auto top(std::move(prototype));
+                             top.assign(val);
+                             return top;
+                         })
+                         .result([op](client::Result&& result) {
+                             // on client worker
+                             try {
+                                 result();
+                                 op->reply();
+                             }catch(std::exception& e){
+                                 op->error(e.what());
+                             }
+                         })
+                         .exec());
+
+                op->onCancel([put]() {
+                    put->cancel();
+                });
+            });
+        }
+
+        // cancel must not wait for the client worker, which may itself be waiting for a server worker
+        auto sub(upstream.monitor(name)
+                 .maskConnected(true)
+                 .maskDisconnected(false)
+                 .syncCancel(false)
+                 .event([went](client::Subscription& sub) {
+                     if(auto ent = went.lock())
+                         onEvent(*ent, sub);
+                 })
+                 .exec());
+
+        Guard E(ent->lock);
+        if(ent->state==Entry::Searching)
+            ent->sub = std::move(sub);
+    }
+
+    // on client worker
+    static
+    void onEvent(Entry& ent, client::Subscription& sub)
+    {
+        auto& pv = ent.pv;
+
+        while(true) {
+            Value val;
+            bool lost = false, failed = false;
+            try {
+                val = sub.pop();
+                if(!val)
+                    break;
+
+            }catch(client::Finished&){
+                log_debug_printf(logproxy, "'%s' upstream finished\n", ent.name.c_str());
+                lost = failed = true;
+
+            }catch(client::Disconnect&){
+                log_debug_printf(logproxy, "'%s' upstream disconnect\n", ent.name.c_str());
+                lost = true;
+
+            }catch(std::exception& e){
+                log_warn_printf(logproxy, "'%s' upstream error : %s\n", ent.name.c_str(), e.what());
+                lost = failed = true;
+            }
+
+            if(lost) {
+                // force downstream clients to search again
+                pv.close();
+
+                Guard E(ent.lock);
+                if(ent.state!=Entry::Negative) {
+                    // on Disconnect, subscription will reconnect.
+                    ent.state = failed ? Entry::Negative : Entry::Searching;
+                    ent.since = epicsTime::getMonotonic();
+                }
+                continue;
+            }
+
+            {
+                Guard E(ent.lock);
+                if(ent.state==Entry::Negative)
+                    continue; // released, or ProxySource::close()
+            }
+
+            try {
+                if(pv.isOpen()) {
+                    pv.post(val.freeze());
+
+                } else {
+                    log_debug_printf(logproxy, "'%s' upstream connect\n", ent.name.c_str());
+                    pv.open(val);
+
+                    Guard E(ent.lock);
+                    if(ent.state==Entry::Searching) {
+                        ent.state = Entry::Connected;
+                        ent.since = epicsTime::getMonotonic();
+                    }
+                }
+            }catch(std::exception& e){
+                log_err_printf(logproxy, "'%s' unable to re-serve update : %s\n", ent.name.c_str(), e.what());
+            }
+        }
+    }
+};
+
+ProxySource ProxySource::build(const client::Context& upstream)
+{
+    if(!upstream)
+        throw std::logic_error("ProxySource requires a client::Context");
+
+    ProxySource ret;
+    ret.impl = std::make_shared<Impl>(upstream);
+    return ret;
+}
+
+ProxySource::~ProxySource() {}
+
+std::shared_ptr<Source> ProxySource::source() const
+{
+    if(!impl)
+        throw std::logic_error("Empty ProxySource");
+    return impl;
+}
+
+ProxySource& ProxySource::negativeTimeout(double sec)
+{
+    if(!impl)
+        throw std::logic_error("Empty ProxySource");
+    Guard G(impl->lock);
+    impl->negTimeout = sec;
+    return *this;
+}
+
+ProxySource& ProxySource::idleTimeout(double sec)
+{
+    if(!impl)
+        throw std::logic_error("Empty ProxySource");
+    Guard G(impl->lock);
+    impl->idleTimeout = sec;
+    return *this;
+}
+
+ProxySource& ProxySource::maxSearching(size_t count)
+{
+    if(!impl)
+        throw std::logic_error("Empty ProxySource");
+    Guard G(impl->lock);
+    impl->maxSearching = count;
+    return *this;
+}
+
+ProxySource& ProxySource::forwardPut(bool forward)
+{
+    if(!impl)
+        throw std::logic_error("Empty ProxySource");
+    Guard G(impl->lock);
+    impl->forwardPut = forward;
+    return *this;
+}
+
+void ProxySource::close()
+{
+    if(!impl)
+        throw std::logic_error("Empty ProxySource");
+
+    decltype (impl->entries) entries;
+    std::vector<std::shared_ptr<client::Subscription>> cancelled;
+    {
+        Guard G(impl->lock);
+        entries = std::move(impl->entries);
+        impl->entries.clear();
+        impl->nSearching = 0u;
+
+        for(auto& pair : entries) {
+            Guard E(pair.second->lock);
+            pair.second->state = Impl::Entry::Negative;
+            cancelled.push_back(std::move(pair.second->sub));
+        }
+    }
+
+    cancelled.clear();
+
+    for(auto& pair : entries) {
+        pair.second->pv.close();
+    }
+}
+
+ProxySource::list_t ProxySource::list() const
+{
+    if(!impl)
+        throw std::logic_error("Empty ProxySource");
+
+    list_t ret;
+    Guard G(impl->lock);
+    for(auto& pair : impl->entries) {
+        Guard E(pair.second->lock);
+        if(pair.second->state!=Impl::Entry::Negative)
+            ret[pair.first] = pair.second->state==Impl::Entry::Connected;
+    }
+    return ret;
+}
+
+}} // namespace pvxs::server
@@ -14,6 +14,8 @@
 #include <string>
 #include <type_traits>
 #include <initializer_list>
+#include <limits>
+#include <memory>
 
 #include <type_traits>
 
@@ -26,6 +28,9 @@
 
 namespace pvxs {namespace impl {
 
+struct ShmRing;
+struct ShmMap;
+
 constexpr bool hostBE{EPICS_BYTE_ORDER==EPICS_ENDIAN_BIG};
 
 //! view of a slice of a buffer.
@@ -66,6 +71,19 @@ public:
     inline const char* file() const { return err ? err : "(null)"; }
     EPICS_ALWAYS_INLINE int line() const { return errline; }
 
+    // Append nbytes at ptr, which is the content of arr, by reference instead of copying.
+    // @returns false if not done, and the caller should copy.
+    virtual bool reference(const shared_array<const void>& arr, const void* ptr, size_t nbytes) { return false; }
+
+    // When non-zero, arrays of at least this many bytes are preceded by a flag, and may be
+    // placed in memory shared with the peer.  Must match between sender and receiver.  cf. shm.h
+    size_t shmThreshold = 0u;
+    // Copy nbytes at ptr into memory shared with the peer.
+    // @returns false if not done, and the caller should send inline.
+    virtual bool shmPlace(const void* ptr, size_t nbytes, uint64_t& offset) { return false; }
+    // Reference nbytes placed at offset by the peer.  @returns nullptr if not valid.
+    virtual std::shared_ptr<const void> shmArray(uint64_t offset, size_t nbytes) { return nullptr; }
+
     // ensure (be resize/refill) that size()>=i
     inline bool ensure(size_t i) {
         return !err && (i<=size() || refill(i));
@@ -135,6 +153,13 @@ class PVXS_API EvOutBuf : public Buffer
     evbuffer * const backing;
     uint8_t* base; // original pos
 public:
+    // Arrays of at least this many bytes, already in the requested byte order, are appended
+    // by reference to the array storage (which is kept alive until drained).  Zero disables.
+    size_t refThreshold = 0u;
+    // when set, incremented by the number of bytes appended by reference
+    size_t* refCount = nullptr;
+    // with shmThreshold
+    ShmRing* shmRing = nullptr;
 
     EvOutBuf(bool be, evbuffer *b, size_t isize=0)
         :base_type(be, nullptr, 0)
@@ -143,6 +168,8 @@ public:
     {refill(isize);}
     virtual ~EvOutBuf();
     virtual bool refill(size_t more) override final;
+    virtual bool reference(const shared_array<const void>& arr, const void* ptr, size_t nbytes) override final;
+    virtual bool shmPlace(const void* ptr, size_t nbytes, uint64_t& offset) override final;
 };
 
 //! deserialize from an evbuffer, possibly segmented
@@ -152,6 +179,8 @@ class PVXS_API EvInBuf : public Buffer
     evbuffer * const backing;
     uint8_t* base; // original pos after ctor or refill()
 public:
+    // with shmThreshold
+    ShmMap* shmMap = nullptr;
 
     EvInBuf(bool be, evbuffer *b, size_t ifill=0)
         :base_type(be, nullptr, 0)
@@ -161,6 +190,7 @@ public:
     virtual ~EvInBuf();
 
     virtual bool refill(size_t more) override final;
+    virtual std::shared_ptr<const void> shmArray(uint64_t offset, size_t nbytes) override final;
 };
 
 // assumes prior buf.ensure(M) where M>=N
@@ -478,7 +508,23 @@ void to_wire(Buffer& buf, const shared_array<const void>& varr)
     auto arr = varr.castTo<const E>();
     to_wire(buf, Size{arr.size()});
 
-    if(std::is_pod<C>::value) {
+    constexpr bool direct = std::is_pod<C>::value && std::is_same<E, C>::value;
+    const bool sameOrder = sizeof(C)==1u || buf.be==hostBE;
+
+    if(direct && buf.shmThreshold && arr.size()*sizeof(C) >= buf.shmThreshold) {
+        uint64_t offset = 0u;
+        if(sameOrder && buf.shmPlace(arr.data(), arr.size()*sizeof(C), offset)) {
+            to_wire(buf, uint8_t(1u));
+            to_wire(buf, offset);
+            return;
+        }
+        to_wire(buf, uint8_t(0u)); // inline follows
+    }
+
+    if(direct && sameOrder && buf.reference(varr, arr.data(), arr.size()*sizeof(C))) {
+        // appended without copying
+
+    } else if(std::is_pod<C>::value) {
         // optimize handling of types with fixed element size
 
         auto src = reinterpret_cast<const char*>(arr.data());
@@ -525,6 +571,28 @@ void from_wire(Buffer& buf, shared_array<const void>& varr)
 {
     Size slen{};
     from_wire(buf, slen);
+
+    constexpr bool direct = std::is_pod<C>::value && std::is_same<E, C>::value;
+
+    // same test as to_wire(), without overflow
+    if(direct && buf.shmThreshold && slen.size >= (buf.shmThreshold + sizeof(C) - 1u)/sizeof(C)) {
+        uint8_t inShm = 0u;
+        from_wire(buf, inShm);
+        if(inShm) {
+            uint64_t offset = 0u;
+            from_wire(buf, offset);
+            std::shared_ptr<const void> region;
+            if(buf.good() && slen.size <= std::numeric_limits<size_t>::max()/sizeof(C))
+                region = buf.shmArray(offset, slen.size*sizeof(C));
+            if(!region) {
+                buf.fault(__FILE__, __LINE__);
+                return;
+            }
+            varr = shared_array<const E>(region, static_cast<const E*>(region.get()), slen.size).template castTo<const void>();
+            return;
+        }
+    }
+
     shared_array<E> arr(slen.size);
 
     if(std::is_pod<C>::value) {
@@ -594,6 +662,8 @@ struct pva_version {
 struct pva_flags {
     enum type_t : uint8_t {
         Control = 0x01,
+        // PVXS specific.  Only after pva_ctrl_msg::CompressAccept.  cf. compress.h
+        Compressed = 0x08,
         SegNone = 0x00,
         SegFirst= 0x10,
         SegLast = 0x20,
@@ -608,6 +678,12 @@ struct pva_ctrl_msg {
         SetMarker = 0,
         AckMarker = 1,
         SetEndian = 2,
+        // PVXS specific.  Only on Unix socket connections.  cf. shm.h
+        ShmOffer = 0x40,   // first from server.  size field is Buffer::shmThreshold.  w/ SCM_RIGHTS if non-zero
+        ShmRelease = 0x41, // from client.  size field is offset/ShmRing::align of an array no longer referenced
+        // PVXS specific.  Payload compression.  cf. compress.h
+        CompressOffer = 0x42,  // from server, after CONNECTION_VALIDATION.  size field is mask of (1<<Compressor::algo_t) supported
+        CompressAccept = 0x43, // from client.  size field is the Compressor::algo_t chosen
     };
 };
 
@@ -634,7 +710,22 @@ enum pva_app_msg_t : uint8_t {
     CMD_MULTIPLE_DATA = 19,
     CMD_RPC = 20,
     CMD_CANCEL_REQUEST = 21,
-    CMD_ORIGIN_TAG = 22
+    CMD_ORIGIN_TAG = 22,
+    // PVXS specific.  For multicast monitors.  cf. server::Server::addMulticast()
+    // Sent through UDP, except for complete values requested by CMD_MCAST_NACK, which are sent through TCP,
+    // and pva_mcast_kind::Grant, which is only sent through TCP.
+    CMD_MCAST_DATA = 0x40, // from server.  PV name, sequence number, pva_mcast_kind, and maybe an update
+    CMD_MCAST_NACK = 0x41, // from client.  PV name, and first and last sequence numbers to re-send
+};
+
+//! Kinds of CMD_MCAST_DATA
+struct pva_mcast_kind {
+    enum type_t : uint8_t {
+        Update = 0,    // changed fields, as with a MONITOR update
+        Sync = 1,      // complete value, as of the sequence number
+        Heartbeat = 2, // latest sequence number, without a value.  Sent when otherwise idle.
+        Grant = 3,     // UDP port from which the server publishes.  Sent through TCP when a subscription is accepted.
+    };
 };
 
 struct pva_search_flags {
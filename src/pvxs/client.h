@@ -176,6 +176,48 @@ public:
 #endif
 };
 
+/** Handle for a batch of GET or PUT operations.
+ *
+ * cf. Context::getMany() and Context::putMany()
+ *
+ * @since UNRELEASED
+ */
+struct PVXS_API Batch {
+    Batch() = default;
+    Batch(const Batch&) = delete;
+    Batch& operator=(const Batch&) = delete;
+    virtual ~Batch() =0;
+
+    //! Number of operations in this batch
+    virtual size_t size() const =0;
+
+    //! Explicitly cancel all pending operations.
+    //! Blocks until an in-progress callback has completed.
+    //! @returns true if any operation was canceled, or false if all were already complete.
+    virtual bool cancel() =0;
+
+    /** @brief Block until all operations complete
+     *
+     * As an alternative to a .result() callback, wait for completion of every operation,
+     * timeout, or interruption (via. interrupt() ).
+     *
+     * @param timeout Time to wait prior to throwing TimeoutError.  cf. epicsEvent::wait(double)
+     * @return One Result for each PV, in the order names were given.
+     *         Each is either a Value (always empty for putMany()) or an error.
+     * @throws Timeout Timeout exceeded
+     * @throws Interrupted interrupt() called
+     */
+    virtual std::vector<Result> wait(double timeout) =0;
+
+    //! wait(double) without a timeout
+    std::vector<Result> wait() {
+        return wait(99999999.0);
+    }
+
+    //! Queue an interruption of a wait() or wait(double) call.
+    virtual void interrupt() =0;
+};
+
 //! Information about the state of a Subscription
 struct SubscriptionStat {
     //! Number of events in the queue
@@ -189,6 +231,10 @@ struct SubscriptionStat {
     size_t maxQueue=0;
     //! Limit on queue size
     size_t limitQueue=0;
+    //! Number of Value updates received as part of a multicast subscription.  cf. server::Server::addMulticast()
+    //! Includes complete values sent through TCP after updates are lost.
+    //! @since UNRELEASED
+    size_t nMcast=0;
 };
 
 //! Handle for monitor subscription
@@ -282,6 +328,69 @@ public:
     virtual std::shared_ptr<Subscription> shared_from_this() const =0;
 };
 
+/** Multiplexed event notification for many Subscriptions.
+ *
+ * A built-in alternative to a user MPMCFIFO fed by MonitorBuilder::event() callbacks.
+ * A Subscription created with MonitorBuilder::completionQueue() is queued
+ * each time its event queue becomes not empty, and appears at most once in
+ * the CompletionQueue until returned by wait().
+ * Any number of threads may call wait() concurrently.
+ *
+ * @code
+ * client::CompletionQueue cq;
+ * std::vector<std::shared_ptr<client::Subscription>> subs;
+ * for(auto& name : pvnames)
+ *     subs.push_back(ctxt.monitor(name).completionQueue(cq).exec());
+ *
+ * // in one or more worker threads
+ * std::vector<std::shared_ptr<client::Subscription>> ready;
+ * while(cq.wait(ready, 64u)) {
+ *     for(auto& sub : ready) {
+ *         try {
+ *             while(auto update = sub->pop()) {
+ *                 ...
+ *             }
+ *         } catch(std::exception& e) {
+ *             ...
+ *         }
+ *     }
+ * }
+ * @endcode
+ *
+ * Queued entries do not keep a Subscription alive.
+ * A Subscription which is cancelled by releasing its last reference is silently skipped.
+ *
+ * @since UNRELEASED
+ */
+class PVXS_API CompletionQueue {
+public:
+    struct Pvt;
+
+    //! Allocate a new and empty queue
+    CompletionQueue();
+    ~CompletionQueue();
+
+    /** Wait for Subscriptions to become ready.
+     *
+     * @param ready Cleared, then filled with up to maxEvents ready Subscriptions.
+     * @param maxEvents Upper limit on entries added to ready.  Zero is treated as one.
+     * @param timeout Time to wait if no Subscription is ready.  Negative waits forever.
+     * @returns ready.size().  Zero on timeout, or after close().
+     */
+    size_t wait(std::vector<std::shared_ptr<Subscription>>& ready, size_t maxEvents, double timeout=-1.0);
+
+    //! Cause all present and future calls to wait() to return without blocking.
+    void close();
+
+    //! Poll the number of Subscriptions presently queued.
+    size_t size() const;
+
+    explicit operator bool() const { return pvt.operator bool(); }
+private:
+    std::shared_ptr<Pvt> pvt;
+    friend class MonitorBuilder;
+};
+
 //! Handle for entry in Channel cache
 struct PVXS_API Connect {
     virtual ~Connect() =0;
@@ -294,6 +403,7 @@ struct PVXS_API Connect {
 
 class GetBuilder;
 class PutBuilder;
+class BatchBuilder;
 class RPCBuilder;
 class MonitorBuilder;
 class RequestBuilder;
@@ -461,6 +571,51 @@ public:
     inline
     PutBuilder put(const std::string& pvname);
 
+    /** Request the present value of many PVs as one batch.
+     *
+     * Operations are started together, and requests to the same server are
+     * sent together.  Completion is through one notification for the whole batch.
+     *
+     * @code
+     * Context ctxt(...);
+     * std::vector<std::string> names = ...;
+     * auto results = ctxt.getMany(names)
+     *                    .exec()
+     *                    ->wait(10.0);
+     * for(size_t i=0; i<names.size(); i++) {
+     *     try {
+     *         std::cout<<names[i]<<" "<<results[i]()<<"\n";
+     *     } catch(std::exception& e) {
+     *         std::cout<<names[i]<<" Error: "<<e.what()<<"\n";
+     *     }
+     * }
+     * @endcode
+     *
+     * See BatchBuilder for details.
+     * @since UNRELEASED
+     */
+    inline
+    BatchBuilder getMany(const std::vector<std::string>& pvnames);
+
+    /** Change many PVs as one batch.
+     *
+     * Marked fields of values[i] are assigned (cf. Value::assign() ) to a Value of
+     * the type of PV pvnames[i].  eg. re-apply the results of an earlier getMany().
+     *
+     * @code
+     * Context ctxt(...);
+     * auto results = ctxt.putMany(names, values)
+     *                    .exec()
+     *                    ->wait(10.0);
+     * @endcode
+     *
+     * See BatchBuilder for details.
+     * @throws std::invalid_argument if pvnames.size()!=values.size()
+     * @since UNRELEASED
+     */
+    inline
+    BatchBuilder putMany(const std::vector<std::string>& pvnames, const std::vector<Value>& values);
+
     inline
     RPCBuilder rpc(const std::string& pvname);
 
@@ -751,6 +906,7 @@ public:
 class GetBuilder : public detail::CommonBuilder<GetBuilder, detail::CommonBase> {
     std::function<void (const Value&)> _onInit;
     std::function<void(Result&&)> _result;
+    double _maxAge = -1.0;
     bool _get = false;
     PVXS_API
     std::shared_ptr<Operation> _exec_info();
@@ -763,6 +919,21 @@ public:
     //! The functor is stored in the Operation returned by exec().
     GetBuilder& result(std::function<void(Result&&)>&& cb) { _result = std::move(cb); return *this; }
 
+    /** Allow a GET to be completed from the cached value of a running Subscription.
+     *
+     * If this Context has a running (not paused or pipelined) Subscription to the same PV,
+     * with the same field selection, and has received from that server within the last
+     * ``seconds``, then the GET completes immediately with a copy of the most recent value
+     * without a network round trip.  Otherwise, a normal GET is made.
+     *
+     * Servers which are otherwise idle are heard from periodically (by default every 15 seconds).
+     * A GET with ``record[...]`` options is never completed from cache.
+     * Negative (the default) disables.  Ignored for info() and with ``autoExec(false)``.
+     *
+     * @since UNRELEASED
+     */
+    GetBuilder& maxAge(double seconds) { _maxAge = seconds; return *this; }
+
 #ifdef PVXS_EXPERT_API_ENABLED
     // called during operation INIT phase for Get/Put/Monitor when remote type
     // description is available.
@@ -904,11 +1075,55 @@ RPCBuilder Context::rpc(const std::string& name, const Value &arg) {
     return ret;
 }
 
+/** Prepare a batch of remote GET or PUT operations.
+ *
+ * pvRequest and other options apply to every operation in the batch.
+ *
+ * See Context::getMany() and Context::putMany()
+ * @since UNRELEASED
+ */
+class BatchBuilder : public detail::CommonBuilder<BatchBuilder, detail::CommonBase> {
+    std::vector<std::string> _names;
+    std::vector<Value> _values;
+    std::function<void(std::vector<Result>&&)> _result;
+    bool _put = false;
+public:
+    BatchBuilder() {}
+    BatchBuilder(const std::shared_ptr<Context::Pvt>& ctx, const std::vector<std::string>& names)
+        :CommonBuilder{ctx, std::string()}, _names(names) {}
+
+    /** Callback through which results are delivered once all operations have completed.
+     *  One Result for each PV, in the order names were given.
+     *  The functor is stored in the Batch returned by exec().
+     */
+    BatchBuilder& result(std::function<void(std::vector<Result>&&)>&& cb) { _result = std::move(cb); return *this; }
+
+    /** Execute the network operations.
+     *  The caller must keep returned Batch pointer until completion
+     *  or any remaining operations will be implicitly canceled.
+     */
+    PVXS_API
+    std::shared_ptr<Batch> exec();
+
+    friend struct Context::Pvt;
+    friend class Context;
+};
+BatchBuilder Context::getMany(const std::vector<std::string>& names) { return BatchBuilder{pvt, names}; }
+BatchBuilder Context::putMany(const std::vector<std::string>& names, const std::vector<Value>& values) {
+    if(names.size()!=values.size())
+        throw std::invalid_argument("putMany() requires one Value for each name");
+    BatchBuilder ret{pvt, names};
+    ret._values = values;
+    ret._put = true;
+    return ret;
+}
+
 //! Prepare a remote subscription
 //! See Context::monitor()
 class MonitorBuilder : public detail::CommonBuilder<MonitorBuilder, detail::CommonBase> {
     std::function<void(Subscription&, const Value&)> _onInit;
     std::function<void(Subscription&)> _event;
+    std::shared_ptr<CompletionQueue::Pvt> _cq;
     bool _maskConn = true;
     bool _maskDisconn = false;
 public:
@@ -923,6 +1138,12 @@ public:
      *  The functor is stored in the Subscription returned by exec().
      */
     MonitorBuilder& event(std::function<void(Subscription&)>&& cb) { _event = std::move(cb); return *this; }
+    /** Queue the Subscription on cq each time its event queue becomes not empty.
+     *
+     *  May be combined with event(), in which case the callback is invoked first.
+     *  @since UNRELEASED
+     */
+    MonitorBuilder& completionQueue(const CompletionQueue& cq) { _cq = cq.pvt; return *this; }
     //! Include Connected exceptions in queue (default false).
     MonitorBuilder& maskConnected(bool m = true) { _maskConn = m; return *this; }
     //! Include Disconnected exceptions in queue (default true).
@@ -1076,6 +1297,27 @@ struct PVXS_API Config : public impl::ConfigCommon {
     //! Whether to extend the addressList with local interface broadcast addresses.  (recommended)
     bool autoAddrList = true;
 
+    /** Bulk connect.  Maximum rate, in packets per second, at which initial search requests are sent.
+     *
+     *  Zero (default) sends each batch of initial searches for newly created Channels at once.
+     *  When non-zero, initial searches are paced.  The rate backs off when search replies are lost,
+     *  and recovers as replies are received.  Useful when connecting to many (eg. thousands of) PVs at once.
+     *
+     *  @since UNRELEASED
+     */
+    double searchRate = 0.0;
+
+    /** Bulk connect.  Maximum number of Channels requested in each CREATE_CHANNEL message.
+     *
+     *  Default of 1 is understood by all servers.  PVXS servers accept larger batches,
+     *  which reduces per message overhead when many Channels are created to one server.
+     *  Other servers (eg. pvAccessCPP) may close a connection on receipt of a batch.
+     *  Zero is treated as 1.
+     *
+     *  @since UNRELEASED
+     */
+    unsigned createChannelBatch = 1u;
+
 private:
     bool BE = EPICS_BYTE_ORDER==EPICS_ENDIAN_BIG;
     bool UDP = true;
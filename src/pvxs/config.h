@@ -141,6 +141,66 @@ struct PVXS_API ConfigCommon {
     //! @since 0.2.0
     double tcpTimeout = 40.0;
 
+    /** Service plain (not TLS) TCP connections with io_uring instead of libevent readiness notification.
+     *
+     *  Reduces syscalls per message at high message rates.
+     *  Linux only.  Ignored, with a warning, if not supported by this build or by the running kernel,
+     *  in which case it is cleared in the effective config().
+     *  Unix socket connections are not serviced by io_uring.
+     *
+     *  @since UNRELEASED
+     */
+    bool ioUring = false;
+
+    /** Location of Unix domain sockets for connections between a client and a server on the same host.
+     *
+     *  A server listens on a socket named for its GUID under this prefix, in addition to its TCP port(s).
+     *  A client connects through this socket, in place of plain TCP, to a server which replies
+     *  to a search from a local address.  Falling back to TCP if the socket can not be reached.
+     *  Servers see the identity of such clients from the OS, not as claimed by "ca" authentication,
+     *  and name the peer as "unix:" and its process ID.  eg. in server::ClientCredentials::peer
+     *  IOC access security treats such peers as host 127.0.0.1 .
+     *  On start, a server removes sockets under a directory prefix left by servers which have exited uncleanly.
+     *
+     *  A leading '@' selects the Linux abstract namespace.  eg. "@pva".
+     *  Otherwise, the path of an existing directory.  eg. "/run/pva".
+     *  Empty (the default) disables.  Not supported on Windows.
+     *
+     *  @since UNRELEASED
+     */
+    std::string unixSocket;
+
+    /** Compress message payloads with LZ4 or zstd.
+     *
+     *  Offered by a server, and accepted by a client, during connection validation.
+     *  Only used when enabled by both peers, and supported by both builds.
+     *  Intended for connections over constrained (eg. wide area) links.
+     *  Not used through Unix sockets.
+     *
+     *  Not used through TLS either, where the size of compressed messages could
+     *  reveal secrets through guessed plaintext.  cf. the CRIME attack on TLS compression.
+     *
+     *  @since UNRELEASED
+     */
+    bool compress = false;
+
+    /** Message payloads smaller than this many bytes are sent without compression.
+     *
+     *  Compression of larger payloads is also skipped for a time after it
+     *  has recently saved little.
+     *
+     *  @since UNRELEASED
+     */
+    size_t compressThreshold = 1024u;
+
+    /** Largest message payload, in bytes, accepted once decompressed.
+     *
+     *  A peer sending a compressed message which claims to expand beyond this is disconnected.
+     *
+     *  @since UNRELEASED
+     */
+    size_t compressMaxSize = 256u<<20u;
+
     static const std::string home;
     static const std::string config_home;
     static const std::string data_home;
@@ -209,6 +269,22 @@ struct PVXS_API ConfigCommon {
      */
     bool tls_disable_stapling{false};
 
+    /**
+     * @brief True if TLS session resumption is disabled.
+     * Otherwise servers issue session tickets and clients offer them when reconnecting,
+     * avoiding a full handshake.
+     */
+    bool tls_disable_session_resumption{false};
+
+    /**
+     * @brief True to hand negotiated TLS sessions to the kernel (kTLS), where supported.
+     * Once both directions are offloaded, a connection is serviced as if it were plain TCP.
+     * Requires OpenSSL >= 3.0 built with kTLS support, and the Linux "tls" module.
+     * Otherwise connections remain in user space.
+     * @since UNRELEASED
+     */
+    bool tls_kernel_offload{false};
+
     /**
      * @brief True if we want to throw an exception if we can't verify a cert with the
      * PVACMS, otherwise we downgrade to a tcp connection
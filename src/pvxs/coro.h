@@ -0,0 +1,287 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef PVXS_CORO_H
+#define PVXS_CORO_H
+
+/** @file coro.h
+ *
+ * C++20 coroutine awaitables for client operations.
+ *
+ * Header only, and empty unless compiled with coroutine support (\__cpp_impl_coroutine).
+ * libpvxs itself need not be built with C++20.
+ *
+ * @code
+ * using namespace pvxs::client;
+ *
+ * SomeTask example(Context& ctxt) { // SomeTask is any coroutine return type
+ *     Value val = co_await coro::exec(ctxt.get("pv:name"));
+ *     co_await coro::exec(ctxt.put("pv:other").set("value", val["value"]));
+ *
+ *     coro::Monitor mon(ctxt.monitor("pv:name"));
+ *     while(true) {
+ *         Value update = co_await mon.next(); // may throw Connected, Disconnect, Finished, ...
+ *         ...
+ *     }
+ * }
+ * @endcode
+ *
+ * By default, a coroutine is resumed on the client worker thread which delivers
+ * the operation result, with the same restrictions as any result() or event() callback.
+ * Alternately, pass an Executor to resume elsewhere.  eg. WorkQueue::executor() .
+ *
+ * @since UNRELEASED
+ */
+
+#if defined(_DOXYGEN_)
+#  define PVXS_HAS_CORO
+#elif defined(__cpp_impl_coroutine) && defined(__has_include)
+#  if __has_include(<coroutine>)
+#    define PVXS_HAS_CORO
+#  endif
+#endif
+
+#ifdef PVXS_HAS_CORO
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include <pvxs/client.h>
+#include <pvxs/util.h>
+
+namespace pvxs {
+namespace client {
+namespace coro {
+
+/** Called to resume a coroutine when its operation completes.
+ *
+ * An empty Executor (the default) resumes immediately on the client worker thread.
+ */
+using Executor = std::function<void(std::coroutine_handle<>)>;
+
+/** Resume coroutines on the thread(s) calling run().
+ *
+ * @code
+ * coro::WorkQueue Q;
+ * auto val = co_await coro::exec(ctxt.get("pv:name"), Q.executor());
+ * ...
+ * Q.run(); // in an application thread.  Returns after Q.stop()
+ * @endcode
+ */
+class WorkQueue {
+    MPMCFIFO<std::coroutine_handle<>> Q;
+public:
+    //! Executor which queues coroutines to be resumed by run()
+    Executor executor() {
+        return [this](std::coroutine_handle<> h) { Q.push(h); };
+    }
+    //! Resume queued coroutines until stop()
+    void run() {
+        while(auto h = Q.pop())
+            h.resume();
+    }
+    //! Cause one call to run() to return, after resuming all coroutines queued before stop()
+    void stop() {
+        Q.push(std::coroutine_handle<>());
+    }
+};
+
+namespace detail {
+
+inline
+void resumeOn(const Executor& exec, std::coroutine_handle<> h)
+{
+    if(exec)
+        exec(h);
+    else
+        h.resume();
+}
+
+template<typename Builder>
+class OpAwaiter {
+    struct State {
+        Result result;
+        std::coroutine_handle<> handle;
+        Executor exec;
+        // set by the first of await_suspend() and the result callback to finish.
+        // The second resumes.
+        std::atomic<bool> once{false};
+    };
+    Builder builder;
+    std::shared_ptr<State> state;
+    std::shared_ptr<Operation> op;
+public:
+    OpAwaiter(Builder&& builder, Executor&& exec)
+        :builder(std::move(builder))
+        ,state(std::make_shared<State>())
+    {
+        state->exec = std::move(exec);
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h)
+    {
+        auto S(state);
+        S->handle = h;
+        op = builder.result([S](Result&& result) {
+                        S->result = std::move(result);
+                        if(S->once.exchange(true))
+                            resumeOn(S->exec, S->handle);
+                    })
+                .exec();
+        // continue without suspending if completed before exec() returned
+        return !S->once.exchange(true);
+    }
+
+    Value await_resume()
+    {
+        return state->result();
+    }
+};
+
+} // namespace detail
+
+/** Execute a GET.  co_await the result Value.
+ *
+ * @throws as Result::operator()()
+ */
+inline
+detail::OpAwaiter<GetBuilder> exec(GetBuilder builder, Executor exec = Executor())
+{
+    return detail::OpAwaiter<GetBuilder>(std::move(builder), std::move(exec));
+}
+
+/** Execute a PUT.  co_await completion.  The Value is always empty.
+ *
+ * @throws as Result::operator()()
+ */
+inline
+detail::OpAwaiter<PutBuilder> exec(PutBuilder builder, Executor exec = Executor())
+{
+    return detail::OpAwaiter<PutBuilder>(std::move(builder), std::move(exec));
+}
+
+/** Execute an RPC.  co_await the reply Value.
+ *
+ * @throws as Result::operator()()
+ */
+inline
+detail::OpAwaiter<RPCBuilder> exec(RPCBuilder builder, Executor exec = Executor())
+{
+    return detail::OpAwaiter<RPCBuilder>(std::move(builder), std::move(exec));
+}
+
+/** A Subscription whose updates are co_await'd.
+ *
+ * Takes over the MonitorBuilder::event() callback.
+ * Only one coroutine may await next() at a time.
+ */
+class Monitor {
+    struct State {
+        std::mutex lock;
+        std::coroutine_handle<> waiter;
+        // event callback while no waiter
+        bool pending = false;
+        Executor exec;
+    };
+    std::shared_ptr<State> state;
+    std::shared_ptr<Subscription> sub;
+public:
+    Monitor() = default;
+    explicit Monitor(MonitorBuilder builder, Executor exec = Executor())
+        :state(std::make_shared<State>())
+    {
+        state->exec = std::move(exec);
+        auto S(state);
+        sub = builder.event([S](Subscription&) {
+                          std::coroutine_handle<> h;
+                          {
+                              std::lock_guard<std::mutex> G(S->lock);
+                              h = S->waiter;
+                              S->waiter = nullptr;
+                              S->pending = !h;
+                          }
+                          if(h)
+                              detail::resumeOn(S->exec, h);
+                      })
+                .exec();
+    }
+
+    //! The underlying Subscription.  eg. to pause() or cancel()
+    const std::shared_ptr<Subscription>& subscription() const { return sub; }
+
+    class Next {
+        std::shared_ptr<State> state;
+        std::shared_ptr<Subscription> sub;
+        Value val;
+        std::exception_ptr exc;
+
+        bool tryPop() {
+            try {
+                val = sub->pop();
+            } catch(...) {
+                exc = std::current_exception();
+            }
+            return val || exc;
+        }
+    public:
+        Next(const std::shared_ptr<State>& state, const std::shared_ptr<Subscription>& sub)
+            :state(state), sub(sub)
+        {}
+
+        bool await_ready() { return tryPop(); }
+
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            auto S(state);
+            std::unique_lock<std::mutex> G(S->lock);
+            // an event may have been delivered since await_ready()
+            while(S->pending) {
+                S->pending = false;
+                G.unlock();
+                if(tryPop())
+                    return false;
+                G.lock();
+            }
+            // once registered, we may be resumed (on another thread) at any time
+            S->waiter = h;
+            return true;
+        }
+
+        /** @returns The next update.  Empty only in the unlikely case of a spurious wakeup.
+         *  @throws as Subscription::pop()
+         */
+        Value await_resume()
+        {
+            if(!val && !exc)
+                (void)tryPop();
+            if(exc)
+                std::rethrow_exception(exc);
+            return std::move(val);
+        }
+    };
+
+    /** co_await the next update.
+     *
+     * @code
+     * Value update = co_await mon.next();
+     * @endcode
+     * @throws Connected, Disconnect, Finished, RemoteError as Subscription::pop()
+     */
+    Next next() { return Next(state, sub); }
+};
+
+} // namespace coro
+} // namespace client
+} // namespace pvxs
+
+#endif // PVXS_HAS_CORO
+
+#endif // PVXS_CORO_H
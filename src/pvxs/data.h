@@ -557,6 +557,33 @@ public:
      */
     void clear();
 
+    /** Make read-only the whole structure of which this field is a part.
+     *
+     * Any later attempt to change it, through any reference, throws std::logic_error.
+     * So a frozen Value may be shared instead of copied.  eg. SharedPV::post()
+     * hands a frozen Value to all subscribers without a clone().
+     *
+     * Selected Union and Any members are also frozen.  Elements of Struct[] and Union[]
+     * arrays are not, as arrays are already shared by assign().
+     *
+     * @returns *this
+     * @since UNRELEASED
+     */
+    Value& freeze();
+    /** Make modifiable again, copying only if necessary.
+     *
+     * If frozen and this is the only reference, simply clears the frozen flag.
+     * If frozen and referenced elsewhere, this reference is replaced with a clone().
+     * No effect if not frozen.
+     *
+     * @returns *this
+     * @since UNRELEASED
+     */
+    Value& thaw();
+    //! True after freeze(), until thaw()
+    //! @since UNRELEASED
+    bool isFrozen() const;
+
     //! Does this Value actually reference some underlying storage
     inline bool valid() const { return desc; }
     inline explicit operator bool() const { return desc; }
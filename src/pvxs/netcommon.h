@@ -60,6 +60,10 @@ struct PVXS_API PeerCredentials {
      * in which the account is a member.
      * On Windows targets this returns the list of local groups for the account.
      * On other targets, an empty list is returned.
+     *
+     * Since UNRELEASED, results are cached process wide for a short time (60 seconds,
+     * or 10 seconds for an unknown account).  Servers begin the lookup in the background
+     * when a client connects.
      */
     std::set<std::string> roles() const;
 
@@ -116,12 +120,80 @@ struct Report {
         std::shared_ptr<const server::ClientCredentials> credentials;
         //! transmit and receive counters in bytes
         size_t tx{}, rx{};
+        /** Bytes not transmitted, and not received, due to payload compression.
+         *  Included in tx and rx as sent on the wire.  cf. ConfigCommon::compress
+         *  @since UNRELEASED
+         */
+        size_t txSaved{}, rxSaved{};
+        /** Bytes of arrays transmitted by reference, without copying into a send buffer,
+         *  and the bytes of those messages sent with MSG_ZEROCOPY.  Included in tx.
+         *  Only from Server::report().  cf. server::Config::zeroCopyThreshold
+         *  @since UNRELEASED
+         */
+        size_t txReferenced{}, txZeroCopy{};
+        /** Socket serviced by io_uring.  cf. ConfigCommon::ioUring
+         *  @since UNRELEASED
+         */
+        bool ioUring = false;
+        /** TLS session offloaded to the kernel.  cf. ConfigCommon::tls_kernel_offload
+         *  @since UNRELEASED
+         */
+        bool tlsKernelOffload = false;
         //! Channels currently connected through this socket
         std::list<Channel> channels;
     };
 
     //! Currently open sockets
     std::list<Connection> connections;
+
+    //! Number of TLS handshakes completed in full, and by resuming a previous session.
+    //! @since UNRELEASED
+    size_t tlsFullHandshakes{}, tlsResumedHandshakes{};
+
+    //! Number of distinct TLS peer certificates whose status is tracked, and of connections sharing these.
+    //! @since UNRELEASED
+    size_t tlsPeerStatuses{}, tlsPeerSubscriptions{};
+
+    /** Info for a single server::HandlerPool.  cf. server::HandlerPool::Stats
+     *  @since UNRELEASED
+     */
+    struct HandlerPool {
+        //! Thread name prefix
+        std::string name;
+        //! handler counters
+        size_t nQueued{}, nRun{}, nRejected{};
+        //! Longest wait to start, and longest run, in seconds
+        double maxWait{}, maxRun{};
+        //! Sum of run times in seconds
+        double totalRun{};
+    };
+
+    //! Existing server::HandlerPool instances.  Only from Server::report()
+    //! @since UNRELEASED
+    std::list<HandlerPool> handlerPools;
+
+    /** Info for a single PV published through server::Server::addMulticast()
+     *  @since UNRELEASED
+     */
+    struct Multicast {
+        //! PV name
+        std::string name;
+        //! Multicast group, and the endpoint from which datagrams are sent
+        std::string group, source;
+        //! Number of client subscriptions receiving updates through the group
+        size_t subscribers{};
+        //! Sequence number of the latest update
+        uint64_t seq{};
+        //! Number of datagrams re-sent in reply to CMD_MCAST_NACK,
+        //! and of complete values sent to clients through TCP.
+        size_t retransmits{}, syncs{};
+        //! Number of CMD_MCAST_NACK ignored as not from a subscriber, or over rate limit.
+        size_t nacksIgnored{};
+    };
+
+    //! PVs published to multicast groups.  Only from Server::report()
+    //! @since UNRELEASED
+    std::list<Multicast> multicasts;
 };
 
 struct PVXS_API ReportInfo {
@@ -0,0 +1,95 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef PVXS_PROXY_H
+#define PVXS_PROXY_H
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <pvxs/version.h>
+
+namespace pvxs {
+namespace client {
+class Context;
+}
+namespace server {
+
+struct Source;
+
+/** Re-serve the PVs of upstream servers, reached through a client::Context.
+ *
+ * Each PV name is subscribed to upstream only once, however many downstream clients
+ * connect to it.  The most recent update is kept in a SharedPV, from which
+ * downstream GET and MONITOR operations are served.  Downstream PUTs are rejected,
+ * unless forwardPut() is enabled.
+ *
+ * A downstream search for a name not yet known begins an upstream subscription, and is not answered.
+ * Searches are answered once the subscription has received its first update.
+ * A name which is not found upstream within negativeTimeout() is then ignored for a further negativeTimeout().
+ * An upstream subscription with no downstream clients, and not searched for, is cancelled after idleTimeout().
+ * At most maxSearching() names are searched for upstream at once.  Further names are ignored until some are found,
+ * or given up on.
+ *
+ * @code
+ *   auto upstream(client::Context::fromEnv());
+ *   auto proxy(server::ProxySource::build(upstream));
+ *   auto serv = server::Config::fromEnv()
+ *              .build()
+ *              .addSource("proxy", proxy.source());
+ * @endcode
+ *
+ * @note The upstream Context should not be able to reach the Server to which this Source is added,
+ *       or names will be proxied in a loop.
+ *
+ * @since UNRELEASED
+ */
+struct PVXS_API ProxySource
+{
+    //! Proxy through the upstream Context
+    static ProxySource build(const client::Context& upstream);
+
+    ~ProxySource();
+
+    inline explicit operator bool() const { return !!impl; }
+
+    //! Fetch the Source interface, which may be used with Server::addSource()
+    std::shared_ptr<Source> source() const;
+
+    //! Seconds for which a name not found upstream is ignored.  Default 30.
+    ProxySource& negativeTimeout(double sec);
+    //! Seconds an unused upstream subscription is kept.  Default 60.
+    ProxySource& idleTimeout(double sec);
+    //! Limit on names searched for upstream at once.  Default 1024.
+    ProxySource& maxSearching(size_t count);
+    /** Forward downstream PUTs upstream.  Default false, where PUTs are rejected.
+     *
+     * Applies to names subsequently searched for.  So call before adding source() to a Server.
+     *
+     * @warning A forwarded PUT is made with the credentials of the upstream Context,
+     *          not those of the downstream client.  Upstream access security (ACF) rules
+     *          see only the proxy, and so will allow a PUT from any downstream client
+     *          which the proxy itself is allowed.  Before enabling this, restrict which
+     *          clients can reach the downstream Server, eg. by interface or with TLS.
+     */
+    ProxySource& forwardPut(bool forward);
+
+    //! Cancel all upstream subscriptions, and disconnect all downstream clients.
+    void close();
+
+    //! Names with an upstream subscription, and whether each is connected
+    typedef std::map<std::string, bool> list_t;
+    list_t list() const;
+
+    struct Impl;
+private:
+    std::shared_ptr<Impl> impl;
+};
+
+} // namespace server
+} // namespace pvxs
+
+#endif // PVXS_PROXY_H
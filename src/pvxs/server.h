@@ -139,6 +139,38 @@ public:
     //! Remove a SharedPV from the "__builtin" StaticSource
     Server& removePV(const std::string& name);
 
+    /** Also publish the monitor updates of a PV to a UDP multicast group.
+     *
+     * The Server subscribes to this PV through its Sources, and sends each update
+     * to the group once, whatever the number of subscribers.
+     * Client subscriptions with pvRequest option "record._options.multicast" naming
+     * the same group join it, and receive only the data type through TCP.
+     * Clients without this option, or connected through TLS, continue to receive updates through TCP.
+     *
+     * The subscription of the Server itself is made with anonymous credentials, with peer "multicast".
+     * Each client subscription is still passed to the Source through ChannelControl::onSubscribe(),
+     * with the credentials of that client, and joins the group only if accepted
+     * with MonitorSetupOp::connect().  Updates then posted to that subscription are discarded.
+     * However, anyone able to join the group on the network can receive its updates.
+     * So only publish PVs which may be read by any host to which the group is routed.
+     *
+     * Updates are sent with sequence numbers.  A client which misses some
+     * asks for them to be sent again, or for the complete current value,
+     * which is sent through TCP.  Requests are answered only from a host with a
+     * client subscription, and at a limited rate.
+     * Clients accept datagrams only from the host of the Server to which they are connected through TCP,
+     * so the group should be sent through an interface with the same address as clients connect to.
+     * Each update must fit in a single datagram (~64KB).
+     * cf. Report::multicasts
+     *
+     * @param name PV name
+     * @param group Multicast address and port, with optional TTL and interface.  eg. "239.255.1.2:5080,1@127.0.0.1"
+     * @throws std::invalid_argument If group is not a multicast address with port.
+     * @throws std::logic_error If name is already published.
+     * @since UNRELEASED
+     */
+    Server& addMulticast(const std::string& name, const std::string& group);
+
     //! Add a Source to this server with an arbitrary source name.
     //!
     //! Source names beginning with "__" are reserved for internal use.
@@ -202,6 +234,43 @@ struct PVXS_API Config : public impl::ConfigCommon {
     std::vector<std::string> beaconDestinations;
     //! Whether to populate the beacon address list automatically.  (recommended)
     bool auto_beacon = true;
+    /** Number of recently searched names whose answers are remembered.  Zero (default) disables.
+     *
+     *  Repeat searches for these names are answered, or ignored, without consulting any Source
+     *  whose onList() gives a complete and non-dynamic list of names.  A Source which changes this
+     *  list must call Source::listChanged(), which, as does any Source being added or removed,
+     *  invalidates all remembered answers.  StaticSource does so on add() and remove().
+     *  Other Sources are consulted for every search.
+     *
+     *  @since UNRELEASED
+     */
+    size_t searchCacheSize = 0u;
+    /** Minimum size, in bytes, of array fields sent without copying.  Zero (default) disables.
+     *
+     *  Such arrays are queued for sending by reference to their storage, instead of being copied into
+     *  the send buffer.  On Linux, plain TCP connections then pass messages containing them to the
+     *  kernel with MSG_ZEROCOPY, avoiding the copy into kernel memory, and hold the arrays until
+     *  the kernel reports completion.  Even after the connection is closed.
+     *  Pinning pages has its own cost, so this pays off only for large payloads.  eg. >= 1 MiB.
+     *  cf. Report::Connection::txReferenced
+     *
+     *  @since UNRELEASED
+     */
+    size_t zeroCopyThreshold = 0u;
+    /** Size, in bytes, of memory shared with each client connected through a Unix socket.  Zero (default) disables.
+     *
+     *  Arrays of at least shmThreshold bytes in GET and monitor updates are copied into this memory,
+     *  and referenced in place by the client, instead of being sent through the socket.
+     *  A client copies out any such array which it retains to complete later partial updates.
+     *  The client is given a read-only descriptor, and the size of the memory is sealed.
+     *  Linux only.  Requires unixSocket.
+     *
+     *  @since UNRELEASED
+     */
+    size_t shmSize = 0u;
+    //! Minimum size, in bytes, of arrays placed in shared memory.  cf. shmSize
+    //! @since UNRELEASED
+    size_t shmThreshold = 65536u;
 
 #ifdef PVXS_ENABLE_OPENSSL
     /**
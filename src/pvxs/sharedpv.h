@@ -62,6 +62,12 @@ struct PVXS_API SharedPV {
     //! Callback when a client executes an RPC operation.
     //! @note RPC operations are allowed even when the SharedPV is not opened (isOpen()==false)
     void onRPC(std::function<void(SharedPV&, std::unique_ptr<ExecOp>&&, Value&&)>&& fn);
+    /** Run onPut() and onRPC() callbacks on HandlerPool threads instead of a server worker.
+     *  Operations are completed with an error if the pool queue is full.
+     *  Pass an empty HandlerPool to revert to calling from a server worker.
+     *  @since UNRELEASED
+     */
+    void handlerPool(const HandlerPool& pool);
 
     /** Provide data type and initial value.  Allows clients to begin connecting.
      * @pre !isOpen()
@@ -73,7 +79,15 @@ struct PVXS_API SharedPV {
     //! Reverse the effects of open() and force disconnect any remaining clients.
     void close();
 
-    //! Update the internal data value, and dispatch subscription updates to any clients.
+    /** Update the internal data value, and dispatch subscription updates to any clients.
+     *
+     * Subscribers are given a clone() of val.  Unless val isFrozen(),
+     * when val itself is shared with subscribers, saving one copy per post().
+     * eg. @code pv.post(update.freeze()); @endcode
+     * where update is not used afterwards.
+     *
+     * @since UNRELEASED A frozen val is shared.
+     */
     void post(const Value& val);
     //! query the internal data value and update the provided Value.
     void fetch(Value& val) const;
@@ -6,6 +6,7 @@
 #ifndef PVXS_SOURCE_H
 #define PVXS_SOURCE_H
 
+#include <atomic>
 #include <string>
 #include <functional>
 
@@ -283,6 +284,22 @@ struct PVXS_API Source {
 
     //! Print status information.
     virtual void show(std::ostream& strm);
+
+    /** Call when the non-dynamic list returned by onList(), or the names claimed by onSearch(), change.
+     *
+     *  A Server with Config::searchCacheSize then forgets its answers to searches for this Source's names.
+     *  Only then does the Server call onList() again.
+     *
+     *  @since UNRELEASED
+     */
+    void listChanged() { _listGeneration.fetch_add(1u, std::memory_order_release); }
+
+    //! Count of listChanged() calls
+    //! @since UNRELEASED
+    uint64_t listGeneration() const { return _listGeneration.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<uint64_t> _listGeneration{0u};
 };
 
 }} // namespace pvxs::server
@@ -109,6 +109,77 @@ private:
     virtual Timer _timerOneShot(double delay, std::function<void()>&& cb) =0;
 };
 
+/** Threads on which to run handlers which may block.
+ *
+ * Source and SharedPV handlers are normally called from a server worker thread
+ * shared by many client connections.  A handler which blocks (eg. file or database I/O)
+ * delays every other client of that worker.
+ * Such a handler may instead hand off work to a HandlerPool.
+ * ExecOp::reply() and ExecOp::error() may be called from any thread.
+ *
+ * @code
+ * server::HandlerPool pool("slowrpc", 2u, 100u);
+ * chan->onRPC([pool](std::unique_ptr<server::ExecOp>&& op, Value&& arg) mutable {
+ *     std::shared_ptr<server::ExecOp> sop(std::move(op));
+ *     if(!pool.submit([sop, arg]() {
+ *         sop->reply(slowWork(arg));
+ *     }))
+ *         sop->error("Server busy");
+ * });
+ * @endcode
+ *
+ * cf. SharedPV::handlerPool()
+ *
+ * @since UNRELEASED
+ */
+class PVXS_API HandlerPool {
+public:
+    struct Pvt;
+
+    //! Handler timing statistics
+    struct Stats {
+        //! Number of handlers presently waiting to run
+        size_t nQueued = 0u;
+        //! Number of handlers which have run
+        size_t nRun = 0u;
+        //! Number of handlers refused because the queue was full
+        size_t nRejected = 0u;
+        //! Longest time (seconds) a handler waited to start
+        double maxWait = 0.0;
+        //! Longest time (seconds) a handler ran
+        double maxRun = 0.0;
+        //! Sum of handler run times (seconds).  totalRun/nRun is the average.
+        double totalRun = 0.0;
+    };
+
+    //! An empty/dummy HandlerPool
+    HandlerPool() = default;
+    /** Start threads.
+     *
+     * @param name Prefix for thread names.
+     * @param nthreads Number of threads.  1 for a dedicated thread.
+     * @param maxQueue If non-zero, submit() fails while this many handlers are waiting to run.
+     */
+    explicit HandlerPool(const std::string& name, unsigned nthreads=1u, size_t maxQueue=0u);
+    ~HandlerPool();
+
+    /** Queue fn to run on a pool thread.
+     *
+     * @returns false if the queue is full.  fn will not be called.
+     */
+    bool submit(std::function<void()>&& fn);
+
+    //! Fetch timing statistics, and optionally reset the counters and maximums.
+    Stats stats(bool reset=false) const;
+
+    explicit operator bool() const { return pvt.operator bool(); }
+private:
+    std::shared_ptr<Pvt> pvt;
+};
+
+PVXS_API
+std::ostream& operator<<(std::ostream& strm, const HandlerPool::Stats& stats);
+
 }} // namespace pvxs::server
 
 #endif // PVXS_SRVCOMMON_H
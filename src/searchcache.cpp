@@ -0,0 +1,86 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include "searchcache.h"
+
+namespace pvxs {
+namespace impl {
+
+constexpr size_t SearchCache::probeWindow;
+
+SearchCache::SearchCache(size_t capacity)
+{
+    // keep load factor <= 0.5 so that most names are found in their home slot
+    size_t nslots = probeWindow;
+    while(nslots < 2u*capacity)
+        nslots <<= 1u;
+    table.resize(nslots);
+    mask = nslots-1u;
+}
+
+uint64_t SearchCache::hashOf(const char* name)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for(; *name; name++) {
+        hash ^= uint8_t(*name);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool SearchCache::matches(const Entry& ent, uint64_t hash, const char* name) const
+{
+    return ent.generation==generation && ent.hash==hash && ent.name==name;
+}
+
+bool SearchCache::lookup(const char* name, bool& claimed)
+{
+    const auto hash = hashOf(name);
+
+    for(size_t i=0u; i<probeWindow; i++) {
+        auto& ent = table[(hash+i)&mask];
+        if(matches(ent, hash, name)) {
+            ent.stamp = ++stamp;
+            claimed = ent.claimed;
+            return true;
+        }
+    }
+    return false;
+}
+
+void SearchCache::insert(const char* name, bool claimed)
+{
+    const auto hash = hashOf(name);
+
+    Entry* victim = nullptr;
+    for(size_t i=0u; i<probeWindow; i++) {
+        auto& ent = table[(hash+i)&mask];
+        if(matches(ent, hash, name)) {
+            victim = &ent;
+            break;
+
+        } else if(ent.generation!=generation) {
+            // unused, or stale.  Keep looking for an existing entry
+            if(!victim || victim->generation==generation)
+                victim = &ent;
+
+        } else if(!victim || (victim->generation==generation && ent.stamp < victim->stamp)) {
+            // least recently answered
+            victim = &ent;
+        }
+    }
+
+    if(victim->generation!=generation || victim->hash!=hash || victim->name!=name) {
+        victim->name = name;
+        victim->hash = hash;
+        victim->generation = generation;
+    }
+    victim->claimed = claimed;
+    victim->stamp = ++stamp;
+}
+
+}} // namespace pvxs::impl
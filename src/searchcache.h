@@ -0,0 +1,62 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef PVXS_SEARCHCACHE_H
+#define PVXS_SEARCHCACHE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <pvxs/version.h>
+
+namespace pvxs {
+namespace impl {
+
+/** Open addressing hash of recently searched names, and whether each was claimed.
+ *
+ *  Bounded in size.  Names are probed for in a short window from their home slot.
+ *  When the window is full, the least recently answered entry in it is replaced.
+ *
+ *  invalidate() forgets all entries in constant time by advancing the generation
+ *  which entries must match to be found.
+ *
+ *  Not thread safe.  Server::Pvt::onSearch() uses it only from the UDP worker.
+ */
+class PVXS_API SearchCache {
+    struct Entry {
+        std::string name;
+        uint64_t hash = 0u;
+        uint64_t generation = 0u; // zero never matches
+        uint64_t stamp = 0u;
+        bool claimed = false;
+    };
+    std::vector<Entry> table;
+    size_t mask = 0u;
+    uint64_t generation = 1u;
+    uint64_t stamp = 0u;
+
+    static uint64_t hashOf(const char* name);
+    bool matches(const Entry& ent, uint64_t hash, const char* name) const;
+public:
+    //! Slots probed from the home slot of a name
+    static constexpr size_t probeWindow = 8u;
+
+    //! Room for at least 'capacity' names.  Zero treated as one.
+    explicit SearchCache(size_t capacity);
+
+    //! @returns true if name was answered since the last invalidate(), with claimed set as answered.
+    bool lookup(const char* name, bool& claimed);
+    //! Remember the answer for this name.
+    void insert(const char* name, bool claimed);
+    //! Forget all answers
+    void invalidate() { generation++; }
+
+    size_t capacity() const { return table.size(); }
+};
+
+}} // namespace pvxs::impl
+
+#endif // PVXS_SEARCHCACHE_H
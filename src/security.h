@@ -180,6 +180,27 @@ struct KeyPair final {
     }
 };
 
+/**
+ * @brief The message digest to use when signing with the given private key
+ *
+ * EdDSA keys (eg. Ed25519) hash internally and must be given no digest.
+ * All other key types sign a SHA-256 digest.
+ *
+ * @param pkey the signing key
+ * @return the digest to pass to X509_sign(), OCSP_basic_sign(), or EVP_DigestSignInit()
+ */
+inline const EVP_MD *signingDigest(EVP_PKEY *pkey) {
+    switch (EVP_PKEY_base_id(pkey)) {
+#ifdef EVP_PKEY_ED25519
+        case EVP_PKEY_ED25519:
+        case EVP_PKEY_ED448:
+            return nullptr;
+#endif
+        default:
+            return EVP_sha256();
+    }
+}
+
 }  // namespace certs
 }  // namespace pvxs
 
@@ -121,6 +121,7 @@ Server& Server::addSource(const std::string& name,
         if(ent)
             throw std::runtime_error(SB()<<"Source already registered : ("<<name<<", "<<order<<")");
         ent = src;
+        pvt->sourcesChange++;
         pvt->beaconChange++;
     }
     return *this;
@@ -138,6 +139,7 @@ std::shared_ptr<Source> Server::removeSource(const std::string& name,  int order
     if(it!=pvt->sources.end()) {
         ret = it->second;
         pvt->sources.erase(it);
+        pvt->sourcesChange++;
     }
     pvt->beaconChange++;
 
@@ -197,12 +199,19 @@ client::Config Server::clientConfig() const
     ret.interfaces = pvt->effective.interfaces;
     ret.addressList = pvt->effective.interfaces;
     ret.autoAddrList = false;
+    ret.ioUring = pvt->effective.ioUring;
+    ret.unixSocket = pvt->effective.unixSocket;
+    ret.compress = pvt->effective.compress;
+    ret.compressThreshold = pvt->effective.compressThreshold;
+    ret.compressMaxSize = pvt->effective.compressMaxSize;
 
 #ifdef PVXS_ENABLE_OPENSSL
     ret.tls_port = pvt->effective.tls_port;
     ret.tls_disabled = pvt->effective.tls_disabled;
     ret.tls_disable_status_check = pvt->effective.tls_disable_status_check;
     ret.tls_disable_stapling = pvt->effective.tls_disable_stapling;
+    ret.tls_disable_session_resumption = pvt->effective.tls_disable_session_resumption;
+    ret.tls_kernel_offload = pvt->effective.tls_kernel_offload;
 #endif
     ret.is_initialized = true;
 
@@ -227,6 +236,23 @@ Server& Server::addPV(const std::string& name, const SharedWildcardPV& pv)
     return *this;
 }
 
+Server& Server::addMulticast(const std::string& name, const std::string& group)
+{
+    if(!pvt)
+        throw std::logic_error("NULL Server");
+    auto serv(pvt.get());
+    serv->acceptor_loop.call([serv, &name, &group]() {
+        if(serv->multicasts.find(name)!=serv->multicasts.end())
+            throw std::logic_error(SB()<<"PV '"<<name<<"' already multicast");
+
+        auto pub(std::make_shared<McastPublisher>(serv, name, group));
+        serv->multicasts[name] = pub;
+        if(serv->state==Pvt::Running)
+            pub->start();
+    });
+    return *this;
+}
+
 Server& Server::removePV(const std::string& name)
 {
     if(!pvt)
@@ -298,9 +324,20 @@ Report Server::report(bool zero) const
             sconn.credentials = conn->cred;
             sconn.tx = conn->statTx;
             sconn.rx = conn->statRx;
+            sconn.ioUring = conn->ioUring();
+            sconn.tlsKernelOffload = conn->kernelTLSOffloaded();
+            sconn.txReferenced = conn->statTxRef;
+            sconn.txZeroCopy = conn->statTxZeroCopy;
+            if(conn->compressor) {
+                sconn.txSaved = conn->compressor->txSaved;
+                sconn.rxSaved = conn->compressor->rxSaved;
+            }
 
             if(zero) {
                 conn->statTx = conn->statRx = 0u;
+                conn->statTxRef = conn->statTxZeroCopy = 0u;
+                if(conn->compressor)
+                    conn->compressor->txSaved = conn->compressor->rxSaved = 0u;
             }
 
             for(auto& pair : conn->chanBySID) {
@@ -319,8 +356,40 @@ Report Server::report(bool zero) const
             }
         }
 
+#ifdef PVXS_ENABLE_OPENSSL
+        if(pvt->tls_context && pvt->tls_context->ctx) {
+            if(auto ex_data = pvt->tls_context->getCertStatusExData()) {
+                {
+                    Guard G(ex_data->resumption.lock);
+                    ret.tlsFullHandshakes = ex_data->resumption.full_handshakes;
+                    ret.tlsResumedHandshakes = ex_data->resumption.resumed_handshakes;
+                    if(zero)
+                        ex_data->resumption.full_handshakes = ex_data->resumption.resumed_handshakes = 0u;
+                }
+                ex_data->countPeerStatuses(ret.tlsPeerStatuses, ret.tlsPeerSubscriptions);
+            }
+        }
+#endif
+
+        for(auto& pair : pvt->multicasts) {
+            ret.multicasts.emplace_back();
+            pair.second->report(ret.multicasts.back(), zero);
+        }
+
     });
 
+    for(auto& pair : handlerPoolStats(zero)) {
+        ret.handlerPools.emplace_back();
+        auto& spool = ret.handlerPools.back();
+        spool.name = pair.first;
+        spool.nQueued = pair.second.nQueued;
+        spool.nRun = pair.second.nRun;
+        spool.nRejected = pair.second.nRejected;
+        spool.maxWait = pair.second.maxWait;
+        spool.maxRun = pair.second.maxRun;
+        spool.totalRun = pair.second.totalRun;
+    }
+
     return ret;
 }
 
@@ -351,6 +420,10 @@ std::ostream& operator<<(std::ostream& strm, const Server& serv)
             }
         }
 
+        for(auto& pair : handlerPoolStats(false)) {
+            strm<<indent{}<<"HandlerPool: "<<pair.first<<" "<<pair.second<<"\n";
+        }
+
         if(detail<2)
             return strm;
 
@@ -394,7 +467,13 @@ std::ostream& operator<<(std::ostream& strm, const Server& serv)
 #ifdef PVXS_ENABLE_OPENSSL
                   <<(conn->iface->isTLS ? " TLS" : "")
 #endif
-                    <<"\n";
+                    <<(conn->ioUring() ? " io_uring" : "")
+                    <<(conn->kernelTLSOffloaded() ? " kTLS" : "")
+                    ;
+                if(conn->compressor)
+                    strm<<" "<<Compressor::name(conn->compressor->algo)
+                        <<" saved TX="<<conn->compressor->txSaved<<" RX="<<conn->compressor->rxSaved;
+                strm<<"\n";
 
                 if(detail<=2)
                     continue;
@@ -404,7 +483,7 @@ std::ostream& operator<<(std::ostream& strm, const Server& serv)
                 strm<<indent{}<<"Cred: "<<*conn->cred<<"\n";
 #ifdef PVXS_ENABLE_OPENSSL
                 if (conn->iface->isTLS && conn->connection()) {
-                    const auto ctx = bufferevent_openssl_get_ssl(conn->connection());
+                    const auto ctx = conn->ssl();
                     assert(ctx);
                     if (const auto cert = SSL_get0_peer_certificate(ctx)) strm << indent{} << "Cert: " << ossl::ShowX509{cert} << "\n";
                 }
@@ -474,6 +553,12 @@ Server::Pvt::Pvt(Server &svr, const Config& conf, CustomServerCallback custom_ce
 {
     effective.expand();
 
+    if(effective.ioUring) {
+        uring = URing::create(acceptor_loop);
+        // fall back to libevent
+        effective.ioUring = !!uring;
+    }
+
 #ifdef PVXS_ENABLE_OPENSSL
     if (effective.isTlsConfigured()) {
         try {
@@ -697,17 +782,44 @@ Server::Pvt::Pvt(Server &svr, const Config& conf, CustomServerCallback custom_ce
         std::copy(pun.b.begin(), pun.b.end(), effective.guid.begin());
     }
 
+    // Unix socket is named for the GUID, through which clients on this host find it.
+    if(!effective.unixSocket.empty()) {
+#ifdef PVXS_HAVE_UNIX_SOCKET
+        acceptor_loop.call([this](){
+            unixRemoveStale(effective.unixSocket);
+            auto name(unixSocketName(effective.unixSocket, effective.guid));
+            try {
+                interfaces.emplace_back(name, this);
+            } catch(std::exception& e) {
+                log_err_printf(serversetup, "Unable to listen on Unix socket %s : %s\n", name.c_str(), e.what());
+            }
+        });
+#else
+        log_warn_printf(serversetup, "Unix sockets not supported.  Ignoring %s\n", effective.unixSocket.c_str());
+#endif
+    }
+
     // Add magic "server" PV
     {
         auto L = sourcesLock.lockWriter();
         sources[std::make_pair(-1, "__server")] = std::make_shared<ServerSource>(this);
         sources[std::make_pair(-1, "__builtin")] = builtinsrc.source();
+        sourcesChange++;
     }
+
+    if(effective.searchCacheSize)
+        searchCache.reset(new SearchCache(effective.searchCacheSize));
 }
 
 Server::Pvt::~Pvt()
 {
     stop();
+    acceptor_loop.call([this]() {
+        multicasts.clear();
+        zeroCopyLinger.clear();
+    });
+    if(uring)
+        acceptor_loop.call([this]() { uring.reset(); });
 }
 
 void Server::Pvt::start()
@@ -754,6 +866,9 @@ void Server::Pvt::start()
         if(event_add(beaconTimer.get(), &immediate))
             log_err_printf(serversetup, "Error enabling beacon timer on\n%s", "");
 
+        for(auto& pair : multicasts)
+            pair.second->start();
+
         state = Running;
     });
 
@@ -793,6 +908,9 @@ void Server::Pvt::stop()
 
         if(event_del(beaconTimer.get()))
             log_err_printf(serversetup, "Error disabling beacon timer\n%s", "");
+
+        for(auto& pair : multicasts)
+            pair.second->stop();
     });
     if(prev_state!=Running)
         return;
@@ -855,8 +973,9 @@ void Server::Pvt::onSearch(const UDPManager::Search& msg)
         searchOp._names[i]._claim = false;
     }
     ipAddrToDottedIP(&msg.server->in, searchOp._src, sizeof(searchOp._src));
+    memcpy(searchMissOp._src, searchOp._src, sizeof(searchOp._src));
 
-    {
+    if(!searchCache) {
         auto G(sourcesLock.lockReader());
         for(const auto& pair : sources) {
             try {
@@ -866,6 +985,50 @@ void Server::Pvt::onSearch(const UDPManager::Search& msg)
                            pair.first.second.c_str(), e.what());
             }
         }
+
+    } else {
+        auto G(sourcesLock.lockReader());
+
+        if(checkSearchCacheSources())
+            searchCache->invalidate();
+
+        // only names not recently answered need be offered to cacheable Sources
+        searchMissOp._names.clear();
+        searchMissIdx.clear();
+        for(auto i : range(searchOp._names.size())) {
+            bool claimed;
+            if(searchCache->lookup(searchOp._names[i]._name, claimed)) {
+                searchOp._names[i]._claim = claimed;
+            } else {
+                searchMissOp._names.push_back(searchOp._names[i]);
+                searchMissIdx.push_back(i);
+            }
+        }
+        log_debug_printf(serversearch, "Search cache answers %zu of %zu names\n",
+                         searchOp._names.size()-searchMissIdx.size(), searchOp._names.size());
+
+        bool cacheable = true;
+        size_t idx = 0u;
+        for(const auto& pair : sources) {
+            auto& op = searchCacheSources[idx++].cacheable ? searchMissOp : searchOp;
+            if(op._names.empty())
+                continue;
+            try {
+                pair.second->onSearch(op);
+            }catch(std::exception& e){
+                log_exc_printf(serversetup, "Unhandled error in Source::onSearch for '%s' : %s\n",
+                           pair.first.second.c_str(), e.what());
+                cacheable = false;
+            }
+        }
+
+        for(auto i : range(searchMissIdx.size())) {
+            const auto& name = searchMissOp._names[i];
+            if(name._claim)
+                searchOp._names[searchMissIdx[i]]._claim = true;
+            if(cacheable)
+                searchCache->insert(name._name, name._claim);
+        }
     }
 
     uint16_t nreply = 0;
@@ -933,6 +1096,50 @@ void Server::Pvt::onSearch(const UDPManager::Search& msg)
     }
 }
 
+/* Note which Sources can be answered for by searchCache, and whether any
+ * Source has been added, removed, or called Source::listChanged(), since last called.
+ * Sources are cacheable if onList() gives a complete, non-dynamic, list of names.
+ * onList() is only called for a Source which is new, or has changed.
+ *
+ * Call on UDP worker with sourcesLock held.
+ * @returns true if searchCache must be invalidated
+ */
+bool Server::Pvt::checkSearchCacheSources()
+{
+    const bool added = searchCacheSourcesChange!=sourcesChange;
+    bool changed = added;
+    if(added) {
+        searchCacheSourcesChange = sourcesChange;
+        searchCacheSources.clear();
+        searchCacheSources.resize(sources.size(), SearchCacheSource{0u, false});
+    }
+
+    size_t idx = 0u;
+    for(const auto& pair : sources) {
+        auto& ent = searchCacheSources[idx++];
+
+        const auto generation(pair.second->listGeneration());
+        if(!added && ent.generation==generation)
+            continue;
+
+        Source::List list;
+        try {
+            list = pair.second->onList();
+        }catch(std::exception& e){
+            log_exc_printf(serversetup, "Unhandled error in Source::onList for '%s' : %s\n",
+                       pair.first.second.c_str(), e.what());
+        }
+        changed = true;
+        ent.generation = generation;
+        ent.cacheable = list.names && !list.dynamic;
+    }
+
+    if(changed)
+        log_debug_printf(serversearch, "Search cache invalidated by Source change%s", "\n");
+
+    return changed;
+}
+
 void Server::Pvt::doBeacons(short evt)
 {
     log_debug_printf(serversetup, "Server beacon timer expires\n%s", "");
@@ -16,6 +16,15 @@
 #include "openssl.h"
 #include "serverconn.h"
 
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && LIBEVENT_VERSION_NUMBER >= 0x02010100
+#  define PVXS_HAVE_ZEROCOPY
+#  include <linux/errqueue.h>
+#endif
+
+#ifdef PVXS_HAVE_UNIX_SOCKET
+#  include <unistd.h>
+#endif
+
 // limit on size of TX buffer above which we suspend RX.
 // defined as multiple of OS socket TX buffer size
 static constexpr size_t tcp_tx_limit_mult = 2u;
@@ -31,7 +40,7 @@ DEFINE_INST_COUNTER(ServerSource);
 std::set<std::string> PeerCredentials::roles() const
 {
     std::set<std::string> ret;
-    osdGetRoles(account, ret);
+    getRoles(account, ret);
     return ret;
 }
 
@@ -74,29 +83,286 @@ DEFINE_LOGGER(stapling, "pvxs.stapling");
 
 DEFINE_LOGGER(remote, "pvxs.remote.log");
 
+#ifdef PVXS_HAVE_ZEROCOPY
+/* Messages sent with MSG_ZEROCOPY.  The kernel reads from our memory after sendmsg() returns,
+ * so every buffer chain of each such message, including referenced arrays, is held until the
+ * kernel reports completion through the socket error queue.
+ *
+ * Completions are reaped before each send, and from a timer while any are inflight.
+ * Not on readability, which would also wake for every message received.
+ * Holds a dup() of the socket so that completions can still be reaped after the connection
+ * is closed.  cf. linger()
+ */
+struct ServerConn::ZeroCopy {
+    const evutil_socket_t sock;
+    // max. number of evbuffer chains sent with one sendmsg()
+    static constexpr size_t maxIOV = 64u;
+
+    // notification ID of next successful sendmsg().  Counted by the kernel from zero.
+    uint32_t nextID = 0u;
+    std::map<uint32_t, evbuf> inflight;
+    // set when the kernel copied anyway.  eg. loopback, or NIC without scatter/gather
+    bool copied = false;
+
+    evevent reapTimer;
+
+    // set after the connection is closed
+    server::Server::Pvt* lingerServ = nullptr;
+    // timer expirations until lingering is abandoned
+    size_t lingerTicks = 0u;
+
+    ZeroCopy(event_base* base, evutil_socket_t orig)
+        :sock(dup(orig))
+        ,reapTimer(__FILE__, __LINE__, event_new(base, -1, EV_TIMEOUT|EV_PERSIST, &onReapS, this))
+    {
+        if(sock<0)
+            throw std::system_error(errno, std::system_category(), "dup()");
+    }
+    ~ZeroCopy()
+    {
+        reapTimer.reset();
+        evutil_closesocket(sock);
+    }
+
+    // @returns number of bytes sent from the start of msg.  Possibly zero.
+    size_t send(evbuffer* msg)
+    {
+        if(!inflight.empty())
+            reap();
+        if(copied)
+            return 0u;
+
+        evbuffer_iovec vec[maxIOV];
+        auto n = std::min(size_t(evbuffer_peek(msg, -1, nullptr, vec, maxIOV)), maxIOV);
+        iovec iov[maxIOV];
+        for(auto i : range(n)) {
+            iov[i].iov_base = vec[i].iov_base;
+            iov[i].iov_len = vec[i].iov_len;
+        }
+        msghdr mh{};
+        mh.msg_iov = iov;
+        mh.msg_iovlen = n;
+
+        // adds references to the chains of msg, which will stay valid even after msg is drained
+        evbuf hold(__FILE__, __LINE__, evbuffer_new());
+        if(evbuffer_add_buffer_reference(hold.get(), msg))
+            throw BAD_ALLOC();
+
+        auto ret = sendmsg(sock, &mh, MSG_ZEROCOPY|MSG_DONTWAIT|MSG_NOSIGNAL);
+        if(ret<=0) {
+            // eg. EAGAIN, or ENOBUFS when over the limit on pinned memory.  Caller falls back to copying.
+            return 0u;
+        }
+
+        inflight.emplace(nextID++, std::move(hold));
+        if(!event_pending(reapTimer.get(), EV_TIMEOUT, nullptr)) {
+            const timeval interval{0, 10000}; // 10ms
+            if(event_add(reapTimer.get(), &interval))
+                log_err_printf(connio, "Unable to add zerocopy reap timer%s\n", "");
+        }
+        return size_t(ret);
+    }
+
+    // release completed messages
+    void reap()
+    {
+        while(true) {
+            char control[128];
+            msghdr mh{};
+            mh.msg_control = control;
+            mh.msg_controllen = sizeof(control);
+
+            if(recvmsg(sock, &mh, MSG_ERRQUEUE|MSG_DONTWAIT) < 0) {
+                auto err(SOCKERRNO);
+                if(err!=SOCK_EWOULDBLOCK && err!=EAGAIN)
+                    log_debug_printf(connio, "zerocopy errqueue error %d\n", err);
+                break;
+            }
+
+            for(auto cmsg = CMSG_FIRSTHDR(&mh); cmsg; cmsg = CMSG_NXTHDR(&mh, cmsg)) {
+                if(!(cmsg->cmsg_level==SOL_IP && cmsg->cmsg_type==IP_RECVERR)
+                        && !(cmsg->cmsg_level==SOL_IPV6 && cmsg->cmsg_type==IPV6_RECVERR))
+                    continue;
+
+                auto serr = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+                if(serr->ee_errno!=0 || serr->ee_origin!=SO_EE_ORIGIN_ZEROCOPY)
+                    continue;
+
+                // completion of IDs in range [ee_info, ee_data]
+                for(uint32_t id = serr->ee_info; ; id++) {
+                    inflight.erase(id); // releases held chains and arrays
+                    if(id==serr->ee_data)
+                        break;
+                }
+
+                if((serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) && !copied) {
+                    // pinning pages only to have them copied is worse than copying ourselves
+                    copied = true;
+                    log_debug_printf(connio, "zerocopy not possible.  Copying%s\n", "");
+                }
+            }
+        }
+    }
+
+    /* After the connection is closed, the kernel may still be reading inflight messages.
+     * If so, hold them, and the socket, until complete.  Or until timeout, if the peer stops
+     * acknowledging.
+     */
+    static
+    void linger(std::unique_ptr<ZeroCopy>&& self, server::Server::Pvt* serv, double timeout)
+    {
+        self->reap();
+        if(self->inflight.empty())
+            return; // release now
+
+        // sends FIN after any queued data
+        (void)shutdown(self->sock, SHUT_RDWR);
+
+        self->lingerServ = serv;
+        self->lingerTicks = size_t(std::max(1.0, timeout/0.01));
+        log_debug_printf(connio, "zerocopy wait for %zu messages after close\n", self->inflight.size());
+
+        auto raw = self.get();
+        serv->zeroCopyLinger.emplace(raw, std::shared_ptr<ZeroCopy>(std::move(self)));
+    }
+
+    void onReap()
+    {
+        reap();
+
+        if(inflight.empty()) {
+            (void)event_del(reapTimer.get());
+        } else if(!lingerServ || --lingerTicks) {
+            return;
+        } else {
+            log_debug_printf(connio, "zerocopy abandon %zu messages after close\n", inflight.size());
+        }
+
+        if(lingerServ) {
+            auto serv = lingerServ;
+            serv->zeroCopyLinger.erase(this); // destroys this
+        }
+    }
+
+    static
+    void onReapS(evutil_socket_t, short, void *raw)
+    {
+        try {
+            static_cast<ZeroCopy*>(raw)->onReap();
+        } catch(std::exception& e) {
+            log_exc_printf(connio, "Unhandled error in zerocopy reap callback: %s\n", e.what());
+        }
+    }
+};
+#else
+struct ServerConn::ZeroCopy {};
+#endif // PVXS_HAVE_ZEROCOPY
+
+static
+bool useURing(const ServIface* iface)
+{
+#ifdef PVXS_ENABLE_IO_URING
+    // Unix sockets carry peer credentials, and shared memory offers, outside of the byte stream
+    return iface->server->uring && !iface->isUnix
+#  ifdef PVXS_ENABLE_OPENSSL
+            && !iface->isTLS
+#  endif
+            ;
+#else
+    (void)iface;
+    return false;
+#endif
+}
+
+// Kernel TLS offload requires that OpenSSL read and write the socket itself,
+// rather than filtering a socket bufferevent.
+static
+bool useKernelTLS(const ServIface* iface)
+{
+#ifdef PVXS_ENABLE_OPENSSL
+    return iface->isTLS && iface->server->tls_context && iface->server->tls_context->kernel_offload;
+#else
+    (void)iface;
+    return false;
+#endif
+}
+
 ServerConn::ServerConn(ServIface* iface, evutil_socket_t sock, struct sockaddr *peer, int socklen)
   : ConnBase(false,
 #ifdef PVXS_ENABLE_OPENSSL
            iface->isTLS,
 #endif
            iface->server->effective.sendBE(),
-            evbufferevent(__FILE__, __LINE__, bufferevent_socket_new(iface->server->acceptor_loop.base, sock, BEV_OPT_CLOSE_ON_FREE|BEV_OPT_DEFER_CALLBACKS)),
-            SockAddr(peer))
+           useURing(iface) || useKernelTLS(iface) ? evbufferevent() // cf. below
+                           : evbufferevent(__FILE__, __LINE__, bufferevent_socket_new(iface->server->acceptor_loop.base, sock, BEV_OPT_CLOSE_ON_FREE|BEV_OPT_DEFER_CALLBACKS)),
+           // Unix socket peers have no network address
+           iface->isUnix ? SockAddr() : SockAddr(peer),
+#ifdef PVXS_HAVE_UNIX_SOCKET
+           iface->isUnix ? unixPeerName(sock) :
+#endif
+                           std::string())
     ,iface(iface)
     ,tcp_tx_limit(evsocket::get_buffer_size(sock, true) * tcp_tx_limit_mult)
+    ,zeroCopyThreshold(iface->server->effective.zeroCopyThreshold)
 {
+#ifdef PVXS_ENABLE_IO_URING
+    if(useURing(iface)) {
+        evbufferevent pair;
+        uring = iface->server->uring->attach(sock, true,
+                                             evsocket::get_buffer_size(sock, true),
+                                             evsocket::get_buffer_size(sock, false),
+                                             pair);
+        connect(std::move(pair));
+    }
+#endif
+
     log_debug_printf(connio, "Client %s connects%s, RX readahead %zu TX limit %zu\n", peerName.c_str(),
 #ifdef PVXS_ENABLE_OPENSSL
                        iface->isTLS ? " TLS" :
 #endif
                       "", readahead, tcp_tx_limit);
-    {
+    if(!iface->isUnix) {
         int opt = 1;
         if(setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (char*)&opt, sizeof(opt))<0) {
             auto err(SOCKERRNO);
             log_warn_printf(connio, "Unable to TCP_NODELAY: %d on %d\n", err, sock);
         }
     }
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    else {
+        if(!unixPeerUser(sock, peerUser))
+            log_debug_printf(connsetup, "Client %s on %s peer credentials not available\n",
+                             peerName.c_str(), iface->name.c_str());
+
+        auto& conf = iface->server->effective;
+        // offsets are sent in units of ShmRing::align
+        if(conf.shmSize && (shm = ShmRing::create(std::min(conf.shmSize, size_t(ShmRing::align*0xffffffffull)))))
+            shmThreshold = std::max(size_t(1u), std::min(conf.shmThreshold, size_t(0xffffffffu)));
+
+        // before anything else is sent
+        sendShmOffer(sock, sendBE, shmThreshold, shm.get());
+    }
+#endif
+
+#ifdef PVXS_HAVE_ZEROCOPY
+    if(zeroCopyThreshold && !useURing(iface) && !iface->isUnix
+#ifdef PVXS_ENABLE_OPENSSL
+            && !iface->isTLS
+#endif
+            ) {
+        int opt = 1;
+        if(setsockopt(sock, SOL_SOCKET, SO_ZEROCOPY, (char*)&opt, sizeof(opt))<0) {
+            auto err(SOCKERRNO);
+            log_debug_printf(connio, "Unable to SO_ZEROCOPY: %d on %d\n", err, sock);
+        } else {
+            try {
+                zeroCopy.reset(new ZeroCopy(iface->server->acceptor_loop.base, sock));
+            } catch(std::exception& e) {
+                log_debug_printf(connio, "Unable to track zerocopy on %d : %s\n", sock, e.what());
+            }
+        }
+    }
+#endif
 
 #ifdef PVXS_ENABLE_OPENSSL
     if (iface->isTLS) {
@@ -115,12 +381,19 @@ ServerConn::ServerConn(ServIface* iface, evutil_socket_t sock, struct sockaddr *
             }
         }
 
-        const auto rawconn = bev.release();
-        // BEV_OPT_CLOSE_ON_FREE will free on error
-        evbufferevent tlsconn(__FILE__, __LINE__,
-                              bufferevent_openssl_filter_new(iface->server->acceptor_loop.base, rawconn, ssl, BUFFEREVENT_SSL_ACCEPTING,
-                                                             BEV_OPT_CLOSE_ON_FREE | BEV_OPT_DEFER_CALLBACKS));
-        bev = std::move(tlsconn);
+        if (bev) {
+            const auto rawconn = bev.release();
+            // BEV_OPT_CLOSE_ON_FREE will free on error
+            evbufferevent tlsconn(__FILE__, __LINE__,
+                                  bufferevent_openssl_filter_new(iface->server->acceptor_loop.base, rawconn, ssl, BUFFEREVENT_SSL_ACCEPTING,
+                                                                 BEV_OPT_CLOSE_ON_FREE | BEV_OPT_DEFER_CALLBACKS));
+            bev = std::move(tlsconn);
+        } else {
+            // cf. useKernelTLS()
+            connect(evbufferevent(__FILE__, __LINE__,
+                                  bufferevent_openssl_socket_new(iface->server->acceptor_loop.base, sock, ssl, BUFFEREVENT_SSL_ACCEPTING,
+                                                                 BEV_OPT_CLOSE_ON_FREE | BEV_OPT_DEFER_CALLBACKS)));
+        }
 
         // added with libevent 2.2.1-alpha
         //(void)bufferevent_ssl_set_flags(bev.get(), BUFFEREVENT_SSL_DIRTY_SHUTDOWN);
@@ -140,8 +413,8 @@ ServerConn::ServerConn(ServIface* iface, evutil_socket_t sock, struct sockaddr *
     // TODO Sends the event to handle the, sets timeout, and
     bufferevent_setcb(bev.get(), &bevReadS, &bevWriteS, &bevEventS, this);
 
-    timeval tmo(totv(iface->server->effective.tcpTimeout));
-    bufferevent_set_timeouts(bev.get(), &tmo, &tmo);
+    bevTimeout = iface->server->acceptor_loop.commonTimeout(totv(iface->server->effective.tcpTimeout));
+    bufferevent_set_timeouts(bev.get(), &bevTimeout, &bevTimeout);
 
     auto tx = bufferevent_get_output(bev.get());
 
@@ -189,12 +462,76 @@ ServerConn::ServerConn(ServIface* iface, evutil_socket_t sock, struct sockaddr *
         statTx += M.save()-buf.data();
     }
 
+    // pointless through a Unix socket, and would leak secrets through TLS
+    if(compressAllowed()) {
+        to_evbuf(tx, Header{pva_ctrl_msg::CompressOffer, pva_flags::Control|pva_flags::Server, Compressor::supported()}, sendBE);
+        statTx += 8u;
+    }
+
     if(bufferevent_enable(bev.get(), EV_READ|EV_WRITE))
         throw std::logic_error("Unable to enable BEV");
 }
 
 ServerConn::~ServerConn() = default;
 
+bool ServerConn::compressAllowed() const
+{
+#ifdef PVXS_ENABLE_OPENSSL
+    if(iface->isTLS)
+        return false;
+#endif
+    return iface->server->effective.compress && !iface->isUnix && Compressor::supported();
+}
+
+void ServerConn::handle_Control(uint8_t cmd, uint32_t value)
+{
+    if(cmd==pva_ctrl_msg::ShmRelease && shm) {
+        shm->release(uint64_t(value)*ShmRing::align);
+
+    } else if(cmd==pva_ctrl_msg::CompressAccept && !compressor) {
+        auto algo = Compressor::algo_t(value);
+        if(value > 0xffu || !compressAllowed()
+                || algo==Compressor::None || !(Compressor::supported() & (1u<<algo))) {
+            log_warn_printf(connsetup, "Client %s accepts compression %u which was not offered.  Ignoring\n",
+                            peerName.c_str(), unsigned(value));
+            return;
+        }
+
+        log_debug_printf(connsetup, "Client %s accepts %s compression\n", peerName.c_str(), Compressor::name(algo));
+        compressor.reset(new Compressor(algo, iface->server->effective.compressThreshold,
+                                        iface->server->effective.compressMaxSize));
+    }
+}
+
+size_t ServerConn::enqueueTxBody(pva_app_msg_t cmd)
+{
+#ifdef PVXS_HAVE_ZEROCOPY
+    auto blen = evbuffer_get_length(txBody.get());
+    auto tx = bev ? bufferevent_get_output(bev.get()) : nullptr;
+
+    // only when nothing else is waiting to be sent, which would need to go first
+    if(zeroCopy && !compressor && tx && blen >= zeroCopyThreshold && !evbuffer_get_length(tx)) {
+        uint8_t header[8];
+        FixedBuf H(sendBE, header, sizeof(header));
+        to_wire(H, Header{cmd, pva_flags::Server, uint32_t(blen)});
+        assert(H.good());
+        if(evbuffer_prepend(txBody.get(), header, sizeof(header)))
+            throw BAD_ALLOC();
+
+        auto sent = zeroCopy->send(txBody.get());
+        (void)evbuffer_drain(txBody.get(), sent);
+        statTxZeroCopy += sent;
+
+        // remainder copied as usual
+        auto err = evbuffer_add_buffer(tx, txBody.get());
+        assert(!err);
+        statTx += 8u + blen;
+        return 8u + blen;
+    }
+#endif
+    return ConnBase::enqueueTxBody(cmd);
+}
+
 const std::shared_ptr<ServerChan>& ServerConn::lookupSID(uint32_t sid)
 {
     auto it = chanBySID.find(sid);
@@ -281,10 +618,20 @@ void ServerConn::handle_CONNECTION_VALIDATION()
                     C->method = selected;
                     C->account = user;
                 });
+#ifdef PVXS_HAVE_UNIX_SOCKET
+                if(!peerUser.empty()) {
+                    // identity provided by the OS takes precedence
+                    if(C->account!=peerUser)
+                        log_debug_printf(connsetup, "Client %s claims '%s' but is '%s'\n",
+                                         peerName.c_str(), C->account.c_str(), peerUser.c_str());
+                    C->method = selected;
+                    C->account = peerUser;
+                }
+#endif
             }
 #ifdef PVXS_ENABLE_OPENSSL
             else if (iface->isTLS && selected == "x509" && bev) {
-                auto ctx = bufferevent_openssl_get_ssl(bev.get());
+                auto ctx = ssl();
                 assert(ctx);
                 ossl::SSLContext::getPeerCredentials(*C, ctx);
             }
@@ -294,6 +641,9 @@ void ServerConn::handle_CONNECTION_VALIDATION()
             }
             C->raw = auth;
 
+            if(C->method!="anonymous")
+                prefetchRoles(C->account); // likely needed soon by eg. QSRV access security
+
             cred = std::move(C);
             log_debug_printf(connsetup, "Client credentials. account: %s, method: %s, authority: %s\n",
                              cred->account.c_str(), cred->method.c_str(), cred->authority.c_str());
@@ -433,6 +783,16 @@ void ServerConn::cleanup()
 {
     log_debug_printf(connsetup, "Client %s Cleanup TCP Connection\n", peerName.c_str());
 
+#ifdef PVXS_ENABLE_IO_URING
+    uring.reset();
+#endif
+#ifdef PVXS_HAVE_ZEROCOPY
+    // release any arrays still held, once the kernel is done with them
+    if(zeroCopy)
+        ZeroCopy::linger(std::move(zeroCopy), iface->server, iface->server->effective.tcpTimeout);
+#endif
+    shm.reset();
+
     iface->server->connections.erase(this);
 
     // grab maps before cleanup()s would modify
@@ -449,11 +809,14 @@ void ServerConn::cleanup()
 
 void ServerConn::bevEvent(short events) {
 #ifdef PVXS_ENABLE_OPENSSL
-    ConnBase::bevEvent(events, [=](bool enable) {
+    // Status changes are fanned out to all connections sharing a peer certificate, maybe after this one is gone.
+    // 'this' is only compared with live connections.
+    auto serv = iface->server;
+    ConnBase::bevEvent(events, [serv, this](bool enable) {
         if (enable)
-            iface->server->acceptor_loop.dispatch([this]() mutable { iface->server->enableTlsForPeerConnection(this); });
+            serv->acceptor_loop.dispatch([serv, this]() mutable { serv->enableTlsForPeerConnection(this); });
         else
-            iface->server->acceptor_loop.dispatch([this]() mutable { iface->server->removePeerTlsConnections(this); });
+            serv->acceptor_loop.dispatch([serv, this]() mutable { serv->removePeerTlsConnections(this); });
     });
 #else
     ConnBase::bevEvent(events);
@@ -497,6 +860,10 @@ void ServerConn::bevWrite()
         bufferevent_setwatermark(bev.get(), EV_WRITE, 0, 0);
         log_debug_printf(connio, "%s resume READ\n", peerName.c_str());
     }
+
+#ifdef PVXS_ENABLE_OPENSSL
+    kernelTLS();
+#endif
 }
 
 
@@ -505,6 +872,7 @@ ServIface::ServIface(const SockAddr &addr, server::Server::Pvt *server, bool fal
 #ifdef PVXS_ENABLE_OPENSSL
   ,isTLS(isTLS)
 #endif
+    ,isUnix(false)
     ,bind_addr(addr)
 {
     server->acceptor_loop.assertInLoop();
@@ -541,6 +909,45 @@ ServIface::ServIface(const SockAddr &addr, server::Server::Pvt *server, bool fal
         log_warn_printf(connsetup, "Server unable to bind %s port %u, falling back to %s\n", (isTLS ? "TLS" : "TCP"), orig_port, name.c_str());
     }
 
+    listen();
+}
+
+#ifdef PVXS_HAVE_UNIX_SOCKET
+ServIface::ServIface(const std::string& unixName, server::Server::Pvt *server)
+    :server(server)
+#ifdef PVXS_ENABLE_OPENSSL
+    ,isTLS(false)
+#endif
+    ,isUnix(true)
+    ,name("unix:"+unixName)
+{
+    server->acceptor_loop.assertInLoop();
+
+    UnixAddr addr(unixName);
+
+    sock = evsocket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(::bind(sock.sock, addr.sa(), addr.len)) {
+        auto err(evutil_socket_geterror(sock.sock));
+        throw std::system_error(err, std::system_category());
+    }
+    if(unixName[0]!='@')
+        unixPath = unixName;
+
+    listen();
+}
+#endif
+
+ServIface::~ServIface()
+{
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    if(!unixPath.empty() && unlink(unixPath.c_str()))
+        log_debug_printf(connsetup, "Unable to remove %s\n", unixPath.c_str());
+#endif
+}
+
+void ServIface::listen()
+{
     // added in libevent 2.1.1
 #ifndef LEV_OPT_DISABLED
 #  define LEV_OPT_DISABLED 0
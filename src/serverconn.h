@@ -8,11 +8,15 @@
 #define SERVERCONN_H
 
 #include <atomic>
+#include <deque>
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
+#include <vector>
 
 #include <epicsEvent.h>
+#include <epicsMutex.h>
 
 #include <pvxs/server.h>
 #include <pvxs/sharedpv.h>
@@ -23,7 +27,10 @@
 #include "conn.h"
 #include "dataimpl.h"
 #include "evhelper.h"
+#include "searchcache.h"
+#include "shm.h"
 #include "udp_collector.h"
+#include "uring.h"
 #include "utilpvt.h"
 #include "openssl.h"
 
@@ -118,6 +125,10 @@ struct ServerConn final : public ConnBase, public std::enable_shared_from_this<S
 {
     ServIface* const iface;
     const size_t tcp_tx_limit;
+    // arrays of at least this many bytes are sent by reference.  cf. server::Config::zeroCopyThreshold
+    const size_t zeroCopyThreshold;
+    // bytes of arrays sent by reference, and of messages sent with MSG_ZEROCOPY
+    size_t statTxRef{}, statTxZeroCopy{};
 
     std::shared_ptr<const server::ClientCredentials> cred;
 
@@ -127,6 +138,19 @@ struct ServerConn final : public ConnBase, public std::enable_shared_from_this<S
 
     std::list<std::function<void()>> backlog;
 
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    // owner of the peer process when iface->isUnix.  Supersedes user name claimed with "ca" auth.
+    std::string peerUser;
+#endif
+
+    // shared with a client connected through a Unix socket.  cf. server::Config::shmSize
+    std::unique_ptr<ShmRing> shm;
+    size_t shmThreshold = 0u;
+
+    // when sending with MSG_ZEROCOPY
+    struct ZeroCopy;
+    std::unique_ptr<ZeroCopy> zeroCopy;
+
     INST_COUNTER(ServerConn);
 
     ServerConn(ServIface* iface, evutil_socket_t sock, struct sockaddr *peer, int socklen);
@@ -136,6 +160,8 @@ struct ServerConn final : public ConnBase, public std::enable_shared_from_this<S
 
     const std::shared_ptr<ServerChan>& lookupSID(uint32_t sid);
 
+    virtual size_t enqueueTxBody(pva_app_msg_t cmd) override final;
+
 #ifdef PVXS_ENABLE_OPENSSL
     ossl::CertStatusExData *getCertStatusExData() override;
 #endif
@@ -162,6 +188,9 @@ private:
 #undef CASE
 
     void handle_GPR(pva_app_msg_t cmd);
+    virtual void handle_Control(uint8_t cmd, uint32_t value) override final;
+    //! May payload compression be offered to, or accepted from, this client
+    bool compressAllowed() const;
 
     virtual std::shared_ptr<ConnBase> self_from_this() override final;
 public:
@@ -178,19 +207,127 @@ struct ServIface
 #ifdef PVXS_ENABLE_OPENSSL
     const bool isTLS;
 #endif
+    // listening on a Unix socket.  cf. ConfigCommon::unixSocket
+    const bool isUnix;
 
-    SockAddr bind_addr;
+    SockAddr bind_addr; // AF_UNSPEC when isUnix
     std::string name;
+    // filesystem Unix socket, to be removed
+    std::string unixPath;
 
     evsocket sock;
     evlisten listener;
 
     ServIface(const SockAddr &addr, server::Server::Pvt *server, bool fallback, bool isTLS);
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    ServIface(const std::string& unixName, server::Server::Pvt *server);
+#endif
+    ServIface(const ServIface&) = delete;
+    ServIface& operator=(const ServIface&) = delete;
+    ~ServIface();
+
+private:
+    void listen();
+public:
 
     static void onConnS(struct evconnlistener *listener, evutil_socket_t sock, struct sockaddr *peer, int socklen, void *raw);
 };
 
 
+/** Publishes the monitor updates of one PV to a UDP multicast group.  cf. Server::addMulticast()
+ *
+ * Subscribes to the PV through the Source API, as would a client.
+ * Each update is sent to the group as one CMD_MCAST_DATA datagram with a sequence number.
+ * Recent datagrams are kept to answer CMD_MCAST_NACK from clients which miss some.
+ * Client subscriptions opting in with pvRequest "record._options.multicast" are first
+ * passed to the Source, as usual, through McastGate.  Once accepted, these are attached
+ * here, and receive only the data type, and any complete values requested, through TCP.
+ */
+struct McastPublisher : public std::enable_shared_from_this<McastPublisher>
+{
+    server::Server::Pvt* const server;
+    const std::string name;
+    const SockEndpoint group;
+
+    McastPublisher(server::Server::Pvt* server, const std::string& name, const std::string& group);
+    McastPublisher(const McastPublisher&) = delete;
+    McastPublisher& operator=(const McastPublisher&) = delete;
+    ~McastPublisher();
+
+    // on acceptor worker
+    void start();
+    void stop();
+    //! Is this the group requested by a client
+    bool matches(const std::string& group) const;
+    //! Pass a client subscription to the Source, and attach it here if accepted
+    std::unique_ptr<server::MonitorSetupOp> gate(std::unique_ptr<server::MonitorSetupOp>&& setup,
+                                                 const SockAddr& peer,
+                                                 const std::weak_ptr<ServerConn>& conn);
+    /** Attach a client subscription accepted by the Source
+     *
+     * @param peer Address of the client, from which CMD_MCAST_NACK is accepted
+     * @param conn Connection through which complete values are sent
+     * @param onClose Called when the client subscription is closed
+     */
+    void subscribe(std::unique_ptr<server::MonitorSetupOp>&& setup,
+                   const SockAddr& peer,
+                   const std::weak_ptr<ServerConn>& conn,
+                   std::function<void(const std::string&)>&& onClose);
+    void report(Report::Multicast& info, bool zero);
+
+    // from Source, on any thread
+    void connected(const Value& prototype);
+    void publish(const Value& val);
+    void closed(const std::string& msg);
+
+    mutable epicsMutex lock;
+    // Source callbacks.  guarded by lock
+    std::function<void(std::unique_ptr<server::MonitorSetupOp>&&)> onSubscribe;
+    std::function<void(const std::string&)> onChanClose, onSubClose;
+    std::function<void(bool)> onStart;
+
+private:
+    void open();
+    void close(const std::string& msg);
+    // caller must hold lock
+    bool encode(bool be, uint8_t kind, uint64_t seq, const Value* val);
+    void send(const SockAddr& dest);
+    void sendSync(ServerConn& conn);
+    void sendGrant(ServerConn& conn);
+
+    void onRx();
+    static void onRxS(evutil_socket_t fd, short evt, void *raw);
+    void onTick();
+    static void onTickS(evutil_socket_t fd, short evt, void *raw);
+
+    // sends to group, and receives CMD_MCAST_NACK
+    evsocket sock;
+    const evevent rx, tick;
+
+    // on acceptor worker
+    bool claimed = false; // by a Source
+    struct Subscriber {
+        std::unique_ptr<server::MonitorSetupOp> setup; // until connected()
+        std::unique_ptr<server::MonitorControlOp> ctrl;
+        SockAddr peer;
+        std::weak_ptr<ServerConn> conn;
+        std::function<void(const std::string&)> onClose;
+    };
+    std::map<const server::MonitorControlOp*, Subscriber> subscribers;
+    std::vector<Subscriber> pending; // until connected()
+    std::vector<uint8_t> rxbuf;
+    // datagrams sent in reply to CMD_MCAST_NACK from each host since last tick
+    std::map<SockAddr, size_t, SockAddrOnlyLess> nackBudget;
+    size_t statRetransmit = 0u, statSync = 0u, statIgnored = 0u;
+
+    // guarded by lock
+    Value current; // type and latest value, once connected()
+    uint64_t seq = 0u; // of latest Update
+    bool sent = false; // since last tick
+    std::deque<std::pair<uint64_t, std::vector<uint8_t>>> history;
+    std::vector<uint8_t> txbuf;
+};
+
 //! Home of the magic "server" PV used by "pvinfo"
 struct ServerSource : public server::Source
 {
@@ -206,6 +343,8 @@ struct ServerSource : public server::Source
     virtual void onSearch(Search &op) override final;
 
     virtual void onCreate(std::unique_ptr<server::ChannelControl> &&op) override final;
+
+    virtual List onList() override final;
 };
 
 } // namespace impl
@@ -233,6 +372,8 @@ struct Server::Pvt
     // handle server "background" tasks.
     // accept new connections and send beacons
     evbase acceptor_loop;
+    // when effective.ioUring
+    std::shared_ptr<URing> uring;
 
 #ifdef PVXS_ENABLE_OPENSSL
     // @note order member `pvxs::client::ContextImpl::connections` after
@@ -255,6 +396,8 @@ struct Server::Pvt
     std::list<ServIface> interfaces;
     // The server connections (@see pvxs::client::ContextImpl::tls_context)
     std::map<ServerConn*, std::shared_ptr<ServerConn> > connections;
+    // MSG_ZEROCOPY messages still inflight after their connection closed.  cf. ServerConn::cleanup()
+    std::map<ServerConn::ZeroCopy*, std::shared_ptr<ServerConn::ZeroCopy> > zeroCopyLinger;
 
     evsocket beaconSender4, beaconSender6;
     evevent beaconTimer;
@@ -265,9 +408,29 @@ struct Server::Pvt
     // made a member to avoid re-alloc of _names vector.
     Source::Search searchOp;
 
+    // Optional answers to recent searches.  @see Config::searchCacheSize
+    // Only used on the UDP worker.
+    std::unique_ptr<SearchCache> searchCache;
+    // Whether searchCache answers for each of sources, as of its Source::listGeneration()
+    struct SearchCacheSource {
+        uint64_t generation;
+        bool cacheable;
+    };
+    std::vector<SearchCacheSource> searchCacheSources;
+    // sourcesChange as of searchCacheSources
+    size_t searchCacheSourcesChange = 0u;
+    // names not answered by searchCache, and their index in searchOp
+    Source::Search searchMissOp;
+    std::vector<size_t> searchMissIdx;
+
     StaticSource builtinsrc;
 
+    // PV name -> publisher.  cf. Server::addMulticast().  Only used on the acceptor worker.
+    std::map<std::string, std::shared_ptr<McastPublisher>> multicasts;
+
     RWLock sourcesLock;
+    // incremented when sources is changed.  guarded by sourcesLock
+    size_t sourcesChange = 0u;
     std::map<std::pair<int, std::string>, std::shared_ptr<Source> > sources;
 
     enum state_t {
@@ -302,6 +465,7 @@ struct Server::Pvt
 
    private:
     void onSearch(const UDPManager::Search& msg);
+    bool checkSearchCacheSources();
     void doBeacons(short evt);
     static void doBeaconsS(evutil_socket_t fd, short evt, void *raw);
 
@@ -316,6 +480,9 @@ struct Server::Pvt
 #endif
 };
 
+// Statistics of all existing HandlerPool instances, by thread name prefix
+std::vector<std::pair<std::string, HandlerPool::Stats>> handlerPoolStats(bool reset);
+
 }} // namespace pvxs::server
 
 #endif // SERVERCONN_H
@@ -79,6 +79,12 @@ struct ServerGPR final : public ServerOp
             (void)evbuffer_drain(conn->txBody.get(), evbuffer_get_length(conn->txBody.get()));
 
             EvOutBuf R(conn->sendBE, conn->txBody.get());
+            R.refThreshold = conn->zeroCopyThreshold;
+            R.refCount = &conn->statTxRef;
+            if(cmd!=CMD_RPC) { // cf. client Connection::handle_GPR()
+                R.shmRing = conn->shm.get();
+                R.shmThreshold = conn->shmThreshold;
+            }
             to_wire(R, uint32_t(ioid));
             to_wire(R, subcmd);
             to_wire(R, sts);
@@ -0,0 +1,246 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <deque>
+#include <ostream>
+#include <set>
+#include <vector>
+
+#include <epicsEvent.h>
+#include <epicsGuard.h>
+#include <epicsMutex.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#include <pvxs/log.h>
+#include <pvxs/source.h>
+
+#include "serverconn.h"
+#include "utilpvt.h"
+
+typedef epicsGuard<epicsMutex> Guard;
+typedef epicsGuardRelease<epicsMutex> UnGuard;
+
+DEFINE_LOGGER(loghandler, "pvxs.svr.handler");
+
+namespace pvxs {
+namespace server {
+
+namespace {
+
+// Shared by pool threads.  Outlives HandlerPool::Pvt if the last reference
+// is released by a handler running on a pool thread.
+struct HandlerQueue final : public epicsThreadRunable, public std::enable_shared_from_this<HandlerQueue>
+{
+    struct Job {
+        std::function<void()> fn;
+        epicsTime queued;
+    };
+
+    const std::string name;
+    const size_t limit;
+
+    mutable epicsMutex lock;
+    epicsEvent wakeup;
+
+    // guarded by lock
+    std::deque<Job> jobs;
+    HandlerPool::Stats stats;
+    unsigned nidle = 0u;
+    bool stop = false;
+
+    HandlerQueue(const std::string& name, size_t limit) :name(name), limit(limit) {}
+    virtual ~HandlerQueue() {}
+
+    virtual void run() override final
+    {
+        // hold our own reference as HandlerPool::Pvt, and our epicsThread, may be destroyed
+        // by the last handler we run.
+        auto self(shared_from_this());
+
+        Guard G(lock);
+        while(true) {
+            if(jobs.empty()) {
+                if(stop)
+                    break;
+                nidle++;
+                {
+                    UnGuard U(G);
+                    wakeup.wait();
+                }
+                nidle--;
+                continue;
+            }
+
+            auto job(std::move(jobs.front()));
+            jobs.pop_front();
+            bool wakeOther = !jobs.empty() && nidle;
+            {
+                UnGuard U(G);
+                if(wakeOther)
+                    wakeup.signal();
+
+                auto start(epicsTime::getCurrent());
+                try {
+                    job.fn();
+                } catch(std::exception& e) {
+                    log_exc_printf(loghandler, "Unhandled exception in handler: %s\n", e.what());
+                }
+                // release captures outside of lock
+                job.fn = nullptr;
+                auto end(epicsTime::getCurrent());
+
+                Guard G2(lock);
+                double waited = start - job.queued;
+                double ran = end - start;
+                stats.nRun++;
+                stats.totalRun += ran;
+                if(waited > stats.maxWait)
+                    stats.maxWait = waited;
+                if(ran > stats.maxRun)
+                    stats.maxRun = ran;
+            }
+        }
+        // pass along to next thread
+        UnGuard U(G);
+        wakeup.signal();
+    }
+};
+
+// All existing pools, for Server::report()
+struct PoolRegistry {
+    epicsMutex lock;
+    // Lock order: PoolRegistry::lock, then HandlerQueue::lock
+    std::set<HandlerQueue*> queues;
+};
+
+PoolRegistry* poolRegistry;
+
+void poolRegistryInit()
+{
+    poolRegistry = new PoolRegistry();
+}
+
+PoolRegistry& registry()
+{
+    threadOnce<&poolRegistryInit>();
+    return *poolRegistry;
+}
+
+} // namespace
+
+struct HandlerPool::Pvt {
+    const std::shared_ptr<HandlerQueue> Q;
+    std::vector<std::unique_ptr<epicsThread>> workers;
+
+    Pvt(const std::string& name, unsigned nthreads, size_t limit)
+        :Q(std::make_shared<HandlerQueue>(name, limit))
+    {
+        nthreads = std::max(1u, nthreads);
+        workers.reserve(nthreads);
+        for(auto i : range(nthreads)) {
+            std::string tname(SB()<<name<<'-'<<i);
+            workers.emplace_back(new epicsThread(*Q, tname.c_str(),
+                                                 epicsThreadGetStackSize(epicsThreadStackBig),
+                                                 epicsThreadPriorityMedium));
+        }
+        for(auto& worker : workers)
+            worker->start();
+
+        auto& reg = registry();
+        Guard G(reg.lock);
+        reg.queues.insert(Q.get());
+    }
+
+    ~Pvt()
+    {
+        {
+            auto& reg = registry();
+            Guard G(reg.lock);
+            reg.queues.erase(Q.get());
+        }
+        {
+            Guard G(Q->lock);
+            Q->stop = true;
+        }
+        Q->wakeup.signal();
+        // queued handlers will still be run.
+        // Does not wait if run by a handler on one of our threads.
+        for(auto& worker : workers)
+            worker->exitWait();
+    }
+};
+
+HandlerPool::HandlerPool(const std::string& name, unsigned nthreads, size_t maxQueue)
+    :pvt(std::make_shared<Pvt>(name, nthreads, maxQueue))
+{}
+
+HandlerPool::~HandlerPool() {}
+
+bool HandlerPool::submit(std::function<void()>&& fn)
+{
+    if(!pvt)
+        throw std::logic_error("NULL HandlerPool");
+
+    auto& Q = *pvt->Q;
+    bool wake;
+    {
+        Guard G(Q.lock);
+        if(Q.limit && Q.jobs.size() >= Q.limit) {
+            Q.stats.nRejected++;
+            return false;
+        }
+        wake = Q.jobs.empty() && Q.nidle;
+        Q.jobs.push_back(HandlerQueue::Job{std::move(fn), epicsTime::getCurrent()});
+    }
+    if(wake)
+        Q.wakeup.signal();
+    return true;
+}
+
+HandlerPool::Stats HandlerPool::stats(bool reset) const
+{
+    if(!pvt)
+        throw std::logic_error("NULL HandlerPool");
+
+    auto& Q = *pvt->Q;
+    Guard G(Q.lock);
+    auto ret(Q.stats);
+    ret.nQueued = Q.jobs.size();
+    if(reset)
+        Q.stats = Stats();
+    return ret;
+}
+
+std::vector<std::pair<std::string, HandlerPool::Stats>> handlerPoolStats(bool reset)
+{
+    std::vector<std::pair<std::string, HandlerPool::Stats>> ret;
+
+    auto& reg = registry();
+    Guard G(reg.lock);
+    ret.reserve(reg.queues.size());
+    for(auto Q : reg.queues) {
+        Guard G2(Q->lock);
+        ret.emplace_back(Q->name, Q->stats);
+        ret.back().second.nQueued = Q->jobs.size();
+        if(reset)
+            Q->stats = HandlerPool::Stats();
+    }
+    return ret;
+}
+
+std::ostream& operator<<(std::ostream& strm, const HandlerPool::Stats& stats)
+{
+    strm<<"queued="<<stats.nQueued
+        <<" run="<<stats.nRun
+        <<" rejected="<<stats.nRejected
+        <<" maxWait="<<stats.maxWait
+        <<" maxRun="<<stats.maxRun
+        <<" avgRun="<<(stats.nRun ? stats.totalRun/stats.nRun : 0.0);
+    return strm;
+}
+
+}} // namespace pvxs::server
@@ -0,0 +1,720 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <epicsGuard.h>
+
+#include <pvxs/log.h>
+
+#include "dataimpl.h"
+#include "serverconn.h"
+
+namespace pvxs { namespace impl {
+DEFINE_LOGGER(logmcast, "pvxs.svr.mcast");
+
+namespace {
+
+typedef epicsGuard<epicsMutex> Guard;
+
+// Period of heartbeats while idle, and of attempts to (re)open the PV.
+constexpr timeval mcastTick{1, 0};
+// Number of recent Updates kept to answer CMD_MCAST_NACK
+constexpr size_t mcastHistory = 64u;
+// Largest UDP payload for IPv4
+constexpr size_t mcastMaxDatagram = 65507u;
+// Number of datagrams, and complete values, sent to one host in reply to CMD_MCAST_NACK per tick
+constexpr size_t mcastNackBudget = mcastHistory;
+
+// The subscription of the Server itself, to be fanned out to clients.
+std::shared_ptr<const server::ClientCredentials> mcastCred()
+{
+    auto cred(std::make_shared<server::ClientCredentials>());
+    cred->peer = "multicast";
+    cred->method = "anonymous";
+    return cred;
+}
+
+/* Adapters through which the Source sees the publisher as a client subscription.
+ * Each holds a weak reference, and may outlive the publisher.
+ */
+
+struct McastControl final : public server::MonitorControlOp
+{
+    const std::weak_ptr<McastPublisher> pub;
+
+    McastControl(const std::string& name, const std::weak_ptr<McastPublisher>& pub)
+        :server::MonitorControlOp(name, mcastCred(), Info)
+        ,pub(pub)
+    {}
+    virtual ~McastControl() {}
+
+    virtual bool doPost(const Value& val, bool maybe, bool force) override final
+    {
+        if(auto P = pub.lock())
+            P->publish(val);
+        return true; // never queued
+    }
+
+    virtual void stats(server::MonitorStat& stat, bool reset) const override final
+    {
+        stat.running = !pub.expired();
+    }
+
+    virtual void setWatermarks(size_t low, size_t high) override final {}
+
+    virtual void onStart(std::function<void(bool)>&& fn) override final
+    {
+        auto P = pub.lock();
+        if(!P || !fn)
+            return;
+        {
+            Guard G(P->lock);
+            P->onStart = fn;
+        }
+        // always running
+        P->server->acceptor_loop.dispatch([fn]() {
+            fn(true);
+        });
+    }
+    virtual void onHighMark(std::function<void()>&& fn) override final {}
+    virtual void onLowMark(std::function<void()>&& fn) override final {}
+};
+
+struct McastSetup final : public server::MonitorSetupOp
+{
+    const std::weak_ptr<McastPublisher> pub;
+
+    McastSetup(const std::string& name, const std::weak_ptr<McastPublisher>& pub)
+        :server::MonitorSetupOp(name, mcastCred(), Info, TypeDef(TypeCode::Struct, {}).create())
+        ,pub(pub)
+    {}
+    virtual ~McastSetup() {}
+
+    virtual std::unique_ptr<server::MonitorControlOp> connect(const Value& prototype) override final
+    {
+        if(!prototype)
+            throw std::invalid_argument("Must provide prototype");
+        auto P = pub.lock();
+        if(!P)
+            throw std::runtime_error("Dead Operation");
+        P->connected(prototype);
+        return std::unique_ptr<server::MonitorControlOp>(new McastControl(_name, pub));
+    }
+
+    virtual void error(const std::string& msg) override final
+    {
+        log_warn_printf(logmcast, "Unable to multicast '%s' : %s\n", _name.c_str(), msg.c_str());
+    }
+
+    virtual void onClose(std::function<void(const std::string&)>&& fn) override final
+    {
+        if(auto P = pub.lock()) {
+            Guard G(P->lock);
+            P->onSubClose = std::move(fn);
+        }
+    }
+};
+
+struct McastChannel final : public server::ChannelControl
+{
+    const std::weak_ptr<McastPublisher> pub;
+
+    McastChannel(const std::string& name, const std::weak_ptr<McastPublisher>& pub)
+        :server::ChannelControl(name, mcastCred(), None)
+        ,pub(pub)
+    {}
+    virtual ~McastChannel() {}
+
+    virtual void onOp(std::function<void(std::unique_ptr<server::ConnectOp>&&)>&& fn) override final {}
+    virtual void onRPC(std::function<void(std::unique_ptr<server::ExecOp>&&, Value&&)>&& fn) override final {}
+
+    virtual void onSubscribe(std::function<void(std::unique_ptr<server::MonitorSetupOp>&&)>&& fn) override final
+    {
+        if(auto P = pub.lock()) {
+            Guard G(P->lock);
+            P->onSubscribe = std::move(fn);
+        }
+    }
+
+    virtual void onClose(std::function<void(const std::string&)>&& fn) override final
+    {
+        if(auto P = pub.lock()) {
+            Guard G(P->lock);
+            P->onChanClose = std::move(fn);
+        }
+    }
+
+    virtual void close() override final
+    {
+        if(auto P = pub.lock())
+            P->closed("Closed by Source");
+    }
+
+    virtual void _updateInfo(const std::shared_ptr<const ReportInfo>& info) override final {}
+};
+
+/* Passed to the Source in place of a client subscription which opts in to multicast,
+ * so that each client is accepted, or not, with its own credentials.
+ * Accepting attaches the client to the publisher.  The returned MonitorControlOp
+ * then discards updates, which the client receives through the group.
+ */
+struct McastGate final : public server::MonitorSetupOp
+{
+    struct State {
+        epicsMutex lock;
+        // until connect()
+        std::unique_ptr<server::MonitorSetupOp> real;
+        std::function<void(const std::string&)> onClose;
+    };
+    const std::shared_ptr<State> state;
+    const std::weak_ptr<McastPublisher> pub;
+    const SockAddr peer;
+    const std::weak_ptr<ServerConn> conn;
+
+    McastGate(std::unique_ptr<server::MonitorSetupOp>&& real,
+              const std::weak_ptr<McastPublisher>& pub,
+              const SockAddr& peer,
+              const std::weak_ptr<ServerConn>& conn)
+        :server::MonitorSetupOp(real->name(), real->credentials(), Info, real->pvRequest())
+        ,state(std::make_shared<State>())
+        ,pub(pub)
+        ,peer(peer)
+        ,conn(conn)
+    {
+        state->real = std::move(real);
+    }
+    virtual ~McastGate() {}
+    // when not accepted, destroying real implies an error
+
+    virtual std::unique_ptr<server::MonitorControlOp> connect(const Value& prototype) override final;
+
+    virtual void error(const std::string& msg) override final
+    {
+        Guard G(state->lock);
+        if(state->real)
+            state->real->error(msg);
+    }
+
+    virtual void onClose(std::function<void(const std::string&)>&& fn) override final
+    {
+        Guard G(state->lock);
+        state->onClose = std::move(fn);
+    }
+};
+
+struct McastDiscard final : public server::MonitorControlOp
+{
+    explicit McastDiscard(const McastGate& gate)
+        :server::MonitorControlOp(gate.name(), gate.credentials(), Info)
+    {}
+    virtual ~McastDiscard() {}
+
+    virtual bool doPost(const Value& val, bool maybe, bool force) override final { return true; }
+    virtual void stats(server::MonitorStat& stat, bool reset) const override final
+    {
+        stat.running = true;
+    }
+    virtual void setWatermarks(size_t low, size_t high) override final {}
+    virtual void onStart(std::function<void(bool)>&& fn) override final {}
+    virtual void onHighMark(std::function<void()>&& fn) override final {}
+    virtual void onLowMark(std::function<void()>&& fn) override final {}
+};
+
+std::unique_ptr<server::MonitorControlOp> McastGate::connect(const Value& prototype)
+{
+    if(!prototype)
+        throw std::invalid_argument("Must provide prototype");
+    auto P = pub.lock();
+    if(!P)
+        throw std::runtime_error("Dead Operation");
+    {
+        Guard G(state->lock);
+        if(!state->real)
+            throw std::logic_error("Already connected");
+    }
+
+    // the client receives the type of the multicast, not of prototype
+    auto st(state);
+    auto addr(peer);
+    auto wconn(conn);
+    std::weak_ptr<McastPublisher> wpub(P);
+    P->server->acceptor_loop.dispatch([st, addr, wconn, wpub]() {
+        auto P = wpub.lock();
+        if(!P)
+            return;
+        std::unique_ptr<server::MonitorSetupOp> real;
+        {
+            Guard G(st->lock);
+            real = std::move(st->real);
+        }
+        if(real)
+            P->subscribe(std::move(real), addr, wconn, [st](const std::string& msg) {
+                decltype(st->onClose) fn;
+                {
+                    Guard G(st->lock);
+                    fn = std::move(st->onClose);
+                }
+                if(fn)
+                    fn(msg);
+            });
+    });
+
+    return std::unique_ptr<server::MonitorControlOp>(new McastDiscard(*this));
+}
+
+} // namespace
+
+McastPublisher::McastPublisher(server::Server::Pvt* server, const std::string& name, const std::string& group)
+    :server(server)
+    ,name(name)
+    ,group(group)
+    ,sock(this->group.addr.family(), SOCK_DGRAM, 0)
+    ,rx(__FILE__, __LINE__,
+        event_new(server->acceptor_loop.base, sock.sock, EV_READ|EV_PERSIST, &onRxS, this))
+    ,tick(__FILE__, __LINE__,
+          event_new(server->acceptor_loop.base, -1, EV_TIMEOUT|EV_PERSIST, &onTickS, this))
+{
+    server->acceptor_loop.assertInLoop();
+
+    if(!this->group.addr.isMCast() || !this->group.addr.port())
+        throw std::invalid_argument(SB()<<"Expected multicast group address with port, not '"<<group<<"'");
+
+    // an ephemeral port, to which clients send CMD_MCAST_NACK
+    sock.bind(SockAddr::any(this->group.addr.family()));
+    sock.mcast_prep_sendto(this->group);
+
+    log_debug_printf(logmcast, "Multicast '%s' to %s from %s\n",
+                     name.c_str(), group.c_str(), sock.sockname().tostring().c_str());
+}
+
+McastPublisher::~McastPublisher() {}
+
+void McastPublisher::start()
+{
+    if(event_add(rx.get(), nullptr) || event_add(tick.get(), &mcastTick))
+        log_err_printf(logmcast, "Error enabling multicast of '%s'\n", name.c_str());
+    open();
+}
+
+void McastPublisher::stop()
+{
+    (void)event_del(rx.get());
+    (void)event_del(tick.get());
+    close("Server stopping");
+}
+
+bool McastPublisher::matches(const std::string& group) const
+{
+    if(group.empty())
+        return false; // client unable to join
+    try {
+        return SockEndpoint(group).addr==this->group.addr;
+    }catch(std::exception& e){
+        log_debug_printf(logmcast, "Client requests invalid multicast group '%s' : %s\n", group.c_str(), e.what());
+        return false;
+    }
+}
+
+void McastPublisher::open()
+{
+    if(claimed)
+        return;
+
+    std::function<void(std::unique_ptr<server::MonitorSetupOp>&&)> subscribe;
+    {
+        std::unique_ptr<server::ChannelControl> op(new McastChannel(name, shared_from_this()));
+
+        auto G(server->sourcesLock.lockReader());
+
+        for(auto& pair : server->sources) {
+            try {
+                pair.second->onCreate(std::move(op));
+            }catch(std::exception& e){
+                log_exc_printf(logmcast, "Unhandled error in onCreate %s,%d for multicast : %s\n",
+                               pair.first.second.c_str(), pair.first.first, e.what());
+            }
+
+            Guard L(lock);
+            if(onSubscribe || !op) {
+                subscribe = onSubscribe;
+                break;
+            }
+        }
+    }
+
+    if(!subscribe) {
+        log_debug_printf(logmcast, "No Source provides '%s' for multicast\n", name.c_str());
+        return;
+    }
+
+    claimed = true;
+    subscribe(std::unique_ptr<server::MonitorSetupOp>(new McastSetup(name, shared_from_this())));
+}
+
+void McastPublisher::close(const std::string& msg)
+{
+    decltype(subscribers) subs;
+    decltype(pending) pend;
+    decltype(onChanClose) chanClose;
+    decltype(onSubClose) subClose;
+    decltype(onStart) start;
+    {
+        Guard G(lock);
+        current = Value();
+        history.clear();
+        onSubscribe = nullptr;
+        chanClose = std::move(onChanClose);
+        subClose = std::move(onSubClose);
+        start = std::move(onStart);
+        onChanClose = onSubClose = nullptr;
+        onStart = nullptr;
+    }
+    subs = std::move(subscribers);
+    pend = std::move(pending);
+    claimed = false;
+
+    if(start)
+        start(false);
+    // release references held by the Source
+    if(subClose)
+        subClose(msg);
+    if(chanClose)
+        chanClose(msg);
+
+    log_debug_printf(logmcast, "Multicast '%s' closed with %zu subscribers : %s\n",
+                     name.c_str(), subs.size(), msg.c_str());
+    // clients are left waiting for a re-open
+}
+
+void McastPublisher::closed(const std::string& msg)
+{
+    std::weak_ptr<McastPublisher> wself(shared_from_this());
+    server->acceptor_loop.dispatch([wself, msg]() {
+        if(auto self = wself.lock())
+            self->close(msg);
+    });
+}
+
+void McastPublisher::connected(const Value& prototype)
+{
+    {
+        Guard G(lock);
+        current = prototype.clone();
+    }
+
+    // attach clients which subscribed before
+    std::weak_ptr<McastPublisher> wself(shared_from_this());
+    server->acceptor_loop.dispatch([wself]() {
+        if(auto self = wself.lock()) {
+            auto pend(std::move(self->pending));
+            for(auto& sub : pend)
+                self->subscribe(std::move(sub.setup), sub.peer, sub.conn, std::move(sub.onClose));
+        }
+    });
+}
+
+std::unique_ptr<server::MonitorSetupOp> McastPublisher::gate(std::unique_ptr<server::MonitorSetupOp>&& setup,
+                                                             const SockAddr& peer,
+                                                             const std::weak_ptr<ServerConn>& conn)
+{
+    return std::unique_ptr<server::MonitorSetupOp>(new McastGate(std::move(setup), shared_from_this(), peer, conn));
+}
+
+void McastPublisher::subscribe(std::unique_ptr<server::MonitorSetupOp>&& setup,
+                               const SockAddr& peer,
+                               const std::weak_ptr<ServerConn>& conn,
+                               std::function<void(const std::string&)>&& onClose)
+{
+    Subscriber sub;
+    sub.setup = std::move(setup);
+    sub.peer = peer;
+    sub.conn = conn;
+    sub.onClose = std::move(onClose);
+
+    Value prototype;
+    {
+        Guard G(lock);
+        if(current)
+            prototype = current.cloneEmpty();
+    }
+    if(!prototype) {
+        pending.push_back(std::move(sub));
+        return;
+    }
+
+    const server::MonitorControlOp* key;
+    try {
+        // sends type to client
+        sub.ctrl = sub.setup->connect(prototype);
+        key = sub.ctrl.get();
+
+        std::weak_ptr<McastPublisher> wself(shared_from_this());
+        sub.setup->onClose([wself, key](const std::string& msg) {
+            // on acceptor worker
+            auto self = wself.lock();
+            if(!self)
+                return;
+            auto it(self->subscribers.find(key));
+            if(it==self->subscribers.end())
+                return;
+            auto fn(std::move(it->second.onClose));
+            self->subscribers.erase(it);
+            if(fn)
+                fn(msg);
+        });
+
+    }catch(std::exception& e){
+        sub.setup->error(e.what());
+        return;
+    }
+
+    log_debug_printf(logmcast, "Client %s subscribes to '%s' through %s\n",
+                     sub.setup->peerName().c_str(), name.c_str(), std::string(SB()<<group.addr).c_str());
+
+    auto sconn(sub.conn.lock());
+    sub.setup.reset();
+    subscribers[key] = std::move(sub);
+
+    // new subscriber learns the source of datagrams, and needs a complete value.
+    // Both through TCP, which is the client's only proof of who sends them.
+    if(sconn) {
+        Guard G(lock);
+        sendGrant(*sconn);
+        sendSync(*sconn);
+    }
+}
+
+void McastPublisher::report(Report::Multicast& info, bool zero)
+{
+    info.name = name;
+    info.group = std::string(SB()<<group.addr);
+    info.source = sock.sockname().tostring();
+    info.subscribers = subscribers.size();
+    {
+        Guard G(lock);
+        info.seq = seq;
+    }
+    info.retransmits = statRetransmit;
+    info.syncs = statSync;
+    info.nacksIgnored = statIgnored;
+
+    if(zero)
+        statRetransmit = statSync = statIgnored = 0u;
+}
+
+void McastPublisher::publish(const Value& val)
+{
+    if(!val) {
+        // finish()
+        closed("Finished");
+        return;
+    }
+
+    Guard G(lock);
+    if(!current)
+        return;
+
+    current.assign(val);
+
+    if(!encode(hostBE, pva_mcast_kind::Update, seq+1u, &val))
+        return;
+
+    seq++;
+    history.emplace_back(seq, txbuf);
+    if(history.size() > mcastHistory)
+        history.pop_front();
+
+    send(group.addr);
+}
+
+bool McastPublisher::encode(bool be, uint8_t kind, uint64_t seq, const Value* val)
+{
+    txbuf.resize(0x10000u);
+
+    VectorOutBuf M(be, txbuf);
+    M.skip(8, __FILE__, __LINE__); // fill in header after body length known
+
+    to_wire(M, name);
+    to_wire(M, seq);
+    to_wire(M, kind);
+    if(val) {
+        to_wire_valid(M, *val);
+        to_wire(M, uint8_t(0u)); // empty overrun mask
+    }
+
+    auto pktlen = M.save()-txbuf.data();
+
+    FixedBuf H(be, txbuf.data(), 8);
+    to_wire(H, Header{CMD_MCAST_DATA, pva_flags::Server, uint32_t(pktlen-8)});
+
+    if(!M.good() || !H.good() || size_t(pktlen) > mcastMaxDatagram) {
+        log_err_printf(logmcast, "Unable to multicast '%s' update of %zu bytes\n", name.c_str(), size_t(pktlen));
+        return false;
+    }
+
+    txbuf.resize(pktlen);
+    return true;
+}
+
+void McastPublisher::send(const SockAddr& dest)
+{
+    auto ntx = sendto(sock.sock, (char*)txbuf.data(), txbuf.size(), 0, &dest->sa, dest.size());
+    if(ntx < 0) {
+        int err = evutil_socket_geterror(sock.sock);
+        log_debug_printf(logmcast, "Error sending '%s' to %s : %s\n",
+                         name.c_str(), dest.tostring().c_str(), evutil_socket_error_to_string(err));
+    }
+    sent = true;
+}
+
+void McastPublisher::sendSync(ServerConn& conn)
+{
+    if(!current || !conn.connection())
+        return;
+
+    auto full(current.clone());
+    full.mark();
+    if(!encode(conn.sendBE, pva_mcast_kind::Sync, seq, &full))
+        return;
+
+    // as a datagram, without header
+    if(evbuffer_add(conn.txBody.get(), txbuf.data()+8u, txbuf.size()-8u))
+        throw BAD_ALLOC();
+    (void)conn.enqueueTxBody(CMD_MCAST_DATA);
+    statSync++;
+}
+
+void McastPublisher::sendGrant(ServerConn& conn)
+{
+    if(!conn.connection())
+        return;
+
+    {
+        EvOutBuf M(conn.sendBE, conn.txBody.get());
+        to_wire(M, name);
+        to_wire(M, seq);
+        to_wire(M, uint8_t(pva_mcast_kind::Grant));
+        to_wire(M, uint16_t(sock.sockname().port()));
+    }
+    (void)conn.enqueueTxBody(CMD_MCAST_DATA);
+}
+
+void McastPublisher::onRx()
+{
+    rxbuf.resize(0x1000u);
+
+    for(unsigned i=0u; i<16u; i++) {
+        SockAddr src;
+        recvfromx R{sock.sock, (char*)rxbuf.data(), rxbuf.size(), &src, nullptr};
+        const int nrx = R.call();
+
+        if(nrx<0)
+            break; // wait for more I/O
+
+        if(nrx<8 || rxbuf[0]!=0xca || rxbuf[3]!=CMD_MCAST_NACK || src.isMCast())
+            continue;
+
+        FixedBuf M(rxbuf[2]&pva_flags::MSB, rxbuf.data()+4, nrx-4);
+        uint32_t len = 0u;
+        std::string pvname;
+        uint64_t first = 0u, last = 0u;
+        from_wire(M, len);
+        from_wire(M, pvname);
+        from_wire(M, first);
+        from_wire(M, last);
+
+        if(!M.good() || len > uint32_t(nrx-8) || pvname!=name) {
+            log_debug_printf(logmcast, "Ignore invalid NACK from %s\n", src.tostring().c_str());
+            continue;
+        }
+
+        log_debug_printf(logmcast, "Client %s NACKs '%s' %llu-%llu\n", src.tostring().c_str(), name.c_str(),
+                         (unsigned long long)first, (unsigned long long)last);
+
+        // only from a host with a client subscription through TCP, and at a limited rate.
+        // Otherwise a forged source address could direct replies to any host.
+        bool known = false;
+        for(auto& pair : subscribers) {
+            if(pair.second.peer.compare(src, false)==0) {
+                known = true;
+                break;
+            }
+        }
+        if(!known || nackBudget[src] >= mcastNackBudget) {
+            log_debug_printf(logmcast, "Ignore NACK of '%s' from %s %s\n", name.c_str(), src.tostring().c_str(),
+                             known ? "over rate limit" : "without subscription");
+            statIgnored++;
+            continue;
+        }
+        auto& budget = nackBudget[src];
+
+        Guard G(lock);
+
+        if(!first || first > last || history.empty() || first < history.front().first) {
+            // too old, or a request for a complete value, which may be large.
+            // So sent through TCP, once to each connection from this host.
+            std::set<ServerConn*> done;
+            for(auto& pair : subscribers) {
+                if(pair.second.peer.compare(src, false)!=0)
+                    continue;
+                auto conn(pair.second.conn.lock());
+                if(conn && done.insert(conn.get()).second)
+                    sendSync(*conn);
+            }
+            budget++;
+            continue;
+        }
+
+        for(auto& ent : history) {
+            if(ent.first < first || ent.first > last)
+                continue;
+            if(budget >= mcastNackBudget) {
+                statIgnored++;
+                break;
+            }
+            auto ntx = sendto(sock.sock, (char*)ent.second.data(), ent.second.size(), 0, &src->sa, src.size());
+            if(ntx < 0)
+                break;
+            budget++;
+            statRetransmit++;
+        }
+    }
+}
+
+void McastPublisher::onRxS(evutil_socket_t fd, short evt, void *raw)
+{
+    try {
+        static_cast<McastPublisher*>(raw)->onRx();
+    }catch(std::exception& e){
+        log_exc_printf(logmcast, "Unhandled error in multicast RX callback: %s\n", e.what());
+    }
+}
+
+void McastPublisher::onTick()
+{
+    nackBudget.clear();
+
+    if(!claimed) {
+        open();
+        return;
+    }
+
+    Guard G(lock);
+    // Let clients notice when they have missed the latest Update
+    if(!sent && current && encode(hostBE, pva_mcast_kind::Heartbeat, seq, nullptr))
+        send(group.addr);
+    sent = false;
+}
+
+void McastPublisher::onTickS(evutil_socket_t fd, short evt, void *raw)
+{
+    try {
+        static_cast<McastPublisher*>(raw)->onTick();
+    }catch(std::exception& e){
+        log_exc_printf(logmcast, "Unhandled error in multicast timer callback: %s\n", e.what());
+    }
+}
+
+}} // namespace pvxs::impl
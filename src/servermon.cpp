@@ -13,6 +13,7 @@
 
 #include <pvxs/log.h>
 #include "dataimpl.h"
+#include "ndcodec.h"
 #include "serverconn.h"
 #include "pvrequest.h"
 
@@ -52,6 +53,8 @@ struct MonitorOp final : public ServerOp
     std::shared_ptr<const FieldDesc> type;
     BitMask pvMask;
     std::string msg;
+    // NTNDArray codec requested with "record._options.codec"
+    std::string codec;
 
     // Further members guarded by this lock (except as noted)
     mutable epicsMutex lock;
@@ -148,6 +151,10 @@ struct MonitorOp final : public ServerOp
             (void)evbuffer_drain(conn->txBody.get(), evbuffer_get_length(conn->txBody.get()));
 
             EvOutBuf R(conn->sendBE, conn->txBody.get());
+            R.refThreshold = conn->zeroCopyThreshold;
+            R.refCount = &conn->statTxRef;
+            R.shmRing = conn->shm.get();
+            R.shmThreshold = conn->shmThreshold;
             to_wire(R, uint32_t(self->ioid));
             to_wire(R, subcmd);
             if(subcmd&0x08) {
@@ -252,6 +259,12 @@ struct ServerMonitorControl : public server::MonitorControlOp
         // pvMask is const at this point, so no need to lock
         bool real = testmask(val, mon->pvMask);
 
+        // codec is also const.  Compress on the posting thread, without the lock,
+        // to keep this work off of the server worker.
+        Value ent(val);
+        if(real && val && !mon->codec.empty())
+            ent = ndCodecEncode(val, mon->codec);
+
         Guard G(mon->lock);
         if(mon->finished)
             return false;
@@ -261,7 +274,7 @@ struct ServerMonitorControl : public server::MonitorControlOp
             if((mon->queue.size() < mon->limit) || force || !val) {
 
                 mon->finished = !val;
-                mon->queue.push_back(val);
+                mon->queue.push_back(ent);
 
                 if(mon->maxQueue < mon->queue.size())
                     mon->maxQueue = mon->queue.size();
@@ -270,7 +283,8 @@ struct ServerMonitorControl : public server::MonitorControlOp
                 // squash
                 assert(mon->limit>0 && !mon->queue.empty());
 
-                mon->queue.back().assign(val);
+                // may be a frozen Value shared with other subscribers
+                mon->queue.back().thaw().assign(ent);
                 mon->nSquash++;
 
             } else {
@@ -532,6 +546,17 @@ void ServerConn::handle_MONITOR()
 
         op->ackAt = std::max<size_t>(1u, std::min(op->ackAt, op->limit));
 
+        auto codec(pvRequest["record._options.codec"]);
+        if(codec.type()==TypeCode::String) {
+            auto name(codec.as<std::string>());
+            if(ndCodecSupported(name)) {
+                op->codec = name;
+            } else if(!name.empty()) {
+                log_debug_printf(connsetup, "Client %s requests unsupported codec \"%s\".  Ignoring\n",
+                                 peerName.c_str(), name.c_str());
+            }
+        }
+
         std::unique_ptr<ServerMonitorSetup> ctrl(new ServerMonitorSetup(this, iface->server->internal_self, chan->name, pvRequest, op));
 
         op->state = ServerOp::Creating;
@@ -543,8 +568,25 @@ void ServerConn::handle_MONITOR()
                    peerName.c_str(), op->pipeline ? " pipeline" : "", unsigned(ioid),
                    std::string(SB()<<pvRequest).c_str());
 
+        // the Server may already be publishing this PV to the group requested
+        std::shared_ptr<McastPublisher> mcast;
+        auto mcastGroup(pvRequest["record._options.multicast"]);
+#ifdef PVXS_ENABLE_OPENSSL
+        // as cleartext, unauthenticated, UDP.  cf. compressAllowed()
+        if(iface->isTLS)
+            mcastGroup = Value();
+#endif
+        if(mcastGroup.type()==TypeCode::String) {
+            auto it(iface->server->multicasts.find(chan->name));
+            if(it!=iface->server->multicasts.end() && it->second->matches(mcastGroup.as<std::string>()))
+                mcast = it->second;
+        }
+
         if(chan->onSubscribe) {
-            chan->onSubscribe(std::move(ctrl));
+            if(mcast)
+                chan->onSubscribe(mcast->gate(std::move(ctrl), peerAddr, shared_from_this()));
+            else
+                chan->onSubscribe(std::move(ctrl));
         } else {
             ctrl->error("Monitor operation not implemented by this PV");
         }
@@ -27,6 +27,16 @@ void ServerSource::onSearch(Search &op)
     // nothing.  our "server" PV is not advertised
 }
 
+server::Source::List ServerSource::onList()
+{
+    // our "server" PV is not advertised, so never claimed by onSearch()
+    static const auto none(std::make_shared<const std::set<std::string>>());
+    List ret;
+    ret.names = none;
+    ret.dynamic = false;
+    return ret;
+}
+
 void ServerSource::onCreate(std::unique_ptr<server::ChannelControl> &&op)
 {
     if(!op || op->name()!=name)
@@ -42,6 +42,8 @@ struct SharedPV::Impl : public std::enable_shared_from_this<Impl>
     std::function<void(SharedPV&)> onFirstConnect;
     std::function<void(SharedPV&)> onLastDisconnect;
 
+    HandlerPool pool;
+
     ptr_set<std::weak_ptr<ChannelControl>> channels;
 
     std::set<std::shared_ptr<ConnectOp>> pending;
@@ -52,6 +54,41 @@ struct SharedPV::Impl : public std::enable_shared_from_this<Impl>
 
     INST_COUNTER(SharedPVImpl);
 
+    // call onPut or onRPC, either now or on a HandlerPool thread
+    static
+    void callExec(const std::shared_ptr<Impl>& self,
+                  const std::function<void(SharedPV&, std::unique_ptr<ExecOp>&&, Value&&)>& cb,
+                  HandlerPool& pool,
+                  std::unique_ptr<ExecOp>&& op, Value&& arg, const char* what)
+    {
+        SharedPV pv;
+        pv.impl = self;
+
+        if(!pool) {
+            try {
+                cb(pv, std::move(op), std::move(arg));
+            }catch(std::exception& e){
+                log_err_printf(logshared, "error in %s cb: %s\n", what, e.what());
+            }
+            return;
+        }
+
+        // std::function must be copyable
+        std::shared_ptr<std::unique_ptr<ExecOp>> sop(std::make_shared<std::unique_ptr<ExecOp>>(std::move(op)));
+        auto fn([pv, cb, sop, arg, what]() mutable {
+            try {
+                cb(pv, std::move(*sop), std::move(arg));
+            }catch(std::exception& e){
+                log_err_printf(logshared, "error in %s cb: %s\n", what, e.what());
+            }
+        });
+        if(!pool.submit(std::move(fn))) {
+            log_warn_printf(logshared, "%s on %s %s rejected, handler queue full\n",
+                            (*sop)->peerName().c_str(), (*sop)->name().c_str(), what);
+            (*sop)->error("Server busy");
+        }
+    }
+
     static
     void connectOp(const std::shared_ptr<Impl>& self, const std::shared_ptr<ConnectOp>& conn, const Value& current)
     {
@@ -168,14 +205,9 @@ void SharedPV::attach(std::unique_ptr<ChannelControl>&& ctrlop)
         Guard G(self->lock);
         auto cb(self->onRPC);
         if(cb) {
-            SharedPV pv;
-            pv.impl = self;
-            try {
-                UnGuard U(G);
-                cb(pv, std::move(op), std::move(arg));
-            }catch(std::exception& e){
-                log_err_printf(logshared, "error in RPC cb: %s\n", e.what());
-            }
+            auto pool(self->pool);
+            UnGuard U(G);
+            Impl::callExec(self, cb, pool, std::move(op), std::move(arg), "RPC");
         } else {
             op->error("RPC not implemented by this PV");
         }
@@ -215,14 +247,9 @@ void SharedPV::attach(std::unique_ptr<ChannelControl>&& ctrlop)
             Guard G(self->lock);
             auto cb(self->onPut);
             if(cb) {
-                try {
-                    SharedPV pv;
-                    pv.impl = self;
-                    UnGuard U(G);
-                    cb(pv, std::move(op), std::move(val));
-                }catch(std::exception& e){
-                    log_err_printf(logshared, "error in Put cb: %s\n", e.what());
-                }
+                auto pool(self->pool);
+                UnGuard U(G);
+                Impl::callExec(self, cb, pool, std::move(op), std::move(val), "Put");
             } else {
                 op->error("Put not implemented by this PV");
             }
@@ -346,6 +373,14 @@ void SharedPV::onRPC(std::function<void(SharedPV&, std::unique_ptr<ExecOp>&&, Va
     impl->onRPC = std::move(fn);
 }
 
+void SharedPV::handlerPool(const HandlerPool& pool)
+{
+    if(!impl)
+        throw std::logic_error("Empty SharedPV");
+    Guard G(impl->lock);
+    impl->pool = pool;
+}
+
 void SharedPV::open(const Value& initial)
 {
     if(!impl)
@@ -434,7 +469,8 @@ void SharedPV::post(const Value& val)
     if(impl->subscribers.empty())
         return;
 
-    auto copy(val.clone());
+    // caller promises not to change a frozen Value, so share it
+    auto copy(val.isFrozen() ? val : val.clone());
 
     for(auto& sub : impl->subscribers) {
         sub->post(copy);
@@ -706,6 +742,7 @@ StaticSource& StaticSource::add(const std::string& name, const SharedPV &pv)
 
     impl->pvs[name] = std::make_shared<SharedPV>(pv);
     impl->list.reset();
+    impl->listChanged();
 
     return *this;
 }
@@ -723,6 +760,7 @@ StaticSource& StaticSource::add(const std::string& name, const SharedWildcardPV&
     // Store as shared_ptr<SharedWildcardPV>
     impl->pvs[name] = std::make_shared<SharedWildcardPV>(pv);
     impl->list.reset();
+    impl->listChanged();
 
     return *this;
 }
@@ -742,6 +780,7 @@ StaticSource& StaticSource::remove(const std::string& name)
         pv = *it->second;
         impl->pvs.erase(it);
         impl->list.reset();
+        impl->listChanged();
     }
 
     pv.close();
@@ -0,0 +1,291 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <string>
+#include <system_error>
+
+#include <pvxs/log.h>
+
+#include "shm.h"
+
+#ifdef PVXS_HAVE_SHM
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+#if defined(PVXS_HAVE_SHM) && defined(MFD_ALLOW_SEALING) && defined(F_ADD_SEALS)
+#  define PVXS_HAVE_SHM_SEAL
+#endif
+
+DEFINE_LOGGER(logshm, "pvxs.shm");
+
+namespace pvxs {
+namespace impl {
+
+constexpr size_t ShmRing::align;
+
+ShmRing::~ShmRing()
+{
+#ifdef PVXS_HAVE_SHM
+    munmap(base, size);
+    close(fd);
+#endif
+}
+
+std::unique_ptr<ShmRing> ShmRing::create(size_t size)
+{
+#ifdef PVXS_HAVE_SHM_SEAL
+    {
+        size_t page = sysconf(_SC_PAGESIZE);
+        size = (size + page - 1u) / page * page;
+    }
+
+    int rwfd = memfd_create("pvxs-shm", MFD_CLOEXEC|MFD_ALLOW_SEALING);
+    if(rwfd<0) {
+        log_warn_printf(logshm, "Unable to memfd_create(): %d\n", errno);
+        return nullptr;
+    }
+
+    // A client able to shrink the ring would fault the server on its next place()
+    if(ftruncate(rwfd, size) || fcntl(rwfd, F_ADD_SEALS, F_SEAL_SHRINK|F_SEAL_GROW|F_SEAL_SEAL)) {
+        log_warn_printf(logshm, "Unable to allocate %zu bytes of shared memory: %d\n", size, errno);
+        close(rwfd);
+        return nullptr;
+    }
+
+    auto base = mmap(nullptr, size, PROT_READ|PROT_WRITE, MAP_SHARED, rwfd, 0);
+    if(base==MAP_FAILED) {
+        log_warn_printf(logshm, "Unable to map %zu bytes of shared memory: %d\n", size, errno);
+        close(rwfd);
+        return nullptr;
+    }
+
+    // only a read-only descriptor is passed to the client
+    int fd = ::open(("/proc/self/fd/" + std::to_string(rwfd)).c_str(), O_RDONLY|O_CLOEXEC);
+    close(rwfd);
+    if(fd<0) {
+        log_warn_printf(logshm, "Unable to reopen shared memory read-only: %d\n", errno);
+        munmap(base, size);
+        return nullptr;
+    }
+
+    log_debug_printf(logshm, "Created shared memory ring of %zu bytes\n", size);
+
+    return std::unique_ptr<ShmRing>(new ShmRing(size, fd, static_cast<uint8_t*>(base)));
+#else
+    (void)size;
+    return nullptr;
+#endif
+}
+
+bool ShmRing::place(const void* ptr, size_t nbytes, uint64_t& offset)
+{
+    const size_t len = (nbytes + align - 1u) & ~(align - 1u);
+    if(!len || len > size)
+        return false;
+
+    // next fit.  Search from where the previous placement ended, then from the start.
+    for(size_t start : {next, size_t(0u)}) {
+        auto it = live.lower_bound(start);
+        if(it!=live.begin()) {
+            auto prev(std::prev(it));
+            start = std::max(start, prev->first + prev->second);
+        }
+
+        while(true) {
+            size_t end = it==live.end() ? size : it->first;
+
+            if(end >= start && end - start >= len) {
+                memcpy(base + start, ptr, nbytes);
+                live[start] = len;
+                next = start + len;
+                offset = start;
+                return true;
+            }
+            if(it==live.end())
+                break;
+            start = it->first + it->second;
+            ++it;
+        }
+    }
+    log_debug_printf(logshm, "Shared memory full.  %zu arrays referenced\n", live.size());
+    return false;
+}
+
+void ShmRing::release(uint64_t offset)
+{
+    if(live.erase(offset))
+        return;
+
+    // misbehaving client.  Don't let it flood the log
+    if(!nUnknown++) {
+        log_warn_printf(logshm, "Client releases unknown offset %llu.  Further ignored\n", (unsigned long long)offset);
+    } else {
+        log_debug_printf(logshm, "Client releases unknown offset %llu, %zu times\n", (unsigned long long)offset, nUnknown);
+    }
+}
+
+ShmMap::~ShmMap()
+{
+#ifdef PVXS_HAVE_SHM
+    munmap(const_cast<uint8_t*>(base), size);
+#endif
+}
+
+std::shared_ptr<ShmMap> ShmMap::open(int fd, std::function<void(uint64_t)>&& onRelease)
+{
+#ifdef PVXS_HAVE_SHM_SEAL
+    // a server able to shrink the ring could fault this client
+    const int seals = fcntl(fd, F_GET_SEALS);
+    if(seals<0 || (seals&(F_SEAL_SHRINK|F_SEAL_SEAL))!=(F_SEAL_SHRINK|F_SEAL_SEAL)) {
+        log_warn_printf(logshm, "Ignore unsealed shared memory: %d\n", seals);
+        close(fd);
+        return nullptr;
+    }
+
+    struct stat info{};
+    void* base = MAP_FAILED;
+    if(!fstat(fd, &info) && info.st_size>0)
+        base = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if(base==MAP_FAILED) {
+        log_warn_printf(logshm, "Unable to map shared memory: %d\n", errno);
+        return nullptr;
+    }
+
+    log_debug_printf(logshm, "Mapped shared memory ring of %zu bytes\n", size_t(info.st_size));
+
+    return std::shared_ptr<ShmMap>(new ShmMap(info.st_size, static_cast<const uint8_t*>(base), std::move(onRelease)));
+#else
+    (void)onRelease;
+    evutil_closesocket(fd);
+    return nullptr;
+#endif
+}
+
+std::shared_ptr<const void> ShmMap::array(uint64_t offset, size_t nbytes)
+{
+    if(offset%ShmRing::align || offset > size || nbytes > size - offset)
+        return nullptr;
+
+    // the mapping outlives all arrays referencing it
+    return std::shared_ptr<const void>(base + offset, Ref{shared_from_this(), offset});
+}
+
+void ShmMap::unpin(Value& val)
+{
+    for(auto fld : val.iall()) {
+        auto type(fld.type());
+        if(!type.isarray() || type.kind()==Kind::Compound)
+            continue;
+
+        auto arr(fld.as<shared_array<const void>>());
+        if(!std::get_deleter<Ref>(arr.dataPtr()))
+            continue;
+
+        auto copy(detail::copyAs(arr.original_type(), arr.original_type(), arr.data(), arr.size()));
+        fld.from(copy.freeze());
+    }
+}
+
+#ifdef PVXS_HAVE_UNIX_SOCKET
+
+void sendShmOffer(evutil_socket_t sock, bool be, size_t threshold, const ShmRing* ring)
+{
+    uint8_t header[8];
+    FixedBuf H(be, header, sizeof(header));
+    to_wire(H, Header{pva_ctrl_msg::ShmOffer, pva_flags::Control|pva_flags::Server, uint32_t(ring ? threshold : 0u)});
+    assert(H.good());
+
+    iovec iov{header, sizeof(header)};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1u;
+
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        cmsghdr align;
+    } control{};
+
+    if(ring) {
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+        auto cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &ring->fd, sizeof(int));
+    }
+
+#ifndef MSG_NOSIGNAL
+#  define MSG_NOSIGNAL 0
+#endif
+    // nothing else yet sent, so the socket buffer has space
+    auto ret = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    if(ret!=ssize_t(sizeof(header))) {
+        auto err(evutil_socket_geterror(sock));
+        throw std::system_error(ret<0 ? err : EIO, std::system_category());
+    }
+}
+
+int recvShmOffer(evutil_socket_t sock, size_t& threshold, int& fd)
+{
+    fd = -1;
+
+    uint8_t header[8];
+    iovec iov{header, sizeof(header)};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1u;
+
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        cmsghdr align;
+    } control{};
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+#ifndef MSG_CMSG_CLOEXEC
+#  define MSG_CMSG_CLOEXEC 0
+#endif
+    auto ret = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    if(ret<0) {
+        auto err(evutil_socket_geterror(sock));
+        if(err==SOCK_EWOULDBLOCK || err==EAGAIN || err==SOCK_EINTR)
+            return -1;
+    }
+
+    for(auto cmsg = CMSG_FIRSTHDR(&msg); ret>0 && cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if(cmsg->cmsg_level==SOL_SOCKET && cmsg->cmsg_type==SCM_RIGHTS && cmsg->cmsg_len==CMSG_LEN(sizeof(int)))
+            memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+
+    Header head{};
+    FixedBuf H(true, header, sizeof(header));
+    if(ret==ssize_t(sizeof(header)))
+        from_wire(H, head);
+
+    if(ret!=ssize_t(sizeof(header)) || !H.good() || (msg.msg_flags&MSG_CTRUNC)
+            || !(head.flags&pva_flags::Control) || head.cmd!=pva_ctrl_msg::ShmOffer
+            || (head.len && fd<0))
+    {
+        log_debug_printf(logshm, "Invalid ShmOffer from server (%d)\n", int(ret));
+        if(fd>=0)
+            evutil_closesocket(fd);
+        fd = -1;
+        return 0;
+    }
+
+    threshold = head.len;
+    return 1;
+}
+
+#endif // PVXS_HAVE_UNIX_SOCKET
+
+}} // namespace pvxs::impl
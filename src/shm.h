@@ -0,0 +1,129 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef SHM_H
+#define SHM_H
+
+#include <functional>
+#include <map>
+#include <memory>
+
+#include <pvxs/data.h>
+
+#include "evhelper.h"
+
+#if defined(__linux__) && defined(PVXS_HAVE_UNIX_SOCKET)
+#  define PVXS_HAVE_SHM
+#endif
+
+namespace pvxs {
+namespace impl {
+
+/** Memory shared by a server with one client, connected through a Unix socket.
+ *
+ * The server copies large array bodies into the ring in place of sending them inline.
+ * The client references these in place, until the last reference is released,
+ * at which point it sends pva_ctrl_msg::ShmRelease and the server may reuse the space.
+ * A ring which fills up, eg. with a client holding on to many arrays, falls back to inline.
+ *
+ * Only used from the server connection worker.
+ */
+struct PVXS_API ShmRing {
+    //! Placement granularity
+    static constexpr size_t align = 64u;
+
+    const size_t size;
+    //! Read-only descriptor passed to the client.  Size is sealed.
+    const int fd;
+
+    ~ShmRing();
+
+    //! Create a ring of (at least) size bytes.
+    //! @returns nullptr if not supported by this build, or on failure.
+    static std::unique_ptr<ShmRing> create(size_t size);
+
+    //! Copy nbytes at ptr into the ring.
+    //! @returns false if no space is available.
+    bool place(const void* ptr, size_t nbytes, uint64_t& offset);
+
+    //! The client no longer references the array placed at offset
+    void release(uint64_t offset);
+
+private:
+    ShmRing(size_t size, int fd, uint8_t* base) :size(size), fd(fd), base(base) {}
+
+    uint8_t* const base;
+    // offset -> length of arrays placed, and not yet released
+    std::map<size_t, size_t> live;
+    // where to look first for free space
+    size_t next = 0u;
+    // releases of offsets not live.  Only the first is logged as a warning
+    size_t nUnknown = 0u;
+};
+
+//! Client's read-only mapping of a ShmRing
+struct PVXS_API ShmMap : public std::enable_shared_from_this<ShmMap> {
+    const size_t size;
+
+    ~ShmMap();
+
+    /** Map a received ShmRing::fd, which is closed.
+     *
+     * @param onRelease Called, from any thread, when no references remain to an array.
+     * @returns nullptr on failure.
+     */
+    static std::shared_ptr<ShmMap> open(int fd, std::function<void(uint64_t offset)>&& onRelease);
+
+    //! Reference an array placed by the server.
+    //! @returns nullptr if out of range
+    std::shared_ptr<const void> array(uint64_t offset, size_t nbytes);
+
+    /** Replace any arrays in val which reference shared memory with private copies.
+     *
+     * For a Value held indefinitely, eg. the cache of the last complete update of an operation,
+     * whose arrays would otherwise keep the server from reusing ring space.
+     */
+    static void unpin(Value& val);
+
+private:
+    // deleter of arrays returned by array()
+    struct Ref {
+        std::shared_ptr<ShmMap> map;
+        uint64_t offset;
+        void operator()(const void*) const { map->onRelease(offset); }
+    };
+
+    ShmMap(size_t size, const uint8_t* base, std::function<void(uint64_t offset)>&& onRelease)
+        :size(size), base(base), onRelease(std::move(onRelease))
+    {}
+
+    const uint8_t* const base;
+    const std::function<void(uint64_t offset)> onRelease;
+};
+
+#ifdef PVXS_HAVE_UNIX_SOCKET
+
+/** Send pva_ctrl_msg::ShmOffer, which must be the first message from the server on a Unix socket connection.
+ *
+ * @param threshold Arrays of at least this many bytes may be placed in ring.  Zero if !ring
+ * @param ring Passed to the client with SCM_RIGHTS.  May be nullptr
+ */
+void sendShmOffer(evutil_socket_t sock, bool be, size_t threshold, const ShmRing* ring);
+
+/** Receive pva_ctrl_msg::ShmOffer, before any other data on a Unix socket connection.
+ *
+ * Must be read with recvmsg() as any file descriptor is discarded by plain read().
+ *
+ * @param threshold Set to that of the server, which may be zero.
+ * @param fd Set to the received ShmRing::fd, or -1.  Caller must close.
+ * @returns -1 if not yet received, 0 if invalid, 1 if received.
+ */
+int recvShmOffer(evutil_socket_t sock, size_t& threshold, int& fd);
+
+#endif // PVXS_HAVE_UNIX_SOCKET
+
+}} // namespace pvxs::impl
+
+#endif // SHM_H
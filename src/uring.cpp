@@ -0,0 +1,738 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <pvxs/log.h>
+
+#include "uring.h"
+
+#ifdef PVXS_ENABLE_IO_URING
+#  include <algorithm>
+#  include <map>
+#  include <set>
+#  include <system_error>
+
+#  include <string.h>
+#  include <sys/eventfd.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+
+#  include <liburing.h>
+
+#  include <epicsGuard.h>
+#  include <epicsMutex.h>
+#endif
+
+DEFINE_LOGGER(logio, "pvxs.tcp.uring");
+
+namespace pvxs {
+namespace impl {
+
+URingSocket::~URingSocket() {}
+
+URing::~URing() {}
+
+#ifndef PVXS_ENABLE_IO_URING
+
+std::shared_ptr<URing> URing::create(const evbase&)
+{
+    log_warn_printf(logio, "io_uring not supported by this build.  Using libevent for TCP%s\n", "");
+    return nullptr;
+}
+
+#else // PVXS_ENABLE_IO_URING
+
+namespace {
+
+// Number and size of receive buffers in the registered buffer ring.  nBufs must be a power of 2.
+constexpr unsigned nBufs = 256u;
+constexpr unsigned bufSize = 16u*1024u;
+constexpr int bufGroup = 0;
+// Received data at least this long is passed by reference, smaller is copied
+// so that a few bytes can not hold a whole buffer.
+constexpr size_t copyThreshold = bufSize/4u;
+// retry interval when no receive buffer is free
+constexpr timeval starvedDelay{0, 10000};
+// submission queue depth
+constexpr unsigned ringDepth = 1024u;
+// max. number of evbuffer chains sent with one sendmsg()
+constexpr size_t maxIOV = 64u;
+// completions taken at once
+constexpr unsigned maxCQE = 64u;
+
+typedef epicsGuard<epicsMutex> Guard;
+
+struct BufPool;
+
+// cleanup context of a buffer referenced by an evbuffer chain
+struct BufRef {
+    BufPool* pool;
+    unsigned bid;
+};
+
+// Receive buffers of the registered buffer ring.  Received data is passed on by reference,
+// so these may outlive the URingImpl until the last evbuffer chain is free'd.
+struct BufPool {
+    const std::unique_ptr<char[]> bufs;
+    BufRef refs[nBufs];
+
+    epicsMutex lock;
+    // guarded by lock.  NULL once the ring is torn down
+    io_uring_buf_ring* bufRing = nullptr;
+    // one for URingImpl, and one for each buffer presently referenced
+    size_t nref = 1u;
+
+    BufPool()
+        :bufs(new char[size_t(nBufs)*bufSize])
+    {
+        for(auto i : range(nBufs))
+            refs[i] = BufRef{this, i};
+    }
+
+    char* buf(unsigned bid) const {
+        return bufs.get() + size_t(bid)*bufSize;
+    }
+
+    // hand back to the kernel.  Call with lock held
+    void recycle(unsigned bid)
+    {
+        if(!bufRing)
+            return;
+        io_uring_buf_ring_add(bufRing, buf(bid), bufSize, bid,
+                              io_uring_buf_ring_mask(nBufs), 0);
+        io_uring_buf_ring_advance(bufRing, 1);
+    }
+
+    void release()
+    {
+        bool last;
+        {
+            Guard G(lock);
+            last = !--nref;
+        }
+        if(last)
+            delete this;
+    }
+
+    // evbuffer_ref_cleanup_cb
+    static
+    void onUnref(const void *, size_t, void *raw)
+    {
+        auto ref = static_cast<BufRef*>(raw);
+        auto pool = ref->pool;
+        {
+            Guard G(pool->lock);
+            pool->recycle(ref->bid);
+        }
+        pool->release();
+    }
+};
+
+struct SockState;
+
+// user_data of each SQE.  Cancellation requests have user_data==NULL
+struct OpTag {
+    SockState* const sock;
+    enum Kind {
+        Recv,
+        Send,
+        Connect,
+    } const kind;
+};
+
+struct SockState {
+    const evutil_socket_t sock;
+    const size_t txLimit, rxLimit;
+    // our end of the pair.  cf. bufferevent_pair_get_partner()
+    evbufferevent wire;
+    // taken from wire input, presently being sent
+    evbuf sending;
+
+    OpTag recvTag{this, OpTag::Recv};
+    OpTag sendTag{this, OpTag::Send};
+    OpTag connTag{this, OpTag::Connect};
+
+    SockAddr peer;
+    msghdr msg{};
+    iovec iov[maxIOV];
+
+    // number of SQEs for which we expect a(nother) CQE
+    unsigned inflight = 0u;
+    bool connected;
+    bool received = false;
+    bool recvArmed = false;
+    bool rxPaused = false;
+    bool isSending = false;
+    // after error or EOF
+    bool failed = false;
+    // after our handle is destroyed
+    bool closing = false;
+
+    SockState(evutil_socket_t sock, bool connected, size_t txLimit, size_t rxLimit)
+        :sock(sock)
+        ,txLimit(txLimit)
+        ,rxLimit(rxLimit)
+        ,sending(__FILE__, __LINE__, evbuffer_new())
+        ,connected(connected)
+    {}
+    ~SockState() {
+        wire.reset();
+        evutil_closesocket(sock);
+    }
+
+    bufferevent* user() const {
+        return wire ? bufferevent_pair_get_partner(wire.get()) : nullptr;
+    }
+};
+
+struct URingImpl final : public URing, public std::enable_shared_from_this<URingImpl>
+{
+    const evbase loop;
+    io_uring ring{};
+    io_uring_buf_ring* bufRing = nullptr;
+    BufPool* pool = nullptr;
+    int efd = -1;
+    evevent evready;
+    evevent evsubmit;
+    evevent evstarved;
+    bool submitPending = false;
+    // cleared if the kernel rejects multishot receive (pre 6.0)
+    bool multishot = true;
+
+    std::map<SockState*, std::unique_ptr<SockState>> socks;
+    // waiting for a free receive buffer
+    std::set<SockState*> starved;
+
+    explicit URingImpl(const evbase& loop)
+        :loop(loop)
+    {
+        io_uring_params params{};
+        if(int err = io_uring_queue_init_params(ringDepth, &ring, &params))
+            throw std::system_error(-err, std::system_category(), "io_uring_queue_init_params()");
+
+        try {
+            int err = 0;
+            bufRing = io_uring_setup_buf_ring(&ring, nBufs, bufGroup, 0, &err);
+            if(!bufRing)
+                throw std::system_error(-err, std::system_category(), "io_uring_setup_buf_ring()");
+
+            pool = new BufPool();
+            for(auto i : range(nBufs))
+                io_uring_buf_ring_add(bufRing, pool->buf(i), bufSize, i,
+                                      io_uring_buf_ring_mask(nBufs), i);
+            io_uring_buf_ring_advance(bufRing, nBufs);
+            {
+                Guard G(pool->lock);
+                pool->bufRing = bufRing;
+            }
+
+            efd = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+            if(efd<0)
+                throw std::system_error(errno, std::system_category(), "eventfd()");
+
+            if(int err = io_uring_register_eventfd(&ring, efd))
+                throw std::system_error(-err, std::system_category(), "io_uring_register_eventfd()");
+
+            evready = evevent(__FILE__, __LINE__,
+                              event_new(loop.base, efd, EV_READ|EV_PERSIST, &onReadyS, this));
+            evsubmit = evevent(__FILE__, __LINE__,
+                               event_new(loop.base, -1, 0, &onSubmitS, this));
+            evstarved = evevent(__FILE__, __LINE__,
+                                event_new(loop.base, -1, 0, &onStarvedS, this));
+
+            if(event_add(evready.get(), nullptr))
+                throw std::runtime_error("Unable to add io_uring eventfd");
+
+        } catch(...) {
+            teardown();
+            throw;
+        }
+    }
+
+    virtual ~URingImpl() {
+        teardown();
+    }
+
+    void teardown()
+    {
+        evready.reset();
+        evsubmit.reset();
+        evstarved.reset();
+        // close sockets to fail any in-progress operations
+        for(auto& pair : socks)
+            (void)shutdown(pair.first->sock, SHUT_RDWR);
+        if(pool) {
+            // buffers still referenced are no longer returned to the ring
+            Guard G(pool->lock);
+            pool->bufRing = nullptr;
+        }
+        if(bufRing)
+            (void)io_uring_free_buf_ring(&ring, bufRing, nBufs, bufGroup);
+        bufRing = nullptr;
+        io_uring_queue_exit(&ring);
+        starved.clear();
+        socks.clear();
+        if(pool)
+            pool->release();
+        pool = nullptr;
+        if(efd>=0)
+            ::close(efd);
+        efd = -1;
+    }
+
+    virtual std::shared_ptr<URingSocket> attach(evutil_socket_t sock, bool connected,
+                                                size_t txLimit, size_t rxLimit,
+                                                evbufferevent& bev) override final;
+
+    io_uring_sqe* getSQE()
+    {
+        auto sqe = io_uring_get_sqe(&ring);
+        if(!sqe) {
+            // SQ full.  Submit what we have now.
+            submitNow();
+            sqe = io_uring_get_sqe(&ring);
+            if(!sqe)
+                throw std::runtime_error("io_uring SQ full");
+        }
+        if(!submitPending) {
+            // submit once all callbacks of this loop iteration have run
+            submitPending = true;
+            event_active(evsubmit.get(), EV_TIMEOUT, 0);
+        }
+        return sqe;
+    }
+
+    void submitNow()
+    {
+        int ret = io_uring_submit(&ring);
+        if(ret<0)
+            log_err_printf(logio, "io_uring_submit() error %d\n", -ret);
+    }
+
+    void armRecv(SockState& S)
+    {
+        if(S.recvArmed || S.rxPaused || !S.connected || S.failed || S.closing)
+            return;
+
+        auto sqe = getSQE();
+        if(multishot)
+            io_uring_prep_recv_multishot(sqe, S.sock, nullptr, 0, 0);
+        else
+            io_uring_prep_recv(sqe, S.sock, nullptr, bufSize, 0);
+        sqe->flags |= IOSQE_BUFFER_SELECT;
+        sqe->buf_group = bufGroup;
+        io_uring_sqe_set_data(sqe, &S.recvTag);
+        S.recvArmed = true;
+        S.inflight++;
+    }
+
+    void startSend(SockState& S)
+    {
+        if(S.isSending || !S.connected || S.failed || S.closing)
+            return;
+
+        if(!evbuffer_get_length(S.sending.get())) {
+            auto input(bufferevent_get_input(S.wire.get()));
+            if(!evbuffer_get_length(input))
+                return;
+
+            // moves whole chains where possible.  New data may then be appended to wire input
+            // while this sendmsg() is in progress, without disturbing the chains we are sending.
+            (void)evbuffer_remove_buffer(input, S.sending.get(), S.txLimit);
+
+            // take more from our partner output
+            (void)bufferevent_enable(S.wire.get(), EV_READ);
+        }
+
+        evbuffer_iovec vec[maxIOV];
+        auto n = std::min(size_t(evbuffer_peek(S.sending.get(), -1, nullptr, vec, maxIOV)), maxIOV);
+        for(auto i : range(n)) {
+            S.iov[i].iov_base = vec[i].iov_base;
+            S.iov[i].iov_len = vec[i].iov_len;
+        }
+        S.msg.msg_iov = S.iov;
+        S.msg.msg_iovlen = n;
+
+        auto sqe = getSQE();
+        io_uring_prep_sendmsg(sqe, S.sock, &S.msg, MSG_NOSIGNAL);
+        io_uring_sqe_set_data(sqe, &S.sendTag);
+        S.isSending = true;
+        S.inflight++;
+    }
+
+    void connect(SockState& S, const SockAddr& peer)
+    {
+        if(S.connected || S.inflight || S.closing)
+            throw std::logic_error("io_uring socket already connecting");
+
+        S.peer = peer;
+        auto sqe = getSQE();
+        io_uring_prep_connect(sqe, S.sock, &S.peer->sa, S.peer.size());
+        io_uring_sqe_set_data(sqe, &S.connTag);
+        S.inflight++;
+    }
+
+    void close(SockState& S)
+    {
+        S.closing = true;
+        if(S.inflight) {
+            // wait for in-progress operations to complete before closing the socket
+            auto sqe = getSQE();
+            io_uring_prep_cancel_fd(sqe, S.sock, IORING_ASYNC_CANCEL_ALL);
+            io_uring_sqe_set_data(sqe, nullptr);
+        } else {
+            forget(S);
+        }
+    }
+
+    void forget(SockState& S)
+    {
+        starved.erase(&S);
+        socks.erase(&S);
+    }
+
+    void fail(SockState& S, int err, short what)
+    {
+        if(S.failed || S.closing)
+            return;
+        S.failed = true;
+
+        log_debug_printf(logio, "socket %d error %d : %s\n", int(S.sock), err, strerror(err));
+
+        // any multishot receive will complete with EOF
+        (void)shutdown(S.sock, SHUT_RDWR);
+
+        if(auto user = S.user()) {
+            EVUTIL_SET_SOCKET_ERROR(err);
+            bufferevent_trigger_event(user, BEV_EVENT_ERROR|what, 0);
+        }
+    }
+
+    // Append received data to our output, from which it is moved to partner input.
+    // Returns true if the buffer is now referenced.
+    bool queueRX(SockState& S, unsigned bid, size_t len)
+    {
+        auto out(bufferevent_get_output(S.wire.get()));
+        auto buf(pool->buf(bid));
+
+        if(len < copyThreshold) {
+            if(evbuffer_add(out, buf, len))
+                log_err_printf(logio, "socket %d unable to queue RX\n", int(S.sock));
+            return false;
+        }
+
+        {
+            Guard G(pool->lock);
+            pool->nref++;
+        }
+        // returned to the ring when the chain is consumed.  cf. BufPool::onUnref()
+        if(evbuffer_add_reference(out, buf, len, &BufPool::onUnref, &pool->refs[bid])) {
+            log_err_printf(logio, "socket %d unable to queue RX\n", int(S.sock));
+            pool->release();
+            return false;
+        }
+        return true;
+    }
+
+    void handleRecv(SockState& S, int res, unsigned flags)
+    {
+        if(!(flags & IORING_CQE_F_MORE)) {
+            S.recvArmed = false;
+            S.inflight--;
+        }
+
+        if(flags & IORING_CQE_F_BUFFER) {
+            auto bid = flags >> IORING_CQE_BUFFER_SHIFT;
+            bool held = false;
+            if(res>0 && !S.failed && !S.closing && S.user())
+                held = queueRX(S, bid, size_t(res));
+            if(!held) {
+                Guard G(pool->lock);
+                pool->recycle(bid);
+            }
+        }
+
+        if(res>0) {
+            S.received = true;
+
+            auto pending = evbuffer_get_length(bufferevent_get_output(S.wire.get()));
+            if(!S.rxPaused && pending >= S.rxLimit) {
+                // stop receiving until our partner catches up.  cf. wireWriteS()
+                S.rxPaused = true;
+                if(S.recvArmed) {
+                    auto sqe = getSQE();
+                    io_uring_prep_cancel(sqe, &S.recvTag, 0);
+                    io_uring_sqe_set_data(sqe, nullptr);
+                }
+            }
+            armRecv(S);
+
+        } else if(res==0) {
+            if(S.failed || S.closing) {
+                // expected after shutdown()
+            } else {
+                S.failed = true;
+                // deliver any remaining RX, then BEV_EVENT_EOF
+                if(S.user())
+                    (void)bufferevent_flush(S.wire.get(), EV_WRITE, BEV_FINISHED);
+            }
+
+        } else if(res==-ENOBUFS) {
+            // all buffers are in use.  Re-arming now would only fail again.
+            starved.insert(&S);
+            if(!event_pending(evstarved.get(), EV_TIMEOUT, nullptr))
+                (void)event_add(evstarved.get(), &starvedDelay);
+
+        } else if(res==-ECANCELED || res==-EAGAIN || res==-EINTR) {
+            // paused, or spurious
+            armRecv(S);
+
+        } else if(res==-EINVAL && multishot && !S.received) {
+            log_debug_printf(logio, "io_uring multishot receive not supported.  Using single shot.%s\n", "");
+            multishot = false;
+            armRecv(S);
+
+        } else {
+            fail(S, -res, BEV_EVENT_READING);
+        }
+    }
+
+    void handleSend(SockState& S, int res)
+    {
+        S.inflight--;
+        S.isSending = false;
+
+        if(res==-EINTR || res==-EAGAIN) {
+            startSend(S);
+
+        } else if(res<0) {
+            fail(S, -res, BEV_EVENT_WRITING);
+
+        } else {
+            (void)evbuffer_drain(S.sending.get(), size_t(res));
+            startSend(S);
+        }
+    }
+
+    void handleConnect(SockState& S, int res)
+    {
+        S.inflight--;
+
+        if(S.closing) {
+        } else if(res<0) {
+            fail(S, -res, 0);
+
+        } else {
+            S.connected = true;
+            if(auto user = S.user())
+                bufferevent_trigger_event(user, BEV_EVENT_CONNECTED, 0);
+            armRecv(S);
+            startSend(S);
+        }
+    }
+
+    void onReady()
+    {
+        eventfd_t cnt;
+        (void)eventfd_read(efd, &cnt);
+
+        struct Completion {
+            OpTag* tag;
+            int res;
+            unsigned flags;
+        } done[maxCQE];
+
+        unsigned n;
+        do {
+            io_uring_cqe* cqes[maxCQE];
+            n = io_uring_peek_batch_cqe(&ring, cqes, maxCQE);
+            for(auto i : range(n)) {
+                done[i].tag = static_cast<OpTag*>(io_uring_cqe_get_data(cqes[i]));
+                done[i].res = cqes[i]->res;
+                done[i].flags = cqes[i]->flags;
+            }
+            io_uring_cq_advance(&ring, n);
+
+            // a SockState is only free'd when it has no SQE in flight, so no later CQE in this batch can refer to it
+            for(auto i : range(n)) {
+                auto tag = done[i].tag;
+                if(!tag)
+                    continue; // cancellation
+
+                auto& S = *tag->sock;
+                try {
+                    switch(tag->kind) {
+                    case OpTag::Recv: handleRecv(S, done[i].res, done[i].flags); break;
+                    case OpTag::Send: handleSend(S, done[i].res); break;
+                    case OpTag::Connect: handleConnect(S, done[i].res); break;
+                    }
+                } catch(std::exception& e) {
+                    log_exc_printf(logio, "socket %d unhandled error in completion: %s\n", int(S.sock), e.what());
+                }
+
+                if(S.closing && !S.inflight)
+                    forget(S);
+            }
+        } while(n==maxCQE);
+    }
+
+    static
+    void onReadyS(evutil_socket_t, short, void *raw)
+    {
+        try {
+            static_cast<URingImpl*>(raw)->onReady();
+        } catch(std::exception& e) {
+            log_exc_printf(logio, "Unhandled error in io_uring completion: %s\n", e.what());
+        }
+    }
+
+    void onStarved()
+    {
+        auto waiting(std::move(starved));
+        starved.clear();
+        for(auto S : waiting)
+            armRecv(*S);
+    }
+
+    static
+    void onStarvedS(evutil_socket_t, short, void *raw)
+    {
+        try {
+            static_cast<URingImpl*>(raw)->onStarved();
+        } catch(std::exception& e) {
+            log_exc_printf(logio, "Unhandled error in io_uring RX retry: %s\n", e.what());
+        }
+    }
+
+    static
+    void onSubmitS(evutil_socket_t, short, void *raw)
+    {
+        auto self = static_cast<URingImpl*>(raw);
+        self->submitPending = false;
+        self->submitNow();
+    }
+};
+
+// Callbacks of our end of the pair
+struct WireCB {
+    URingImpl* ring;
+    SockState* sock;
+};
+
+struct SockHandle final : public URingSocket
+{
+    const std::weak_ptr<URingImpl> ring;
+    // valid while ring is alive
+    SockState* const state;
+    const std::unique_ptr<WireCB> cb;
+
+    SockHandle(const std::shared_ptr<URingImpl>& ring, SockState* state, std::unique_ptr<WireCB>&& cb)
+        :URingSocket(state->sock)
+        ,ring(ring)
+        ,state(state)
+        ,cb(std::move(cb))
+    {}
+    virtual ~SockHandle() {
+        if(auto R = ring.lock()) {
+            // no more wire callbacks
+            if(state->wire)
+                bufferevent_setcb(state->wire.get(), nullptr, nullptr, nullptr, nullptr);
+            R->close(*state);
+        }
+    }
+
+    virtual void connect(const SockAddr& peer) override final
+    {
+        auto R(ring.lock());
+        if(!R)
+            throw std::logic_error("io_uring closed");
+        R->connect(*state, peer);
+    }
+};
+
+void wireReadS(struct bufferevent *, void *raw)
+{
+    auto cb = static_cast<WireCB*>(raw);
+    try {
+        // partner output moved to our input
+        cb->ring->startSend(*cb->sock);
+    } catch(std::exception& e) {
+        log_exc_printf(logio, "socket %d unhandled error in TX: %s\n", int(cb->sock->sock), e.what());
+    }
+}
+
+void wireWriteS(struct bufferevent *, void *raw)
+{
+    auto cb = static_cast<WireCB*>(raw);
+    try {
+        // partner has consumed enough of our output
+        auto& S = *cb->sock;
+        if(S.rxPaused) {
+            S.rxPaused = false;
+            cb->ring->armRecv(S);
+        }
+    } catch(std::exception& e) {
+        log_exc_printf(logio, "socket %d unhandled error in RX: %s\n", int(cb->sock->sock), e.what());
+    }
+}
+
+std::shared_ptr<URingSocket> URingImpl::attach(evutil_socket_t sock, bool connected,
+                                               size_t txLimit, size_t rxLimit,
+                                               evbufferevent& bev)
+{
+    loop.assertInLoop();
+
+    std::unique_ptr<SockState> state;
+    try {
+        state.reset(new SockState(sock, connected, std::max(txLimit, size_t(bufSize)), std::max(rxLimit, size_t(bufSize))));
+    } catch(...) {
+        evutil_closesocket(sock);
+        throw;
+    }
+
+    bufferevent* pair[2];
+    if(bufferevent_pair_new(loop.base, BEV_OPT_DEFER_CALLBACKS, pair))
+        throw BAD_ALLOC();
+    evbufferevent user(__FILE__, __LINE__, pair[0]);
+    state->wire = evbufferevent(__FILE__, __LINE__, pair[1]);
+
+    std::unique_ptr<WireCB> cb(new WireCB{this, state.get()});
+    auto wire = state->wire.get();
+    bufferevent_setcb(wire, &wireReadS, &wireWriteS, nullptr, cb.get());
+    // partner output is moved to our input, up to txLimit
+    bufferevent_setwatermark(wire, EV_READ, 0, state->txLimit);
+    // notify when partner input drains
+    bufferevent_setwatermark(wire, EV_WRITE, state->rxLimit/2u, 0);
+    if(bufferevent_enable(wire, EV_READ|EV_WRITE))
+        throw std::logic_error("Unable to enable io_uring BEV");
+
+    auto S = state.get();
+    socks[S] = std::move(state);
+
+    std::shared_ptr<URingSocket> ret(new SockHandle(shared_from_this(), S, std::move(cb)));
+
+    armRecv(*S);
+
+    bev = std::move(user);
+    return ret;
+}
+
+} // namespace
+
+std::shared_ptr<URing> URing::create(const evbase& loop)
+{
+    try {
+        auto ret(std::make_shared<URingImpl>(loop));
+        log_info_printf(logio, "Using io_uring for TCP%s\n", "");
+        return ret;
+    } catch(std::exception& e) {
+        log_warn_printf(logio, "io_uring not available (%s).  Using libevent for TCP\n", e.what());
+        return nullptr;
+    }
+}
+
+#endif // PVXS_ENABLE_IO_URING
+
+}} // namespace pvxs::impl
@@ -0,0 +1,73 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef URING_H
+#define URING_H
+
+#include <memory>
+
+#include "evhelper.h"
+
+namespace pvxs {
+namespace impl {
+
+/** Handle to a TCP socket serviced by a URing.
+ *
+ * Destroying the handle closes the socket.
+ */
+struct URingSocket {
+    const evutil_socket_t sock;
+
+    virtual ~URingSocket();
+
+    //! Begin connecting.  Completion is delivered through the bufferevent as BEV_EVENT_CONNECTED or BEV_EVENT_ERROR.
+    virtual void connect(const SockAddr& peer) =0;
+
+protected:
+    explicit URingSocket(evutil_socket_t sock) :sock(sock) {}
+};
+
+/** io_uring based I/O for TCP sockets, in place of libevent readiness notification.
+ *
+ * Each socket is presented as one end of a bufferevent pair, which may be used as if it
+ * were a socket bufferevent.  The other end is filled by multishot receives into a
+ * registered buffer ring, and drained by sendmsg() directly from evbuffer chains.
+ * Larger receives are passed on by reference, and the buffer returned to the ring once consumed.
+ * New submissions are batched into a single io_uring_enter() once per event loop iteration,
+ * and completions are collected in bulk via an eventfd.
+ *
+ * Only for plain TCP.  TLS and Unix socket connections continue to use socket bufferevents.
+ *
+ * All methods must be called from the event loop thread.
+ */
+struct URing {
+    virtual ~URing();
+
+    /** Create for an event loop.
+     *
+     * @returns nullptr if io_uring is not supported by this build, or by the running kernel.
+     */
+    static
+    std::shared_ptr<URing> create(const evbase& loop);
+
+    /** Take ownership of a socket.
+     *
+     * @param sock A TCP socket.  Either already connected, or to be connected with URingSocket::connect()
+     * @param connected True if sock is already connected.  eg. from accept()
+     * @param txLimit Bytes to be taken from the bufferevent output, and queued for sending.
+     *                Any excess remains in the bufferevent output.
+     * @param rxLimit Receiving is paused while this many bytes are waiting in the bufferevent input.
+     * @param bev Set to the bufferevent through which this socket should be used.
+     * @returns Handle owning sock.
+     */
+    virtual
+    std::shared_ptr<URingSocket> attach(evutil_socket_t sock, bool connected,
+                                        size_t txLimit, size_t rxLimit,
+                                        evbufferevent& bev) =0;
+};
+
+}} // namespace pvxs::impl
+
+#endif // URING_H
@@ -223,8 +223,26 @@ public:
 #undef RWLOCK_RLOCK
 #undef RWLOCK_RUNLOCK
 
+//! @returns false if account is not known.  roles then contains only account.
 PVXS_API
-void osdGetRoles(const std::string& account, std::set<std::string>& roles);
+bool osdGetRoles(const std::string& account, std::set<std::string>& roles);
+
+//! Seconds for which osdGetRoles() results for a known account are remembered
+constexpr double roleCacheTTL = 60.0;
+//! Seconds for which an unknown account is remembered
+constexpr double roleCacheNegativeTTL = 10.0;
+//! Number of accounts remembered
+constexpr size_t roleCacheMaxEntries = 1024u;
+
+//! As osdGetRoles(), through a process wide cache
+PVXS_API
+void getRoles(const std::string& account, std::set<std::string>& roles);
+//! Queue account for resolution by a worker thread, unless already cached
+PVXS_API
+void prefetchRoles(const std::string& account);
+//! Forget all cached roles
+PVXS_API
+void clearRoleCache();
 
 void logger_shutdown();
 
@@ -0,0 +1,142 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/* Compare the throughput of large array GETs between processes on the same host
+ * over loopback TCP, over a Unix socket, and through a shared memory ring.
+ *
+ *   benchlocal [-n <#iterations>] [-s <#elements>] [mode ...]
+ *
+ * Modes are "tcp", "uds" and "shm".  Default is all.
+ * Run with $PVXS_LOG="pvxs.shm=DEBUG" to see when the ring is full.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <epicsTime.h>
+#include <epicsGetopt.h>
+
+#include <pvxs/client.h>
+#include <pvxs/log.h>
+#include <pvxs/nt.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+
+#include "utilpvt.h"
+
+#if EPICS_VERSION_INT < VERSION_INT(7,0,1,0)
+#define epicsMonotonicGet epicsTime::getCurrent
+#endif
+
+using namespace pvxs;
+
+namespace {
+
+template<typename T>
+bool parse_as(T& out, const char *s)
+{
+    std::istringstream strm(s);
+    return (strm>>out).fail() || !strm.eof();
+}
+
+// @returns seconds for one GET
+double timeGets(const std::string& mode, size_t nelem, size_t n)
+{
+
+    auto initial(nt::NTScalar{TypeCode::Float64A}.create());
+    shared_array<double> arr(nelem);
+    for(auto i : range(arr.size()))
+        arr[i] = double(i);
+
+    auto pv(server::SharedPV::buildReadonly());
+    pv.open(initial.update("value", arr.freeze()));
+
+    auto sconf(server::Config::isolated());
+    if(mode!="tcp")
+        sconf.unixSocket = "/tmp";
+    if(mode=="shm")
+        sconf.shmSize = 4u*nelem*sizeof(double);
+    auto serv(sconf.build().addPV("bench", pv));
+    serv.start();
+
+    auto cli(serv.clientConfig().build());
+
+    // connect before timing
+    auto first(cli.get("bench").exec()->wait(10.0));
+    if(first["value"].as<shared_array<const double>>().size()!=nelem)
+        throw std::runtime_error("Unexpected array length");
+
+    auto t0(epicsMonotonicGet());
+    for(size_t i=0; i<n; i++)
+        (void)cli.get("bench").exec()->wait(10.0);
+    auto t1(epicsMonotonicGet());
+
+    return (t1-t0)*1e-9/n;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    logger_config_env();
+    size_t n = 100u;
+    size_t nelem = 1u<<20u;
+
+    int opt;
+    while((opt = getopt(argc, argv, "hn:s:")) != -1) {
+        switch (opt) {
+        case 'h':
+            std::cerr<<"Usage: "<<argv[0]<<" [-n <#iterations>] [-s <#elements>] [mode ...]"<<std::endl;
+            return 0;
+        default:
+            std::cerr<<"Unknown argument -"<<char(opt)<<std::endl;
+            return 1;
+        case 'n':
+            if(parse_as<size_t>(n, optarg) || n==0u) {
+                std::cerr<<"Invalid #iterations: "<<optarg<<std::endl;
+                return 1;
+            }
+            break;
+        case 's':
+            if(parse_as<size_t>(nelem, optarg) || nelem==0u) {
+                std::cerr<<"Invalid #elements: "<<optarg<<std::endl;
+                return 1;
+            }
+            break;
+        }
+    }
+
+    std::vector<std::string> modes;
+    for(int i=optind; i<argc; i++)
+        modes.push_back(argv[i]);
+    if(modes.empty())
+        modes = {"tcp", "uds", "shm"};
+
+    try {
+        const double MB = double(nelem*sizeof(double))/(1024.0*1024.0);
+
+        std::cout<<"# mode\tGET ms\tMB/s\n";
+
+        for(auto& mode : modes) {
+            if(mode!="tcp" && mode!="uds" && mode!="shm") {
+                std::cerr<<"Unknown mode: "<<mode<<std::endl;
+                return 1;
+            }
+            auto tget(timeGets(mode, nelem, n));
+
+            std::cout<<mode
+                     <<"\t"<<tget*1e3
+                     <<"\t"<<MB/tget<<"\n";
+        }
+    } catch(std::exception& e) {
+        std::cerr<<"Error: "<<e.what()<<std::endl;
+        return 1;
+    }
+
+    return 0;
+}
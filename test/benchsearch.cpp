@@ -0,0 +1,137 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/* Time connecting a client to many PVs, with and without bulk connect
+ * search pacing.  The local stand-in server is an isolated server::Server
+ * with one SharedPV per name.
+ *
+ *   benchsearch [-n <#pvs>] [-r <search pkt/s>] [-w <timeout sec>]
+ */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <atomic>
+
+#include <epicsTime.h>
+#include <epicsGetopt.h>
+#include <epicsEvent.h>
+
+#include <pvxs/client.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/nt.h>
+#include <pvxs/log.h>
+
+#include "utilpvt.h"
+
+#if EPICS_VERSION_INT<VERSION_INT(7,0,3,1)
+#  define getMonotonic getCurrent
+#endif
+
+using namespace pvxs;
+
+namespace {
+
+// @returns true if all of 's' was parsed
+template<typename T>
+bool parse_as(T& out, const char *s)
+{
+    std::istringstream strm(s);
+    return !(strm>>out).fail() && strm.eof();
+}
+
+// @returns seconds to connect all, or a negative value on timeout
+double connectAll(const server::Server& serv, size_t npv, double rate, double timeout)
+{
+    auto conf(serv.clientConfig());
+    conf.searchRate = rate;
+    auto ctxt(conf.build());
+
+    std::atomic<size_t> nconn{0u};
+    epicsEvent done;
+
+    std::vector<std::shared_ptr<client::Connect>> conns(npv);
+
+    const auto t0(epicsTime::getMonotonic());
+
+    for(size_t i=0; i<npv; i++) {
+        conns[i] = ctxt.connect(SB()<<"pv"<<i)
+                .onConnect([&nconn, &done, npv]() {
+                    if(++nconn == npv)
+                        done.signal();
+                })
+                .exec();
+    }
+
+    bool ok = done.wait(timeout);
+    const auto t1(epicsTime::getMonotonic());
+
+    auto report(ctxt.report(false));
+    std::cout<<"# rate="<<rate<<" connected "<<nconn.load()<<"/"<<npv
+             <<" in "<<((t1-t0))<<" sec, using "<<report.connections.size()<<" connection(s)\n";
+
+    return ok ? (t1-t0) : -1.0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    logger_config_env();
+    size_t npv = 50000u;
+    double rate = 500.0;
+    double timeout = 120.0;
+
+    int opt;
+    while((opt = getopt(argc, argv, "hn:r:w:")) != -1) {
+        switch (opt) {
+        case 'h':
+            std::cerr<<"Usage: "<<argv[0]<<" [-n <#pvs>] [-r <search pkt/s>] [-w <timeout sec>]"<<std::endl;
+            return 0;
+        default:
+            std::cerr<<"Unknown argument -"<<char(opt)<<std::endl;
+            return 1;
+        case 'n':
+            if(!parse_as<size_t>(npv, optarg)) {
+                std::cerr<<"Invalid #pvs: "<<optarg<<std::endl;
+                return 1;
+            }
+            break;
+        case 'r':
+            if(!parse_as<double>(rate, optarg) || rate<0.0) {
+                std::cerr<<"Invalid rate: "<<optarg<<std::endl;
+                return 1;
+            }
+            break;
+        case 'w':
+            if(!parse_as<double>(timeout, optarg)) {
+                std::cerr<<"Invalid timeout: "<<optarg<<std::endl;
+                return 1;
+            }
+            break;
+        }
+    }
+
+    auto proto(nt::NTScalar{TypeCode::UInt32}.create());
+    auto pv(server::SharedPV::buildReadonly());
+    pv.open(proto.cloneEmpty());
+
+    auto serv(server::Config::isolated().build());
+    for(size_t i=0; i<npv; i++) {
+        serv.addPV(SB()<<"pv"<<i, pv);
+    }
+    serv.start();
+
+    std::cout<<"# Server with "<<npv<<" PVs\n";
+
+    auto tfast(connectAll(serv, npv, 0.0, timeout));
+    auto tpaced(connectAll(serv, npv, rate, timeout));
+
+    std::cout<<"unpaced\t"<<tfast<<"\npaced\t"<<tpaced<<"\n";
+
+    return tfast<0.0 || tpaced<0.0 ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/* Compare the throughput of large array GETs over loopback with plain TCP,
+ * with TLS processed by OpenSSL in user space, and with TLS offloaded to the kernel (kTLS).
+ *
+ *   benchtls [-n <#iterations>] [-s <#elements>] [-S <server keychain>] [-C <client keychain>] [mode ...]
+ *
+ * Modes are "tcp", "tls" and "ktls".  Default is all.
+ * Keychains default to those written by gen_test_certs.  eg. run from the test output directory.
+ * A warning is printed if "ktls" sessions are not offloaded, in which case user space TLS is measured.
+ */
+
+#define PVXS_ENABLE_EXPERT_API
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <epicsTime.h>
+#include <epicsGetopt.h>
+#include <epicsVersion.h>
+
+#include <pvxs/client.h>
+#include <pvxs/log.h>
+#include <pvxs/nt.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+
+#include "utilpvt.h"
+
+#if EPICS_VERSION_INT<VERSION_INT(7,0,3,1)
+#  define getMonotonic getCurrent
+#endif
+
+using namespace pvxs;
+
+namespace {
+
+template<typename T>
+bool parse_as(T& out, const char *s)
+{
+    std::istringstream strm(s);
+    return !(strm>>out).fail() && strm.eof();
+}
+
+// @returns seconds for one GET
+double timeGets(const std::string& mode, const std::string& serverKeychain, const std::string& clientKeychain,
+                size_t nelem, size_t n)
+{
+    const bool tls = mode!="tcp";
+
+    auto initial(nt::NTScalar{TypeCode::Float64A}.create());
+    shared_array<double> arr(nelem);
+    for(auto i : range(arr.size()))
+        arr[i] = double(i);
+
+    auto pv(server::SharedPV::buildReadonly());
+    pv.open(initial.update("value", arr.freeze()));
+
+    auto sconf(server::Config::isolated());
+    if(tls) {
+        sconf.tls_keychain_file = serverKeychain;
+        sconf.tls_kernel_offload = mode=="ktls";
+    }
+    auto serv(sconf.build().addPV("bench", pv));
+    serv.start();
+
+    auto cconf(serv.clientConfig());
+    if(tls)
+        cconf.tls_keychain_file = clientKeychain;
+    auto cli(cconf.build());
+
+    // connect, and complete any offload, before timing
+    auto first(cli.get("bench").exec()->wait(10.0));
+    if(first["value"].as<shared_array<const double>>().size()!=nelem)
+        throw std::runtime_error("Unexpected array length");
+
+    if(mode=="ktls") {
+        bool offloaded = false;
+        for(auto& conn : serv.report().connections)
+            offloaded |= conn.tlsKernelOffload;
+        if(!offloaded)
+            std::cerr<<"# Warning: ktls session not offloaded.  Not supported by OpenSSL or kernel?"<<std::endl;
+    }
+
+    const auto t0(epicsTime::getMonotonic());
+    for(size_t i=0; i<n; i++)
+        (void)cli.get("bench").exec()->wait(10.0);
+    const auto t1(epicsTime::getMonotonic());
+
+    return (t1-t0)/n;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    logger_config_env();
+    size_t n = 100u;
+    size_t nelem = 1u<<20u;
+    std::string serverKeychain("server1.p12"), clientKeychain("client1.p12");
+
+    int opt;
+    while((opt = getopt(argc, argv, "hn:s:S:C:")) != -1) {
+        switch (opt) {
+        case 'h':
+            std::cerr<<"Usage: "<<argv[0]<<" [-n <#iterations>] [-s <#elements>] [-S <server keychain>] [-C <client keychain>] [mode ...]"<<std::endl;
+            return 0;
+        default:
+            std::cerr<<"Unknown argument -"<<char(opt)<<std::endl;
+            return 1;
+        case 'n':
+            if(!parse_as<size_t>(n, optarg) || n==0u) {
+                std::cerr<<"Invalid #iterations: "<<optarg<<std::endl;
+                return 1;
+            }
+            break;
+        case 's':
+            if(!parse_as<size_t>(nelem, optarg) || nelem==0u) {
+                std::cerr<<"Invalid #elements: "<<optarg<<std::endl;
+                return 1;
+            }
+            break;
+        case 'S':
+            serverKeychain = optarg;
+            break;
+        case 'C':
+            clientKeychain = optarg;
+            break;
+        }
+    }
+
+    std::vector<std::string> modes;
+    for(int i=optind; i<argc; i++)
+        modes.push_back(argv[i]);
+    if(modes.empty())
+        modes = {"tcp", "tls", "ktls"};
+
+    try {
+        const double MB = double(nelem*sizeof(double))/(1024.0*1024.0);
+
+        std::cout<<"# mode\tGET ms\tMB/s\n";
+
+        for(auto& mode : modes) {
+            if(mode!="tcp" && mode!="tls" && mode!="ktls") {
+                std::cerr<<"Unknown mode: "<<mode<<std::endl;
+                return 1;
+            }
+            auto tget(timeGets(mode, serverKeychain, clientKeychain, nelem, n));
+
+            std::cout<<mode
+                     <<"\t"<<tget*1e3
+                     <<"\t"<<MB/tget<<"\n";
+        }
+    } catch(std::exception& e) {
+        std::cerr<<"Error: "<<e.what()<<std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,232 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/* Compare key types for the costs paid by PVA TLS and PVACMS.
+ * For each key type, time key generation, full (not resumed) TLS handshakes
+ * through an in-memory BIO pair, and signing of OCSP status responses.
+ *
+ *   benchtlskeys [-n <#iterations>] [key type ...]
+ *
+ * Key types are as accepted by IdFileFactory::keyType().  Default is all.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <openssl/ocsp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#include <epicsTime.h>
+#include <epicsGetopt.h>
+
+#include <pvxs/log.h>
+
+#include "certfilefactory.h"
+#include "ownedptr.h"
+#include "security.h"
+#include "utilpvt.h"
+
+#if EPICS_VERSION_INT < VERSION_INT(7,0,1,0)
+#define epicsMonotonicGet epicsTime::getCurrent
+#endif
+
+using namespace pvxs;
+using pvxs::certs::IdFileFactory;
+
+namespace {
+
+template<typename T>
+bool parse_as(T& out, const char *s)
+{
+    std::istringstream strm(s);
+    return (strm>>out).fail() || !strm.eof();
+}
+
+void must(bool ok, const char* what)
+{
+    if(!ok)
+        throw std::runtime_error(SB()<<"Failed to "<<what);
+}
+
+ossl_ptr<X509> makeCert(const char* CN, EVP_PKEY* key, X509* issuer, EVP_PKEY* ikey, long serial)
+{
+    ossl_ptr<X509> cert(X509_new());
+    must(X509_set_version(cert.get(), 2)==1, "set version");
+    must(X509_set_pubkey(cert.get(), key)==1, "set pubkey");
+    must(ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), serial)==1, "set serial");
+
+    auto sub(X509_get_subject_name(cert.get()));
+    must(X509_NAME_add_entry_by_txt(sub, "CN", MBSTRING_ASC,
+                                    reinterpret_cast<const unsigned char*>(CN), -1, -1, 0)==1, "set CN");
+    must(X509_set_issuer_name(cert.get(), X509_get_subject_name(issuer ? issuer : cert.get()))==1, "set issuer");
+
+    must(!!X509_gmtime_adj(X509_getm_notBefore(cert.get()), 0), "set notBefore");
+    must(!!X509_gmtime_adj(X509_getm_notAfter(cert.get()), 24*60*60), "set notAfter");
+
+    if(!issuer) {
+        X509V3_CTX ctx;
+        X509V3_set_ctx_nodb(&ctx);
+        X509V3_set_ctx(&ctx, cert.get(), cert.get(), nullptr, nullptr, 0);
+        ossl_ptr<X509_EXTENSION> ext(X509V3_EXT_conf_nid(nullptr, &ctx, NID_basic_constraints,
+                                                         const_cast<char*>("critical,CA:TRUE")));
+        must(ext && X509_add_ext(cert.get(), ext.get(), -1)==1, "add basicConstraints");
+    }
+
+    auto signer = ikey ? ikey : key;
+    must(X509_sign(cert.get(), signer, certs::signingDigest(signer))>0, "sign certificate");
+    return cert;
+}
+
+// Move pending bytes from one side's write BIO to the other side's read BIO
+void pump(BIO* from, BIO* to)
+{
+    char buf[4096];
+    int n;
+    while((n = BIO_read(from, buf, sizeof(buf))) > 0)
+        must(BIO_write(to, buf, n)==n, "pump");
+}
+
+// @returns seconds for one full TLS handshake
+double timeHandshakes(X509* cacert, X509* cert, EVP_PKEY* key, size_t n)
+{
+    ossl_ptr<SSL_CTX> sctx(SSL_CTX_new(TLS_server_method()));
+    ossl_ptr<SSL_CTX> cctx(SSL_CTX_new(TLS_client_method()));
+    must(sctx && cctx, "create SSL_CTX");
+
+    must(SSL_CTX_use_certificate(sctx.get(), cert)==1, "use certificate");
+    must(SSL_CTX_use_PrivateKey(sctx.get(), key)==1, "use key");
+    // full handshake each time
+    SSL_CTX_set_session_cache_mode(sctx.get(), SSL_SESS_CACHE_OFF);
+    SSL_CTX_set_options(sctx.get(), SSL_OP_NO_TICKET);
+    SSL_CTX_set_session_cache_mode(cctx.get(), SSL_SESS_CACHE_OFF);
+
+    must(X509_STORE_add_cert(SSL_CTX_get_cert_store(cctx.get()), cacert)==1, "trust CA");
+    SSL_CTX_set_verify(cctx.get(), SSL_VERIFY_PEER, nullptr);
+
+    auto t0(epicsMonotonicGet());
+    for(size_t i=0; i<n; i++) {
+        ossl_ptr<SSL> server(SSL_new(sctx.get()));
+        ossl_ptr<SSL> client(SSL_new(cctx.get()));
+        must(server && client, "create SSL");
+
+        // each SSL owns its pair of memory BIOs
+        SSL_set_bio(server.get(), BIO_new(BIO_s_mem()), BIO_new(BIO_s_mem()));
+        SSL_set_bio(client.get(), BIO_new(BIO_s_mem()), BIO_new(BIO_s_mem()));
+        SSL_set_accept_state(server.get());
+        SSL_set_connect_state(client.get());
+
+        bool sdone = false, cdone = false;
+        for(unsigned round=0u; !(sdone && cdone); round++) {
+            must(round < 16u, "complete handshake");
+
+            if(!cdone) {
+                auto ret = SSL_do_handshake(client.get());
+                cdone = ret==1;
+                must(cdone || SSL_get_error(client.get(), ret)==SSL_ERROR_WANT_READ, "client handshake");
+            }
+            pump(SSL_get_wbio(client.get()), SSL_get_rbio(server.get()));
+
+            if(!sdone) {
+                auto ret = SSL_do_handshake(server.get());
+                sdone = ret==1;
+                must(sdone || SSL_get_error(server.get(), ret)==SSL_ERROR_WANT_READ, "server handshake");
+            }
+            pump(SSL_get_wbio(server.get()), SSL_get_rbio(client.get()));
+        }
+        must(SSL_get_verify_result(client.get())==X509_V_OK, "verify server certificate");
+    }
+    auto t1(epicsMonotonicGet());
+
+    return (t1-t0)*1e-9/n;
+}
+
+// @returns seconds to sign one OCSP response
+double timeOCSPSign(X509* cacert, EVP_PKEY* cakey, X509* cert, size_t n)
+{
+    auto t0(epicsMonotonicGet());
+    for(size_t i=0; i<n; i++) {
+        ossl_ptr<OCSP_BASICRESP> basic(OCSP_BASICRESP_new());
+        auto id(OCSP_cert_to_id(nullptr, cert, cacert));
+        must(!!id, "create OCSP cert id");
+
+        ossl_ptr<ASN1_TIME> now(ASN1_TIME_set(nullptr, time(nullptr)));
+        ossl_ptr<ASN1_TIME> next(ASN1_TIME_set(nullptr, time(nullptr)+30*60));
+        auto single(OCSP_basic_add1_status(basic.get(), id, V_OCSP_CERTSTATUS_GOOD, 0, nullptr, now.get(), next.get()));
+        OCSP_CERTID_free(id);
+        must(!!single, "add OCSP status");
+
+        must(OCSP_basic_sign(basic.get(), cacert, cakey, certs::signingDigest(cakey), nullptr, 0)==1, "sign OCSP response");
+    }
+    auto t1(epicsMonotonicGet());
+
+    return (t1-t0)*1e-9/n;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    logger_config_env();
+    size_t n = 200u;
+
+    int opt;
+    while((opt = getopt(argc, argv, "hn:")) != -1) {
+        switch (opt) {
+        case 'h':
+            std::cerr<<"Usage: "<<argv[0]<<" [-n <#iterations>] [key type ...]"<<std::endl;
+            return 0;
+        default:
+            std::cerr<<"Unknown argument -"<<char(opt)<<std::endl;
+            return 1;
+        case 'n':
+            if(parse_as<size_t>(n, optarg) || n==0u) {
+                std::cerr<<"Invalid #iterations: "<<optarg<<std::endl;
+                return 1;
+            }
+            break;
+        }
+    }
+
+    std::vector<std::string> types;
+    for(int i=optind; i<argc; i++)
+        types.push_back(argv[i]);
+    if(types.empty()) {
+        types = {IdFileFactory::kKeyTypeRsa, IdFileFactory::kKeyTypeP256, IdFileFactory::kKeyTypeP384};
+#ifdef EVP_PKEY_ED25519
+        types.push_back(IdFileFactory::kKeyTypeEd25519);
+#endif
+    }
+
+    try {
+        std::cout<<"# type\tkeygen ms\thandshake ms\thandshakes/s\tOCSP sign ms\tOCSP signs/s\n";
+
+        for(auto& type : types) {
+            auto t0(epicsMonotonicGet());
+            auto cakey(IdFileFactory::createKeyPair(type));
+            auto t1(epicsMonotonicGet());
+            auto key(IdFileFactory::createKeyPair(type));
+
+            auto cacert(makeCert("bench CA", cakey->pkey.get(), nullptr, nullptr, 1));
+            auto cert(makeCert("bench server", key->pkey.get(), cacert.get(), cakey->pkey.get(), 2));
+
+            auto thandshake(timeHandshakes(cacert.get(), cert.get(), key->pkey.get(), n));
+            auto tsign(timeOCSPSign(cacert.get(), cakey->pkey.get(), cert.get(), n));
+
+            std::cout<<IdFileFactory::keyType(type)
+                     <<"\t"<<(t1-t0)*1e-6
+                     <<"\t"<<thandshake*1e3<<"\t"<<1.0/thandshake
+                     <<"\t"<<tsign*1e3<<"\t"<<1.0/tsign<<"\n";
+        }
+    } catch(std::exception& e) {
+        std::cerr<<"Error: "<<e.what()<<std::endl;
+        return 1;
+    }
+
+    return 0;
+}
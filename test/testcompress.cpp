@@ -0,0 +1,137 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#define PVXS_ENABLE_EXPERT_API
+
+#include <testMain.h>
+
+#include <epicsUnitTest.h>
+
+#include <pvxs/unittest.h>
+#include <pvxs/log.h>
+#include <pvxs/client.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/nt.h>
+
+#include "utilpvt.h"
+#include "compress.h"
+#include "pvaproto.h"
+
+namespace {
+using namespace pvxs;
+
+// large payloads are compressed in both directions, when supported by this build
+void testTransfer()
+{
+    testShow()<<__func__;
+
+    auto conf(server::Config::isolated());
+    conf.compress = true;
+    conf.compressThreshold = 1024u;
+
+    auto pv(server::SharedPV::buildMailbox());
+    auto fill = [](size_t n, double base) -> Value {
+        shared_array<double> arr(n);
+        for(auto i : range(n))
+            arr[i] = base + double(i%16u);
+        auto top(nt::NTScalar{TypeCode::Float64A}.create());
+        top["value"] = arr.freeze();
+        return top;
+    };
+    auto check = [](const Value& top, size_t n, double base) -> bool {
+        auto arr(top["value"].as<shared_array<const double>>());
+        if(arr.size()!=n)
+            return false;
+        for(auto i : range(n))
+            if(arr[i]!=base + double(i%16u))
+                return false;
+        return true;
+    };
+
+    pv.open(fill(8192u, 0.0));
+    auto serv = conf.build()
+            .addPV("big", pv);
+    serv.start();
+
+    auto cli = serv.clientConfig().build();
+
+    testTrue(check(cli.get("big").exec()->wait(5.0), 8192u, 0.0));
+
+    cli.put("big").build([&fill](Value&&) { return fill(8192u, 100.0); }).exec()->wait(5.0);
+    testTrue(check(cli.get("big").exec()->wait(5.0), 8192u, 100.0));
+
+    testDiag("Below threshold");
+    cli.put("big").build([&fill](Value&&) { return fill(4u, 7.0); }).exec()->wait(5.0);
+    testTrue(check(cli.get("big").exec()->wait(5.0), 4u, 7.0));
+
+    auto report(serv.report());
+#if defined(PVXS_ENABLE_LZ4) || defined(PVXS_ENABLE_ZSTD)
+    if(testEq(report.connections.size(), 1u)) {
+        auto& conn = report.connections.front();
+        testTrue(conn.txSaved > 0u && conn.rxSaved > 0u)<<" txSaved="<<conn.txSaved<<" rxSaved="<<conn.rxSaved;
+    } else {
+        testSkip(1, "No connection");
+    }
+#else
+    testSkip(2, "Compression not supported by this build");
+#endif
+}
+
+// the uncompressed length claimed by a peer is checked before allocating
+void testBounds(impl::Compressor::algo_t algo)
+{
+    testShow()<<__func__<<" "<<impl::Compressor::name(algo);
+
+    if(!(impl::Compressor::supported() & (1u<<algo))) {
+        testSkip(4, "Not supported by this build");
+        return;
+    }
+
+    impl::Compressor comp(algo, 8u, 1u<<20u);
+    impl::evbuf body(__FILE__, __LINE__, evbuffer_new());
+    std::vector<uint8_t> zeros(1u<<16u);
+
+    // compress zeros, then replace the uncompressed length
+    auto forge = [&comp, &body, &zeros](uint32_t blen) -> bool {
+        (void)evbuffer_drain(body.get(), evbuffer_get_length(body.get()));
+        (void)evbuffer_add(body.get(), zeros.data(), zeros.size());
+        if(!comp.compress(body.get(), true))
+            return false;
+        if(blen) {
+            FixedBuf L(true, evbuffer_pullup(body.get(), 4), 4u);
+            to_wire(L, blen);
+        }
+        return true;
+    };
+
+    testTrue(forge(0u));
+    comp.decompress(body.get(), true);
+    testEq(evbuffer_get_length(body.get()), zeros.size());
+
+    testThrowsMatch<std::runtime_error>("would expand", [&]() {
+        if(forge(2u<<20u))
+            comp.decompress(body.get(), true);
+    })<<" over maxSize";
+
+    testThrowsMatch<std::runtime_error>("can not expand", [&]() {
+        if(forge(1u<<20u))
+            comp.decompress(body.get(), true);
+    })<<" more than compressed length allows";
+}
+
+} // namespace
+
+MAIN(testcompress)
+{
+    testPlan(13);
+    testSetup();
+    logger_config_env();
+    testTransfer();
+    testBounds(impl::Compressor::LZ4);
+    testBounds(impl::Compressor::Zstd);
+    cleanup_for_valgrind();
+    return testDone();
+}
@@ -82,11 +82,15 @@ void testDefs()
         conf.interfaces = {"1.2.3.4", "1.1.1.1"};
         conf.addressList = {"1.2.1.2", "4.3.2.1:1234"};
         conf.autoAddrList = false;
+        conf.searchRate = 250.0;
+        conf.createChannelBatch = 32u;
         conf.updateDefs(defs);
         testEq(defs["EPICS_PVA_BROADCAST_PORT"], "1234");
         testEq(defs["EPICS_PVA_AUTO_ADDR_LIST"], "NO");
         testEq(defs["EPICS_PVA_ADDR_LIST"], "1.2.1.2 4.3.2.1:1234");
         testEq(defs["EPICS_PVA_INTF_ADDR_LIST"], "1.2.3.4 1.1.1.1");
+        testEq(defs["EPICS_PVA_SEARCH_RATE"], "250");
+        testEq(defs["EPICS_PVA_CREATE_BATCH"], "32");
     }
 
     {
@@ -97,11 +101,24 @@ void testDefs()
         defs["EPICS_PVA_AUTO_ADDR_LIST"] = "NO";
         defs["EPICS_PVA_ADDR_LIST"] = "1.2.1.2 4.3.2.1:1234";
         defs["EPICS_PVA_INTF_ADDR_LIST"] = "1.2.3.4 1.1.1.1";
+        defs["EPICS_PVA_SEARCH_RATE"] = "100.5";
+        defs["EPICS_PVA_CREATE_BATCH"] = "16";
         conf.applyDefs(defs);
         testEq(conf.udp_port, 1234);
         testFalse(conf.autoAddrList);
         testEq(conf.addressList, std::vector<std::string>({"1.2.1.2:1234", "4.3.2.1:1234"}));
         testEq(conf.interfaces, std::vector<std::string>({"1.1.1.1", "1.2.3.4"}));
+        testEq(conf.searchRate, 100.5);
+        testEq(conf.createChannelBatch, 16u);
+    }
+
+    for(auto bad : {"-1", "65536", "4294967297"}) {
+        client::Config::defs_t defs;
+        client::Config conf;
+
+        defs["EPICS_PVA_CREATE_BATCH"] = bad;
+        conf.applyDefs(defs);
+        testEq(conf.createChannelBatch, 1u)<<" from "<<bad;
     }
 
     {
@@ -179,7 +196,7 @@ void testClientAuto()
 
 MAIN(testconfig)
 {
-    testPlan(31);
+    testPlan(38);
     testSetup();
     testDefs();
     logger_config_env();
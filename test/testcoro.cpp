@@ -0,0 +1,157 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <thread>
+
+#include <testMain.h>
+
+#include <epicsUnitTest.h>
+
+#include <epicsEvent.h>
+
+#include <pvxs/unittest.h>
+#include <pvxs/log.h>
+#include <pvxs/client.h>
+#include <pvxs/coro.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/nt.h>
+
+#ifdef PVXS_HAS_CORO
+
+namespace {
+using namespace pvxs;
+
+// minimal fire-and-forget coroutine
+struct Task {
+    struct promise_type {
+        Task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() {
+            try {
+                throw;
+            } catch(std::exception& e) {
+                testFail("Unhandled exception in coroutine: %s", e.what());
+            }
+        }
+    };
+};
+
+struct Tester {
+    Value initial;
+    server::SharedPV mbox;
+    server::SharedPV rdonly;
+    server::Server serv;
+    client::Context cli;
+    epicsEvent done;
+
+    Tester()
+        :initial(nt::NTScalar{TypeCode::Int32}.create())
+        ,mbox(server::SharedPV::buildMailbox())
+        ,rdonly(server::SharedPV::buildReadonly())
+        ,serv(server::Config::isolated()
+              .build()
+              .addPV("mailbox", mbox)
+              .addPV("rdonly", rdonly))
+        ,cli(serv.clientConfig().build())
+    {
+        testShow()<<"Server:\n"<<serv.config()
+                  <<"Client:\n"<<cli.config();
+
+        initial["value"] = 42;
+        mbox.open(initial);
+        rdonly.open(initial);
+        serv.start();
+    }
+
+    Task getPut()
+    {
+        auto val = co_await client::coro::exec(cli.get("mailbox"));
+        testEq(val["value"].as<int32_t>(), 42);
+
+        co_await client::coro::exec(cli.put("mailbox").set("value", 43));
+
+        val = co_await client::coro::exec(cli.get("mailbox"));
+        testEq(val["value"].as<int32_t>(), 43);
+
+        try {
+            co_await client::coro::exec(cli.put("rdonly").set("value", 43));
+            testFail("Put to read-only PV succeeds");
+        } catch(client::RemoteError& e) {
+            testPass("Expected error: %s", e.what());
+        }
+
+        done.signal();
+    }
+
+    Task monitor(client::coro::Executor exec)
+    {
+        client::coro::Monitor mon(cli.monitor("mailbox").maskConnected(true), exec);
+
+        auto update = co_await mon.next();
+        testEq(update["value"].as<int32_t>(), 42);
+
+        mbox.post(initial.cloneEmpty().update("value", 43));
+
+        // skip any empty (spurious) wakeups
+        do {
+            update = co_await mon.next();
+        } while(!update);
+        testEq(update["value"].as<int32_t>(), 43);
+
+        done.signal();
+    }
+};
+
+void testGetPut()
+{
+    testShow()<<__func__;
+
+    Tester T;
+    T.getPut();
+    testOk1(T.done.wait(5.0));
+}
+
+void testMonitor()
+{
+    testShow()<<__func__;
+
+    Tester T;
+    client::coro::WorkQueue Q;
+    std::thread worker([&Q]() { Q.run(); });
+
+    T.monitor(Q.executor());
+    testOk1(T.done.wait(5.0));
+
+    Q.stop();
+    worker.join();
+}
+
+} // namespace
+
+MAIN(testcoro)
+{
+    testPlan(7);
+    testSetup();
+    logger_config_env();
+    testGetPut();
+    testMonitor();
+    cleanup_for_valgrind();
+    return testDone();
+}
+
+#else // PVXS_HAS_CORO
+
+MAIN(testcoro)
+{
+    testPlan(1);
+    testSkip(1, "No C++20 coroutine support");
+    return testDone();
+}
+
+#endif // PVXS_HAS_CORO
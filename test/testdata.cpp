@@ -491,11 +491,122 @@ void testClear()
     testFalse(val.isMarked(true, true));
 }
 
+void testAssignSame()
+{
+    testShow()<<__func__;
+
+    auto val = TypeDef(TypeCode::Struct, {
+                           members::UInt32("int"),
+                           members::String("string"),
+                           members::Struct("sub", {
+                               members::UInt32("a"),
+                               members::Struct("b", {
+                                   members::String("c"),
+                               }),
+                           }),
+                           members::Union("choice", {
+                               members::UInt32("x"),
+                               members::String("y"),
+                           }),
+                           members::UInt32A("arr"),
+                       }).create();
+
+    val["int"] = 1u;
+    val["string"] = "unchanged";
+    val["sub.a"] = 2u;
+    val["sub.b.c"] = "nested";
+    val["choice->y"] = "selected";
+    val["arr"] = shared_array<const uint32_t>({1,2,3});
+
+    // only copy 'int', 'choice', and all of 'sub'
+    val.unmark();
+    val["int"] = 5u;
+    val["sub"].mark();
+    val["choice"].mark();
+
+    auto copy(val.clone());
+
+    testTrue(copy["int"].isMarked(false, false));
+    testEq(copy["int"].as<uint32_t>(), 5u);
+    testFalse(copy["string"].isMarked(false, false));
+    testEq(copy["string"].as<std::string>(), "");
+    testTrue(copy["sub"].isMarked(false, false));
+    testTrue(copy["sub.a"].isMarked(false, false));
+    testEq(copy["sub.a"].as<uint32_t>(), 2u);
+    testTrue(copy["sub.b"].isMarked(false, false));
+    testEq(copy["sub.b.c"].as<std::string>(), "nested");
+    testEq(copy.nameOf(copy["choice->"]), "y");
+    testEq(copy["choice"].as<std::string>(), "selected");
+    testFalse(copy["arr"].isMarked(false, false));
+    testEq(copy["arr"].as<shared_array<const void>>().size(), 0u);
+
+    // union storage is not shared
+    copy["choice->y"] = "other";
+    testEq(val["choice"].as<std::string>(), "selected");
+}
+
+void testFreeze()
+{
+    testShow()<<__func__;
+
+    auto val = TypeDef(TypeCode::Struct, {
+                           members::UInt32("int"),
+                           members::Union("choice", {
+                               members::UInt32("x"),
+                               members::String("y"),
+                           }),
+                       }).create();
+
+    val["int"] = 1u;
+    val["choice->y"] = "selected";
+
+    auto fld(val["int"]);
+    val.freeze();
+    testTrue(val.isFrozen());
+    testTrue(fld.isFrozen());
+    testTrue(val["choice->y"].isFrozen());
+
+    testThrows<std::logic_error>([&fld]() {
+        fld = 2u;
+    });
+    testThrows<std::logic_error>([&val]() {
+        val["choice->y"] = "other";
+    });
+    testThrows<std::logic_error>([&val]() {
+        val["choice->x"] = 3u; // select
+    });
+    testThrows<std::logic_error>([&val]() {
+        val.unmark();
+    });
+    testEq(val["int"].as<uint32_t>(), 1u);
+    testEq(val["choice"].as<std::string>(), "selected");
+
+    // shared, so copy on thaw()
+    auto shared(val);
+    shared.thaw();
+    testFalse(shared.isFrozen());
+    testTrue(val.isFrozen());
+    testFalse(shared["choice->y"].isFrozen());
+    shared["int"] = 4u;
+    shared["choice->y"] = "other";
+    testEq(val["int"].as<uint32_t>(), 1u);
+    testEq(val["choice"].as<std::string>(), "selected");
+
+    // only reference, so no copy
+    fld = Value();
+    auto store = Value::Helper::store_ptr(val);
+    val.thaw();
+    testFalse(val.isFrozen());
+    testEq(Value::Helper::store_ptr(val), store);
+    val["choice->y"] = "again";
+    testEq(val["choice"].as<std::string>(), "again");
+}
+
 } // namespace
 
 MAIN(testdata)
 {
-    testPlan(156);
+    testPlan(187);
     testSetup();
     testTraverse();
     testAssign();
@@ -550,6 +661,8 @@ MAIN(testdata)
     testUnionMagicAssign();
     testExtract();
     testClear();
+    testAssignSame();
+    testFreeze();
     cleanup_for_valgrind();
     return testDone();
 }
@@ -7,6 +7,7 @@
 #include <testMain.h>
 
 #include <epicsUnitTest.h>
+#include <epicsEvent.h>
 
 #include <pvxs/unittest.h>
 #include <pvxs/log.h>
@@ -142,15 +143,62 @@ void test_fill_evbuf()
     testEq(evbuffer_get_length(buf.get()), 0u);
 }
 
+void test_wheel()
+{
+    testDiag("%s", __func__);
+
+    evbase base("TEST");
+    epicsEvent done;
+    unsigned nOnce = 0u, nPeriodic = 0u, nCancelled = 0u;
+    std::unique_ptr<WheelTimer> once, periodic, cancelled, last;
+
+    base.call([&]() {
+        once.reset(new WheelTimer(base, [&nOnce]() { nOnce++; }));
+        periodic.reset(new WheelTimer(base, [&nPeriodic, &periodic]() {
+            if(++nPeriodic==3u)
+                periodic->cancel();
+        }));
+        cancelled.reset(new WheelTimer(base, [&nCancelled]() { nCancelled++; }));
+        last.reset(new WheelTimer(base, [&done]() { done.signal(); }));
+
+        once->start(0.1);
+        periodic->start(0.1, true);
+        cancelled->start(0.2);
+        last->start(0.6);
+        testEq(base.wheel().size(), 4u);
+
+        testTrue(cancelled->cancel());
+        testFalse(cancelled->cancel());
+        testEq(base.wheel().size(), 3u);
+    });
+
+    testTrue(done.wait(5.0));
+
+    base.call([&]() {
+        testEq(nOnce, 1u);
+        testEq(nPeriodic, 3u);
+        testEq(nCancelled, 0u);
+        testFalse(periodic->pending());
+        testEq(base.wheel().size(), 0u);
+
+        // must not outlive the evbase
+        once.reset();
+        periodic.reset();
+        cancelled.reset();
+        last.reset();
+    });
+}
+
 } // namespace
 
 MAIN(testev)
 {
     SockAttach attach;
-    testPlan(20);
+    testPlan(30);
     testSetup();
     test_call();
     test_fill_evbuf();
+    test_wheel();
     cleanup_for_valgrind();
     return testDone();
 }
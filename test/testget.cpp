@@ -444,6 +444,101 @@ struct Tester {
 
         testEq(val["value"].as<int32_t>(), other);
     }
+
+    void maxAge()
+    {
+        testShow()<<__func__;
+
+        mbox.open(initial);
+        serv.start();
+
+        auto chanTx = [this]() -> size_t {
+            size_t tx = 0u;
+            for(auto& conn : cli.report(false).connections)
+                for(auto& chan : conn.channels)
+                    tx += chan.tx;
+            return tx;
+        };
+
+        // no Subscription, so from network
+        auto val = cli.get("mailbox").maxAge(10.0).exec()->wait(5.0);
+        testEq(val["value"].as<int32_t>(), 42);
+
+        epicsEvent evt;
+        auto sub(cli.monitor("mailbox")
+                 .maskConnected(true)
+                 .event([&evt](client::Subscription&) { evt.signal(); })
+                 .exec());
+
+        auto waitFor = [&sub, &evt](int32_t expect) {
+            while(true) {
+                if(auto update = sub->pop()) {
+                    if(update["value"].as<int32_t>()==expect)
+                        return true;
+                } else if(!evt.wait(5.0)) {
+                    return false;
+                }
+            }
+        };
+
+        testTrue(waitFor(42))<<" initial update";
+
+        auto tx0 = chanTx();
+        val = cli.get("mailbox").maxAge(10.0).exec()->wait(5.0);
+        testEq(val["value"].as<int32_t>(), 42);
+        testEq(chanTx(), tx0)<<" GET from cache sends nothing";
+
+        mbox.post(initial.cloneEmpty().update("value", 43));
+        testTrue(waitFor(43))<<" second update";
+
+        val = cli.get("mailbox").maxAge(10.0).exec()->wait(5.0);
+        testEq(val["value"].as<int32_t>(), 43);
+
+        // record[] options always from network
+        val = cli.get("mailbox").maxAge(10.0).record("process", false).exec()->wait(5.0);
+        testEq(val["value"].as<int32_t>(), 43);
+        testNotEq(chanTx(), tx0)<<" GET with record[] options from network";
+    }
+
+    void batch()
+    {
+        testShow()<<__func__;
+
+        mbox.open(initial);
+        serv.start();
+
+        auto results(cli.getMany({"mailbox", "mailbox"}).exec()->wait(5.0));
+        if(testEq(results.size(), 2u)) {
+            testEq(results[0]()["value"].as<int32_t>(), 42);
+            testEq(results[1]()["value"].as<int32_t>(), 42);
+        } else {
+            testSkip(2, "No results");
+        }
+
+        // mbox is read-only
+        results = cli.putMany({"mailbox"}, {initial.cloneEmpty().update("value", 43)}).exec()->wait(5.0);
+        testThrows<client::RemoteError>([&results]() {
+            results.at(0)();
+        });
+
+        testEq(cli.getMany({}).exec()->wait(5.0).size(), 0u);
+
+        epicsEvent done;
+        std::vector<client::Result> actual;
+        auto op(cli.getMany({"mailbox"})
+                .result([&actual, &done](std::vector<client::Result>&& results) {
+                    actual = std::move(results);
+                    done.signal();
+                })
+                .exec());
+
+        testOk1(done.wait(5.0));
+        if(testEq(actual.size(), 1u)) {
+            testEq(actual[0]()["value"].as<int32_t>(), 42);
+        } else {
+            testSkip(1, "No result");
+        }
+    }
 };
 
 struct ErrorSource : public server::Source
@@ -516,7 +611,7 @@ void testError(bool phase)
 
 MAIN(testget)
 {
-    testPlan(62);
+    testPlan(78);
     testSetup();
     logger_config_env();
     const bool canIPv6 = pvxs::impl::evsocket::canIPv6;
@@ -537,6 +632,8 @@ MAIN(testget)
     Tester().badRequest();
     Tester().delayExec();
     Tester().ordering();
+    Tester().maxAge();
+    Tester().batch();
     testError(false);
     testError(true);
     cleanup_for_valgrind();
@@ -7,12 +7,16 @@
 #define PVXS_ENABLE_EXPERT_API
 
 #include <atomic>
+#include <cstring>
 
 #include <testMain.h>
 
 #include <epicsUnitTest.h>
 
 #include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsTime.h>
 
 #include <pvxs/unittest.h>
 #include <pvxs/log.h>
@@ -22,6 +26,9 @@
 #include <pvxs/source.h>
 #include <pvxs/nt.h>
 
+#include "utilpvt.h"
+#include "udp_collector.h"
+
 namespace {
 using namespace pvxs;
 
@@ -241,11 +248,162 @@ void testError()
     }
 }
 
+// @returns bytes received by the server
+size_t batchCreate(unsigned batch)
+{
+    testShow()<<__func__<<" "<<batch;
+
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(nt::NTScalar{TypeCode::Int32}.create());
+
+    auto serv = server::Config::isolated().build();
+    for(auto i : {0, 1, 2, 3, 4, 5, 6, 7, 8, 9})
+        serv.addPV(SB()<<"batch"<<i, mbox);
+    serv.start();
+
+    auto conf(serv.clientConfig());
+    conf.createChannelBatch = batch;
+    auto cli = conf.build();
+
+    std::atomic<unsigned> nok{0u};
+    std::atomic<unsigned> ndone{0u};
+    epicsEvent done;
+
+    std::vector<std::shared_ptr<client::Operation>> ops;
+    for(auto i : {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}) {
+        ops.push_back(cli.info(SB()<<"batch"<<i)
+                      .result([&nok, &ndone, &done](client::Result&& result) {
+                          try {
+                              result();
+                              nok++;
+                          }catch(std::exception& e){
+                              testDiag("Error %s", e.what());
+                          }
+                          if(++ndone==10u)
+                              done.signal();
+                      })
+                      .exec());
+    }
+
+    cli.hurryUp();
+
+    testOk1(done.wait(5.0));
+    testEq(nok.load(), 10u);
+    testEq(cli.report(false).connections.size(), 1u);
+
+    auto report(serv.report(false));
+    return report.connections.empty() ? 0u : report.connections.front().rx;
+}
+
+void testBatchCreate()
+{
+    testShow()<<__func__;
+
+    auto single(batchCreate(1u));
+    auto batched(batchCreate(4u));
+
+    // 3 CREATE_CHANNEL messages instead of 10.  Each with an 8 byte header and a 2 byte count.
+    testEq(single - batched, (10u - 3u)*(8u + 2u))<<" single="<<single<<" batched="<<batched;
+}
+
+// Capture the initial search requests sent by a client with Config::searchRate set
+void testSearchPacing()
+{
+    testShow()<<__func__;
+
+    typedef epicsGuard<epicsMutex> Guard;
+
+    // mostly short names, with some too long to fit in the space left at the end of a packet
+    std::vector<std::string> names;
+    for(size_t i=0u; i<120u; i++) {
+        std::string name(SB()<<"pace"<<i<<':');
+        name.resize(i%10u==9u ? 250u : 20u, 'x');
+        names.push_back(name);
+    }
+
+    struct Packet {
+        epicsTime rx;
+        size_t nbytes;
+        size_t nnames;
+    };
+
+    epicsMutex lock;
+    std::set<std::string> seen;
+    std::vector<Packet> initial;
+    epicsEvent done;
+
+    SockAddr listener(SockAddr::loopback(AF_INET));
+    auto manager = UDPManager::instance();
+    auto sub = manager.onSearch(listener, [&](const UDPManager::Search& msg)
+    {
+        Guard G(lock);
+        if(msg.names.empty() || seen.count(msg.names.front().name))
+            return; // discovery, or a later re-search
+
+        // reconstruct message size.  header, search ID, flags, reply address and port
+        size_t nbytes = 8u + 4u + 4u + 16u + 2u;
+        // protocols
+        nbytes += 1u + (msg.protoTCP ? 4u : 0u) + (msg.protoTLS ? 4u : 0u);
+        // names
+        nbytes += 2u;
+        for(auto& name : msg.names) {
+            nbytes += 4u + 1u + strlen(name.name);
+            seen.insert(name.name);
+        }
+        initial.push_back(Packet{epicsTime::getCurrent(), nbytes, msg.names.size()});
+
+        if(seen.size()==names.size())
+            done.signal();
+    });
+    sub->start();
+
+    auto conf(server::Config::isolated().build().clientConfig());
+    conf.addressList = {listener.tostring()};
+    conf.autoAddrList = false;
+    conf.searchRate = 10.0;
+    auto cli(conf.build());
+
+    std::vector<std::shared_ptr<client::Connect>> conns;
+    for(auto& name : names)
+        conns.push_back(cli.connect(name).exec());
+
+    testOk1(done.wait(10.0));
+
+    Guard G(lock);
+    testEq(seen.size(), names.size());
+
+    if(!(testTrue(initial.size()>=2u)<<" packets "<<initial.size())) {
+        testSkip(3, "not paced");
+        return;
+    }
+
+    // 5811 bytes of names in packets of at most 1400 bytes
+    testTrue(initial.size()<=5u)<<" packets "<<initial.size();
+
+    bool full = true;
+    for(size_t i=0u; i<initial.size(); i++) {
+        auto& pkt = initial[i];
+        testDiag("Packet %zu with %zu names, %zu bytes", i, pkt.nnames, pkt.nbytes);
+        if(pkt.nbytes>1400u) {
+            full = false;
+        } else if(i+1u<initial.size() && 1400u-pkt.nbytes >= 4u + 1u + 20u) {
+            full = false; // a short name should have been packed into the remaining space
+        }
+    }
+    testTrue(full)<<" all but the last packet filled";
+
+    // no more than 10 packets per second
+    auto span(initial.back().rx - initial.front().rx);
+    auto expect((initial.size() - 1u) / conf.searchRate);
+    // allow for timer granularity
+    testTrue(span >= expect*0.5)<<" "<<span<<" >= "<<expect<<"*0.5 sec.";
+}
+
 } // namespace
 
 MAIN(testinfo)
 {
-    testPlan(13);
+    testPlan(26);
     testSetup();
     logger_config_env();
     Tester().loopback();
@@ -255,5 +413,7 @@ MAIN(testinfo)
     Tester().asyncCancel();
     Tester().orphan();
     testError();
+    testBatchCreate();
+    testSearchPacing();
     return testDone();
 }
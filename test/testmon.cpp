@@ -5,7 +5,9 @@
  */
 #define PVXS_ENABLE_EXPERT_API
 
+#include <algorithm>
 #include <atomic>
+#include <set>
 #include <typeinfo>
 
 #include <testMain.h>
@@ -13,6 +15,7 @@
 #include <epicsUnitTest.h>
 
 #include <epicsEvent.h>
+#include <epicsThread.h>
 
 #include <pvxs/unittest.h>
 #include <pvxs/log.h>
@@ -21,6 +24,10 @@
 #include <pvxs/sharedpv.h>
 #include <pvxs/source.h>
 #include <pvxs/nt.h>
+#include "evhelper.h"
+#include "pvaproto.h"
+#include "dataimpl.h"
+#include "ndcodec.h"
 
 namespace {
 using namespace pvxs;
@@ -359,11 +366,459 @@ struct TestReconn : public BasicTest
     }
 };
 
+struct TestCQ : public BasicTest
+{
+    typedef std::set<client::Subscription*> subset_t;
+
+    // pop all ready Subscriptions until expected are seen with the expected value
+    subset_t drain(client::CompletionQueue& cq, size_t nexpect, int32_t expect)
+    {
+        subset_t seen;
+        std::vector<std::shared_ptr<client::Subscription>> ready;
+        while(seen.size()<nexpect && cq.wait(ready, 4u, 5.0)) {
+            for(auto& sub : ready) {
+                while(auto val = sub->pop()) {
+                    if(val["value"].as<int32_t>()==expect)
+                        seen.insert(sub.get());
+                }
+            }
+        }
+        return seen;
+    }
+
+    void testCQ()
+    {
+        testShow()<<__func__;
+
+        serv.start();
+        mbox.open(initial);
+
+        client::CompletionQueue cq;
+        auto sub1(cli.monitor("mailbox").completionQueue(cq).exec());
+        auto sub2(cli.monitor("mailbox").completionQueue(cq).exec());
+
+        cli.hurryUp();
+
+        testEq(drain(cq, 2u, 42).size(), 2u)<<" initial updates";
+
+        std::vector<std::shared_ptr<client::Subscription>> ready;
+        testEq(cq.wait(ready, 4u, 0.1), 0u)<<" nothing queued";
+
+        post(43);
+        testEq(drain(cq, 2u, 43).size(), 2u)<<" second updates";
+
+        // implicit cancel
+        sub2.reset();
+        post(44);
+        auto seen(drain(cq, 1u, 44));
+        testEq(seen.size(), 1u);
+        testTrue(seen.find(sub1.get())!=seen.end());
+
+        // several updates queue a Subscription only once
+        for(auto v : {45, 46, 47})
+            post(v);
+        {
+            client::SubscriptionStat stat;
+            for(unsigned i=0u; i<50u; i++) {
+                sub1->stats(stat);
+                if(stat.nQueue>=3u)
+                    break;
+                epicsThreadSleep(0.1);
+            }
+            testEq(stat.nQueue, 3u);
+        }
+        testEq(cq.size(), 1u)<<" queued once";
+        testEq(cq.wait(ready, 4u, 0.1), 1u);
+        testEq(cq.wait(ready, 4u, 0.1), 0u)<<" not queued again until the next update";
+
+        cq.close();
+        testEq(cq.wait(ready, 4u), 0u)<<" closed";
+    }
+
+    void testFrozen()
+    {
+        testShow()<<__func__;
+
+        serv.start();
+        mbox.open(initial);
+
+        client::CompletionQueue cq;
+        auto sub1(cli.monitor("mailbox").record("queueSize", 1).completionQueue(cq).exec());
+        auto sub2(cli.monitor("mailbox").completionQueue(cq).exec());
+
+        cli.hurryUp();
+
+        testEq(drain(cq, 2u, 42).size(), 2u)<<" initial updates";
+
+        // each update is shared by both subscriber queues.
+        // sub1 squashing into a shared update must copy it first.
+        Value update;
+        for(auto v : {43, 44, 45}) {
+            update = initial.cloneEmpty();
+            update["value"] = v;
+            mbox.post(update.freeze());
+        }
+
+        testTrue(update.isFrozen());
+        testEq(update["value"].as<int32_t>(), 45);
+        testEq(drain(cq, 2u, 45).size(), 2u)<<" last updates";
+        testEq(mbox.fetch()["value"].as<int32_t>(), 45);
+    }
+};
+
+struct TestMcast : public BasicTest
+{
+    const std::string group{"239.255.42.42:5081,1@127.0.0.1"};
+
+    Value popWait(double timeout)
+    {
+        while(true) {
+            if(auto ret = sub->pop())
+                return ret;
+            else if(!evt.wait(timeout))
+                return Value();
+        }
+    }
+
+    // subscribe through the group, and wait for the initial value
+    Value setup()
+    {
+        serv.addMulticast("mailbox", group);
+        serv.start();
+        mbox.open(initial);
+
+        sub = cli.monitor("mailbox")
+                .record("multicast", group)
+                .event([this](client::Subscription& sub) {
+                    evt.signal();
+                })
+                .exec();
+
+        cli.hurryUp();
+
+        return popWait(5.0);
+    }
+
+    // updates are delivered through the multicast group, in order
+    void testMcast()
+    {
+        testShow()<<__func__;
+
+        auto first(setup());
+        if(!first) {
+            testSkip(8, "No multicast through loopback");
+            return;
+        }
+        testEq(first["value"].as<int32_t>(), 42);
+
+        for(int32_t v : {43, 44, 45}) {
+            post(v);
+            auto update(popWait(5.0));
+            testEq(update ? update["value"].as<int32_t>() : -1, v);
+        }
+
+        // not through TCP
+        client::SubscriptionStat stats;
+        sub->stats(stats);
+        auto report(serv.report());
+        if(testEq(report.multicasts.size(), 1u)) {
+            auto& info = report.multicasts.front();
+            testEq(info.subscribers, 1u);
+            testTrue(info.seq>=3u)<<" seq="<<info.seq;
+        } else {
+            testSkip(2, "No multicast");
+        }
+        testTrue(stats.nMcast>=4u)<<" nMcast="<<stats.nMcast;
+    }
+
+    // a resumed subscription is sent a complete value through TCP
+    void testResync()
+    {
+        testShow()<<__func__;
+
+        if(!setup()) {
+            testSkip(2, "No multicast through loopback");
+            return;
+        }
+
+        sub->pause(true);
+        post(46);
+        post(47);
+        while(sub->pop()) {}
+        epicsThreadSleep(0.2); // past the client NACK rate limit
+        sub->pause(false);
+
+        Value last;
+        while(auto update = popWait(5.0)) {
+            last = update;
+            if(last["value"].as<int32_t>()==47)
+                break;
+        }
+        testEq(last ? last["value"].as<int32_t>() : -1, 47);
+
+        auto report(serv.report());
+        testTrue(!report.multicasts.empty() && report.multicasts.front().syncs>0u);
+    }
+
+    // send CMD_MCAST_NACK from the given address, and wait for a re-sent update
+    static
+    bool nack(const SockAddr& from, const SockAddr& dest, uint64_t seq, double timeout)
+    {
+        evsocket sock(AF_INET, SOCK_DGRAM, 0);
+        sock.bind(from);
+
+        std::vector<uint8_t> msg;
+        VectorOutBuf M(true, msg);
+        M.skip(8, __FILE__, __LINE__);
+        to_wire(M, "mailbox");
+        to_wire(M, seq);
+        to_wire(M, seq);
+        auto pktlen = M.save()-msg.data();
+        FixedBuf H(true, msg.data(), 8);
+        to_wire(H, Header{CMD_MCAST_NACK, 0u, uint32_t(pktlen-8)});
+        if(!M.good() || !H.good())
+            testAbort("Unable to encode NACK");
+
+        testDiag("NACK %llu from %s to %s", (unsigned long long)seq,
+                 from.tostring().c_str(), dest.tostring().c_str());
+        (void)sendto(sock.sock, (char*)msg.data(), pktlen, 0, &dest->sa, dest.size());
+
+        std::vector<uint8_t> rx(0x10000u);
+        auto expire(epicsTime::getCurrent() + timeout);
+        while(epicsTime::getCurrent() < expire) {
+            SockAddr src;
+            auto nrx = recvfromx{sock.sock, (char*)rx.data(), rx.size(), &src, nullptr}.call();
+            if(nrx>=8 && rx[0]==0xca && rx[3]==CMD_MCAST_DATA)
+                return true;
+            epicsThreadSleep(0.01);
+        }
+        return false;
+    }
+
+    // lost updates are re-sent only to a host with a subscription
+    void testNack()
+    {
+        testShow()<<__func__;
+
+        if(!setup()) {
+            testSkip(4, "No multicast through loopback");
+            return;
+        }
+
+        post(43);
+        (void)popWait(5.0);
+
+        auto report(serv.report());
+        if(report.multicasts.empty()) {
+            testSkip(4, "No multicast");
+            return;
+        }
+        auto info(report.multicasts.front());
+        SockAddr dest(SockAddr::loopback(AF_INET, SockAddr(info.source).port()));
+
+        testTrue(nack(SockAddr::loopback(AF_INET), dest, info.seq, 5.0))<<" from subscriber";
+        testTrue(serv.report().multicasts.front().retransmits>0u);
+
+#ifdef __linux__
+        // anything in 127.0.0.0/8 is loopback
+        testFalse(nack(SockAddr("127.0.0.2"), dest, info.seq, 1.0))<<" from other host";
+        testTrue(serv.report().multicasts.front().nacksIgnored>0u);
+#else
+        testSkip(2, "Second loopback address only on Linux");
+#endif
+    }
+
+    // datagrams sent to the group from a host other than that of the server are ignored
+    void testForeign()
+    {
+        testShow()<<__func__;
+
+        if(!setup()) {
+            testSkip(3, "No multicast through loopback");
+            return;
+        }
+
+        post(43);
+        auto update(popWait(5.0));
+        testEq(update ? update["value"].as<int32_t>() : -1, 43);
+
+#ifdef __linux__
+        auto report(serv.report());
+        if(report.multicasts.empty()) {
+            testSkip(2, "No multicast");
+            return;
+        }
+
+        // forge the next update
+        auto forged(initial.cloneEmpty());
+        forged["value"] = 99;
+
+        std::vector<uint8_t> msg;
+        VectorOutBuf M(true, msg);
+        M.skip(8, __FILE__, __LINE__);
+        to_wire(M, "mailbox");
+        to_wire(M, uint64_t(report.multicasts.front().seq+1u));
+        to_wire(M, uint8_t(pva_mcast_kind::Update));
+        to_wire_valid(M, forged);
+        to_wire(M, uint8_t(0u));
+        auto pktlen = M.save()-msg.data();
+        FixedBuf H(true, msg.data(), 8);
+        to_wire(H, Header{CMD_MCAST_DATA, pva_flags::Server, uint32_t(pktlen-8)});
+        if(!M.good() || !H.good())
+            testAbort("Unable to encode update");
+
+        SockEndpoint dest(group);
+        evsocket sock(AF_INET, SOCK_DGRAM, 0);
+        // anything in 127.0.0.0/8 is loopback
+        sock.bind(SockAddr("127.0.0.2"));
+        sock.mcast_prep_sendto(dest);
+        (void)sendto(sock.sock, (char*)msg.data(), pktlen, 0, &dest.addr->sa, dest.addr.size());
+
+        update = popWait(1.0);
+        testFalse(update)<<" "<<update;
+
+        post(44);
+        update = popWait(5.0);
+        testEq(update ? update["value"].as<int32_t>() : -1, 44);
+#else
+        testSkip(2, "Second loopback address only on Linux");
+#endif
+    }
+};
+
+struct TestCodec : public BasicTest
+{
+    static
+    shared_array<const uint16_t> pattern(unsigned scale)
+    {
+        shared_array<uint16_t> pixels(4096u*4u + 3u);
+        for(size_t i=0u; i<pixels.size(); i++)
+            pixels[i] = uint16_t((i%64u) * (i/4096u + scale));
+        return pixels.freeze();
+    }
+
+    static
+    shared_array<const uint16_t> noise()
+    {
+        shared_array<uint16_t> pixels(4096u*4u + 3u);
+        uint32_t x = 12345u;
+        for(size_t i=0u; i<pixels.size(); i++) {
+            x = x*1103515245u + 12345u;
+            pixels[i] = uint16_t(x>>16u);
+        }
+        return pixels.freeze();
+    }
+
+    // as sent by the server, before any client decodes
+    void testEncode(const char *codec, bool supported)
+    {
+        testShow()<<__func__<<" "<<codec;
+
+        if(!supported) {
+            testSkip(4, "Codec not built");
+            return;
+        }
+
+        auto img(nt::NTNDArray{}.create());
+        img["value->ushortValue"] = pattern(1u);
+
+        auto enc(impl::ndCodecEncode(img, codec));
+        testEq(enc["value"].as<Value>().type(), TypeCode::UInt8A);
+        testEq(enc["codec.name"].as<std::string>(), codec);
+        testTrue(enc["compressedSize"].as<int64_t>() < enc["uncompressedSize"].as<int64_t>())
+                <<" compressedSize="<<enc["compressedSize"].as<int64_t>();
+
+        auto plain(img.cloneEmpty());
+        plain["value->ushortValue"] = noise();
+        plain["codec.name"].unmark();
+        enc = impl::ndCodecEncode(plain, codec);
+        testTrue(enc["value"].as<Value>().type()==TypeCode::UInt16A
+                 && enc["codec.name"].isMarked() && enc["codec.name"].as<std::string>().empty())
+                <<" incompressible sent as is "<<enc["codec.name"];
+    }
+
+    // as written by areaDetector.  bitshuffle, then LZ4, of 8 uint16_t, followed by one more as is
+    void testBSLZ4Vector(bool supported)
+    {
+        testShow()<<__func__;
+
+        if(!supported) {
+            testSkip(2, "Codec not built");
+            return;
+        }
+
+        shared_array<uint16_t> expect({0xfe01, 0xfd02, 0xfb04, 0xf708, 0xef10, 0xdf20, 0xbf40, 0x7f80, 0x1234});
+        shared_array<uint8_t> wire({
+            0x00, 0x00, 0x00, 0x12, // block length (BE)
+            0xf0, 0x01, // LZ4 token. 16 literals, no match
+            // bit planes.  (byte 0, bit 0) ... (byte 1, bit 7)
+            0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+            0xfe, 0xfd, 0xfb, 0xf7, 0xef, 0xdf, 0xbf, 0x7f,
+            0x34, 0x12, // remainder (LE)
+        });
+
+        auto img(nt::NTNDArray{}.create());
+        img["value->ubyteValue"] = wire.freeze();
+        img["codec.name"] = "bslz4";
+        img["codec.parameters"] = 6; // ushort
+        img["uncompressedSize"] = 18;
+
+        testTrue(impl::ndCodecDecode(img));
+        testArrEq(img["value"].as<shared_array<const uint16_t>>(), expect.freeze());
+    }
+
+    // NTNDArray compressed by the server, decompressed by the client
+    void testCodec(const char *codec, bool supported)
+    {
+        testShow()<<__func__<<" "<<codec;
+
+        if(!supported) {
+            testSkip(6, "Codec not built");
+            return;
+        }
+
+        auto expect(pattern(0u));
+
+        auto img(nt::NTNDArray{}.create());
+        img["value->ushortValue"] = expect;
+
+        serv.start();
+        mbox.open(img);
+
+        sub = cli.monitor("mailbox")
+                .record("codec", std::string(codec))
+                .event([this](client::Subscription& sub) {
+                    evt.signal();
+                })
+                .exec();
+
+        cli.hurryUp();
+
+        auto update(pop(sub, evt));
+        testEq(update["value"].as<Value>().type(), TypeCode::UInt16A);
+        testArrEq(update["value"].as<shared_array<const uint16_t>>(), expect);
+        testEq(update["codec.name"].as<std::string>(), "");
+
+        testDiag("Later, and incompressible, updates");
+        for(auto next : {pattern(2u), noise(), pattern(3u)}) {
+            auto delta(img.cloneEmpty());
+            delta["value->ushortValue"] = next;
+            mbox.post(delta);
+
+            update = pop(sub, evt);
+            auto arr(update["value"].as<shared_array<const uint16_t>>());
+            testTrue(arr.size()==next.size() && std::equal(arr.begin(), arr.end(), next.begin())
+                     && update["codec.name"].as<std::string>().empty())
+                    <<" codec.name="<<update["codec.name"];
+        }
+    }
+};
+
 } // namespace
 
 MAIN(testmon)
 {
-    testPlan(41);
+    testPlan(105);
     testSetup();
     try{
         logger_config_env();
@@ -377,6 +832,29 @@ MAIN(testmon)
         TestLifeCycle().testDelta();
         TestReconn().testReconn(false);
         TestReconn().testReconn(true);
+        TestCQ().testCQ();
+        TestCQ().testFrozen();
+        TestMcast().testMcast();
+        TestMcast().testResync();
+        TestMcast().testNack();
+        TestMcast().testForeign();
+#ifdef PVXS_ENABLE_LZ4
+        const bool haveLZ4 = true;
+#else
+        const bool haveLZ4 = false;
+#endif
+#ifdef PVXS_ENABLE_ZSTD
+        const bool haveZstd = true;
+#else
+        const bool haveZstd = false;
+#endif
+        TestCodec().testEncode("lz4", haveLZ4);
+        TestCodec().testEncode("bslz4", haveLZ4);
+        TestCodec().testEncode("zstd", haveZstd);
+        TestCodec().testBSLZ4Vector(haveLZ4);
+        TestCodec().testCodec("lz4", haveLZ4);
+        TestCodec().testCodec("bslz4", haveLZ4);
+        TestCodec().testCodec("zstd", haveZstd);
     }catch(std::exception& e) {
         testFail("Unhandled exception %s : %s", typeid(e).name(), e.what());
         throw;
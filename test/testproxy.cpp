@@ -0,0 +1,273 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#define PVXS_ENABLE_EXPERT_API
+
+#include <testMain.h>
+
+#include <epicsUnitTest.h>
+
+#include <epicsEvent.h>
+#include <epicsThread.h>
+
+#include <pvxs/unittest.h>
+#include <pvxs/log.h>
+#include <pvxs/client.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/source.h>
+#include <pvxs/proxy.h>
+#include <pvxs/nt.h>
+
+namespace {
+using namespace pvxs;
+
+// upstream server, re-served through a ProxySource by a downstream server
+struct Tester {
+    Value initial;
+    server::SharedPV mbox;
+    server::Server upserv;
+    client::Context upcli;
+    server::ProxySource proxy;
+    server::Server serv;
+    client::Context cli;
+
+    Tester()
+        :initial(nt::NTScalar{TypeCode::Int32}.create())
+        ,mbox(server::SharedPV::buildMailbox())
+        ,upserv(server::Config::isolated()
+                .build()
+                .addPV("mailbox", mbox))
+        ,upcli(upserv.clientConfig().build())
+        ,proxy(server::ProxySource::build(upcli))
+        ,serv(server::Config::isolated()
+              .build()
+              .addSource("proxy", proxy.source()))
+        ,cli(serv.clientConfig().build())
+    {
+        testShow()<<"Upstream:\n"<<upserv.config()
+                  <<"Downstream:\n"<<serv.config();
+
+        initial["value"] = 42;
+        mbox.open(initial);
+        upserv.start();
+        serv.start();
+    }
+
+    ~Tester()
+    {
+        proxy.close();
+        if(cli.use_count()>1u)
+            testAbort("Tester Context leak");
+    }
+
+    static
+    Value pop(const std::shared_ptr<client::Subscription>& sub, epicsEvent& evt)
+    {
+        while(true) {
+            if(auto ret = sub->pop()) {
+                return ret;
+
+            } else if (!evt.wait(5.0)) {
+                testAbort("timeout waiting for event");
+            }
+        }
+    }
+
+    // wait for the periodic sweep to act
+    template<typename Fn>
+    static
+    bool waitFor(Fn fn)
+    {
+        for(unsigned i=0u; i<100u; i++) {
+            if(fn())
+                return true;
+            epicsThreadSleep(0.1);
+        }
+        return false;
+    }
+
+    void get()
+    {
+        testShow()<<__func__;
+
+        // first search is not answered, but begins the upstream subscription
+        auto val(cli.get("mailbox").exec()->wait(10.0));
+        testEq(val["value"].as<int32_t>(), 42);
+
+        auto list(proxy.list());
+        testEq(list.size(), 1u);
+        testTrue(list["mailbox"]);
+    }
+
+    void share()
+    {
+        testShow()<<__func__;
+
+        auto cli2(serv.clientConfig().build());
+
+        epicsEvent evt1, evt2;
+        auto sub1(cli.monitor("mailbox")
+                  .event([&evt1](client::Subscription&) { evt1.signal(); })
+                  .exec());
+        auto sub2(cli2.monitor("mailbox")
+                  .event([&evt2](client::Subscription&) { evt2.signal(); })
+                  .exec());
+
+        testEq(pop(sub1, evt1)["value"].as<int32_t>(), 42);
+        testEq(pop(sub2, evt2)["value"].as<int32_t>(), 42);
+
+        auto update(initial.cloneEmpty());
+        update["value"] = 43;
+        mbox.post(update);
+
+        testEq(pop(sub1, evt1)["value"].as<int32_t>(), 43);
+        testEq(pop(sub2, evt2)["value"].as<int32_t>(), 43);
+
+        // served from the proxy cache
+        auto val(cli2.get("mailbox").exec()->wait(5.0));
+        testEq(val["value"].as<int32_t>(), 43);
+
+        size_t nchan = 0u;
+        for(auto& conn : upserv.report().connections) {
+            for(auto& chan : conn.channels) {
+                if(chan.name=="mailbox")
+                    nchan++;
+            }
+        }
+        testEq(nchan, 1u)<<" upstream channels";
+    }
+
+    void put()
+    {
+        testShow()<<__func__;
+
+        proxy.forwardPut(true);
+
+        cli.put("mailbox")
+                .set("value", 44)
+                .exec()->wait(10.0);
+
+        testEq(mbox.fetch()["value"].as<int32_t>(), 44);
+    }
+
+    void putDenied()
+    {
+        testShow()<<__func__;
+
+        // read-only by default
+        testThrows<client::RemoteError>([this]() {
+            cli.put("mailbox")
+                    .set("value", 44)
+                    .exec()->wait(10.0);
+        });
+
+        testEq(mbox.fetch()["value"].as<int32_t>(), 42);
+    }
+
+    void disconnect()
+    {
+        testShow()<<__func__;
+
+        epicsEvent evt;
+        auto sub(cli.monitor("mailbox")
+                 .maskConnected(true)
+                 .maskDisconnected(false)
+                 .event([&evt](client::Subscription&) { evt.signal(); })
+                 .exec());
+
+        testEq(pop(sub, evt)["value"].as<int32_t>(), 42);
+
+        mbox.close();
+
+        testThrows<client::Disconnect>([&sub, &evt]() {
+            pop(sub, evt);
+        });
+
+        mbox.open(initial);
+
+        testEq(pop(sub, evt)["value"].as<int32_t>(), 42);
+    }
+
+    void negative()
+    {
+        testShow()<<__func__;
+
+        proxy.negativeTimeout(2.0);
+
+        testThrows<client::Timeout>([this]() {
+            cli.get("nonexistent").exec()->wait(1.0);
+        });
+
+        // never claimed
+        auto list(proxy.list());
+        if(testEq(list.count("nonexistent"), 1u))
+            testFalse(list.at("nonexistent"));
+        else
+            testSkip(1, "Not searching");
+
+        testTrue(waitFor([this]() { return proxy.list().count("nonexistent")==0u; }))<<" not given up on";
+
+        // ignored while negative, so not searched for upstream again
+        testThrows<client::Timeout>([this]() {
+            cli.get("nonexistent").exec()->wait(0.5);
+        });
+        testEq(proxy.list().count("nonexistent"), 0u);
+    }
+
+    void idle()
+    {
+        testShow()<<__func__;
+
+        proxy.idleTimeout(0.5);
+
+        {
+            auto cli2(serv.clientConfig().build());
+            testEq(cli2.get("mailbox").exec()->wait(10.0)["value"].as<int32_t>(), 42);
+            testEq(proxy.list().count("mailbox"), 1u);
+        }
+
+        // after last downstream client disconnects
+        testTrue(waitFor([this]() { return proxy.list().count("mailbox")==0u; }))<<" not forgotten";
+    }
+
+    void maxSearch()
+    {
+        testShow()<<__func__;
+
+        proxy.maxSearching(1u);
+
+        auto op1(cli.get("nonexistent1").exec());
+        auto op2(cli.get("nonexistent2").exec());
+
+        testThrows<client::Timeout>([&op1]() {
+            op1->wait(1.0);
+        });
+        testThrows<client::Timeout>([&op2]() {
+            op2->wait(0.1);
+        });
+
+        testEq(proxy.list().size(), 1u);
+    }
+};
+
+} // namespace
+
+MAIN(testproxy)
+{
+    testPlan(27);
+    testSetup();
+    logger_config_env();
+    Tester().get();
+    Tester().share();
+    Tester().put();
+    Tester().putDenied();
+    Tester().disconnect();
+    Tester().negative();
+    Tester().idle();
+    Tester().maxSearch();
+    cleanup_for_valgrind();
+    return testDone();
+}
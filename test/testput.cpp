@@ -12,6 +12,7 @@
 #include <epicsUnitTest.h>
 
 #include <epicsEvent.h>
+#include <epicsThread.h>
 
 #include <pvxs/unittest.h>
 #include <pvxs/log.h>
@@ -267,6 +268,39 @@ struct Tester : public TesterBase
         testOk1(done.wait(5.0));
         testEq(mbox.fetch()["value"].as<uint32_t>(), 124u);
     }
+
+    void pool()
+    {
+        testShow()<<__func__;
+
+        server::HandlerPool pool("testpool");
+        mbox.handlerPool(pool);
+        mbox.onPut([](server::SharedPV& pv, std::unique_ptr<server::ExecOp>&& op, Value&& val) {
+            std::string tname(epicsThreadGetNameSelf());
+            testTrue(tname.find("testpool")==0u)<<" onPut() from "<<tname;
+            pv.post(val);
+            op->reply();
+        });
+
+        mbox.open(initial);
+        serv.start();
+
+        testWait(false);
+
+        // reply() is sent before the handler returns
+        for(unsigned i=0u; i<100u && pool.stats().nRun==0u; i++)
+            epicsThreadSleep(0.01);
+        auto stats(pool.stats());
+        testShow()<<stats;
+        testEq(stats.nRun, 1u);
+
+        size_t nrun = 0u;
+        for(auto& spool : serv.report().handlerPools) {
+            if(spool.name=="testpool")
+                nrun = spool.nRun;
+        }
+        testEq(nrun, 1u)<<" Server::report()";
+    }
 };
 
 struct TestPutBuilder : public TesterBase
@@ -310,6 +344,27 @@ struct TestPutBuilder : public TesterBase
     }
 };
 
+void testPoolFull()
+{
+    testShow()<<__func__;
+
+    server::HandlerPool pool("testfull", 1u, 1u);
+    epicsEvent started, release;
+
+    testOk1(pool.submit([&started, &release]() {
+        started.signal();
+        release.wait();
+    }));
+    started.wait();
+
+    testOk1(pool.submit([]() {}));
+    testOk1(!pool.submit([]() {}));
+
+    release.signal();
+
+    testEq(pool.stats().nRejected, 1u);
+}
+
 void testRO()
 {
     testShow()<<__func__;
@@ -411,17 +466,19 @@ void testError()
 
 MAIN(testput)
 {
-    testPlan(40);
+    testPlan(51);
     testSetup();
     logger_config_env();
     Tester().loopback(false);
     Tester().loopback(true);
     Tester().lazy();
+    Tester().pool();
     Tester().timeout();
     Tester().cancel();
     Tester().orphan();
     Tester().manualExec();
     TestPutBuilder().testSet();
+    testPoolFull();
     testRO();
     testError();
     cleanup_for_valgrind();
@@ -296,6 +296,67 @@ namespace {
         testdbGetFieldEqual("async:seq", DBF_LONG, 2);
     }
 
+    void testInProcess()
+    {
+        testDiag("==== %s ====", __func__);
+
+        longinRecord *i1 = (longinRecord *)testdbRecordPtr("src:i1");
+
+        testqsrvWaitForLinkConnected(&i1->inp);
+
+        std::shared_ptr<pvaLinkChannel> lchan;
+        {
+            DBLocker lock((dbCommon*)i1);
+            lchan = static_cast<pvaLink*>(i1->inp.value.json.jlink)->lchan;
+        }
+        Guard G(lchan->lock);
+        testEq(!!lchan->local, !!pvaLinkInProcess)<<" link to local record connects in-process";
+        testEq(!!lchan->op_mon, !pvaLinkInProcess)<<" client subscription";
+    }
+
+    void testReopen()
+    {
+        testDiag("==== %s ====", __func__);
+        auto serv(ioc::server());
+
+        auto special(server::SharedPV::buildReadonly());
+        special.open(nt::NTScalar{TypeCode::Int32}.create()
+                     .update("value", 43));
+        serv.addPV("reopen:pv", special);
+
+        testdbPutFieldOk("reopen.INP", DBR_STRING, "{\"pva\":\"reopen:pv\"}");
+        testqsrvWaitForLinkConnected("reopen.INP");
+
+        auto rec = (longinRecord *)testdbRecordPtr("reopen");
+        auto inProcess = [rec]() -> bool {
+            std::shared_ptr<pvaLinkChannel> lchan;
+            {
+                DBLocker lock((dbCommon*)rec);
+                lchan = static_cast<pvaLink*>(rec->inp.value.json.jlink)->lchan;
+            }
+            Guard G(lchan->lock);
+            return !!lchan->local;
+        };
+
+        testEq(inProcess(), !!pvaLinkInProcess);
+
+        // Source closes the channel.  Link reconnects in-process once re-opened.
+        special.close();
+        testqsrvWaitForLinkConnected("reopen.INP", false);
+
+        special.open(nt::NTScalar{TypeCode::Int32}.create()
+                     .update("value", 44));
+        testqsrvWaitForLinkConnected("reopen.INP");
+
+        testEq(inProcess(), !!pvaLinkInProcess)<<" after re-open";
+
+        testdbPutFieldOk("reopen.PROC", DBF_LONG, 1);
+        testdbGetFieldEqual("reopen.VAL", DBF_LONG, 44);
+
+        serv.removePV("reopen:pv");
+        testdbPutFieldOk("reopen.INP", DBR_STRING, ""); // avoid further log messages
+    }
+
     void testDisconnect()
     {
         testDiag("==== %s ====", __func__);
@@ -483,40 +544,49 @@ extern "C" void testioc_registerRecordDeviceDriver(struct dbBase *);
 
 MAIN(testpvalink)
 {
-    testPlan(92);
+    testPlan(200);
     testSetup();
     pvxs::logger_config_env();
 
-    try
-    {
-        TestIOC IOC;
-
-        testdbReadDatabase("testioc.dbd", NULL, NULL);
-        testioc_registerRecordDeviceDriver(pdbbase);
-        testdbReadDatabase("testpvalink.db", NULL, NULL);
-
-        IOC.init();
-
-        testGet();
-        testFieldLinks();
-        testProc();
-        testSevr();
-        testPut();
-        testStrings();
-        testToFromString();
-        testArrays();
-        testStringArray();
-        testPutAsync();
-        testDisconnect();
-        testMeta();
-        testFwd();
-        testAtomic();
-        testEnum();
-    }
-    catch (std::exception &e)
-    {
-        testFail("Unexpected exception: %s", e.what());
+    // once through the client, and once in-process
+    for(int inProcess : {0, 1}) {
+        try
+        {
+            testDiag("pvaLinkInProcess = %d", inProcess);
+            pvaLinkInProcess = inProcess;
+
+            TestIOC IOC;
+
+            testdbReadDatabase("testioc.dbd", NULL, NULL);
+            testioc_registerRecordDeviceDriver(pdbbase);
+            testdbReadDatabase("testpvalink.db", NULL, NULL);
+
+            IOC.init();
+
+            testGet();
+            testInProcess();
+            testFieldLinks();
+            testProc();
+            testSevr();
+            testPut();
+            testStrings();
+            testToFromString();
+            testArrays();
+            testStringArray();
+            testPutAsync();
+            testDisconnect();
+            testReopen();
+            testMeta();
+            testFwd();
+            testAtomic();
+            testEnum();
+        }
+        catch (std::exception &e)
+        {
+            testFail("Unexpected exception: %s", e.what());
+        }
     }
+
     // call epics atexits explicitly to handle older base w/o de-init hooks
     epicsExitCallAtExits();
     cleanup_for_valgrind();
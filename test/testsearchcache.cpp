@@ -0,0 +1,225 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <atomic>
+#include <cstring>
+
+#include <testMain.h>
+
+#include <epicsUnitTest.h>
+
+#include <epicsEvent.h>
+#include <epicsThread.h>
+
+#include <pvxs/unittest.h>
+#include <pvxs/log.h>
+#include <pvxs/client.h>
+#include <pvxs/server.h>
+#include <pvxs/source.h>
+
+#include "searchcache.h"
+#include "utilpvt.h"
+
+namespace {
+using namespace pvxs;
+
+void testCache()
+{
+    testShow()<<__func__;
+
+    impl::SearchCache cache(4u);
+    testTrue(cache.capacity()>=8u)<<" "<<cache.capacity();
+
+    bool claimed = true;
+    testFalse(cache.lookup("foo", claimed));
+
+    cache.insert("foo", false);
+    cache.insert("bar", true);
+
+    testTrue(cache.lookup("foo", claimed));
+    testFalse(claimed);
+    testTrue(cache.lookup("bar", claimed));
+    testTrue(claimed);
+
+    // update existing
+    cache.insert("foo", true);
+    testTrue(cache.lookup("foo", claimed));
+    testTrue(claimed);
+
+    cache.invalidate();
+    testFalse(cache.lookup("foo", claimed));
+    testFalse(cache.lookup("bar", claimed));
+
+    // overfill.  The most recent is always remembered, and never more than capacity
+    size_t nfound = 0u;
+    for(unsigned i=0u; i<100u; i++) {
+        std::string name(SB()<<"name"<<i);
+        cache.insert(name.c_str(), i&1);
+        if(!cache.lookup(name.c_str(), claimed) || claimed!=bool(i&1))
+            nfound += 1000u; // fail
+    }
+    testEq(nfound, 0u);
+    for(unsigned i=0u; i<100u; i++) {
+        std::string name(SB()<<"name"<<i);
+        if(cache.lookup(name.c_str(), claimed))
+            nfound++;
+    }
+    testTrue(nfound>0u && nfound<=cache.capacity())<<" found "<<nfound;
+}
+
+struct CountingSource : public server::Source
+{
+    std::atomic<unsigned> nsearch{0u};
+    // searches for "late", which is only claimed once allowLate()
+    std::atomic<unsigned> nlate{0u};
+    std::atomic<bool> claimLate{false};
+    // searches without Search::source()
+    std::atomic<unsigned> nnosource{0u};
+    std::shared_ptr<const std::set<std::string>> names;
+
+    CountingSource()
+        :names(std::make_shared<const std::set<std::string>>(std::set<std::string>{"counted"}))
+    {}
+
+    virtual void onSearch(Search &op) override final
+    {
+        if(strncmp(op.source(), "127.", 4u)!=0)
+            nnosource++;
+        for(auto& name : op) {
+            if(strcmp(name.name(), "counted")==0) {
+                nsearch++;
+                name.claim();
+            } else if(strcmp(name.name(), "late")==0) {
+                nlate++;
+                if(claimLate)
+                    name.claim();
+            }
+        }
+    }
+
+    void allowLate()
+    {
+        names = std::make_shared<const std::set<std::string>>(std::set<std::string>{"counted", "late"});
+        claimLate = true;
+        listChanged();
+    }
+    virtual void onCreate(std::unique_ptr<server::ChannelControl> &&op) override final
+    {
+        auto chan = std::move(op);
+
+        chan->onOp([](std::unique_ptr<server::ConnectOp>&& op) {
+            op->error("counted");
+        });
+    }
+    virtual List onList() override final
+    {
+        List ret;
+        ret.names = names;
+        ret.dynamic = false;
+        return ret;
+    }
+};
+
+// @returns true if the name is found within timeout
+bool info(const server::Server& serv, const char *name, double timeout)
+{
+    // a new Context for each, so that each searches
+    auto cli = serv.clientConfig().build();
+
+    epicsEvent done;
+
+    auto op = cli.info(name)
+            .result([&done](client::Result&& result) {
+                done.signal();
+            })
+            .exec();
+
+    // search more than once
+    cli.hurryUp();
+    if(done.wait(timeout/2.0))
+        return true;
+    cli.hurryUp();
+    return done.wait(timeout/2.0);
+}
+
+void infoCounted(const server::Server& serv)
+{
+    testOk(info(serv, "counted", 5.0), "info(\"counted\")");
+}
+
+void testServer()
+{
+    testShow()<<__func__;
+
+    auto src(std::make_shared<CountingSource>());
+
+    auto conf(server::Config::isolated());
+    conf.searchCacheSize = 16u;
+
+    auto serv = conf.build()
+            .addSource("counting", src)
+            .start();
+
+    infoCounted(serv);
+    testEq(src->nsearch.load(), 1u);
+
+    // answered from cache
+    infoCounted(serv);
+    testEq(src->nsearch.load(), 1u);
+
+    // adding a Source invalidates
+    serv.addSource("other", std::make_shared<CountingSource>(), 10);
+
+    infoCounted(serv);
+    testEq(src->nsearch.load(), 2u);
+}
+
+// repeat searches for unknown names
+void testNegative()
+{
+    testShow()<<__func__;
+
+    auto src(std::make_shared<CountingSource>());
+
+    auto conf(server::Config::isolated());
+    conf.searchCacheSize = 16u;
+
+    auto serv = conf.build()
+            .addSource("counting", src)
+            .start();
+
+    testFalse(info(serv, "late", 2.0));
+    testEq(src->nlate.load(), 1u)<<" repeats answered from cache";
+
+    // a Source which changes its names invalidates
+    src->allowLate();
+    testTrue(info(serv, "late", 5.0));
+    testEq(src->nlate.load(), 2u);
+
+    // replacing a Source invalidates
+    auto src2(std::make_shared<CountingSource>());
+    serv.removeSource("counting");
+    serv.addSource("counting", src2);
+
+    testFalse(info(serv, "late", 2.0));
+    testEq(src2->nlate.load(), 1u);
+
+    testEq(src->nnosource.load() + src2->nnosource.load(), 0u);
+}
+
+} // namespace
+
+MAIN(testsearchcache)
+{
+    testPlan(25);
+    testSetup();
+    logger_config_env();
+    testCache();
+    testServer();
+    testNegative();
+    cleanup_for_valgrind();
+    return testDone();
+}
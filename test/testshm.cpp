@@ -0,0 +1,190 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#define PVXS_ENABLE_EXPERT_API
+
+#include <testMain.h>
+
+#include <epicsUnitTest.h>
+
+#include <pvxs/unittest.h>
+#include <pvxs/log.h>
+#include <pvxs/client.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/nt.h>
+
+#include "utilpvt.h"
+#include "shm.h"
+
+#if defined(__linux__)
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+namespace {
+using namespace pvxs;
+
+#if defined(__linux__)
+// large arrays placed in memory shared with clients connected through a Unix socket
+void testGet()
+{
+    testShow()<<__func__;
+
+    auto conf(server::Config::isolated());
+    conf.unixSocket = "@pvxs-testshm";
+    conf.shmSize = 64u*1024u;
+    conf.shmThreshold = 1024u;
+
+    auto pv(server::SharedPV::buildReadonly());
+    auto fill = [&pv](size_t n, double base) {
+        shared_array<double> arr(n);
+        for(auto i : range(n))
+            arr[i] = base + double(i);
+        auto top(nt::NTScalar{TypeCode::Float64A}.create());
+        top["value"] = arr.freeze();
+        if(pv.isOpen())
+            pv.post(top);
+        else
+            pv.open(top);
+    };
+    auto check = [](const Value& top, size_t n, double base) -> bool {
+        auto arr(top["value"].as<shared_array<const double>>());
+        if(arr.size()!=n)
+            return false;
+        for(auto i : range(n))
+            if(arr[i]!=base + double(i))
+                return false;
+        return true;
+    };
+
+    fill(4096u, 0.0);
+    auto serv = conf.build()
+            .addPV("big", pv);
+    serv.start();
+
+    auto cli = serv.clientConfig().build();
+
+    // hold more than fit in the ring, which falls back to inline
+    std::vector<Value> held;
+    for(auto i : range(3u)) {
+        fill(4096u, 1000.0*i);
+        held.push_back(cli.get("big").exec()->wait(5.0));
+    }
+    for(auto i : range(held.size()))
+        testTrue(check(held[i], 4096u, 1000.0*i))<<" result "<<i;
+    held.clear();
+
+    fill(4096u, 42.0);
+    testTrue(check(cli.get("big").exec()->wait(5.0), 4096u, 42.0));
+
+    testDiag("Below threshold");
+    fill(16u, 7.0);
+    testTrue(check(cli.get("big").exec()->wait(5.0), 16u, 7.0));
+}
+
+// the cache of an operation must not hold arrays in the ring
+void testUnpin()
+{
+    testShow()<<__func__;
+
+    auto ring(impl::ShmRing::create(64u*1024u));
+    if(!ring) {
+        testSkip(4, "Shared memory not supported");
+        return;
+    }
+
+    std::vector<uint64_t> released;
+    auto map(impl::ShmMap::open(dup(ring->fd), [&released](uint64_t offset) {
+        released.push_back(offset);
+    }));
+    testTrue(!!map);
+    if(!map) {
+        testSkip(3, "Unable to map");
+        return;
+    }
+
+    shared_array<double> orig(1024u);
+    for(auto i : range(orig.size()))
+        orig[i] = double(i);
+
+    uint64_t offset = 0u;
+    if(!ring->place(orig.data(), orig.size()*sizeof(double), offset))
+        testAbort("Unable to place");
+
+    auto cache(nt::NTScalar{TypeCode::Float64A}.create());
+    {
+        auto region(map->array(offset, orig.size()*sizeof(double)));
+        cache["value"] = shared_array<const double>(region, static_cast<const double*>(region.get()), orig.size());
+    }
+    testTrue(released.empty());
+
+    impl::ShmMap::unpin(cache);
+
+    testEq(released.size(), 1u);
+    auto arr(cache["value"].as<shared_array<const double>>());
+    testArrEq(arr, orig.freeze());
+}
+
+// a client must not be able to resize the ring, which would fault the server on its next place()
+void testShrink()
+{
+    testShow()<<__func__;
+
+    auto ring(impl::ShmRing::create(64u*1024u));
+    if(!ring) {
+        testSkip(5, "Shared memory not supported");
+        return;
+    }
+
+    // as passed to the client
+    testFalse(ftruncate(ring->fd, 0)==0)<<" read-only";
+
+    // a client may re-open its descriptor for writing
+    int rwfd = ::open(("/proc/self/fd/" + std::to_string(ring->fd)).c_str(), O_RDWR|O_CLOEXEC);
+    if(rwfd>=0) {
+        testFalse(ftruncate(rwfd, 0)==0)<<" shrink";
+        testFalse(ftruncate(rwfd, 2u*ring->size)==0)<<" grow";
+        close(rwfd);
+    } else {
+        testSkip(2, "Unable to re-open read-write");
+    }
+
+    shared_array<uint32_t> orig(4096u);
+    for(auto i : range(orig.size()))
+        orig[i] = uint32_t(i);
+
+    // the server survives
+    uint64_t offset = 0u;
+    testTrue(ring->place(orig.data(), orig.size()*sizeof(uint32_t), offset));
+
+    auto map(impl::ShmMap::open(dup(ring->fd), [](uint64_t) {}));
+    if(map) {
+        auto region(map->array(offset, orig.size()*sizeof(uint32_t)));
+        shared_array<const uint32_t> arr(region, static_cast<const uint32_t*>(region.get()), orig.size());
+        testArrEq(arr, orig.freeze());
+    } else {
+        testFail("Unable to map");
+    }
+}
+#endif
+
+} // namespace
+
+MAIN(testshm)
+{
+    testPlan(14);
+    testSetup();
+    logger_config_env();
+#if defined(__linux__)
+    testGet();
+    testUnpin();
+    testShrink();
+#else
+    testSkip(14, "Shared memory only on Linux");
+#endif
+    cleanup_for_valgrind();
+    return testDone();
+}
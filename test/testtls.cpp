@@ -8,9 +8,18 @@
 #include <cstring>
 #include <sstream>
 
+#include <epicsThread.h>
 #include <epicsUnitTest.h>
 #include <testMain.h>
 
+#ifdef __linux__
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  ifndef TCP_ULP
+#    define TCP_ULP 31
+#  endif
+#endif
+
 #include <pvxs/client.h>
 #include <pvxs/log.h>
 #include <pvxs/nt.h>
@@ -20,6 +29,8 @@
 #include <pvxs/unittest.h>
 
 #include "certstatusmanager.h"
+#include "evhelper.h"
+#include "openssl.h"
 #include "testcerts.h"
 #include "utilpvt.h"
 
@@ -476,10 +487,244 @@ void testServerReconfig() {
     testEq(update[TEST_PV_FIELD].as<std::string>(), TLS_METHOD_STRING "/" CERT_CN_IOC1);
 }
 
+/**
+ * @brief testSessionResumption is a test that verifies that reconnecting clients resume their previous TLS session
+ *
+ * The server is stopped and restarted, keeping its TLS context, so the client reconnects and offers the
+ * session ticket it received during the first handshake.  The peer credentials must be unaffected.
+ */
+void testSessionResumption() {
+    testShow() << __func__;
+
+    auto serv_conf(server::Config::isolated());
+    serv_conf.tls_keychain_file = SERVER1_KEYCHAIN_FILE;
+
+    auto serv(serv_conf.build().addSource(WHO_AM_I_PV, std::make_shared<WhoAmI>()));
+
+    auto cli_conf(serv.clientConfig());
+    cli_conf.tls_keychain_file = CLIENT1_KEYCHAIN_FILE;
+
+    auto cli(cli_conf.build());
+
+    serv.start();
+
+    epicsEvent evt;
+    auto sub(cli.monitor(WHO_AM_I_PV).maskConnected(false).maskDisconnected(false).event([&evt](client::Subscription&) { evt.signal(); }).exec());
+
+    try {
+        pop(sub, evt);
+        testFail("Missing expected Connected");
+    } catch (client::Connected& e) {
+        testTrue(e.cred->isTLS);
+    }
+
+    Value update = pop(sub, evt);
+    testEq(update[TEST_PV_FIELD].as<std::string>(), TLS_METHOD_STRING "/" CERT_CN_CLIENT1);
+
+    testDiag("serv.stop()");
+    serv.stop();
+    testThrows<client::Disconnect>([&sub, &evt] { pop(sub, evt); });
+
+    testDiag("serv.start()");
+    serv.start();
+    try {
+        pop(sub, evt);
+        testFail("Missing expected Connected");
+    } catch (client::Connected& e) {
+        testTrue(e.cred->isTLS);
+    }
+
+    update = pop(sub, evt);
+    testEq(update[TEST_PV_FIELD].as<std::string>(), TLS_METHOD_STRING "/" CERT_CN_CLIENT1);
+
+    auto cli_report(cli.report());
+    testEq(cli_report.tlsFullHandshakes, 1u);
+    testEq(cli_report.tlsResumedHandshakes, 1u);
+
+    auto serv_report(serv.report());
+    testEq(serv_report.tlsFullHandshakes, 1u);
+    testEq(serv_report.tlsResumedHandshakes, 1u);
+}
+
+/**
+ * @brief testSharedPeerStatus is a test that verifies that connections from peers presenting the same certificate share one status
+ *
+ * Two client contexts with the same keychain make two connections to the server.  The server tracks the status of
+ * the client certificate once, with both connections subscribed to it.
+ */
+void testSharedPeerStatus() {
+    testShow() << __func__;
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    auto mbox(server::SharedPV::buildReadonly());
+
+    auto serv_conf(server::Config::isolated());
+    serv_conf.tls_keychain_file = SERVER1_KEYCHAIN_FILE;
+
+    auto serv(serv_conf.build().addPV(TEST_PV, mbox));
+
+    auto cli_conf(serv.clientConfig());
+    cli_conf.tls_keychain_file = CLIENT1_KEYCHAIN_FILE;
+
+    auto cli1(cli_conf.build());
+    auto cli2(cli_conf.build());
+
+    mbox.open(initial.update(TEST_PV_FIELD, 42));
+    serv.start();
+
+    testEq(cli1.get(TEST_PV).exec()->wait(5.0)[TEST_PV_FIELD].as<int32_t>(), 42);
+    testEq(cli2.get(TEST_PV).exec()->wait(5.0)[TEST_PV_FIELD].as<int32_t>(), 42);
+
+    auto serv_report(serv.report());
+    testEq(serv_report.connections.size(), 2u);
+    testEq(serv_report.tlsPeerStatuses, 1u);
+    testEq(serv_report.tlsPeerSubscriptions, 2u);
+
+    auto cli_report(cli1.report());
+    testEq(cli_report.tlsPeerSubscriptions, 1u);
+}
+
+/**
+ * @brief Whether TLS 1.3 sessions should be offloaded to the kernel in both directions.
+ *
+ * Needs an OpenSSL built with kTLS, which receives TLS 1.3 from 3.2, and the Linux "tls" module,
+ * which can only be attached to a connected TCP socket.
+ */
+bool expectKernelOffload() {
+#if defined(PVXS_HAVE_KTLS) && defined(__linux__) && !defined(OPENSSL_NO_KTLS) && OPENSSL_VERSION_NUMBER >= 0x30200000L
+    try {
+        evsocket listener(AF_INET, SOCK_STREAM, 0, true), sender(AF_INET, SOCK_STREAM, 0, true);
+        auto addr(SockAddr::loopback(AF_INET));
+        listener.bind(addr);
+        listener.listen(1);
+        if (::connect(sender.sock, &addr->sa, addr.size())) return false;
+        return !setsockopt(sender.sock, SOL_TCP, TCP_ULP, "tls", sizeof("tls"));
+    } catch (std::exception& e) {
+        testDiag("kTLS probe error: %s", e.what());
+        return false;
+    }
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief testKernelOffload is a test that verifies connections when TLS kernel offload is requested
+ *
+ * Whether sessions are actually handed to the kernel depends on the OpenSSL build and on the running kernel.
+ * Where supported, both ends must report the offload.
+ * Peer credentials are taken from the session after offload.
+ */
+void testKernelOffload() {
+    testShow() << __func__;
+
+    auto initial(nt::NTScalar{TypeCode::Float64A}.create());
+    auto mbox(server::SharedPV::buildReadonly());
+
+    auto serv_conf(server::Config::isolated());
+    serv_conf.tls_keychain_file = SERVER1_KEYCHAIN_FILE;
+    serv_conf.tls_kernel_offload = true;
+
+    auto serv(serv_conf.build().addSource(WHO_AM_I_PV, std::make_shared<WhoAmI>()).addPV(TEST_PV, mbox));
+
+    auto cli_conf(serv.clientConfig());
+    cli_conf.tls_keychain_file = CLIENT1_KEYCHAIN_FILE;
+    testTrue(cli_conf.tls_kernel_offload);
+
+    auto cli(cli_conf.build());
+
+    // spans many TLS records
+    shared_array<double> arr(1u << 17u);
+    for (auto i : range(arr.size())) arr[i] = double(i);
+    mbox.open(initial.update(TEST_PV_FIELD, arr.freeze()));
+    serv.start();
+
+    epicsEvent evt;
+    auto sub(cli.monitor(WHO_AM_I_PV).maskConnected(false).maskDisconnected(false).event([&evt](client::Subscription&) { evt.signal(); }).exec());
+
+    try {
+        pop(sub, evt);
+        testFail("Missing expected Connected");
+    } catch (client::Connected& e) {
+        testTrue(e.cred->isTLS);
+    }
+
+    Value update = pop(sub, evt);
+    testEq(update[TEST_PV_FIELD].as<std::string>(), TLS_METHOD_STRING "/" CERT_CN_CLIENT1);
+
+    auto reply(cli.get(TEST_PV).exec()->wait(5.0));
+    auto result(reply[TEST_PV_FIELD].as<shared_array<const double>>());
+    testEq(result.size(), size_t(1u << 17u));
+    testTrue(!result.empty() && result[result.size() - 1u] == double(result.size() - 1u));
+
+    if (expectKernelOffload()) {
+        // the client offloads once it has processed the first reply
+        bool server = false, client = false;
+        for (unsigned i = 0u; i < 100u && !(server && client); i++) {
+            server = client = false;
+            for (auto& conn : serv.report().connections) server |= conn.tlsKernelOffload;
+            for (auto& conn : cli.report().connections) client |= conn.tlsKernelOffload;
+            if (!(server && client)) epicsThreadSleep(0.01);
+        }
+        testTrue(server) << " server offloaded";
+        testTrue(client) << " client offloaded";
+
+        // continues after offload
+        mbox.post(initial.cloneEmpty().update(TEST_PV_FIELD, shared_array<const double>({1.0, 2.0})));
+        testEq(cli.get(TEST_PV).exec()->wait(5.0)[TEST_PV_FIELD].as<shared_array<const double>>().size(), 2u);
+    } else {
+        testSkip(3, "kTLS not supported by OpenSSL or kernel");
+    }
+}
+
+/**
+ * @brief testMulticast verifies that a subscription through TLS is not moved to a multicast group
+ *
+ * Updates sent to the group would be cleartext, and unauthenticated, so continue through the TLS connection.
+ */
+void testMulticast() {
+    testShow() << __func__;
+
+    const std::string group("239.255.42.43:5082,1@127.0.0.1");
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    auto mbox(server::SharedPV::buildReadonly());
+
+    auto serv_conf(server::Config::isolated());
+    serv_conf.tls_keychain_file = SERVER1_KEYCHAIN_FILE;
+
+    auto serv(serv_conf.build().addPV(TEST_PV, mbox).addMulticast(TEST_PV, group));
+
+    auto cli_conf(serv.clientConfig());
+    cli_conf.tls_keychain_file = CLIENT1_KEYCHAIN_FILE;
+
+    auto cli(cli_conf.build());
+
+    mbox.open(initial.update(TEST_PV_FIELD, 42));
+    serv.start();
+
+    epicsEvent evt;
+    auto sub(cli.monitor(TEST_PV).record("multicast", group).event([&evt](client::Subscription&) { evt.signal(); }).exec());
+
+    Value update = pop(sub, evt);
+    testEq(update ? update[TEST_PV_FIELD].as<int32_t>() : -1, 42);
+
+    mbox.post(initial.cloneEmpty().update(TEST_PV_FIELD, 43));
+    update = pop(sub, evt);
+    testEq(update ? update[TEST_PV_FIELD].as<int32_t>() : -1, 43);
+
+    client::SubscriptionStat stats;
+    sub->stats(stats);
+    testEq(stats.nMcast, 0u);
+
+    auto report(serv.report());
+    testTrue(report.multicasts.empty() || report.multicasts.front().subscribers == 0u);
+}
+
 }  // namespace
 
 MAIN(testtls) {
-    testPlan(33);
+    testPlan(60);
     testSetup();
     logger_config_env();
     testLegacyMode();
@@ -492,6 +737,10 @@ MAIN(testtls) {
     testGetNameServer();
     testClientReconfig();
     testServerReconfig();
+    testSessionResumption();
+    testSharedPeerStatus();
+    testKernelOffload();
+    testMulticast();
     cleanup_for_valgrind();
     return testDone();
 }
@@ -127,6 +127,25 @@ struct Tester {
         }
     }
 
+    void parseCached() const {
+        testShow() << __func__;
+        try {
+            testDiag("Re-parsing OCSP Response: %s", "Client certificate");
+            const auto hits = CertStatusManager::verifyCacheHits(trusted_store.get());
+            auto parsed_response = CertStatusManager::parse(client1_cert_status.ocsp_bytes, trusted_store.get());
+            testEq(parsed_response.serial, client1_serial);
+            testEq(parsed_response.ocsp_status.i, OCSP_CERTSTATUS_REVOKED);
+            testEq(CertStatusManager::verifyCacheHits(trusted_store.get()), hits + 1u) << " verification served from cache";
+        } catch (std::exception &e) {
+            testFail("Failed to re-parse Client OCSP response: %s", e.what());
+        }
+
+        // A verification remembered for one trusted store must not be reused for another
+        ossl_ptr<X509_STORE> empty_store(X509_STORE_new());
+        testThrows<OCSPParseException>([this, &empty_store] { CertStatusManager::parse(client1_cert_status.ocsp_bytes, empty_store.get()); });
+        testEq(CertStatusManager::verifyCacheHits(empty_store.get()), 0u);
+    }
+
     void makeStatusResponses() {
         testShow() << __func__;
         const auto cert_status_creator(CertStatusFactory(cert_auth_cert.cert, cert_auth_cert.pkey, cert_auth_cert.chain, 0, STATUS_VALID_FOR_SECS));
@@ -319,13 +338,14 @@ MAIN(testtlsstatus) {
     // Initialize SSL
     ossl::sslInit();
 
-    testPlan(125);
+    testPlan(130);
     testSetup();
     logger_config_env();
     const auto tester = new Tester();
     tester->initialisation();
     tester->ocspPayload();
     tester->parse();
+    tester->parseCached();
     tester->makeStatusResponses();
     tester->testStatusConversions();
     tester->makeStatusRequest();
@@ -0,0 +1,163 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#define PVXS_ENABLE_EXPERT_API
+
+#include <testMain.h>
+
+#include <epicsUnitTest.h>
+
+#include <osiProcess.h>
+
+#include <pvxs/unittest.h>
+#include <pvxs/log.h>
+#include <pvxs/client.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/nt.h>
+#include "evhelper.h"
+
+#if defined(__linux__)
+#  include <unistd.h>
+#  include <sys/stat.h>
+#endif
+
+namespace {
+using namespace pvxs;
+
+#if defined(__linux__)
+// clients on the same host connect through a Unix socket
+struct Tester {
+    std::string account, method, iface, peer;
+    server::SharedPV mbox;
+    server::Server serv;
+
+    explicit Tester(const std::string& unixSocket)
+        :mbox(server::SharedPV::buildMailbox())
+        ,serv([&unixSocket]() {
+                  auto conf(server::Config::isolated());
+                  conf.unixSocket = unixSocket;
+                  return conf;
+              }()
+              .build()
+              .addPV("local", mbox))
+    {
+        testShow()<<"Server:\n"<<serv.config();
+
+        mbox.onPut([this](server::SharedPV& pv, std::unique_ptr<server::ExecOp>&& op, Value&& top) {
+            auto cred(op->credentials());
+            account = cred->account;
+            method = cred->method;
+            iface = cred->iface;
+            peer = cred->peer;
+            pv.post(top);
+            op->reply();
+        });
+        mbox.open(nt::NTScalar{TypeCode::Int32}.create());
+        serv.start();
+    }
+
+    void put(const client::Config& cconf, int32_t val)
+    {
+        auto cli(cconf.build());
+        cli.put("local").set("value", val).exec()->wait(5.0);
+    }
+};
+
+void testAbstract()
+{
+    testShow()<<__func__;
+
+    Tester T("@pvxs-testunix"); // abstract
+
+    T.put(T.serv.clientConfig(), 1);
+
+    std::vector<char> buf(256u);
+    (void)osiGetUserName(buf.data(), buf.size()-1u);
+    testEq(T.account, buf.data());
+    testEq(T.method, "ca");
+    testTrue(T.iface.find("unix:")==0u)<<" iface="<<T.iface;
+    // only the OS knows the PID of the peer process
+    testEq(T.peer, "unix:"+std::to_string(getpid()));
+
+    {
+        auto cconf(T.serv.clientConfig());
+        cconf.unixSocket.clear();
+        T.put(cconf, 2);
+        testTrue(T.iface.find("unix:")==std::string::npos)<<" iface="<<T.iface;
+    }
+
+    {
+        testDiag("No server listening, fall back to TCP");
+        auto cconf(T.serv.clientConfig());
+        cconf.unixSocket = "@pvxs-testunix-nonexistent";
+        T.put(cconf, 3);
+        testTrue(T.iface.find("unix:")==std::string::npos)<<" iface="<<T.iface;
+    }
+}
+
+bool exists(const std::string& path)
+{
+    struct stat info{};
+    return lstat(path.c_str(), &info)==0;
+}
+
+void testStale()
+{
+    testShow()<<__func__;
+
+    const std::string tmpl("/tmp/pvxs-testunix-XXXXXX");
+    std::vector<char> dir(tmpl.begin(), tmpl.end());
+    dir.push_back('\0');
+    if(!mkdtemp(dir.data()))
+        testAbort("Unable to create temporary directory");
+    const std::string prefix(dir.data());
+
+    // left by a server which exited without unlinking
+    const std::string stale(prefix+"/0123456789abcdef01234567");
+    // not named as a server socket
+    const std::string other(prefix+"/other");
+    for(auto& name : {stale, other}) {
+        impl::UnixAddr addr(name);
+        impl::evsocket sock(AF_UNIX, SOCK_STREAM, 0);
+        if(::bind(sock.sock, addr.sa(), addr.len))
+            testAbort("Unable to bind %s", name.c_str());
+    }
+
+    std::string own;
+    {
+        Tester T(prefix);
+        own = impl::unixSocketName(prefix, T.serv.config().guid);
+
+        testFalse(exists(stale))<<" "<<stale;
+        testTrue(exists(other))<<" "<<other;
+
+        T.put(T.serv.clientConfig(), 1);
+        testTrue(T.iface.find("unix:")==0u)<<" iface="<<T.iface;
+    }
+    testFalse(exists(own))<<" "<<own;
+
+    (void)unlink(other.c_str());
+    (void)unlink(stale.c_str());
+    (void)rmdir(prefix.c_str());
+}
+#endif
+
+} // namespace
+
+MAIN(testunix)
+{
+    testPlan(10);
+    testSetup();
+    logger_config_env();
+#if defined(__linux__)
+    testAbstract();
+    testStale();
+#else
+    testSkip(10, "Unix sockets tested only on Linux");
+#endif
+    cleanup_for_valgrind();
+    return testDone();
+}
@@ -0,0 +1,134 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#define PVXS_ENABLE_EXPERT_API
+
+#include <testMain.h>
+
+#include <epicsUnitTest.h>
+
+#include <pvxs/unittest.h>
+#include <pvxs/log.h>
+#include <pvxs/client.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/nt.h>
+
+#include "utilpvt.h"
+
+namespace {
+using namespace pvxs;
+
+// plain TCP connections serviced by io_uring, where supported
+struct Tester {
+    server::SharedPV small;
+    server::SharedPV big;
+    server::Server serv;
+    client::Context cli;
+
+    Tester()
+        :small(server::SharedPV::buildReadonly())
+        ,big(server::SharedPV::buildReadonly())
+        ,serv([]() {
+                  auto conf(server::Config::isolated());
+                  conf.ioUring = true;
+                  return conf;
+              }()
+              .build()
+              .addPV("small", small)
+              .addPV("big", big))
+        ,cli(serv.clientConfig().build())
+    {
+        testShow()<<"Server:\n"<<serv.config()
+                  <<"Client:\n"<<cli.config();
+
+        auto initial(nt::NTScalar{TypeCode::Int32}.create());
+        initial["value"] = 42;
+        small.open(initial);
+
+        big.open(fill(0.0));
+
+        serv.start();
+    }
+
+    ~Tester()
+    {
+        if(cli.use_count()>1u)
+            testAbort("Tester Context leak: %u", unsigned(cli.use_count()));
+    }
+
+    // much larger than one receive buffer
+    static
+    Value fill(double base)
+    {
+        shared_array<double> arr(1u<<16u);
+        for(auto i : range(arr.size()))
+            arr[i] = base + double(i);
+        auto top(nt::NTScalar{TypeCode::Float64A}.create());
+        top["value"] = arr.freeze();
+        return top;
+    }
+
+    static
+    bool check(const Value& top, double base)
+    {
+        auto arr(top["value"].as<shared_array<const double>>());
+        if(arr.size()!=1u<<16u)
+            return false;
+        for(auto i : range(arr.size()))
+            if(arr[i]!=base + double(i))
+                return false;
+        return true;
+    }
+
+    void transfer()
+    {
+        testShow()<<__func__;
+
+        testEq(cli.get("small").exec()->wait(5.0)["value"].as<int32_t>(), 42);
+
+        for(unsigned i=0u; i<3u; i++) {
+            big.post(fill(1000.0*i));
+            testTrue(check(cli.get("big").exec()->wait(5.0), 1000.0*i))<<" iteration "<<i;
+        }
+    }
+
+    void report()
+    {
+        testShow()<<__func__;
+
+        cli.get("small").exec()->wait(5.0);
+
+        if(!serv.config().ioUring) {
+            testSkip(3, "io_uring not supported by this build, or running kernel");
+            return;
+        }
+
+        auto sreport(serv.report());
+        if(testEq(sreport.connections.size(), 1u)) {
+            testTrue(sreport.connections.front().ioUring)<<" server";
+        } else {
+            testSkip(1, "No connection");
+        }
+
+        bool cUring = false;
+        for(auto& conn : cli.report().connections)
+            cUring |= conn.ioUring;
+        testTrue(cUring)<<" client";
+    }
+};
+
+} // namespace
+
+MAIN(testuring)
+{
+    testPlan(7);
+    testSetup();
+    logger_config_env();
+    Tester().transfer();
+    Tester().report();
+    cleanup_for_valgrind();
+    return testDone();
+}
@@ -183,6 +183,50 @@ void testAccount()
     }
 }
 
+void testRoleCache()
+{
+    testShow()<<__func__;
+
+    std::string account;
+    {
+        std::vector<char> buf(128);
+        (void)osiGetUserName(buf.data(), buf.size()-1u);
+        buf.back() = '\0';
+        account = buf.data();
+    }
+
+    std::set<std::string> expect, roles;
+    osdGetRoles(account, expect);
+
+    clearRoleCache();
+    getRoles(account, roles);
+    testTrue(roles==expect);
+
+    // from cache
+    roles.clear();
+    getRoles(account, roles);
+    testTrue(roles==expect);
+
+    // prefetch of an account not cached.  lookup waits for the worker, or finds its result
+    clearRoleCache();
+    prefetchRoles(account);
+    roles.clear();
+    getRoles(account, roles);
+    testTrue(roles==expect);
+
+    // unknown accounts are cached, with themselves as the only role
+    const std::string unknown("pvxs-no-such-account");
+    roles.clear();
+#if defined(_WIN32) || (!defined(__rtems__) && !defined(vxWorks))
+    testFalse(osdGetRoles(unknown, roles));
+#else
+    testSkip(1, "No group lookup.  All accounts are known");
+#endif
+    roles.clear();
+    getRoles(unknown, roles);
+    testTrue(roles==std::set<std::string>{unknown});
+}
+
 void testTestEq()
 {
     testShow()<<__func__;
@@ -291,13 +335,14 @@ void testOnce()
 
 MAIN(testutil)
 {
-    testPlan(35);
+    testPlan(40);
     testTrue(version_abi_check())<<" 0x"<<std::hex<<PVXS_VERSION<<" ~= 0x"<<std::hex<<PVXS_ABI_VERSION;
     testServerGUID();
     testFill();
     testSpam();
     testSpamMany();
     testAccount();
+    testRoleCache();
     testTestEq();
     testStrDiff();
     testOnce();
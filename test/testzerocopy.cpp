@@ -0,0 +1,141 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#define PVXS_ENABLE_EXPERT_API
+
+#include <testMain.h>
+
+#include <epicsUnitTest.h>
+
+#include <osiSock.h>
+
+#include <pvxs/unittest.h>
+#include <pvxs/log.h>
+#include <pvxs/client.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/nt.h>
+
+#include "utilpvt.h"
+
+namespace {
+using namespace pvxs;
+
+// arrays over the threshold are sent by reference, and with MSG_ZEROCOPY where possible
+struct Tester {
+    Value initial;
+    server::SharedPV mbox;
+    server::Server serv;
+    client::Context cli;
+
+    static constexpr size_t bigCount = 1u<<18u;
+
+    Tester()
+        :initial(nt::NTScalar{TypeCode::UInt32A}.create())
+        ,mbox(server::SharedPV::buildReadonly())
+        ,serv([]() {
+                  auto conf(server::Config::isolated());
+                  conf.zeroCopyThreshold = 4096u;
+                  return conf;
+              }()
+              .build()
+              .addPV("big", mbox))
+        ,cli(serv.clientConfig().build())
+    {
+        testShow()<<"Server:\n"<<serv.config();
+
+        shared_array<uint32_t> arr(bigCount);
+        for(auto i : range(arr.size()))
+            arr[i] = uint32_t(i);
+        mbox.open(initial.cloneEmpty().update("value", arr.freeze()));
+        serv.start();
+    }
+
+    ~Tester()
+    {
+        if(cli.use_count()>1u)
+            testAbort("Tester Context leak: %u", unsigned(cli.use_count()));
+    }
+
+    // can this host send with MSG_ZEROCOPY?
+    static
+    bool expectZeroCopy()
+    {
+#if defined(__linux__) && defined(SO_ZEROCOPY)
+        auto sock = epicsSocketCreate(AF_INET, SOCK_STREAM, 0);
+        if(sock==INVALID_SOCKET)
+            return false;
+        int opt = 1;
+        bool ok = setsockopt(sock, SOL_SOCKET, SO_ZEROCOPY, (char*)&opt, sizeof(opt))==0;
+        epicsSocketDestroy(sock);
+        return ok;
+#else
+        return false;
+#endif
+    }
+
+    void big()
+    {
+        testShow()<<__func__;
+
+        (void)serv.report(true);
+
+        // repeat as loopback may have the kernel fall back to copying after the first
+        for(unsigned i=0u; i<3u; i++) {
+            auto result(cli.get("big").exec()->wait(5.0)["value"].as<shared_array<const uint32_t>>());
+            testTrue(result.size()==bigCount && result[bigCount-1u]==uint32_t(bigCount-1u))
+                    <<" iteration "<<i<<" size="<<result.size();
+        }
+
+        auto report(serv.report());
+        if(testEq(report.connections.size(), 1u)) {
+            auto& conn = report.connections.front();
+            testTrue(conn.txReferenced >= 3u*bigCount*sizeof(uint32_t))<<" txReferenced="<<conn.txReferenced;
+            if(expectZeroCopy()) {
+                testTrue(conn.txZeroCopy > 0u)<<" txZeroCopy="<<conn.txZeroCopy;
+            } else {
+                testSkip(1, "MSG_ZEROCOPY not supported");
+            }
+        } else {
+            testSkip(2, "No connection");
+        }
+    }
+
+    void small()
+    {
+        testShow()<<__func__;
+
+        shared_array<uint32_t> arr({1u, 2u, 3u});
+        mbox.post(initial.cloneEmpty().update("value", arr.freeze()));
+        (void)cli.get("big").exec()->wait(5.0);
+
+        (void)serv.report(true);
+
+        auto result(cli.get("big").exec()->wait(5.0)["value"].as<shared_array<const uint32_t>>());
+        testEq(result.size(), 3u);
+
+        auto report(serv.report());
+        if(testEq(report.connections.size(), 1u)) {
+            auto& conn = report.connections.front();
+            testEq(conn.txReferenced, 0u);
+            testEq(conn.txZeroCopy, 0u);
+        } else {
+            testSkip(2, "No connection");
+        }
+    }
+};
+
+} // namespace
+
+MAIN(testzerocopy)
+{
+    testPlan(10);
+    testSetup();
+    logger_config_env();
+    Tester().big();
+    Tester().small();
+    cleanup_for_valgrind();
+    return testDone();
+}